@@ -0,0 +1,43 @@
+#!/usr/bin/env bash
+# File    : checkpoint.sh
+# Purpose : Writes synthetic .safetensors files for the benchmark scripts
+# Author  : Martin Rizzo | <martinrizzo@gmail.com>
+# Date    : Dec 13, 2025
+# Repo    : https://github.com/martin-rizzo/CheckpointTools
+# License : MIT
+#- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+#                              CheckpointTools
+#      CLI tools for inspecting and manipulating model checkpoint files
+#_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _
+# Sourced by the benchmark scripts, it only defines functions.
+
+# Writes a .safetensors file with the given number of F32 tensors of shape
+# [1]. The name of the tensor number `i` is an awk expression of `i`
+# (default: 'model.layers.<i/1000>.block.<i%1000>.weight').
+#
+# Usage:
+#   write_checkpoint FILE NUMBER_OF_TENSORS [NAME_EXPRESSION]
+#
+write_checkpoint() {
+    local file=$1 count=$2 name=${3:-'sprintf("model.layers.%d.block.%d.weight", int(i / 1000), i % 1000)'}
+    local header_file="$1.header" length k
+    awk -v count="$count" 'BEGIN {
+        printf "{"
+        for( i = 0 ; i < count ; ++i ) {
+            if( i > 0 ) { printf "," }
+            printf "\"%s\":{\"dtype\":\"F32\",\"shape\":[1],\"data_offsets\":[%d,%d]}", '"$name"', 4 * i, 4 * i + 4
+        }
+        printf "}"
+    }' > "$header_file" || return 1
+    # the header is padded with spaces to a multiple of 8 bytes
+    length=$(stat -c %s "$header_file")
+    printf '%*s' $(( (8 - length % 8) % 8 )) '' >> "$header_file"
+    length=$(stat -c %s "$header_file")
+    : > "$file"
+    for k in 0 1 2 3 4 5 6 7; do
+        printf "\\$(printf '%03o' $(( (length >> (8 * k)) & 255 )))" >> "$file"
+    done
+    cat "$header_file" >> "$file"
+    head -c $(( 4 * count )) /dev/zero >> "$file"
+    rm -f "$header_file"
+}
@@ -0,0 +1,101 @@
+#!/usr/bin/env bash
+# File    : ckquantize-vs-llama-quantize.sh
+# Purpose : Times ckquantize against llama.cpp's llama-quantize and compares their outputs
+# Author  : Martin Rizzo | <martinrizzo@gmail.com>
+# Date    : Dec 8, 2025
+# Repo    : https://github.com/martin-rizzo/CheckpointTools
+# License : MIT
+#- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+#                              CheckpointTools
+#      CLI tools for inspecting and manipulating model checkpoint files
+#_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _
+SCRIPT_NAME=$(basename "${BASH_SOURCE[0]}" .sh)         # script name without extension
+SCRIPT_DIR=$(realpath "$(dirname "${BASH_SOURCE[0]}")") # script directory
+PROJECT_DIR=$(dirname "$SCRIPT_DIR")                    # project directory
+CKQUANTIZE=${CKQUANTIZE:-"$PROJECT_DIR/builddir/ckquantize"}
+LLAMA_QUANTIZE=${LLAMA_QUANTIZE:-llama-quantize}
+HELP="
+Usage: ./$SCRIPT_NAME.sh [OPTIONS] MODEL.gguf [TYPE...]
+
+  Quantizes MODEL.gguf (a F32/F16/BF16 .gguf, e.g. written by llama.cpp's
+  convert_hf_to_gguf.py) with llama-quantize and with ckquantize, to each
+  TYPE (default: Q8_0 Q4_0 Q4_K Q6_K), and prints the wall time of both.
+
+  llama-quantize runs with '--pure', so every 2D tensor gets TYPE as with
+  ckquantize. Each ckquantize output is then compared byte for byte with
+  the llama-quantize one ('ckquantize --compare'); a second ckquantize run
+  does it, so the comparison is not part of the timing. Tensors whose rows
+  don't fit the block size fall back to another type, which is not the
+  same in both tools; they are listed with both types.
+
+  Options:
+    -t, --threads <N>   Threads for both tools (default: one per core)
+    -o, --output <DIR>  Directory of the outputs (default: a temporary one, removed at the end)
+    -h, --help          Show this help message and exit.
+
+  Environment:
+    CKQUANTIZE          ckquantize binary (default: builddir/ckquantize)
+    LLAMA_QUANTIZE      llama-quantize binary (default: the one in PATH)
+"
+
+fatal_error() { echo -e "\n[ERROR] $1\n" >&2; exit 1; }
+
+# Prints the wall time of a command in seconds, discarding its output.
+#
+# Usage:
+#   wall_time COMMAND [ARGS...]
+#
+wall_time() {
+    local start end
+    start=$(date +%s.%N)
+    "$@" > /dev/null 2>&1 || return 1
+    end=$(date +%s.%N)
+    awk -v start="$start" -v end="$end" 'BEGIN { print end - start }'
+}
+
+main() {
+    local threads=$(nproc) output_dir='' model='' types=()
+
+    while [[ $# -gt 0 ]]; do
+        case $1 in
+            -t|--threads) threads=$2; shift ;;
+            -o|--output)  output_dir=$2; shift ;;
+            -h|--help)    echo "$HELP"; exit 0 ;;
+            -*)           fatal_error "Invalid option: \"$1\", use --help for usage." ;;
+            *)            if [[ -z $model ]]; then model=$1; else types+=("$1"); fi ;;
+        esac
+        shift
+    done
+    [[ -n $model       ]] || fatal_error "No model provided, use --help for usage."
+    [[ -f $model       ]] || fatal_error "The file '$model' doesn't exist."
+    [[ -x $CKQUANTIZE  ]] || fatal_error "ckquantize not found at '$CKQUANTIZE', build it with ./make.sh or set CKQUANTIZE."
+    command -v "$LLAMA_QUANTIZE" > /dev/null || fatal_error "llama-quantize not found, set LLAMA_QUANTIZE."
+    [[ ${#types[@]} -gt 0 ]] || types=(Q8_0 Q4_0 Q4_K Q6_K)
+    if [[ -z $output_dir ]]; then
+        output_dir=$(mktemp -d)
+        trap "rm -rf '$output_dir'" EXIT
+    fi
+
+    local type llama_file ck_file llama_time ck_time different=()
+    printf "%-6s  %16s  %16s  %s\n" "TYPE" "llama-quantize" "ckquantize" "OUTPUTS"
+    for type in "${types[@]}"; do
+        llama_file="$output_dir/llama-$type.gguf"
+        ck_file="$output_dir/ck-$type.gguf"
+        llama_time=$(wall_time "$LLAMA_QUANTIZE" --pure "$model" "$llama_file" "$type" "$threads") \
+            || fatal_error "llama-quantize failed to quantize to $type."
+        ck_time=$(wall_time "$CKQUANTIZE" --no-color -f -t "$threads" -q "$type" -o "$ck_file" "$model") \
+            || fatal_error "ckquantize failed to quantize to $type."
+        if "$CKQUANTIZE" --no-color -f -t "$threads" -q "$type" -o "$ck_file" --compare "$llama_file" "$model" > "$output_dir/compare-$type.txt"; then
+            printf "%-6s  %14.2f s  %14.2f s  identical\n" "$type" "$llama_time" "$ck_time"
+        else
+            printf "%-6s  %14.2f s  %14.2f s  DIFFERENT (see below)\n" "$type" "$llama_time" "$ck_time"
+            different+=("$type")
+        fi
+    done
+    for type in "${different[@]}"; do
+        echo -e "\n==> $type <=="
+        cat "$output_dir/compare-$type.txt"
+    done
+    [[ ${#different[@]} -eq 0 ]]
+}
+main "$@"
@@ -0,0 +1,133 @@
+#!/usr/bin/env bash
+# File    : ckshow-output.sh
+# Purpose : Times the tensor listings of ckshow on a synthetic checkpoint
+# Author  : Martin Rizzo | <martinrizzo@gmail.com>
+# Date    : Dec 10, 2025
+# Repo    : https://github.com/martin-rizzo/CheckpointTools
+# License : MIT
+#- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+#                              CheckpointTools
+#      CLI tools for inspecting and manipulating model checkpoint files
+#_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _
+SCRIPT_NAME=$(basename "${BASH_SOURCE[0]}" .sh)         # script name without extension
+SCRIPT_DIR=$(realpath "$(dirname "${BASH_SOURCE[0]}")") # script directory
+PROJECT_DIR=$(dirname "$SCRIPT_DIR")                    # project directory
+CKSHOW=${CKSHOW:-"$PROJECT_DIR/builddir/ckshow"}
+HELP="
+Usage: ./$SCRIPT_NAME.sh [OPTIONS]
+
+  Writes a synthetic .safetensors file with N tensors (F32, shape [1],
+  named 'model.layers.<L>.block.<B>.weight') and lists it with ckshow in
+  every format: the human tree, plain columns (-b), JSON (-j) and NDJSON
+  (--ndjson). Each listing goes to a file; the script prints its wall time,
+  its size and, when strace is installed, the number of write(2) calls.
+  The JSON listing (and every record of the NDJSON one) is checked with
+  python3 when it is installed.
+
+  With --baseline the same listings are run with a second ckshow binary
+  (e.g. one built from an older commit), so both can be compared on the
+  same file. The formats that binary doesn't support (the option is
+  rejected, or ignored and the human tree printed instead) are skipped.
+
+  Options:
+    -n, --tensors <N>       Number of tensors (default: 1000000)
+    --baseline <CKSHOW>     A second ckshow binary to compare with
+    -o, --output <DIR>      Directory of the files (default: a temporary one, removed at the end)
+    -h, --help              Show this help message and exit.
+
+  Environment:
+    CKSHOW                  ckshow binary (default: builddir/ckshow)
+"
+
+source "$SCRIPT_DIR/checkpoint.sh"                      # for write_checkpoint
+
+fatal_error() { echo -e "\n[ERROR] $1\n" >&2; exit 1; }
+
+# Runs a listing, prints its wall time, size and write(2) calls, and checks
+# the JSON (one document) and NDJSON (one document per line) listings.
+#
+# Usage:
+#   run_listing LABEL OUTPUT CKSHOW [ARGS...]
+#
+run_listing() {
+    local label=$1 output=$2 start end seconds writes='-' valid=''
+    shift 2
+    start=$(date +%s.%N)
+    "$@" > "$output" || fatal_error "'$*' failed."
+    end=$(date +%s.%N)
+    seconds=$(awk -v start="$start" -v end="$end" 'BEGIN { print end - start }')
+    if command -v strace > /dev/null; then
+        strace -f -c -e trace=write -o "$output.strace" "$@" > /dev/null 2>&1
+        writes=$(awk '$NF == "write" { print $4 }' "$output.strace")
+        rm -f "$output.strace"
+    fi
+    if command -v python3 > /dev/null; then
+        case $label in
+            *" json")
+                python3 -c 'import json, sys; json.load(sys.stdin)' < "$output" 2> /dev/null \
+                    && valid='valid JSON' || valid='INVALID JSON' ;;
+            *" ndjson")
+                python3 -c 'import json, sys; [json.loads(line) for line in sys.stdin]' < "$output" 2> /dev/null \
+                    && valid='valid NDJSON' || valid='INVALID NDJSON' ;;
+        esac
+    fi
+    printf "%-22s  %8.2f s  %12s B  %10s  %s\n" "$label" "$seconds" "$(stat -c %s "$output")" "${writes:-0}" "$valid"
+}
+
+# Returns success if a ckshow binary supports a listing format: the option
+# is accepted and the listing of a small file differs from the human one.
+#
+# Usage:
+#   supports_format CKSHOW PROBE_FILE [OPTION]
+#
+supports_format() {
+    local binary=$1 probe=$2 option=$3 human listing
+    [[ -n $option ]] || return 0
+    human=$("$binary" --no-color "$probe" 2> /dev/null)            || return 1
+    listing=$("$binary" --no-color "$option" "$probe" 2> /dev/null) || return 1
+    [[ $listing != "$human" ]]
+}
+
+main() {
+    local count=1000000 baseline='' output_dir='' binaries binary format label name
+    local formats=('human:' 'plain:-b' 'json:-j' 'ndjson:--ndjson')
+
+    while [[ $# -gt 0 ]]; do
+        case $1 in
+            -n|--tensors) count=$2; shift ;;
+            --baseline)   baseline=$2; shift ;;
+            -o|--output)  output_dir=$2; shift ;;
+            -h|--help)    echo "$HELP"; exit 0 ;;
+            *)            fatal_error "Invalid argument: \"$1\", use --help for usage." ;;
+        esac
+        shift
+    done
+    [[ -x $CKSHOW ]] || fatal_error "ckshow not found at '$CKSHOW', build it with ./make.sh or set CKSHOW."
+    [[ -z $baseline || -x $baseline ]] || fatal_error "The baseline '$baseline' is not an executable."
+    if [[ -z $output_dir ]]; then
+        output_dir=$(mktemp -d)
+        trap "rm -rf '$output_dir'" EXIT
+    fi
+    mkdir -p "$output_dir" || fatal_error "Can't create '$output_dir'."
+
+    local model="$output_dir/model.safetensors" probe="$output_dir/probe.safetensors"
+    echo "Writing $count tensors to $model"
+    write_checkpoint "$model" "$count"
+    write_checkpoint "$probe" 4
+
+    printf "\n%-22s  %10s  %14s  %10s\n" "LISTING" "TIME" "SIZE" "WRITES"
+    binaries=("$CKSHOW")
+    [[ -z $baseline ]] || binaries+=("$baseline")
+    for binary in "${binaries[@]}"; do
+        name=$([[ $binary == "$CKSHOW" ]] && echo "ckshow" || echo "baseline")
+        for format in "${formats[@]}"; do
+            label="$name ${format%%:*}"
+            if ! supports_format "$binary" "$probe" "${format#*:}"; then
+                printf "%-22s  %s\n" "$label" "(not supported, skipped)"
+                continue
+            fi
+            run_listing "$label" "$output_dir/$name-${format%%:*}.txt" "$binary" --no-color ${format#*:} "$model"
+        done
+    done
+}
+main "$@"
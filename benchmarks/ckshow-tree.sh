@@ -0,0 +1,115 @@
+#!/usr/bin/env bash
+# File    : ckshow-tree.sh
+# Purpose : Measures the time and memory of the ckshow tensor tree at 10k, 100k and 1M names
+# Author  : Martin Rizzo | <martinrizzo@gmail.com>
+# Date    : Dec 13, 2025
+# Repo    : https://github.com/martin-rizzo/CheckpointTools
+# License : MIT
+#- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+#                              CheckpointTools
+#      CLI tools for inspecting and manipulating model checkpoint files
+#_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _
+SCRIPT_NAME=$(basename "${BASH_SOURCE[0]}" .sh)         # script name without extension
+SCRIPT_DIR=$(realpath "$(dirname "${BASH_SOURCE[0]}")") # script directory
+PROJECT_DIR=$(dirname "$SCRIPT_DIR")                    # project directory
+CKSHOW=${CKSHOW:-"$PROJECT_DIR/builddir/ckshow"}
+HELP="
+Usage: ./$SCRIPT_NAME.sh [OPTIONS] [N...]
+
+  Writes a synthetic .safetensors file for each N (default: 10000 100000
+  1000000) with names like 'model.layers.<L>.block<B>.mlp.w<W>.weight',
+  and measures two ckshow runs on it: the tree listing, which builds the
+  name tree, and the plain listing (-b), which reads the same inventory
+  without building it. For each run the script prints the wall time and
+  the peak RSS (best of several runs); the difference between both rows is
+  the cost of building and printing the tree.
+
+  The peak RSS is read with GNU time (/usr/bin/time) or, without it, with
+  python3.
+
+  Options:
+    -r, --runs <N>      Runs of each listing, the fastest is kept (default: 3)
+    -o, --output <DIR>  Directory of the files (default: a temporary one, removed at the end)
+    -h, --help          Show this help message and exit.
+
+  Environment:
+    CKSHOW              ckshow binary (default: builddir/ckshow)
+"
+source "$SCRIPT_DIR/checkpoint.sh"                      # for write_checkpoint
+
+fatal_error() { echo -e "\n[ERROR] $1\n" >&2; exit 1; }
+
+# Prints the wall time in seconds, the peak RSS in KiB and the exit status
+# of a command, discarding its output.
+#
+# Usage:
+#   measure COMMAND [ARGS...]
+#
+measure() {
+    if [[ -x /usr/bin/time ]]; then
+        /usr/bin/time -f '%e %M %x' -o /dev/stdout "$@" 2> /dev/null > /dev/null | tail -n 1
+        return
+    fi
+    python3 - "$@" <<'PYTHON'
+import resource, subprocess, sys, time
+start = time.perf_counter()
+code  = subprocess.call(sys.argv[1:], stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+print(f"{time.perf_counter() - start:.3f} {resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss} {code}")
+PYTHON
+}
+
+# Prints the best wall time and the peak RSS of several runs of a command.
+#
+# Usage:
+#   best_of RUNS COMMAND [ARGS...]
+#
+best_of() {
+    local runs=$1 run seconds rss status best='' peak=0
+    shift
+    for (( run = 0 ; run < runs ; ++run )); do
+        read -r seconds rss status < <(measure "$@")
+        [[ $status == 0 ]] || return 1
+        best=$(awk -v a="$best" -v b="$seconds" 'BEGIN { print (a == "" || b < a) ? b : a }')
+        (( rss > peak )) && peak=$rss
+    done
+    echo "$best $peak"
+}
+
+main() {
+    local runs=3 output_dir='' counts=() count model tree flat
+    local names='sprintf("model.layers.%d.block%d.mlp.w%d.weight", int(i / 1000), int(i / 10) % 100, i % 10)'
+
+    while [[ $# -gt 0 ]]; do
+        case $1 in
+            -r|--runs)   runs=$2; shift ;;
+            -o|--output) output_dir=$2; shift ;;
+            -h|--help)   echo "$HELP"; exit 0 ;;
+            -*)          fatal_error "Invalid option: \"$1\", use --help for usage." ;;
+            *)           counts+=("$1") ;;
+        esac
+        shift
+    done
+    [[ -x $CKSHOW ]] || fatal_error "ckshow not found at '$CKSHOW', build it with ./make.sh or set CKSHOW."
+    [[ -x /usr/bin/time ]] || command -v python3 > /dev/null || fatal_error "Neither GNU time nor python3 found."
+    [[ ${#counts[@]} -gt 0 ]] || counts=(10000 100000 1000000)
+    if [[ -z $output_dir ]]; then
+        output_dir=$(mktemp -d)
+        trap "rm -rf '$output_dir'" EXIT
+    fi
+    mkdir -p "$output_dir" || fatal_error "Can't create '$output_dir'."
+
+    printf "%-8s  %24s  %24s  %24s\n" "NAMES" "tree (time, RSS)" "plain -b (time, RSS)" "tree cost"
+    for count in "${counts[@]}"; do
+        model="$output_dir/model-$count.safetensors"
+        write_checkpoint "$model" "$count" "$names" || fatal_error "Can't write '$model'."
+        tree=$(best_of "$runs" "$CKSHOW" --no-color "$model")    || fatal_error "ckshow failed on '$model'."
+        flat=$(best_of "$runs" "$CKSHOW" --no-color -b "$model") || fatal_error "ckshow -b failed on '$model'."
+        awk -v count="$count" -v tree="$tree" -v flat="$flat" 'BEGIN {
+            split(tree, t, " "); split(flat, f, " ")
+            printf "%-8s  %8.3f s  %8.1f MiB  %8.3f s  %8.1f MiB  %8.3f s  %8.1f MiB\n", count,
+                   t[1], t[2] / 1024, f[1], f[2] / 1024, t[1] - f[1], (t[2] - f[2]) / 1024
+        }'
+        rm -f "$model"
+    done
+}
+main "$@"
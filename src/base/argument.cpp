@@ -26,8 +26,9 @@ Argument::Argument(int i, int argc, char* argv[]) {
     StringView next{ (i+1) < argc ? argv[i+1] : "" };
 
     // by default, assume the associated value is the next non-option argument
+    // (a lone "-" is a value, the usual name of the standard input)
     _name = curr;
-    if( !next.starts_with("-") ) { _value = next; }
+    if( !next.starts_with("-") || next == "-" ) { _value = next; }
 
     // if the current argument starts with "-" and contains an "=",
     // extract the embedded value
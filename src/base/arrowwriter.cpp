@@ -0,0 +1,412 @@
+/*
+| File    : arrowwriter.cpp
+| Purpose : A small self-contained encoder of Arrow IPC streams.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 11, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm>  // for std::max
+#include <bit>        // for std::endian
+#include "arrowwriter.h"
+
+// values of the unions and enums of Arrow's Schema.fbs and Message.fbs
+namespace arrow {
+    enum : std::uint8_t  { HeaderSchema = 1, HeaderDictionaryBatch = 2, HeaderRecordBatch = 3 };
+    enum : std::uint8_t  { TypeInt = 2, TypeUtf8 = 5, TypeList = 12 };
+    enum : std::int16_t  { MetadataVersionV5 = 4 };
+    enum : std::int16_t  { EndiannessLittle = 0, EndiannessBig = 1 };
+    constexpr std::uint32_t Continuation = 0xFFFFFFFF;
+}
+
+
+//============================= FLATBUFFERS ===============================//
+
+/**
+ * Just enough of a FlatBuffers builder to encode Arrow messages.
+ *
+ * As in the reference implementation the buffer is built from the back:
+ * children are written before their parents, and every object is identified
+ * by its distance to the end of the buffer. The bytes are kept reversed, so
+ * prepending is a push_back, and put in order by `finish()`.
+ * Objects must not be nested: strings, vectors and child tables are created
+ * before the `start_table()` of the table that refers to them.
+ */
+class FlatBuilder
+{
+public:
+    using Ref = std::uint32_t;
+
+    template <typename T>
+    void add_scalar(std::uint16_t field, T value) {
+        _prep(sizeof(T), 0);
+        _push(value);
+        _fields.push_back({ field, _size() });
+    }
+    void add_ref(std::uint16_t field, Ref ref) {
+        _push_ref(ref);
+        _fields.push_back({ field, _size() });
+    }
+    void start_table() {
+        _fields.clear();
+        _tableStart = _size();
+    }
+    Ref end_table() {
+        _prep(4, 0);
+        _push<std::int32_t>(0);
+        const Ref table = _size();
+
+        std::uint16_t numberOfFields = 0;
+        for( const auto& [field, ref] : _fields ) { numberOfFields = std::max<std::uint16_t>(numberOfFields, field + 1); }
+        std::vector<std::uint16_t> vtable(numberOfFields, 0);
+        for( const auto& [field, ref] : _fields ) { vtable[field] = static_cast<std::uint16_t>(table - ref); }
+        for( auto it = vtable.rbegin() ; it != vtable.rend() ; ++it ) { _push(*it); }
+        _push( static_cast<std::uint16_t>(table - _tableStart) );
+        _push( static_cast<std::uint16_t>(4 + 2 * numberOfFields) );
+
+        // the table starts with the distance back to its vtable
+        const auto distance = static_cast<std::int32_t>(_size() - table);
+        for( int i = 0 ; i < 4 ; ++i ) { _bytes[table - 1 - i] = static_cast<char>(distance >> (8 * i)); }
+        _fields.clear();
+        return table;
+    }
+    Ref create_string(StringView text) {
+        _prep(4, text.size() + 1);
+        _bytes.push_back('\0');
+        _bytes.insert(_bytes.end(), text.rbegin(), text.rend());
+        _push( static_cast<std::uint32_t>(text.size()) );
+        return _size();
+    }
+    Ref create_ref_vector(const std::vector<Ref>& refs) {
+        _prep(4, refs.size() * 4);
+        for( auto it = refs.rbegin() ; it != refs.rend() ; ++it ) { _push_ref(*it); }
+        _push( static_cast<std::uint32_t>(refs.size()) );
+        return _size();
+    }
+    /// Vector of structs made of `fieldsPerStruct` int64 fields (Arrow's Buffer and FieldNode).
+    Ref create_struct_vector(const std::vector<std::int64_t>& fields, size_t fieldsPerStruct) {
+        _prep(4, fields.size() * 8);
+        _prep(8, fields.size() * 8);
+        for( auto it = fields.rbegin() ; it != fields.rend() ; ++it ) { _push(*it); }
+        _push( static_cast<std::uint32_t>(fields.size() / fieldsPerStruct) );
+        return _size();
+    }
+    String finish(Ref root) {
+        _prep(_minAlign, 4);
+        _push_ref(root);
+        String buffer{ _bytes.rbegin(), _bytes.rend() };
+        _bytes.clear();
+        return buffer;
+    }
+
+private:
+    std::vector<char>                        _bytes;  ///< the buffer, last byte first
+    std::vector<std::pair<std::uint16_t, Ref>> _fields;
+    Ref                                      _tableStart = 0;
+    size_t                                   _minAlign   = 1;
+
+    Ref _size() const noexcept { return static_cast<Ref>(_bytes.size()); }
+    void _prep(size_t alignment, size_t additionalBytes) {
+        _minAlign = std::max(_minAlign, alignment);
+        const size_t padding = (~(_bytes.size() + additionalBytes) + 1) & (alignment - 1);
+        _bytes.insert(_bytes.end(), padding, '\0');
+    }
+    template <typename T>
+    void _push(T value) {
+        // little-endian: the most significant byte is prepended first
+        using U = std::make_unsigned_t<T>;
+        const auto bits = static_cast<U>(value);
+        for( int i = sizeof(T) - 1 ; i >= 0 ; --i ) { _bytes.push_back( static_cast<char>(bits >> (8 * i)) ); }
+    }
+    void _push_ref(Ref ref) {
+        _prep(4, 0);
+        _push( static_cast<std::uint32_t>(_size() + 4 - ref) );
+    }
+};
+
+template <>
+void FlatBuilder::_push<bool>(bool value) { _bytes.push_back(value ? 1 : 0); }
+
+static FlatBuilder::Ref
+_create_int_type(FlatBuilder& fb, std::int32_t bitWidth) {
+    fb.start_table();
+    fb.add_scalar<std::int32_t>(0, bitWidth);
+    fb.add_scalar<bool>(1, true);
+    return fb.end_table();
+}
+
+static FlatBuilder::Ref
+_create_empty_table(FlatBuilder& fb) {
+    fb.start_table();
+    return fb.end_table();
+}
+
+static FlatBuilder::Ref
+_create_field(FlatBuilder&                  fb,
+              StringView                    name,
+              std::uint8_t                  typeType,
+              FlatBuilder::Ref              type,
+              const std::vector<FlatBuilder::Ref>& children,
+              FlatBuilder::Ref              dictionary = 0
+) {
+    const auto nameRef     = fb.create_string(name);
+    const auto childrenRef = fb.create_ref_vector(children);
+    fb.start_table();
+    fb.add_ref(0, nameRef);
+    fb.add_ref(3, type);
+    if( dictionary ) { fb.add_ref(4, dictionary); }
+    fb.add_ref(5, childrenRef);
+    fb.add_scalar<std::uint8_t>(2, typeType);
+    return fb.end_table();
+}
+
+static String
+_finish_message(FlatBuilder& fb, std::uint8_t headerType, FlatBuilder::Ref header, std::int64_t bodyLength) {
+    fb.start_table();
+    fb.add_scalar<std::int64_t>(3, bodyLength);
+    fb.add_ref(2, header);
+    fb.add_scalar<std::int16_t>(0, arrow::MetadataVersionV5);
+    fb.add_scalar<std::uint8_t>(1, headerType);
+    return fb.finish( fb.end_table() );
+}
+
+static FlatBuilder::Ref
+_create_record_batch(FlatBuilder& fb, std::int64_t length, const std::vector<std::int64_t>& nodes, const std::vector<std::int64_t>& buffers) {
+    const auto nodesRef   = fb.create_struct_vector(nodes, 2);
+    const auto buffersRef = fb.create_struct_vector(buffers, 2);
+    fb.start_table();
+    fb.add_scalar<std::int64_t>(0, length);
+    fb.add_ref(1, nodesRef);
+    fb.add_ref(2, buffersRef);
+    return fb.end_table();
+}
+
+//======================= CONSTRUCTION/DESTRUCTION ========================//
+
+/**
+ * Creates the writer and writes the schema message.
+ * @param out       The sink that receives the stream.
+ * @param columns   Name and type of each column.
+ * @param batchSize Number of rows of each record batch.
+ */
+ArrowWriter::ArrowWriter(OutputSink& out, const std::vector<Column>& columns, size_t batchSize)
+: _out{ out }
+, _batchSize{ std::max<size_t>(batchSize, 1) }
+{
+    _columns.resize(columns.size());
+    for( size_t i = 0 ; i < columns.size() ; ++i ) {
+        auto& column = _columns[i];
+        column.info = columns[i];
+        column.offsets.push_back(0);
+        column.newOffsets.push_back(0);
+    }
+    _write_schema();
+}
+
+//================================= ROWS ==================================//
+
+ArrowWriter&
+ArrowWriter::add_string(size_t column, StringView text) {
+    auto& data = _columns[column];
+    data.bytes.append(text);
+    data.offsets.push_back( static_cast<std::int32_t>(data.bytes.size()) );
+    return *this;
+}
+
+ArrowWriter&
+ArrowWriter::add_int64(size_t column, std::int64_t value) {
+    _columns[column].values.push_back(value);
+    return *this;
+}
+
+ArrowWriter&
+ArrowWriter::add_int64_list(size_t column, std::span<const std::int64_t> values) {
+    auto& data = _columns[column];
+    data.values.insert(data.values.end(), values.begin(), values.end());
+    data.offsets.push_back( static_cast<std::int32_t>(data.values.size()) );
+    return *this;
+}
+
+ArrowWriter&
+ArrowWriter::add_dictionary(size_t column, StringView text) {
+    auto& data = _columns[column];
+    if( data.lastIndex < 0 || text != data.lastValue ) {
+        auto it = data.ids.find(text);
+        if( it == data.ids.end() ) {
+            it = data.ids.emplace( String{text}, static_cast<std::int32_t>(data.ids.size()) ).first;
+            data.newBytes.append(text);
+            data.newOffsets.push_back( static_cast<std::int32_t>(data.newBytes.size()) );
+        }
+        data.lastValue.assign(text);
+        data.lastIndex = it->second;
+    }
+    data.indices.push_back(data.lastIndex);
+    return *this;
+}
+
+/**
+ * Ends the current row, every column must have received one value.
+ * The batch is encoded and written once it has `batchSize` rows.
+ */
+void
+ArrowWriter::end_row() {
+    if( ++_rows >= _batchSize ) { _write_batch(); }
+}
+
+/**
+ * Writes the pending rows and the end-of-stream marker.
+ */
+void
+ArrowWriter::finish() {
+    if( _finished ) { return; }
+    if( _rows > 0 ) { _write_batch(); }
+    _write_uint32(arrow::Continuation);
+    _write_uint32(0);
+    _finished = true;
+}
+
+//============================ IMPLEMENTATION =============================//
+
+void
+ArrowWriter::_write_schema() {
+    FlatBuilder fb;
+    std::vector<FlatBuilder::Ref> fields;
+    for( size_t i = 0 ; i < _columns.size() ; ++i ) {
+        const auto& column = _columns[i].info;
+        switch( column.type ) {
+            case Type::STRING:
+                fields.push_back( _create_field(fb, column.name, arrow::TypeUtf8, _create_empty_table(fb), {}) );
+                break;
+            case Type::INT64:
+                fields.push_back( _create_field(fb, column.name, arrow::TypeInt, _create_int_type(fb, 64), {}) );
+                break;
+            case Type::INT64_LIST: {
+                const auto item = _create_field(fb, "item", arrow::TypeInt, _create_int_type(fb, 64), {});
+                fields.push_back( _create_field(fb, column.name, arrow::TypeList, _create_empty_table(fb), {item}) );
+                break;
+            }
+            case Type::DICTIONARY: {
+                const auto indexType = _create_int_type(fb, 32);
+                fb.start_table();
+                fb.add_scalar<std::int64_t>(0, static_cast<std::int64_t>(i));
+                fb.add_ref(1, indexType);
+                const auto encoding = fb.end_table();
+                fields.push_back( _create_field(fb, column.name, arrow::TypeUtf8, _create_empty_table(fb), {}, encoding) );
+                break;
+            }
+        }
+    }
+    const auto fieldsRef = fb.create_ref_vector(fields);
+    fb.start_table();
+    fb.add_ref(1, fieldsRef);
+    fb.add_scalar<std::int16_t>(0, std::endian::native == std::endian::big ? arrow::EndiannessBig : arrow::EndiannessLittle);
+    const auto schema = fb.end_table();
+    _write_message(_finish_message(fb, arrow::HeaderSchema, schema, 0), Body{});
+}
+
+/**
+ * Writes the dictionary values that appeared in the current batch and then
+ * the batch itself, and empties the columns for the next one.
+ */
+void
+ArrowWriter::_write_batch() {
+    for( size_t i = 0 ; i < _columns.size() ; ++i ) {
+        auto& column = _columns[i];
+        if( column.info.type != Type::DICTIONARY ) { continue; }
+        if( column.dictionarySent && column.newOffsets.size() == 1 ) { continue; }
+        _write_dictionary(static_cast<std::int64_t>(i), column);
+    }
+
+    const auto rows = static_cast<std::int64_t>(_rows);
+    Body body;
+    for( auto& column : _columns ) {
+        body.nodes.insert(body.nodes.end(), { rows, 0 });
+        _add_buffer(body, nullptr, 0); // validity, no nulls
+        switch( column.info.type ) {
+            case Type::STRING:
+                _add_buffer(body, column.offsets.data(), column.offsets.size() * sizeof(std::int32_t));
+                _add_buffer(body, column.bytes.data(),   column.bytes.size());
+                break;
+            case Type::INT64:
+                _add_buffer(body, column.values.data(),  column.values.size() * sizeof(std::int64_t));
+                break;
+            case Type::INT64_LIST:
+                _add_buffer(body, column.offsets.data(), column.offsets.size() * sizeof(std::int32_t));
+                body.nodes.insert(body.nodes.end(), { static_cast<std::int64_t>(column.values.size()), 0 });
+                _add_buffer(body, nullptr, 0);
+                _add_buffer(body, column.values.data(),  column.values.size() * sizeof(std::int64_t));
+                break;
+            case Type::DICTIONARY:
+                _add_buffer(body, column.indices.data(), column.indices.size() * sizeof(std::int32_t));
+                break;
+        }
+    }
+    FlatBuilder fb;
+    const auto batch = _create_record_batch(fb, rows, body.nodes, body.buffers);
+    _write_message(_finish_message(fb, arrow::HeaderRecordBatch, batch, body.length), body);
+
+    for( auto& column : _columns ) {
+        column.offsets.resize(1);
+        column.bytes.clear();
+        column.values.clear();
+        column.indices.clear();
+    }
+    _rows = 0;
+}
+
+/**
+ * Writes the values added to a dictionary since it was last sent
+ * (the first time as the whole dictionary, then as deltas).
+ */
+void
+ArrowWriter::_write_dictionary(std::int64_t id, ColumnData& column) {
+    const auto count = static_cast<std::int64_t>(column.newOffsets.size() - 1);
+    Body body;
+    body.nodes = { count, 0 };
+    _add_buffer(body, nullptr, 0);
+    _add_buffer(body, column.newOffsets.data(), column.newOffsets.size() * sizeof(std::int32_t));
+    _add_buffer(body, column.newBytes.data(),   column.newBytes.size());
+
+    FlatBuilder fb;
+    const auto data = _create_record_batch(fb, count, body.nodes, body.buffers);
+    fb.start_table();
+    fb.add_scalar<std::int64_t>(0, id);
+    fb.add_ref(1, data);
+    if( column.dictionarySent ) { fb.add_scalar<bool>(2, true); }
+    const auto dictionaryBatch = fb.end_table();
+    _write_message(_finish_message(fb, arrow::HeaderDictionaryBatch, dictionaryBatch, body.length), body);
+
+    column.newOffsets.resize(1);
+    column.newBytes.clear();
+    column.dictionarySent = true;
+}
+
+/**
+ * Writes an encapsulated message: continuation marker, size of the
+ * metadata, the metadata padded to 8 bytes and the body.
+ */
+void
+ArrowWriter::_write_message(const String& metadata, const Body& body) {
+    const size_t paddedSize = align_up(metadata.size(), 8);
+    _write_uint32(arrow::Continuation);
+    _write_uint32(static_cast<std::uint32_t>(paddedSize));
+    _out.write( metadata ).fill('\0', paddedSize - metadata.size());
+    for( const auto& data : body.data ) {
+        _out.write( StringView{ data.data(), data.size() } ).fill('\0', align_up(data.size(), 8) - data.size());
+    }
+}
+
+void
+ArrowWriter::_write_uint32(std::uint32_t value) {
+    for( int i = 0 ; i < 4 ; ++i ) { _out.put( static_cast<char>(value >> (8 * i)) ); }
+}
+
+void
+ArrowWriter::_add_buffer(Body& body, const void* data, size_t size) {
+    body.buffers.insert(body.buffers.end(), { body.length, static_cast<std::int64_t>(size) });
+    body.data.emplace_back( static_cast<const char*>(data), size );
+    body.length += static_cast<std::int64_t>( align_up(size, 8) );
+}
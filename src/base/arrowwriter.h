@@ -0,0 +1,117 @@
+/*
+| File    : arrowwriter.h
+| Purpose : A small self-contained encoder of Arrow IPC streams.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 11, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef ARROWWRITER_H_
+#define ARROWWRITER_H_
+#include <cstdint>        // for std::int32_t, std::int64_t
+#include <functional>     // for std::hash, std::equal_to
+#include <span>           // for std::span
+#include <unordered_map>  // for std::unordered_map
+#include <vector>         // for std::vector
+#include "common.h"
+#include "outputsink.h"
+
+/**
+ * Writes a table in the Arrow IPC streaming format, without libarrow.
+ *
+ * The stream is a schema message followed by record batches of up to
+ * `batchSize` rows; each batch is encoded as soon as it is complete, so the
+ * memory used does not depend on the number of rows. Dictionary columns
+ * store each distinct string once: the values that first appear in a batch
+ * are sent in a dictionary batch right before it (a delta after the first
+ * one), and the column itself only holds 32-bit indices.
+ *
+ * Supported column types:
+ *   - STRING      : utf8
+ *   - INT64       : int64
+ *   - INT64_LIST  : list<int64>
+ *   - DICTIONARY  : dictionary<int32, utf8>
+ * No column has nulls.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * ArrowWriter arrow{ OutputSink::standard_output(), {
+ *     {"name", ArrowWriter::Type::STRING}, {"dtype", ArrowWriter::Type::DICTIONARY} } };
+ * for( const auto& tensor : tensors ) {
+ *     arrow.add_string(0, tensor.name).add_dictionary(1, tensor.dtype).end_row();
+ * }
+ * arrow.finish();
+ * @endcode
+ */
+class ArrowWriter
+{
+public:
+    enum class Type {
+        STRING, INT64, INT64_LIST, DICTIONARY
+    };
+    struct Column {
+        String name;
+        Type   type;
+    };
+    static constexpr size_t DefaultBatchSize = 64 * 1024;
+
+// CONSTRUCTION/DESTRUCTION
+public:
+    ArrowWriter(OutputSink& out, const std::vector<Column>& columns, size_t batchSize = DefaultBatchSize);
+    ArrowWriter(const ArrowWriter&) = delete;
+    ArrowWriter& operator=(const ArrowWriter&) = delete;
+
+// ROWS
+public:
+    ArrowWriter& add_string(size_t column, StringView text);
+    ArrowWriter& add_int64(size_t column, std::int64_t value);
+    ArrowWriter& add_int64_list(size_t column, std::span<const std::int64_t> values);
+    ArrowWriter& add_dictionary(size_t column, StringView text);
+    void end_row();
+    void finish();
+
+// IMPLEMENTATION
+private:
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(StringView text) const noexcept { return std::hash<StringView>{}(text); }
+    };
+    struct ColumnData {
+        Column                    info;
+        std::vector<std::int32_t> offsets;    ///< STRING, INT64_LIST: start of each row (+1)
+        String                    bytes;      ///< STRING: text of the rows
+        std::vector<std::int64_t> values;     ///< INT64: rows, INT64_LIST: items of all rows
+        std::vector<std::int32_t> indices;    ///< DICTIONARY: index of each row
+        std::unordered_map<String, std::int32_t, StringHash, std::equal_to<>> ids; ///< DICTIONARY: index of each value
+        std::vector<std::int32_t> newOffsets; ///< DICTIONARY: values not sent yet
+        String                    newBytes;
+        String                    lastValue;  ///< DICTIONARY: value of the previous row (sorted input repeats it)
+        std::int32_t              lastIndex = -1;
+        bool                      dictionarySent = false;
+    };
+    struct Body {
+        std::vector<std::int64_t> nodes;   ///< (length, null_count) pairs
+        std::vector<std::int64_t> buffers; ///< (offset, length) pairs
+        std::vector<std::span<const char>> data;
+        std::int64_t              length = 0;
+    };
+    void _write_schema();
+    void _write_batch();
+    void _write_dictionary(std::int64_t id, ColumnData& column);
+    void _write_message(const String& metadata, const Body& body);
+    void _write_uint32(std::uint32_t value);
+    static void _add_buffer(Body& body, const void* data, size_t size);
+private:
+    OutputSink&             _out;
+    std::vector<ColumnData> _columns;
+    size_t                  _batchSize;
+    size_t                  _rows = 0;   ///< rows in the current batch
+    bool                    _finished = false;
+};
+
+
+#endif // ARROWWRITER_H_
@@ -11,6 +11,8 @@
 |      CLI tools for inspecting and manipulating model checkpoint files
 \_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
 #include <charconv>
+#include <cstdio>   // for std::snprintf
+#include <cstdlib>  // for std::strtod
 #include "common.h"
 
 int
@@ -21,3 +23,87 @@ to_integer(StringView str,
     auto resultInfo = std::from_chars(str.data(), str.data() + str.size(), result);
     return resultInfo.ec == std::errc{} ? result : defaultValue;
 }
+
+double
+to_double(StringView str,
+          double     defaultValue // = 0.0
+){
+    // std::from_chars for floating point is still missing in some standard libraries
+    const String text{ str };
+    char* end = nullptr;
+    const double result = std::strtod(text.c_str(), &end);
+    return (!text.empty() && end == text.c_str() + text.size()) ? result : defaultValue;
+}
+
+std::uint64_t
+to_size(StringView    str,
+        std::uint64_t defaultValue // = 0
+){
+    std::uint64_t result;
+    auto resultInfo = std::from_chars(str.data(), str.data() + str.size(), result);
+    if( resultInfo.ec != std::errc{} ) { return defaultValue; }
+
+    // parse the optional unit suffix ("K", "KB", "KiB", ...)
+    StringView unit{ resultInfo.ptr, static_cast<size_t>(str.data() + str.size() - resultInfo.ptr) };
+    if( unit.empty() ) { return result; }
+    int shift = 0;
+    switch( unit.front() ) {
+        case 'k': case 'K': shift = 10; break;
+        case 'm': case 'M': shift = 20; break;
+        case 'g': case 'G': shift = 30; break;
+        case 't': case 'T': shift = 40; break;
+        case 'b': case 'B': shift =  0; break;
+        default: return defaultValue;
+    }
+    unit.remove_prefix(1);
+    if( shift == 0 && !unit.empty() ) { return defaultValue; }
+    if( !unit.empty() && unit != "B" && unit != "iB" ) { return defaultValue; }
+    return result << shift;
+}
+
+String
+to_human_size(std::uint64_t bytes) {
+    static const char* const units[] = { "B", "KiB", "MiB", "GiB", "TiB", "PiB" };
+    double value = static_cast<double>(bytes);
+    int    unit  = 0;
+    while( value >= 1024.0 && unit < 5 ) { value /= 1024.0; ++unit; }
+
+    char buffer[32];
+    if( unit == 0 ) { std::snprintf(buffer, sizeof(buffer), "%llu B", static_cast<unsigned long long>(bytes)); }
+    else            { std::snprintf(buffer, sizeof(buffer), "%.2f %s", value, units[unit]);                    }
+    return buffer;
+}
+
+String
+to_human_count(std::uint64_t count) {
+    static const char* const units[] = { "", "K", "M", "B", "T" };
+    double value = static_cast<double>(count);
+    int    unit  = 0;
+    while( value >= 1000.0 && unit < 4 ) { value /= 1000.0; ++unit; }
+
+    char buffer[32];
+    if( unit == 0 ) { std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(count)); }
+    else            { std::snprintf(buffer, sizeof(buffer), "%.2f %s", value, units[unit]);                }
+    return buffer;
+}
+
+bool
+matches_glob(StringView pattern, StringView text) noexcept {
+    // iterative matcher with single-star backtracking, linear for typical patterns
+    size_t p = 0, t = 0, starP = StringView::npos, starT = 0;
+    while( t < text.size() ) {
+        if( p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t]) ) {
+            ++p; ++t;
+        } else if( p < pattern.size() && pattern[p] == '*' ) {
+            starP = p++;
+            starT = t;
+        } else if( starP != StringView::npos ) {
+            p = starP + 1;
+            t = ++starT;
+        } else {
+            return false;
+        }
+    }
+    while( p < pattern.size() && pattern[p] == '*' ) { ++p; }
+    return p == pattern.size();
+}
@@ -0,0 +1,335 @@
+/*
+| File    : file.cpp
+| Purpose : A minimal RAII wrapper around a native file handle with positional I/O.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 2, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm> // for std::min
+#include <utility>   // for std::exchange
+#include <vector>    // for std::vector
+#include "file.h"
+#ifdef _WIN32
+#   define WIN32_LEAN_AND_MEAN
+#   include <windows.h>
+#else
+#   include <fcntl.h>    // for ::open()
+#   include <unistd.h>   // for ::pread(), ::pwrite(), ::ftruncate(), ::fsync()
+#   include <sys/stat.h> // for ::fstat()
+#   include <cerrno>     // for errno, EINTR
+#endif
+#ifdef __linux__
+#   include <sys/ioctl.h> // for ::ioctl()
+#   include <linux/fs.h>  // for FICLONERANGE
+#endif
+
+
+//======================= CONSTRUCTION/DESTRUCTION ========================//
+
+File::File(File&& other) noexcept
+: _handle{ std::exchange(other._handle, InvalidHandle) }
+{ }
+
+File::~File() {
+    close();
+}
+
+File&
+File::operator=(File&& other) noexcept {
+    if( this != &other ) {
+        close();
+        _handle = std::exchange(other._handle, InvalidHandle);
+    }
+    return *this;
+}
+
+//============================ OPENING/CLOSING ============================//
+
+#ifdef _WIN32
+
+bool
+File::open_read(const String& path) {
+    close();
+    HANDLE h = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                             nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    _handle = (h != INVALID_HANDLE_VALUE) ? h : InvalidHandle;
+    return is_open();
+}
+
+bool
+File::open_read_write(const String& path) {
+    close();
+    HANDLE h = ::CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                             nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    _handle = (h != INVALID_HANDLE_VALUE) ? h : InvalidHandle;
+    return is_open();
+}
+
+bool
+File::create(const String& path) {
+    close();
+    HANDLE h = ::CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                             nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    _handle = (h != INVALID_HANDLE_VALUE) ? h : InvalidHandle;
+    return is_open();
+}
+
+void
+File::close() noexcept {
+    if( is_open() ) { ::CloseHandle(_handle); }
+    _handle = InvalidHandle;
+}
+
+#else
+
+bool
+File::open_read(const String& path) {
+    close();
+    do { _handle = ::open(path.c_str(), O_RDONLY | O_CLOEXEC); } while( _handle<0 && errno==EINTR );
+    return is_open();
+}
+
+bool
+File::open_read_write(const String& path) {
+    close();
+    do { _handle = ::open(path.c_str(), O_RDWR | O_CLOEXEC); } while( _handle<0 && errno==EINTR );
+    return is_open();
+}
+
+bool
+File::create(const String& path) {
+    close();
+    do { _handle = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644); } while( _handle<0 && errno==EINTR );
+    return is_open();
+}
+
+void
+File::close() noexcept {
+    if( is_open() ) { ::close(_handle); }
+    _handle = InvalidHandle;
+}
+
+#endif
+
+bool
+File::is_open() const noexcept {
+    return _handle != InvalidHandle;
+}
+
+File::Handle
+File::handle() const noexcept {
+    return _handle;
+}
+
+//============================= POSITIONAL I/O ============================//
+
+#ifdef _WIN32
+
+bool
+File::read_at(void* buffer, std::uint64_t size, std::uint64_t offset) const {
+    auto* ptr = static_cast<char*>(buffer);
+    while( size > 0 ) {
+        OVERLAPPED overlapped{};
+        overlapped.Offset     = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = size < 0x40000000 ? static_cast<DWORD>(size) : 0x40000000, count = 0;
+        if( !::ReadFile(_handle, ptr, chunk, &count, &overlapped) || count == 0 ) { return false; }
+        ptr += count; offset += count; size -= count;
+    }
+    return true;
+}
+
+bool
+File::write_at(const void* buffer, std::uint64_t size, std::uint64_t offset) const {
+    auto* ptr = static_cast<const char*>(buffer);
+    while( size > 0 ) {
+        OVERLAPPED overlapped{};
+        overlapped.Offset     = static_cast<DWORD>(offset);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD chunk = size < 0x40000000 ? static_cast<DWORD>(size) : 0x40000000, count = 0;
+        if( !::WriteFile(_handle, ptr, chunk, &count, &overlapped) || count == 0 ) { return false; }
+        ptr += count; offset += count; size -= count;
+    }
+    return true;
+}
+
+std::uint64_t
+File::size() const {
+    LARGE_INTEGER size;
+    return ::GetFileSizeEx(_handle, &size) ? static_cast<std::uint64_t>(size.QuadPart) : 0;
+}
+
+bool
+File::resize(std::uint64_t size) const {
+    FILE_END_OF_FILE_INFO info;
+    info.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+    return ::SetFileInformationByHandle(_handle, FileEndOfFileInfo, &info, sizeof(info)) != 0;
+}
+
+bool
+File::sync() const {
+    return ::FlushFileBuffers(_handle) != 0;
+}
+
+#else
+
+/**
+ * Reads exactly `size` bytes starting at `offset` into `buffer`.
+ * @return `true` on success, `false` if an error occurs or the end of file is reached.
+ */
+bool
+File::read_at(void* buffer, std::uint64_t size, std::uint64_t offset) const {
+    auto* ptr = static_cast<char*>(buffer);
+    while( size > 0 ) {
+        ssize_t count = ::pread(_handle, ptr, size, static_cast<off_t>(offset));
+        if( count < 0 && errno == EINTR ) { continue; }
+        if( count <= 0 ) { return false; }
+        ptr += count; offset += count; size -= count;
+    }
+    return true;
+}
+
+/**
+ * Writes exactly `size` bytes from `buffer` starting at `offset`.
+ * @return `true` on success, `false` if an error occurs.
+ */
+bool
+File::write_at(const void* buffer, std::uint64_t size, std::uint64_t offset) const {
+    auto* ptr = static_cast<const char*>(buffer);
+    while( size > 0 ) {
+        ssize_t count = ::pwrite(_handle, ptr, size, static_cast<off_t>(offset));
+        if( count < 0 && errno == EINTR ) { continue; }
+        if( count <= 0 ) { return false; }
+        ptr += count; offset += count; size -= count;
+    }
+    return true;
+}
+
+/**
+ * Returns the current size of the file in bytes (0 if it cannot be determined).
+ */
+std::uint64_t
+File::size() const {
+    struct stat info;
+    return ::fstat(_handle, &info) == 0 ? static_cast<std::uint64_t>(info.st_size) : 0;
+}
+
+/**
+ * Truncates or extends the file to `size` bytes.
+ * @details When the file is extended no data blocks are allocated, the new
+ *          region stays as a hole until it is written.
+ */
+bool
+File::resize(std::uint64_t size) const {
+    return ::ftruncate(_handle, static_cast<off_t>(size)) == 0;
+}
+
+/**
+ * Flushes the file data and metadata to the storage device.
+ */
+bool
+File::sync() const {
+    return ::fsync(_handle) == 0;
+}
+
+#endif
+
+//============================= DATA TRANSFER =============================//
+
+namespace {
+
+/**
+ * Copies a byte range between two files through a user-space buffer.
+ * (the portable path, used when the kernel can't do the copy by itself)
+ */
+bool
+_buffered_copy(const File& source, std::uint64_t sourceOffset, std::uint64_t size,
+               const File& target, std::uint64_t offset)
+{
+    std::vector<char> buffer( std::min<std::uint64_t>(size, 8 * 1024 * 1024) );
+    while( size > 0 ) {
+        const std::uint64_t chunk = std::min<std::uint64_t>(size, buffer.size());
+        if( !source.read_at(buffer.data(), chunk, sourceOffset) || !target.write_at(buffer.data(), chunk, offset) ) {
+            return false;
+        }
+        sourceOffset += chunk; offset += chunk; size -= chunk;
+    }
+    return true;
+}
+
+} // namespace
+
+/**
+ * Copies `size` bytes of `source`, starting at `sourceOffset`, into this
+ * file at `offset`, using the cheapest mechanism the platform offers:
+ *
+ *  1. CLONE:         the blocks are shared with the source (reflink, Linux
+ *                    FICLONERANGE on Btrfs, XFS, bcachefs...), no data is
+ *                    copied at all. Only possible for whole filesystem blocks
+ *                    at the same position inside a block in both files; the
+ *                    unaligned head and tail are copied normally.
+ *  2. KERNEL_COPY:   copy_file_range(2), the data never reaches user space
+ *                    (and NFS/SMB can copy it on the server).
+ *  3. BUFFERED_COPY: pread/pwrite through a buffer.
+ *
+ * @param method If not null, receives the mechanism used for the bulk of the data.
+ * @return `true` on success, `false` if an error occurs.
+ */
+bool
+File::copy_from(const File&   source,
+                std::uint64_t sourceOffset,
+                std::uint64_t size,
+                std::uint64_t offset,
+                CopyMethod*   method
+) const {
+    if( method ) { *method = CopyMethod::NONE; }
+    if( size == 0 ) { return true; }
+
+#ifdef __linux__
+    struct stat info;
+    const std::uint64_t blockSize = (::fstat(_handle, &info) == 0 && info.st_blksize > 0) ? info.st_blksize : 4096;
+
+    // 1) clone the whole blocks (a range that reaches the end of the
+    //    source may end in a partial block)
+    if( size >= blockSize && sourceOffset % blockSize == offset % blockSize ) {
+        const std::uint64_t head  = (blockSize - sourceOffset % blockSize) % blockSize;
+        const bool          toEnd = sourceOffset + size == source.size();
+        const std::uint64_t body  = toEnd ? size - head : (size - head) / blockSize * blockSize;
+
+        file_clone_range range{};
+        range.src_fd      = source._handle;
+        range.src_offset  = sourceOffset + head;
+        range.src_length  = body;
+        range.dest_offset = offset + head;
+        if( body > 0 && ::ioctl(_handle, FICLONERANGE, &range) == 0 ) {
+            const std::uint64_t tail = size - head - body;
+            if( method ) { *method = CopyMethod::CLONE; }
+            return copy_from(source, sourceOffset, head, offset) &&
+                   copy_from(source, sourceOffset + head + body, tail, offset + head + body);
+        }
+    }
+
+    // 2) let the kernel copy the data
+    auto sourcePosition = static_cast<loff_t>(sourceOffset);
+    auto targetPosition = static_cast<loff_t>(offset);
+    while( size > 0 ) {
+        const ssize_t count = ::copy_file_range(source._handle, &sourcePosition, _handle, &targetPosition,
+                                                std::min<std::uint64_t>(size, 1024 * 1024 * 1024), 0);
+        if( count < 0 && errno == EINTR ) { continue; }
+        if( count <= 0 ) { break; }
+        if( method ) { *method = CopyMethod::KERNEL_COPY; }
+        size -= count;
+    }
+    if( size == 0 ) { return true; }
+    sourceOffset = static_cast<std::uint64_t>(sourcePosition);
+    offset       = static_cast<std::uint64_t>(targetPosition);
+#endif
+
+    // 3) copy whatever is left through a buffer
+    if( method && *method == CopyMethod::NONE ) { *method = CopyMethod::BUFFERED_COPY; }
+    return _buffered_copy(source, sourceOffset, size, *this, offset);
+}
@@ -0,0 +1,94 @@
+/*
+| File    : file.h
+| Purpose : A minimal RAII wrapper around a native file handle with positional I/O.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 2, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef FILE_H_
+#define FILE_H_
+#include <cstdint>  // for std::uint64_t
+#include "common.h"
+
+/**
+ * A minimal RAII wrapper around a native file handle with positional I/O.
+ *
+ * All reads and writes take an explicit offset (pread/pwrite semantics), so a
+ * single File object can be shared by several threads copying independent
+ * regions of the same file without any locking.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * File input, output;
+ * if( !input.open_read("model.safetensors") ) { ... }
+ * if( !output.create("copy.safetensors")    ) { ... }
+ * output.resize( input.size() );
+ * std::vector<char> buffer(4096);
+ * input.read_at(buffer.data(), buffer.size(), 0);
+ * output.write_at(buffer.data(), buffer.size(), 0);
+ * @endcode
+ */
+class File
+{
+public:
+#ifdef _WIN32
+    using Handle = void*;
+#else
+    using Handle = int;
+#endif
+
+// CONSTRUCTION/DESTRUCTION
+public:
+    File() = default;
+    File(const File&) = delete;
+    File(File&& other) noexcept;
+    ~File();
+
+// ASSIGNMENT OPERATORS
+public:
+    File& operator=(const File&) = delete;
+    File& operator=(File&& other) noexcept;
+
+// OPENING/CLOSING
+public:
+    [[nodiscard]] bool open_read(const String& path);
+    [[nodiscard]] bool open_read_write(const String& path);
+    [[nodiscard]] bool create(const String& path);
+    void close() noexcept;
+    [[nodiscard]] bool is_open() const noexcept;
+    [[nodiscard]] Handle handle() const noexcept;
+
+// POSITIONAL I/O
+public:
+    [[nodiscard]] bool read_at (void*       buffer, std::uint64_t size, std::uint64_t offset) const;
+    [[nodiscard]] bool write_at(const void* buffer, std::uint64_t size, std::uint64_t offset) const;
+    [[nodiscard]] std::uint64_t size() const;
+    [[nodiscard]] bool resize(std::uint64_t size) const;
+    [[nodiscard]] bool sync() const;
+
+// DATA TRANSFER
+public:
+    enum class CopyMethod { NONE, CLONE, KERNEL_COPY, BUFFERED_COPY };
+    [[nodiscard]] bool copy_from(const File&   source,
+                                 std::uint64_t sourceOffset,
+                                 std::uint64_t size,
+                                 std::uint64_t offset,
+                                 CopyMethod*   method = nullptr) const;
+
+// IMPLEMENTATION
+private:
+    Handle _handle = InvalidHandle;
+#ifdef _WIN32
+    static constexpr Handle InvalidHandle = nullptr;
+#else
+    static constexpr Handle InvalidHandle = -1;
+#endif
+};
+
+
+#endif // FILE_H_
@@ -0,0 +1,412 @@
+/*
+| File    : gguf.cpp
+| Purpose : Low-level access to the layout of .gguf files (key/values, tensor infos and data offsets).
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 4, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm> // for std::max, std::min, std::equal, std::find
+#include <cctype>    // for std::toupper
+#include <cstring>   // for std::memcpy
+#include "gguf.h"
+#include "file.h"
+
+
+//================================ HELPERS ================================//
+
+namespace {
+
+/**
+ * Sequential reader of the header of a .gguf file.
+ * The header is loaded in growing chunks and kept in memory, so the encoded
+ * bytes of any value can be copied once it has been parsed.
+ */
+class HeaderReader
+{
+public:
+    HeaderReader(const File& file) : _file{file}, _fileSize{file.size()} { }
+
+    std::uint64_t position() const noexcept { return _position; }
+    StringView bytes(std::uint64_t begin, std::uint64_t end) const noexcept {
+        return StringView{ _buffer.data() + begin, static_cast<size_t>(end - begin) };
+    }
+    std::uint64_t remaining() const noexcept { return _fileSize - _position; }
+
+    bool skip(std::uint64_t size) {
+        if( !_ensure(size) ) { return false; }
+        _position += size;
+        return true;
+    }
+
+    template <typename T>
+    bool read(T& value) {
+        if( !_ensure(sizeof(T)) ) { return false; }
+        std::memcpy(&value, _buffer.data() + _position, sizeof(T));
+        _position += sizeof(T);
+        return true;
+    }
+
+    bool read_string(String& value) {
+        std::uint64_t length;
+        if( !read(length) || !_ensure(length) ) { return false; }
+        value.assign(_buffer.data() + _position, length);
+        _position += length;
+        return true;
+    }
+
+private:
+    bool _ensure(std::uint64_t size) {
+        if( size > remaining() ) { return false; }
+        if( _position + size <= _buffer.size() ) { return true; }
+        const std::uint64_t chunk   = std::max<std::uint64_t>(1024 * 1024, _buffer.size());
+        const std::uint64_t newSize = std::min(_fileSize, std::max(_position + size, _buffer.size() + chunk));
+        const std::uint64_t oldSize = _buffer.size();
+        _buffer.resize(newSize);
+        return _file.read_at(_buffer.data() + oldSize, newSize - oldSize, oldSize);
+    }
+    const File&   _file;
+    std::uint64_t _fileSize;
+    std::uint64_t _position = 0;
+    String        _buffer;
+};
+
+/**
+ * Returns the size of a fixed-size value type, or 0 for strings and arrays.
+ */
+std::uint64_t
+_scalar_size(GgufFile::ValueType type) noexcept {
+    using ValueType = GgufFile::ValueType;
+    switch( type ) {
+        case ValueType::UINT8:   case ValueType::INT8:  case ValueType::BOOL:    return 1;
+        case ValueType::UINT16:  case ValueType::INT16:                          return 2;
+        case ValueType::UINT32:  case ValueType::INT32: case ValueType::FLOAT32: return 4;
+        case ValueType::UINT64:  case ValueType::INT64: case ValueType::FLOAT64: return 8;
+        default: return 0;
+    }
+}
+
+/**
+ * Skips over one encoded value, validating its structure.
+ */
+bool
+_skip_value(HeaderReader& reader, GgufFile::ValueType type, int depth = 0) {
+    using ValueType = GgufFile::ValueType;
+    if( const auto size = _scalar_size(type) ) { return reader.skip(size); }
+    if( type == ValueType::STRING ) {
+        std::uint64_t length;
+        return reader.read(length) && reader.skip(length);
+    }
+    if( type == ValueType::ARRAY && depth < 8 ) {
+        std::uint32_t elementType;
+        std::uint64_t count;
+        if( !reader.read(elementType) || !reader.read(count) ) { return false; }
+        const auto elementSize = _scalar_size( static_cast<ValueType>(elementType) );
+        if( elementSize ) { return count <= reader.remaining() / elementSize && reader.skip(count * elementSize); }
+        if( count > reader.remaining() ) { return false; }
+        for( std::uint64_t i=0 ; i<count ; ++i ) {
+            if( !_skip_value(reader, static_cast<ValueType>(elementType), depth+1) ) { return false; }
+        }
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+//============================= CONSTRUCTION ==============================//
+
+/**
+ * Checks whether a file starts with the GGUF magic number.
+ */
+bool
+GgufFile::is_gguf_file(const String& path) {
+    File file;
+    std::uint32_t magic = 0;
+    return file.open_read(path) && file.read_at(&magic, sizeof(magic), 0) && magic == Magic;
+}
+
+/**
+ * Reads the layout of a .gguf file.
+ *
+ * @param path      The path to the .gguf file.
+ * @param readError Set to `ReadError::None` on success, or to the error found.
+ */
+GgufFile
+GgufFile::from_file(const String& path, ReadError& readError) {
+    File file;
+    if( !file.open_read(path) ) { readError = ReadError::FileNotFound; return {}; }
+
+    GgufFile      gguf;
+    HeaderReader  reader{file};
+    std::uint32_t magic;
+    std::uint64_t tensorCount, keyValueCount;
+    if( !reader.read(magic) || magic != Magic ) { readError = ReadError::InvalidFormat; return {}; }
+    if( !reader.read(gguf._version) || gguf._version < 2 || gguf._version > 3 ) {
+        readError = ReadError::UnsupportedVersion;
+        return {};
+    }
+    if( !reader.read(tensorCount) || !reader.read(keyValueCount) ||
+        tensorCount > reader.remaining() || keyValueCount > reader.remaining() )
+    {
+        readError = ReadError::InvalidFormat;
+        return {};
+    }
+
+    // key/value pairs (stored encoded, as they appear in the file)
+    gguf._metadata.reserve(keyValueCount);
+    for( std::uint64_t i=0 ; i<keyValueCount ; ++i ) {
+        KeyValue      keyValue;
+        std::uint32_t type;
+        if( !reader.read_string(keyValue.key) || !reader.read(type) ) { readError = ReadError::MissingData; return {}; }
+        keyValue.type = static_cast<ValueType>(type);
+        const auto begin = reader.position();
+        if( !_skip_value(reader, keyValue.type) ) { readError = ReadError::InvalidFormat; return {}; }
+        keyValue.value = reader.bytes(begin, reader.position());
+        if( keyValue.key == "general.alignment" ) { gguf._alignment = keyValue.as_uint64(DefaultAlignment); }
+        gguf._metadata.push_back( std::move(keyValue) );
+    }
+    if( gguf._alignment == 0 || (gguf._alignment & (gguf._alignment - 1)) != 0 ) {
+        readError = ReadError::InvalidFormat;
+        return {};
+    }
+
+    // tensor infos
+    gguf._tensors.reserve(tensorCount);
+    for( std::uint64_t i=0 ; i<tensorCount ; ++i ) {
+        Tensor        tensor;
+        std::uint32_t numberOfDimensions;
+        if( !reader.read_string(tensor.name) || !reader.read(numberOfDimensions) || numberOfDimensions > 8 ) {
+            readError = ReadError::InvalidFormat;
+            return {};
+        }
+        std::uint64_t numberOfElements = 1;
+        bool          overflows        = false;
+        tensor.shape.resize(numberOfDimensions);
+        for( auto& dimension : tensor.shape ) {
+            if( !reader.read(dimension) ) { readError = ReadError::MissingData; return {}; }
+            overflows = overflows || (dimension != 0 && numberOfElements > UINT64_MAX / dimension);
+            numberOfElements *= dimension;
+        }
+        if( std::find(tensor.shape.begin(), tensor.shape.end(), 0) != tensor.shape.end() ) { overflows = false; }
+        if( !reader.read(tensor.type) || !reader.read(tensor.offset) ) { readError = ReadError::MissingData; return {}; }
+        // a shape whose size doesn't fit in 64 bits, or a tensor that ends past
+        // 2^64 or doesn't start on the alignment, can't be read from any file
+        const std::uint32_t blockSize = type_block_size(tensor.type);
+        if( blockSize != 0 ) {
+            const std::uint64_t blocks     = numberOfElements / blockSize + (numberOfElements % blockSize != 0);
+            const std::uint64_t blockBytes = type_size(tensor.type, blockSize);
+            overflows = overflows || blocks > UINT64_MAX / blockBytes;
+        }
+        tensor.size = overflows ? 0 : type_size(tensor.type, numberOfElements);
+        if( overflows || tensor.size > UINT64_MAX - tensor.offset || tensor.offset % gguf._alignment != 0 ) {
+            readError = ReadError::InvalidFormat;
+            return {};
+        }
+        gguf._tensors.push_back( std::move(tensor) );
+    }
+
+    gguf._path       = path;
+    gguf._headerSize = reader.position();
+    gguf._dataOffset = align_up(gguf._headerSize, gguf._alignment);
+    if( gguf._dataOffset > file.size() || gguf.data_size() > file.size() - gguf._dataOffset ) {
+        readError = ReadError::MissingData;
+        return {};
+    }
+    readError = ReadError::None;
+    return gguf;
+}
+
+//============================== ATTRIBUTES ===============================//
+
+/**
+ * Returns the size of the data section, as indexed by the tensors.
+ */
+std::uint64_t
+GgufFile::data_size() const noexcept {
+    std::uint64_t size = 0;
+    for( const auto& tensor : _tensors ) { size = std::max(size, tensor.offset + tensor.size); }
+    return size;
+}
+
+/**
+ * Finds the key/value pair with the given key.
+ * @return A pointer to the key/value pair, or `nullptr` if not found.
+ */
+const GgufFile::KeyValue*
+GgufFile::find(StringView key) const noexcept {
+    for( const auto& keyValue : _metadata ) {
+        if( keyValue.key == key ) { return &keyValue; }
+    }
+    return nullptr;
+}
+
+/**
+ * Returns the value as a string (only for STRING values, empty otherwise).
+ */
+String
+GgufFile::KeyValue::as_string() const {
+    if( type != ValueType::STRING || value.size() < 8 ) { return {}; }
+    return value.substr(8);
+}
+
+/**
+ * Returns the value as an unsigned integer (only for integer values).
+ */
+std::uint64_t
+GgufFile::KeyValue::as_uint64(std::uint64_t defaultValue) const noexcept {
+    std::uint64_t result = 0;
+    switch( type ) {
+        case ValueType::UINT8:  case ValueType::UINT16: case ValueType::UINT32: case ValueType::UINT64:
+        case ValueType::INT8:   case ValueType::INT16:  case ValueType::INT32:  case ValueType::INT64:
+            std::memcpy(&result, value.data(), std::min<size_t>(value.size(), sizeof(result)));
+            return result;
+        default:
+            return defaultValue;
+    }
+}
+
+/**
+ * Creates a key/value pair holding a STRING value.
+ */
+GgufFile::KeyValue
+GgufFile::KeyValue::from_string(StringView key, StringView value) {
+    KeyValue keyValue{ String{key}, ValueType::STRING, String(8, '\0') };
+    const std::uint64_t length = value.size();
+    std::memcpy(keyValue.value.data(), &length, sizeof(length));
+    keyValue.value += value;
+    return keyValue;
+}
+
+/**
+ * Creates a key/value pair holding a UINT32 value.
+ */
+GgufFile::KeyValue
+GgufFile::KeyValue::from_uint32(StringView key, std::uint32_t value) {
+    KeyValue keyValue{ String{key}, ValueType::UINT32, String(sizeof(value), '\0') };
+    std::memcpy(keyValue.value.data(), &value, sizeof(value));
+    return keyValue;
+}
+
+//=========================== HEADER GENERATION ===========================//
+
+/**
+ * Generates the header (key/values + tensor infos) for a .gguf file.
+ *
+ * The header is padded with zeros so that the data section starts at a
+ * multiple of `alignment` bytes. If the alignment is not the default one,
+ * `metadata` must contain a "general.alignment" key with the same value,
+ * otherwise readers will look for the data section at the wrong offset.
+ *
+ * @param tensors   The tensors to describe, their `offset` must already be
+ *                  the one they will have in the new data section.
+ * @param metadata  The key/value pairs, with their values already encoded.
+ * @param alignment The alignment of the data section.
+ * @return The bytes that go at the start of the file, before the data section.
+ */
+String
+GgufFile::build_header(const Tensors&  tensors,
+                       const Metadata& metadata,
+                       std::uint64_t   alignment // = DefaultAlignment
+){
+    String header;
+    header.reserve( 24 + 64 * metadata.size() + 96 * tensors.size() );
+    const auto append = [&header](const auto& value) {
+        header.append( reinterpret_cast<const char*>(&value), sizeof(value) );
+    };
+    const auto append_string = [&](StringView string) {
+        append( static_cast<std::uint64_t>(string.size()) );
+        header += string;
+    };
+
+    append( Magic );
+    append( std::uint32_t{3} );
+    append( static_cast<std::uint64_t>(tensors.size())  );
+    append( static_cast<std::uint64_t>(metadata.size()) );
+    for( const auto& keyValue : metadata ) {
+        append_string( keyValue.key );
+        append( static_cast<std::uint32_t>(keyValue.type) );
+        header += keyValue.value;
+    }
+    for( const auto& tensor : tensors ) {
+        append_string( tensor.name );
+        append( static_cast<std::uint32_t>(tensor.shape.size()) );
+        for( const auto dimension : tensor.shape ) { append(dimension); }
+        append( tensor.type );
+        append( tensor.offset );
+    }
+    header.resize( align_up(header.size(), alignment), '\0' );
+    return header;
+}
+
+//============================== GGML TYPES ===============================//
+
+namespace {
+    struct TypeTraits { StringView name; std::uint32_t blockSize; std::uint32_t blockBytes; };
+    constexpr TypeTraits TypeTable[] = {
+        /*  0 */ {"F32",     1,   4}, /*  1 */ {"F16",     1,   2}, /*  2 */ {"Q4_0",   32,  18},
+        /*  3 */ {"Q4_1",   32,  20}, /*  4 */ {"",        0,   0}, /*  5 */ {"",        0,   0},
+        /*  6 */ {"Q5_0",   32,  22}, /*  7 */ {"Q5_1",   32,  24}, /*  8 */ {"Q8_0",   32,  34},
+        /*  9 */ {"Q8_1",   32,  36}, /* 10 */ {"Q2_K",  256,  84}, /* 11 */ {"Q3_K",  256, 110},
+        /* 12 */ {"Q4_K",  256, 144}, /* 13 */ {"Q5_K",  256, 176}, /* 14 */ {"Q6_K",  256, 210},
+        /* 15 */ {"Q8_K",  256, 292}, /* 16 */ {"IQ2_XXS",256, 66}, /* 17 */ {"IQ2_XS",256,  74},
+        /* 18 */ {"IQ3_XXS",256, 98}, /* 19 */ {"IQ1_S", 256,  50}, /* 20 */ {"IQ4_NL", 32,  18},
+        /* 21 */ {"IQ3_S", 256, 110}, /* 22 */ {"IQ2_S", 256,  82}, /* 23 */ {"IQ4_XS",256, 136},
+        /* 24 */ {"I8",      1,   1}, /* 25 */ {"I16",     1,   2}, /* 26 */ {"I32",     1,   4},
+        /* 27 */ {"I64",     1,   8}, /* 28 */ {"F64",     1,   8}, /* 29 */ {"IQ1_M", 256,  56},
+        /* 30 */ {"BF16",    1,   2}, /* 31 */ {"",        0,   0}, /* 32 */ {"",        0,   0},
+        /* 33 */ {"",        0,   0}, /* 34 */ {"TQ1_0", 256,  54}, /* 35 */ {"TQ2_0", 256,  66},
+        /* 36 */ {"",        0,   0}, /* 37 */ {"",        0,   0}, /* 38 */ {"",        0,   0},
+        /* 39 */ {"MXFP4",  32,  17},
+    };
+    constexpr std::uint32_t NumberOfTypes = sizeof(TypeTable) / sizeof(TypeTable[0]);
+}
+
+/**
+ * Returns the number of bytes used by `numberOfElements` elements of a ggml type.
+ * (0 if the type is unknown)
+ */
+std::uint64_t
+GgufFile::type_size(std::uint32_t type, std::uint64_t numberOfElements) noexcept {
+    if( type >= NumberOfTypes || TypeTable[type].blockSize == 0 ) { return 0; }
+    const auto& traits = TypeTable[type];
+    return (numberOfElements / traits.blockSize + (numberOfElements % traits.blockSize != 0)) * traits.blockBytes;
+}
+
+/**
+ * Returns the number of elements per block of a ggml type (1 for the
+ * non-quantized types, 0 if the type is unknown).
+ */
+std::uint32_t
+GgufFile::type_block_size(std::uint32_t type) noexcept {
+    return type < NumberOfTypes ? TypeTable[type].blockSize : 0;
+}
+
+/**
+ * Returns the name of a ggml type ("F32", "Q4_K", ...), or "?" if unknown.
+ */
+StringView
+GgufFile::type_name(std::uint32_t type) noexcept {
+    if( type >= NumberOfTypes || TypeTable[type].name.empty() ) { return "?"; }
+    return TypeTable[type].name;
+}
+
+/**
+ * Returns the ggml type with the given name (case insensitive),
+ * or `UnknownType` if there is no such type.
+ */
+std::uint32_t
+GgufFile::type_from_name(StringView name) noexcept {
+    const auto equals_ignore_case = [](StringView a, StringView b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+            return std::toupper(static_cast<unsigned char>(x)) == std::toupper(static_cast<unsigned char>(y));
+        });
+    };
+    for( std::uint32_t type=0 ; type<NumberOfTypes ; ++type ) {
+        if( !TypeTable[type].name.empty() && equals_ignore_case(TypeTable[type].name, name) ) { return type; }
+    }
+    return UnknownType;
+}
@@ -0,0 +1,106 @@
+/*
+| File    : gguf.h
+| Purpose : Low-level access to the layout of .gguf files (key/values, tensor infos and data offsets).
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 4, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef GGUF_H_
+#define GGUF_H_
+#include <cstdint>          // for std::uint64_t, std::uint32_t
+#include <vector>           // for std::vector
+#include <tin/readerror.h>  // for tin::ReadError
+#include "common.h"
+using tin::ReadError;
+
+/**
+ * Low-level access to the layout of a .gguf file.
+ *
+ * Like SafetensorsFile, this class reads only the header and exposes the
+ * physical layout needed by the tools that rewrite checkpoints. Key/value
+ * pairs are kept in their encoded form so they can be written back
+ * byte-for-byte, with helpers to decode the scalar and string values.
+ *
+ * File layout (version 2 and 3):
+ *   [u32 magic "GGUF"] [u32 version] [u64 tensor count] [u64 key/value count]
+ *   [key/value pairs] [tensor infos] [padding to alignment] [data section]
+ * Each tensor's offset is relative to the start of the (aligned) data section.
+ */
+class GgufFile
+{
+public:
+    enum class ValueType : std::uint32_t {
+        UINT8 = 0, INT8, UINT16, INT16, UINT32, INT32, FLOAT32, BOOL, STRING, ARRAY, UINT64, INT64, FLOAT64
+    };
+    struct KeyValue {
+        String    key;
+        ValueType type = ValueType::UINT8;
+        String    value;  ///< the value exactly as encoded in the file
+        [[nodiscard]] String        as_string() const;
+        [[nodiscard]] std::uint64_t as_uint64(std::uint64_t defaultValue = 0) const noexcept;
+        [[nodiscard]] static KeyValue from_string(StringView key, StringView value);
+        [[nodiscard]] static KeyValue from_uint32(StringView key, std::uint32_t value);
+    };
+    struct Tensor {
+        String                     name;
+        std::vector<std::uint64_t> shape;      ///< dimensions in ggml order (ne[0] is the innermost)
+        std::uint32_t              type   = 0; ///< ggml type (0 = F32, 1 = F16, 8 = Q8_0, ...)
+        std::uint64_t              offset = 0; ///< first byte, relative to the data section
+        std::uint64_t              size   = 0; ///< size in bytes, derived from the type and shape
+    };
+    using Tensors  = std::vector<Tensor>;
+    using Metadata = std::vector<KeyValue>;
+
+    static constexpr std::uint32_t Magic            = 0x46554747; ///< "GGUF" read as little-endian u32
+    static constexpr std::uint64_t DefaultAlignment = 32;
+
+// CONSTRUCTION
+public:
+    [[nodiscard]] static GgufFile from_file(const String& path, ReadError& readError);
+    [[nodiscard]] static bool     is_gguf_file(const String& path);
+    GgufFile() = default;
+
+// ATTRIBUTES
+public:
+    [[nodiscard]] const String&   path()        const noexcept { return _path;       }
+    [[nodiscard]] std::uint32_t   version()     const noexcept { return _version;    }
+    [[nodiscard]] std::uint64_t   alignment()   const noexcept { return _alignment;  }
+    [[nodiscard]] std::uint64_t   header_size() const noexcept { return _headerSize; }
+    [[nodiscard]] std::uint64_t   data_offset() const noexcept { return _dataOffset; }
+    [[nodiscard]] std::uint64_t   data_size()   const noexcept;
+    [[nodiscard]] const Tensors&  tensors()     const noexcept { return _tensors;    }
+    [[nodiscard]] const Metadata& metadata()    const noexcept { return _metadata;   }
+    [[nodiscard]] const KeyValue* find(StringView key) const noexcept;
+
+// HEADER GENERATION
+public:
+    [[nodiscard]] static String build_header(const Tensors&  tensors,
+                                             const Metadata& metadata,
+                                             std::uint64_t   alignment = DefaultAlignment);
+
+// GGML TYPES
+public:
+    static constexpr std::uint32_t UnknownType = 0xFFFFFFFF;
+    [[nodiscard]] static std::uint64_t type_size(std::uint32_t type, std::uint64_t numberOfElements) noexcept;
+    [[nodiscard]] static std::uint32_t type_block_size(std::uint32_t type) noexcept;
+    [[nodiscard]] static StringView    type_name(std::uint32_t type) noexcept;
+    [[nodiscard]] static std::uint32_t type_from_name(StringView name) noexcept;
+
+// IMPLEMENTATION
+private:
+    String        _path;
+    std::uint32_t _version    = 0;
+    std::uint64_t _alignment  = DefaultAlignment;
+    std::uint64_t _headerSize = 0; ///< bytes used by the header, before the alignment padding
+    std::uint64_t _dataOffset = 0;
+    Tensors       _tensors;
+    Metadata      _metadata;
+};
+
+
+#endif // GGUF_H_
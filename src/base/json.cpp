@@ -0,0 +1,254 @@
+/*
+| File    : json.cpp
+| Purpose : A small JSON value class with a parser, enough to read checkpoint headers.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 2, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <charconv> // for std::from_chars
+#include <cstdlib>  // for std::strtod
+#include "json.h"
+
+
+//================================ PARSER =================================//
+
+/**
+ * Recursive descent parser that fills JsonValue objects.
+ * (declared as friend of JsonValue so it can populate its members directly)
+ */
+class JsonParser
+{
+public:
+    explicit JsonParser(StringView text) : _ptr{text.data()}, _end{text.data() + text.size()} { }
+
+    bool parse_document(JsonValue& value) {
+        if( !parse_value(value, 0) ) { return false; }
+        skip_whitespace();
+        return _ptr == _end;
+    }
+
+private:
+    static constexpr int MaxDepth = 256;
+    const char* _ptr;
+    const char* _end;
+
+    void skip_whitespace() noexcept {
+        while( _ptr<_end && (*_ptr==' ' || *_ptr=='\n' || *_ptr=='\r' || *_ptr=='\t') ) { ++_ptr; }
+    }
+
+    bool consume(char ch) noexcept {
+        skip_whitespace();
+        if( _ptr<_end && *_ptr==ch ) { ++_ptr; return true; }
+        return false;
+    }
+
+    bool consume_literal(StringView literal) noexcept {
+        if( static_cast<size_t>(_end-_ptr) < literal.size() ) { return false; }
+        if( StringView{_ptr, literal.size()} != literal ) { return false; }
+        _ptr += literal.size();
+        return true;
+    }
+
+    bool parse_value(JsonValue& value, int depth) {
+        skip_whitespace();
+        if( _ptr >= _end || depth > MaxDepth ) { return false; }
+        switch( *_ptr ) {
+            case '{': return parse_object(value, depth);
+            case '[': return parse_array(value, depth);
+            case '"': value._type = JsonValue::Type::STRING; return parse_string(value._text);
+            case 't': value._type = JsonValue::Type::BOOLEAN; value._text = "true";  return consume_literal("true");
+            case 'f': value._type = JsonValue::Type::BOOLEAN; value._text = "false"; return consume_literal("false");
+            case 'n': value._type = JsonValue::Type::NUL; return consume_literal("null");
+            default : return parse_number(value);
+        }
+    }
+
+    bool parse_object(JsonValue& value, int depth) {
+        value._type = JsonValue::Type::OBJECT;
+        ++_ptr; // '{'
+        if( consume('}') ) { return true; }
+        do {
+            skip_whitespace();
+            JsonValue::Member member;
+            if( _ptr>=_end || *_ptr!='"' || !parse_string(member.first) ) { return false; }
+            if( !consume(':') ) { return false; }
+            if( !parse_value(member.second, depth+1) ) { return false; }
+            value._members.push_back( std::move(member) );
+        } while( consume(',') );
+        return consume('}');
+    }
+
+    bool parse_array(JsonValue& value, int depth) {
+        value._type = JsonValue::Type::ARRAY;
+        ++_ptr; // '['
+        if( consume(']') ) { return true; }
+        do {
+            JsonValue item;
+            if( !parse_value(item, depth+1) ) { return false; }
+            value._items.push_back( std::move(item) );
+        } while( consume(',') );
+        return consume(']');
+    }
+
+    bool parse_number(JsonValue& value) {
+        const char* start = _ptr;
+        if( _ptr<_end && *_ptr=='-' ) { ++_ptr; }
+        while( _ptr<_end && ((*_ptr>='0' && *_ptr<='9') || *_ptr=='.' || *_ptr=='e' || *_ptr=='E' || *_ptr=='+' || *_ptr=='-') ) {
+            ++_ptr;
+        }
+        if( _ptr == start ) { return false; }
+        value._type = JsonValue::Type::NUMBER;
+        value._text.assign(start, _ptr);
+        return true;
+    }
+
+    static int hex_digit(char ch) noexcept {
+        if( ch>='0' && ch<='9' ) { return ch - '0';      }
+        if( ch>='a' && ch<='f' ) { return ch - 'a' + 10; }
+        if( ch>='A' && ch<='F' ) { return ch - 'A' + 10; }
+        return -1;
+    }
+
+    bool parse_hex4(unsigned& codepoint) noexcept {
+        if( _end-_ptr < 4 ) { return false; }
+        codepoint = 0;
+        for( int i=0 ; i<4 ; ++i ) {
+            int digit = hex_digit(*_ptr++);
+            if( digit<0 ) { return false; }
+            codepoint = (codepoint << 4) | static_cast<unsigned>(digit);
+        }
+        return true;
+    }
+
+    static void append_utf8(String& out, unsigned codepoint) {
+        if( codepoint < 0x80 ) {
+            out += static_cast<char>(codepoint);
+        } else if( codepoint < 0x800 ) {
+            out += static_cast<char>(0xC0 | (codepoint >> 6));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else if( codepoint < 0x10000 ) {
+            out += static_cast<char>(0xE0 | (codepoint >> 12));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (codepoint >> 18));
+            out += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codepoint & 0x3F));
+        }
+    }
+
+    bool parse_string(String& out) {
+        ++_ptr; // '"'
+        while( _ptr < _end ) {
+            // copy the run of plain characters in one go
+            const char* run = _ptr;
+            while( _ptr<_end && *_ptr!='"' && *_ptr!='\\' ) { ++_ptr; }
+            out.append(run, _ptr);
+            if( _ptr >= _end ) { return false; }
+            if( *_ptr++ == '"' ) { return true; }
+
+            // escape sequence
+            if( _ptr >= _end ) { return false; }
+            switch( *_ptr++ ) {
+                case '"' : out += '"';  break;
+                case '\\': out += '\\'; break;
+                case '/' : out += '/';  break;
+                case 'b' : out += '\b'; break;
+                case 'f' : out += '\f'; break;
+                case 'n' : out += '\n'; break;
+                case 'r' : out += '\r'; break;
+                case 't' : out += '\t'; break;
+                case 'u' : {
+                    unsigned codepoint;
+                    if( !parse_hex4(codepoint) ) { return false; }
+                    // combine UTF-16 surrogate pairs
+                    if( codepoint>=0xD800 && codepoint<=0xDBFF && _end-_ptr>=6 && _ptr[0]=='\\' && _ptr[1]=='u' ) {
+                        _ptr += 2;
+                        unsigned low;
+                        if( !parse_hex4(low) ) { return false; }
+                        codepoint = 0x10000 + ((codepoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    append_utf8(out, codepoint);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        return false;
+    }
+};
+
+//============================= CONSTRUCTION ==============================//
+
+/**
+ * Parses a JSON document.
+ * @param text The JSON text to parse.
+ * @param ok   Set to `true` if the whole text is a valid JSON document.
+ * @return The root value of the document (a null value if parsing failed).
+ */
+JsonValue
+JsonValue::parse(StringView text, bool& ok) {
+    JsonValue  value;
+    JsonParser parser{text};
+    ok = parser.parse_document(value);
+    if( !ok ) { value = JsonValue{}; }
+    return value;
+}
+
+//============================= VALUE ACCESS ==============================//
+
+/**
+ * Returns the value as an unsigned 64-bit integer.
+ * @param defaultValue The value to return if this is not an unsigned integer.
+ */
+std::uint64_t
+JsonValue::as_uint64(std::uint64_t defaultValue) const noexcept {
+    if( _type != Type::NUMBER ) { return defaultValue; }
+    std::uint64_t result;
+    auto resultInfo = std::from_chars(_text.data(), _text.data() + _text.size(), result);
+    return (resultInfo.ec == std::errc{} && resultInfo.ptr == _text.data() + _text.size()) ? result : defaultValue;
+}
+
+/**
+ * Returns the value as a double.
+ * @param defaultValue The value to return if this is not a number.
+ */
+double
+JsonValue::as_double(double defaultValue) const noexcept {
+    if( _type != Type::NUMBER ) { return defaultValue; }
+    return std::strtod(_text.c_str(), nullptr);
+}
+
+/**
+ * Finds the member with the given key in an object.
+ * @return A pointer to the member value, or `nullptr` if not found.
+ */
+const JsonValue*
+JsonValue::find(StringView key) const noexcept {
+    for( const auto& member : _members ) {
+        if( member.first == key ) { return &member.second; }
+    }
+    return nullptr;
+}
+
+/**
+ * Returns the member with the given key, or a null value if not found.
+ */
+const JsonValue&
+JsonValue::operator[](StringView key) const noexcept {
+    static const JsonValue null;
+    const JsonValue* value = find(key);
+    return value ? *value : null;
+}
+
+//=============================== WRITING =================================//
+
+void
+append_json_string(String& out, StringView text) {
+    escape_json_string(text, [&](StringView piece) { out.append(piece); });
+}
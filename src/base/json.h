@@ -0,0 +1,134 @@
+/*
+| File    : json.h
+| Purpose : A small JSON value class with a parser, enough to read checkpoint headers.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 2, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef JSON_H_
+#define JSON_H_
+#include <array>    // for std::array
+#include <cstdint>  // for std::uint64_t
+#include <vector>   // for std::vector
+#include "common.h"
+
+/**
+ * A small JSON value with a parser, enough to read checkpoint headers and
+ * `.index.json` files.
+ *
+ * Numbers are kept as their original text, so 64-bit offsets are read back
+ * without the precision loss of a round-trip through `double`. Object members
+ * keep the order in which they appear in the document.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * bool ok;
+ * auto json = JsonValue::parse(R"({"weight_map": {"a.weight": "model-1.safetensors"}})", ok);
+ * if( ok ) {
+ *     for( const auto& [name, file] : json["weight_map"].members() ) {
+ *         std::cout << name << " -> " << file.as_string() << std::endl;
+ *     }
+ * }
+ * @endcode
+ */
+class JsonValue
+{
+public:
+    enum class Type {
+        NUL, BOOLEAN, NUMBER, STRING, ARRAY, OBJECT
+    };
+    using Member  = std::pair<String, JsonValue>;
+    using Members = std::vector<Member>;
+    using Items   = std::vector<JsonValue>;
+
+// CONSTRUCTION
+public:
+    [[nodiscard]] static JsonValue parse(StringView text, bool& ok);
+    JsonValue() = default;
+
+// ATTRIBUTES
+public:
+    [[nodiscard]] Type type()       const noexcept { return _type;               }
+    [[nodiscard]] bool is_null()    const noexcept { return _type==Type::NUL;    }
+    [[nodiscard]] bool is_string()  const noexcept { return _type==Type::STRING; }
+    [[nodiscard]] bool is_number()  const noexcept { return _type==Type::NUMBER; }
+    [[nodiscard]] bool is_array()   const noexcept { return _type==Type::ARRAY;  }
+    [[nodiscard]] bool is_object()  const noexcept { return _type==Type::OBJECT; }
+
+// VALUE ACCESS
+public:
+    [[nodiscard]] const String&   as_string() const noexcept { return _text; }
+    [[nodiscard]] bool            as_bool()   const noexcept { return _type==Type::BOOLEAN && _text=="true"; }
+    [[nodiscard]] std::uint64_t   as_uint64(std::uint64_t defaultValue = 0) const noexcept;
+    [[nodiscard]] double          as_double(double defaultValue = 0.0) const noexcept;
+    [[nodiscard]] const Items&    items()     const noexcept { return _items;   }
+    [[nodiscard]] const Members&  members()   const noexcept { return _members; }
+    [[nodiscard]] const JsonValue* find(StringView key) const noexcept;
+    [[nodiscard]] const JsonValue& operator[](StringView key) const noexcept;
+
+// IMPLEMENTATION
+private:
+    friend class JsonParser;
+    Type    _type = Type::NUL;
+    String  _text;    ///< string value, number text or "true"/"false"
+    Items   _items;   ///< array elements
+    Members _members; ///< object members
+};
+
+
+/**
+ * Writes `text` as a quoted JSON string through `write`, a callable that
+ * takes each piece of the output as a `StringView`.
+ *
+ * The text is scanned for the bytes that need escaping and every run of
+ * bytes between them is written in one piece, so names that need no
+ * escaping (nearly all of them) cost a single scan and three writes.
+ * It is the escaper of both `append_json_string()` and `JsonWriter`.
+ */
+template <typename Write>
+void escape_json_string(StringView text, Write&& write) {
+    static constexpr std::array<bool, 256> NeedsEscape = [] {
+        std::array<bool, 256> table{};
+        for( int ch = 0 ; ch < 0x20 ; ++ch ) { table[ch] = true; }
+        table['"'] = table['\\'] = true;
+        return table;
+    }();
+    static const char* const HexDigits = "0123456789abcdef";
+    write(StringView{"\""});
+    const char* run = text.data();
+    const char* end = text.data() + text.size();
+    for( const char* ptr = run ; ptr < end ; ++ptr ) {
+        const auto uch = static_cast<unsigned char>(*ptr);
+        if( !NeedsEscape[uch] ) { continue; }
+
+        write( StringView{run, static_cast<size_t>(ptr - run)} );
+        switch( uch ) {
+            case '"' : write(StringView{"\\\""}); break;
+            case '\\': write(StringView{"\\\\"}); break;
+            case '\n': write(StringView{"\\n"});  break;
+            case '\r': write(StringView{"\\r"});  break;
+            case '\t': write(StringView{"\\t"});  break;
+            default  : {
+                const char escaped[] = { '\\', 'u', '0', '0', HexDigits[uch >> 4], HexDigits[uch & 0xF] };
+                write( StringView{escaped, sizeof(escaped)} );
+                break;
+            }
+        }
+        run = ptr + 1;
+    }
+    write( StringView{run, static_cast<size_t>(end - run)} );
+    write(StringView{"\""});
+}
+
+/**
+ * Appends `text` to `out` as a quoted JSON string, escaping as required.
+ */
+void append_json_string(String& out, StringView text);
+
+
+#endif // JSON_H_
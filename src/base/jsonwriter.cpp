@@ -0,0 +1,25 @@
+/*
+| File    : jsonwriter.cpp
+| Purpose : Writes JSON documents straight into an OutputSink, without a DOM.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 10, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include "jsonwriter.h"
+#include "json.h"   // for escape_json_string
+
+
+//================================ HELPERS ================================//
+
+/**
+ * Writes `text` to `out` as a quoted JSON string.
+ * (see `escape_json_string()`, shared with `append_json_string()`)
+ */
+void
+JsonWriter::write_json_string(OutputSink& out, StringView text) {
+    escape_json_string(text, [&](StringView piece) { out.write(piece); });
+}
@@ -0,0 +1,96 @@
+/*
+| File    : jsonwriter.h
+| Purpose : Writes JSON documents straight into an OutputSink, without a DOM.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 10, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef JSONWRITER_H_
+#define JSONWRITER_H_
+#include <cmath>        // for std::isfinite
+#include <type_traits>  // for std::is_arithmetic_v, std::is_floating_point_v
+#include "common.h"
+#include "outputsink.h"
+
+/**
+ * Writes a JSON document piece by piece into an OutputSink.
+ *
+ * Nothing is kept in memory besides the state needed to place the commas, so
+ * a listing of millions of tensors costs no more than the sink's buffer. The
+ * writer does not check that the calls form a valid document; objects must
+ * alternate `key()` and a value, and every `begin_*()` needs its `end_*()`.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * JsonWriter json{ OutputSink::standard_output() };
+ * json.begin_object();
+ * json.member("file", filename);
+ * json.key("tensors").begin_array();
+ * for( const auto& tensor : tensors ) {
+ *     json.begin_object().member("name", tensor.name).member("size", tensor.size).end_object();
+ * }
+ * json.end_array();
+ * json.end_object().end_document();
+ * @endcode
+ */
+class JsonWriter
+{
+// CONSTRUCTION
+public:
+    explicit JsonWriter(OutputSink& out) : _out{out} { }
+
+// STRUCTURE
+public:
+    JsonWriter& begin_object() { _separator(); _out.put('{'); _needsComma = false; return *this; }
+    JsonWriter& end_object()   { _out.put('}'); _needsComma = true; return *this; }
+    JsonWriter& begin_array()  { _separator(); _out.put('['); _needsComma = false; return *this; }
+    JsonWriter& end_array()    { _out.put(']'); _needsComma = true; return *this; }
+    JsonWriter& key(StringView name) {
+        _separator(); write_json_string(_out, name); _out.put(':');
+        _afterKey = true;
+        return *this;
+    }
+    JsonWriter& end_document() { _out.put('\n'); _needsComma = false; return *this; }
+
+// VALUES
+public:
+    JsonWriter& value(StringView text)    { _separator(); write_json_string(_out, text); _needsComma = true; return *this; }
+    JsonWriter& value(const String& text) { return value( StringView{text} ); }
+    JsonWriter& value(const char* text)   { return value( StringView{text} ); }
+    JsonWriter& value(bool boolean)       { return raw( boolean ? "true" : "false" ); }
+    JsonWriter& null()                    { return raw( "null" ); }
+    template <typename T> requires (std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char>)
+    JsonWriter& value(T number) {
+        if constexpr( std::is_floating_point_v<T> ) { if( !std::isfinite(number) ) { return null(); } }
+        _separator(); _out.number(number); _needsComma = true;
+        return *this;
+    }
+    /// Writes text that is already valid JSON (e.g. a shape such as "[64,32]").
+    JsonWriter& raw(StringView json) { _separator(); _out.write(json); _needsComma = true; return *this; }
+
+    template <typename T>
+    JsonWriter& member(StringView name, const T& value_) { key(name); return value(value_); }
+
+// HELPERS
+public:
+    static void write_json_string(OutputSink& out, StringView text);
+
+// IMPLEMENTATION
+private:
+    void _separator() {
+        if( _afterKey ) { _afterKey = false; return; }
+        if( _needsComma ) { _out.put(','); }
+    }
+private:
+    OutputSink& _out;
+    bool        _needsComma = false; ///< a value was written in the current container
+    bool        _afterKey   = false; ///< the next value belongs to the last key
+};
+
+
+#endif // JSONWRITER_H_
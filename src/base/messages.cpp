@@ -15,6 +15,37 @@
 #include "colors.h" 
 #include "messages.h"
 
+/// The text that receives the messages of this thread, null = the console
+static thread_local std::string* CapturedText = nullptr;
+
+/**
+ * Writes a complete message, with its line breaks, to the console or to the
+ * text that captures the messages of this thread.
+ */
+static void
+_emit(const std::string& lines) {
+    if( CapturedText ) { *CapturedText += lines; }
+    else               { std::cerr << lines << std::flush; }
+}
+
+//============================== CAPTURING ================================//
+
+/**
+ * Starts capturing the messages of the current thread into `text`.
+ * Captures can be nested; the innermost one receives the messages.
+ */
+Messages::Capture::Capture(std::string& text) noexcept
+: _previous{CapturedText}
+{
+    CapturedText = &text;
+}
+
+Messages::Capture::~Capture() {
+    CapturedText = _previous;
+}
+
+//=============================== MESSAGES ================================//
+
 
 /**
  * Displays a warning message to the console.
@@ -27,7 +58,7 @@
 void
 Messages::warning(Text message) {
     auto c = Colors::instance();
-    std::cerr << c.warning() << "[WARNING]" << c.reset() << " " << message << std::endl;
+    _emit( c.warning() + "[WARNING]" + c.reset() + " " + std::string(message) + "\n" );
 }
 
 /**
@@ -41,7 +72,18 @@ Messages::warning(Text message) {
 void
 Messages::error(Text message) {
     auto c = Colors::instance();
-    std::cerr << c.error() << "[ERROR]" << c.reset() << " " << message << std::endl;
+    _emit( c.error() + "[ERROR]" + c.reset() + " " + std::string(message) + "\n" );
+}
+
+/**
+ * Writes text that is already formatted as messages, usually captured
+ * while another thread ran a command, to the console (or to the capture of
+ * the current thread).
+ * @param text The messages, with their line breaks.
+ */
+void
+Messages::write(Text text) {
+    _emit( std::string(text) );
 }
 
 /**
@@ -53,7 +95,7 @@ Messages::error(Text message) {
  * as additional context.
  * 
  * After displaying these messages, it terminates the program execution using
- * `std::exit`.
+ * `std::exit`, or throws `FatalError` if the thread is capturing its messages.
  *
  * @param message      The main content of the fatal error message.
  * @param infoMessages An optional vector containing additional texts that
@@ -70,8 +112,47 @@ Messages::fatal_error(Text message,
     
     // Print additional messages if any
     auto c = Colors::instance();
+    std::string lines;
     for (const auto& info : infoMessages) {
-        std::cerr << " " << c.info() << "\xF0\x9F\x9B\x88 " << info << c.reset() << std::endl;
+        lines += " " + c.info() + "\xF0\x9F\x9B\x88 " + std::string(info) + c.reset() + "\n";
     }
+    _emit(lines);
+    if( CapturedText ) { throw FatalError{ exitCode>=1 ? exitCode : 1 }; }
     std::exit( exitCode>=1 ? exitCode : 1 );
 }
+
+/**
+ * Returns a human-readable description of an error found while reading a checkpoint file.
+ * @param readError The error returned by the reader.
+ */
+Messages::Text
+Messages::read_error_description(tin::ReadError readError) noexcept {
+    using tin::ReadError;
+    switch(readError) {
+        case ReadError::FileNotFound:
+            return "File not found.";
+        case ReadError::InvalidFormat:
+            return "This is probably not a valid .safetensors or .gguf file.";
+        case ReadError::UnsupportedVersion:
+            return "The file may be from an older or newer version of the format that this tool does not support.";
+        case ReadError::HeaderTooLarge:
+            return "The file header may be corrupted, incomplete, or have other issues that prevent it from being read correctly.";
+        case ReadError::MemoryAllocationFailed:
+            return "There may not be enough memory available to read this file, or it is corrupted in a way that prevents allocation of enough memory.";
+        case ReadError::MissingData:
+            return "The file is missing some required data, which may indicate corruption or have other issues that prevent it from being read correctly.";
+        default:
+            return "An unknown error occurred while reading the file.";
+    }
+}
+
+/**
+ * Displays the error found while reading a checkpoint file and exits the program.
+ * @param readError The error returned by the reader.
+ * @param filename  An optional name of the file that was being read.
+ */
+void
+Messages::fatal_read_error(tin::ReadError readError, Text filename) {
+    if( filename.empty() ) { fatal_error(read_error_description(readError)); }
+    fatal_error(read_error_description(readError), { "File: " + std::string(filename) });
+}
@@ -12,8 +12,10 @@
 #pragma once
 #ifndef MESSAGES_H_
 #define MESSAGES_H_
-#include <string_view> // for std::string_view
-#include <vector>      // for std::vector
+#include <string>          // for std::string
+#include <string_view>     // for std::string_view
+#include <vector>          // for std::vector
+#include <tin/readerror.h> // for tin::ReadError
 
 
 /**
@@ -23,17 +25,43 @@
  *  - Warnings    : Informative messages that do not interrupt the flow of the program.
  *  - Errors      : Issues encountered during execution that may require attention but are not critical.
  *  - Fatal Errors: Critical issues that warrant immediate termination of the program.
+ *
+ * A thread that runs a command on behalf of someone else (a request of the
+ * daemon) creates a `Messages::Capture`: while it is alive, the messages of
+ * that thread are appended to a string instead of written to the console,
+ * and a fatal error throws `Messages::FatalError` instead of exiting.
+ * `Messages::write()` prints the captured text later, on any thread.
  */
 class Messages
 {
 public:
     using Text = std::string_view;
+
+    /// Thrown by `fatal_error()` on a thread that is capturing its messages.
+    struct FatalError {
+        int exitCode;
+    };
+
+    /// Redirects the messages of the current thread to `text` while alive.
+    class Capture {
+    public:
+        explicit Capture(std::string& text) noexcept;
+        Capture(const Capture&) = delete;
+        Capture& operator=(const Capture&) = delete;
+        ~Capture();
+    private:
+        std::string* _previous;
+    };
+
 public:
     static              void warning    (Text message);
     static              void error      (Text message);
+    static              void write      (Text text);
     [[noreturn]] static void fatal_error(Text message,
                                          const std::vector<Text>& infoMessages = {},
                                          int                      exitCode     = 1);
+    [[noreturn]] static void fatal_read_error(tin::ReadError readError, Text filename = {});
+    [[nodiscard]] static Text read_error_description(tin::ReadError readError) noexcept;
 };
 
 
@@ -0,0 +1,141 @@
+/*
+| File    : minifloat.h
+| Purpose : Conversions between float and the reduced precision formats used in checkpoints.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 5, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef MINIFLOAT_H_
+#define MINIFLOAT_H_
+#include <bit>      // for std::bit_cast
+#include <cmath>    // for std::ldexp, std::nearbyint, std::isnan
+#include <cstdint>  // for std::uint8_t, std::uint16_t, std::uint32_t
+
+/*
+  Every conversion from float rounds to the nearest value, ties to even.
+  Values too large for the format overflow as described below.
+
+  +---------+------+----------+----------+-----------------------------------+
+  | Format  | Bits | Exponent | Mantissa | Overflow                          |
+  | ------- | ---- | -------- | -------- | --------------------------------- |
+  | F16     |  16  |    5     |    10    | infinity                          |
+  | BF16    |  16  |    8     |     7    | infinity                          |
+  | F8_E4M3 |   8  |    4     |     3    | saturates to 448 (no infinities)  |
+  | F8_E5M2 |   8  |    5     |     2    | saturates to 57344                |
+  +---------+------+----------+----------+-----------------------------------+
+*/
+
+namespace minifloat_detail {
+
+    /**
+     * Encodes a finite non-negative float with the given number of mantissa
+     * bits and exponent bias, returning the exponent and mantissa fields.
+     * Values too small for a normal number are encoded as subnormals. The
+     * caller must check the result for overflow.
+     */
+    [[nodiscard]] inline std::uint32_t
+    encode(float magnitude, int mantissaBits, int bias) noexcept {
+        const float minNormal = std::bit_cast<float>(static_cast<std::uint32_t>(128 - bias) << 23);
+        if( magnitude < minNormal ) {
+            // subnormal: value = mantissa * 2^(1 - bias - mantissaBits)
+            // (rounding up to 1<<mantissaBits gives the smallest normal number)
+            return static_cast<std::uint32_t>( std::nearbyint(std::ldexp(magnitude, bias - 1 + mantissaBits)) );
+        }
+        const int shift = 23 - mantissaBits;
+        std::uint32_t bits = std::bit_cast<std::uint32_t>(magnitude);
+        bits += ((1u << (shift - 1)) - 1) + ((bits >> shift) & 1); // round to nearest, ties to even
+        const std::uint32_t exponent = (bits >> 23) - 127 + bias;
+        const std::uint32_t mantissa = (bits >> shift) & ((1u << mantissaBits) - 1);
+        return (exponent << mantissaBits) | mantissa;
+    }
+
+    /**
+     * Decodes the exponent and mantissa fields of a finite minifloat.
+     */
+    [[nodiscard]] inline float
+    decode(std::uint32_t fields, int mantissaBits, int bias) noexcept {
+        const std::uint32_t exponent = fields >> mantissaBits;
+        const std::uint32_t mantissa = fields & ((1u << mantissaBits) - 1);
+        if( exponent == 0 ) { return std::ldexp(static_cast<float>(mantissa), 1 - bias - mantissaBits); }
+        return std::ldexp(static_cast<float>(mantissa | (1u << mantissaBits)), static_cast<int>(exponent) - bias - mantissaBits);
+    }
+}
+
+//================================== F16 ==================================//
+
+[[nodiscard]] inline std::uint16_t
+float_to_f16(float value) noexcept {
+    const std::uint32_t sign = (std::bit_cast<std::uint32_t>(value) >> 16) & 0x8000;
+    const float magnitude = std::fabs(value);
+    if( std::isnan(magnitude) ) { return static_cast<std::uint16_t>(sign | 0x7E00); }
+    const std::uint32_t fields = magnitude < 65536.0f ? minifloat_detail::encode(magnitude, 10, 15) : 0x7C00;
+    return static_cast<std::uint16_t>(sign | (fields < 0x7C00 ? fields : 0x7C00));
+}
+
+[[nodiscard]] inline float
+f16_to_float(std::uint16_t value) noexcept {
+    const std::uint32_t sign     = static_cast<std::uint32_t>(value & 0x8000) << 16;
+    const std::uint32_t exponent = (value >> 10) & 0x1F;
+    const std::uint32_t mantissa = value & 0x3FF;
+    if( exponent == 0x1F ) { return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13)); }
+    if( exponent == 0    ) { const float subnormal = std::ldexp(static_cast<float>(mantissa), -24); return sign ? -subnormal : subnormal; }
+    return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+//================================= BF16 ==================================//
+
+[[nodiscard]] inline std::uint16_t
+float_to_bf16(float value) noexcept {
+    std::uint32_t bits = std::bit_cast<std::uint32_t>(value);
+    if( std::isnan(value) ) { return static_cast<std::uint16_t>((bits >> 16) | 0x40); }
+    bits += 0x7FFF + ((bits >> 16) & 1);
+    return static_cast<std::uint16_t>(bits >> 16);
+}
+
+[[nodiscard]] inline float
+bf16_to_float(std::uint16_t value) noexcept {
+    return std::bit_cast<float>(static_cast<std::uint32_t>(value) << 16);
+}
+
+//================================ F8_E4M3 ================================//
+
+[[nodiscard]] inline std::uint8_t
+float_to_f8_e4m3(float value) noexcept {
+    const std::uint32_t sign = (std::bit_cast<std::uint32_t>(value) >> 24) & 0x80;
+    const float magnitude = std::fabs(value);
+    if( std::isnan(magnitude) ) { return static_cast<std::uint8_t>(sign | 0x7F); }
+    const std::uint32_t fields = magnitude < 512.0f ? minifloat_detail::encode(magnitude, 3, 7) : 0x7E;
+    return static_cast<std::uint8_t>(sign | (fields < 0x7E ? fields : 0x7E));
+}
+
+[[nodiscard]] inline float
+f8_e4m3_to_float(std::uint8_t value) noexcept {
+    const float magnitude = (value & 0x7F) == 0x7F ? NAN : minifloat_detail::decode(value & 0x7F, 3, 7);
+    return (value & 0x80) ? -magnitude : magnitude;
+}
+
+//================================ F8_E5M2 ================================//
+
+[[nodiscard]] inline std::uint8_t
+float_to_f8_e5m2(float value) noexcept {
+    const std::uint32_t sign = (std::bit_cast<std::uint32_t>(value) >> 24) & 0x80;
+    const float magnitude = std::fabs(value);
+    if( std::isnan(magnitude) ) { return static_cast<std::uint8_t>(sign | 0x7F); }
+    const std::uint32_t fields = magnitude < 65536.0f ? minifloat_detail::encode(magnitude, 2, 15) : 0x7B;
+    return static_cast<std::uint8_t>(sign | (fields < 0x7B ? fields : 0x7B));
+}
+
+[[nodiscard]] inline float
+f8_e5m2_to_float(std::uint8_t value) noexcept {
+    const std::uint32_t fields = value & 0x7F;
+    const float magnitude = fields >= 0x7C ? (fields == 0x7C ? INFINITY : NAN) : minifloat_detail::decode(fields, 2, 15);
+    return (value & 0x80) ? -magnitude : magnitude;
+}
+
+
+#endif // MINIFLOAT_H_
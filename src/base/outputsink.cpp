@@ -0,0 +1,103 @@
+/*
+| File    : outputsink.cpp
+| Purpose : A large user-space output buffer flushed with one write per buffer.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 9, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <iostream>  // for std::cout, std::ostream
+#include "outputsink.h"
+#ifdef _WIN32
+#   include <io.h>      // for ::_write()
+#   define STDOUT_FILENO 1
+#else
+#   include <unistd.h>  // for ::write(), STDOUT_FILENO
+#   include <cerrno>    // for errno, EINTR
+#endif
+
+
+//======================= CONSTRUCTION/DESTRUCTION ========================//
+
+/**
+ * Creates a sink that writes to a file descriptor (e.g. STDOUT_FILENO).
+ */
+OutputSink::OutputSink(int fileDescriptor, size_t capacity)
+: _buffer{ new char[capacity] }
+, _capacity{ capacity }
+, _fileDescriptor{ fileDescriptor }
+{ }
+
+/**
+ * Creates a sink that writes to a `std::ostream`, one `write()` per buffer.
+ */
+OutputSink::OutputSink(std::ostream& stream, size_t capacity)
+: _buffer{ new char[capacity] }
+, _capacity{ capacity }
+, _stream{ &stream }
+{ }
+
+OutputSink::~OutputSink() {
+    flush();
+}
+
+/**
+ * Returns the sink of the standard output, shared by the whole program.
+ * Anything pending in `std::cout` is flushed before the sink is created.
+ */
+OutputSink&
+OutputSink::standard_output() {
+    static OutputSink sink = (std::cout.flush(), OutputSink{STDOUT_FILENO});
+    return sink;
+}
+
+//================================ WRITING ================================//
+
+/**
+ * Writes the buffered text to the target.
+ * @return `false` if the target reported an error (the text is discarded).
+ */
+bool
+OutputSink::flush() {
+    const bool ok = _write_to_target(_buffer.get(), _size);
+    _size = 0;
+    return ok;
+}
+
+//============================ IMPLEMENTATION =============================//
+
+OutputSink&
+OutputSink::_write_large(StringView text) {
+    flush();
+    if( text.size() < _capacity ) {
+        std::memcpy(_buffer.get(), text.data(), text.size());
+        _size = text.size();
+    }
+    else {
+        _write_to_target(text.data(), text.size());
+    }
+    return *this;
+}
+
+bool
+OutputSink::_write_to_target(const char* data, size_t size) {
+    if( size == 0 || _failed ) { return !_failed; }
+    if( _stream ) {
+        _failed = !_stream->write(data, static_cast<std::streamsize>(size));
+        return !_failed;
+    }
+    while( size > 0 ) {
+#ifdef _WIN32
+        const int count = ::_write(_fileDescriptor, data, static_cast<unsigned>(std::min<size_t>(size, 0x40000000)));
+#else
+        const ssize_t count = ::write(_fileDescriptor, data, size);
+        if( count < 0 && errno == EINTR ) { continue; }
+#endif
+        if( count <= 0 ) { _failed = true; return false; }
+        data += count; size -= static_cast<size_t>(count);
+    }
+    return true;
+}
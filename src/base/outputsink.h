@@ -0,0 +1,118 @@
+/*
+| File    : outputsink.h
+| Purpose : A large user-space output buffer flushed with one write per buffer.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 9, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef OUTPUTSINK_H_
+#define OUTPUTSINK_H_
+#include <algorithm>    // for std::min
+#include <charconv>     // for std::to_chars
+#include <cstring>      // for std::memcpy, std::memset
+#include <iosfwd>       // for std::ostream
+#include <memory>       // for std::unique_ptr
+#include <type_traits>  // for std::is_arithmetic_v
+#include "common.h"
+
+/**
+ * A large user-space output buffer that is flushed with a single write(2)
+ * call per buffer.
+ *
+ * Listings of hundreds of thousands of lines should not go through
+ * `std::endl` (one flush per line) nor build temporary strings for every
+ * number. Text, padding and numbers (formatted with `std::to_chars`) are
+ * appended to the buffer and only reach the file descriptor when it is full,
+ * when `flush()` is called, or when the sink is destroyed.
+ *
+ * The sink can also wrap a `std::ostream`, which receives one `write()` per
+ * buffer; this is how `Table` keeps printing to any stream.
+ *
+ * Text written to `std::cout` and to `OutputSink::standard_output()` is
+ * buffered separately, so one of them must be flushed before switching to
+ * the other.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * auto& out = OutputSink::standard_output();
+ * for( const auto& tensor : tensors ) {
+ *     out << tensor.name << ',' << tensor.size << '\n';
+ * }
+ * out.flush();
+ * @endcode
+ */
+class OutputSink
+{
+public:
+    static constexpr size_t DefaultCapacity = 1024 * 1024;
+
+// CONSTRUCTION/DESTRUCTION
+public:
+    explicit OutputSink(int fileDescriptor, size_t capacity = DefaultCapacity);
+    explicit OutputSink(std::ostream& stream, size_t capacity = DefaultCapacity);
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+    ~OutputSink();
+    [[nodiscard]] static OutputSink& standard_output();
+
+// WRITING
+public:
+    OutputSink& write(StringView text) {
+        if( text.size() > _capacity - _size ) { return _write_large(text); }
+        std::memcpy(_buffer.get() + _size, text.data(), text.size());
+        _size += text.size();
+        return *this;
+    }
+    OutputSink& put(char ch) {
+        if( _size == _capacity ) { flush(); }
+        _buffer[_size++] = ch;
+        return *this;
+    }
+    OutputSink& fill(char ch, size_t count) {
+        while( count > 0 ) {
+            if( _size == _capacity ) { flush(); }
+            const size_t chunk = std::min(count, _capacity - _size);
+            std::memset(_buffer.get() + _size, ch, chunk);
+            _size += chunk; count -= chunk;
+        }
+        return *this;
+    }
+    template <typename T> requires std::is_arithmetic_v<T>
+    OutputSink& number(T value) {
+        char digits[32];
+        const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+        return write( StringView{digits, static_cast<size_t>(result.ptr - digits)} );
+    }
+    bool flush();
+    [[nodiscard]] bool good() const noexcept { return !_failed; }
+    [[nodiscard]] size_t pending() const noexcept { return _size; }
+
+// OPERATORS
+public:
+    OutputSink& operator<<(StringView    text ) { return write(text); }
+    OutputSink& operator<<(const String& text ) { return write(text); }
+    OutputSink& operator<<(const char*   text ) { return write(text); }
+    OutputSink& operator<<(char          ch   ) { return put(ch);     }
+    template <typename T> requires (std::is_arithmetic_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>)
+    OutputSink& operator<<(T value) { return number(value); }
+
+// IMPLEMENTATION
+private:
+    OutputSink& _write_large(StringView text);
+    bool        _write_to_target(const char* data, size_t size);
+private:
+    std::unique_ptr<char[]> _buffer;
+    size_t                  _capacity = 0;
+    size_t                  _size     = 0;
+    int                     _fileDescriptor = -1;
+    std::ostream*           _stream   = nullptr;
+    bool                    _failed   = false;
+};
+
+
+#endif // OUTPUTSINK_H_
@@ -0,0 +1,71 @@
+/*
+| File    : parallel.h
+| Purpose : Minimal helpers to run independent jobs on several threads.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 2, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+#include <atomic>    // for std::atomic
+#include <thread>    // for std::thread
+#include <vector>    // for std::vector
+#include <algorithm> // for std::min, std::max
+
+
+/**
+ * Returns the number of threads to use when the user doesn't specify one.
+ */
+[[nodiscard]] inline unsigned
+default_thread_count() noexcept {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * Calls `function(index)` for every index in [0, count) using several threads.
+ *
+ * Indices are handed out dynamically, one at a time, so jobs of very different
+ * cost are still balanced between threads. The call returns when every job has
+ * finished. The function must be safe to call concurrently.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * parallel_for(jobs.size(), default_thread_count(), [&](size_t i) {
+ *     process( jobs[i] );
+ * });
+ * @endcode
+ *
+ * @param count           The number of jobs.
+ * @param numberOfThreads The maximum number of threads to use (0 = default).
+ * @param function        The callable invoked with the index of each job.
+ */
+template <typename Function>
+void parallel_for(size_t count, unsigned numberOfThreads, Function&& function)
+{
+    if( numberOfThreads == 0 ) { numberOfThreads = default_thread_count(); }
+    numberOfThreads = static_cast<unsigned>( std::min<size_t>(numberOfThreads, count) );
+
+    // run on the calling thread when there is nothing to parallelize
+    if( numberOfThreads <= 1 ) {
+        for( size_t i=0 ; i<count ; ++i ) { function(i); }
+        return;
+    }
+
+    std::atomic<size_t> nextIndex{0};
+    auto worker = [&]() {
+        for( size_t i = nextIndex++ ; i < count ; i = nextIndex++ ) { function(i); }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(numberOfThreads - 1);
+    for( unsigned t=1 ; t<numberOfThreads ; ++t ) { threads.emplace_back(worker); }
+    worker();
+    for( auto& thread : threads ) { thread.join(); }
+}
+
+
+#endif // PARALLEL_H_
@@ -0,0 +1,462 @@
+/*
+| File    : patternset.cpp
+| Purpose : Matches names against several glob/regex patterns with one DFA.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 13, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm>  // for std::sort
+#include "patternset.h"
+
+
+//============================= REGEX PARSER ==============================//
+
+/**
+ * Recursive descent parser that builds the NFA of a regex in a PatternSet.
+ * (declared as friend of PatternSet so it can create the states directly)
+ */
+class RegexParser
+{
+public:
+    RegexParser(PatternSet& set, StringView regex) : _set{set}, _text{regex}, _firstState{set._states.size()} { }
+
+    /// true if the regex is an alternation of several branches at its top level
+    bool has_top_level_alternation() const noexcept { return _topLevelAlternation; }
+
+    bool parse(PatternSet::Fragment& fragment, String& error) {
+        fragment = parse_alternation();
+        if( _error.empty() && _pos < _text.size() ) { _error = "unmatched ')'"; }
+        if( !_error.empty() ) {
+            error = "Invalid regular expression '" + String{_text} + "': " + _error + " at position " + std::to_string(_pos);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    using ByteSet  = PatternSet::ByteSet;
+    using Fragment = PatternSet::Fragment;
+    static constexpr int MaxRepeat = 1000;
+    PatternSet& _set;
+    StringView  _text;
+    size_t      _firstState;  ///< states before the regex, the ones after it count against MaxNfaStates
+    size_t      _pos = 0;
+    int         _groupLevel = 0;
+    bool        _topLevelAlternation = false;
+    String      _error;
+
+    bool at_end() const noexcept { return _pos >= _text.size(); }
+    bool too_large() {
+        if( _error.empty() && _set._states.size() - _firstState > PatternSet::MaxNfaStates ) { _error = "expression too large"; }
+        return !_error.empty();
+    }
+    char peek()   const noexcept { return _text[_pos]; }
+
+    Fragment parse_alternation() {
+        Fragment fragment = parse_concatenation();
+        while( _error.empty() && !at_end() && peek() == '|' ) {
+            ++_pos;
+            if( _groupLevel == 0 ) { _topLevelAlternation = true; }
+            fragment = _set._alternate(fragment, parse_concatenation());
+        }
+        return fragment;
+    }
+
+    Fragment parse_concatenation() {
+        Fragment fragment = _set._empty_fragment();
+        while( _error.empty() && !at_end() && peek() != '|' && peek() != ')' ) {
+            fragment = _set._concat(fragment, parse_repetition());
+        }
+        return fragment;
+    }
+
+    Fragment parse_repetition() {
+        const size_t atomStart = _pos;
+        Fragment fragment = parse_atom();
+        while( _error.empty() && !at_end() ) {
+            const char ch = peek();
+            if     ( ch == '*' ) { ++_pos; fragment = _set._star(fragment);     }
+            else if( ch == '+' ) { ++_pos; fragment = _set._plus(fragment);     }
+            else if( ch == '?' ) { ++_pos; fragment = _set._optional(fragment); }
+            else if( ch == '{' ) { fragment = parse_counted(atomStart, fragment); }
+            else { break; }
+        }
+        return fragment;
+    }
+
+    /// "{m}", "{m,}" or "{m,n}" after the atom that starts at `atomStart`;
+    /// the copies of the atom are built by parsing its text again, so nested
+    /// counts multiply the states and stop at `MaxNfaStates`.
+    Fragment parse_counted(size_t atomStart, Fragment atom) {
+        const size_t atomEnd = _pos;
+        ++_pos;
+        const int minimum = parse_number();
+        int maximum = minimum;
+        if( !at_end() && peek() == ',' ) {
+            ++_pos;
+            maximum = (!at_end() && peek() == '}') ? -1 : parse_number();
+        }
+        if( at_end() || peek() != '}' || minimum < 0 || (maximum >= 0 && maximum < minimum) || maximum > MaxRepeat ) {
+            _error = "invalid repetition count";
+            return atom;
+        }
+        const size_t countEnd = ++_pos;
+
+        auto copy_of_atom = [&]() {
+            _pos = atomStart;
+            Fragment copy = parse_atom();
+            _pos = atomEnd;
+            return copy;
+        };
+        Fragment fragment = minimum > 0 ? atom : _set._empty_fragment();
+        for( int i = 1 ; i < minimum && !too_large() ; ++i ) { fragment = _set._concat(fragment, copy_of_atom()); }
+        if( maximum < 0 && !too_large() ) {
+            fragment = _set._concat(fragment, _set._star(minimum > 0 ? copy_of_atom() : atom));
+        }
+        for( int i = std::max(minimum, 1) ; i < maximum && !too_large() ; ++i ) {
+            fragment = _set._concat(fragment, _set._optional(copy_of_atom()));
+        }
+        if( minimum == 0 && maximum > 0 ) { fragment = _set._concat(fragment, _set._optional(atom)); }
+        _pos = countEnd;
+        return fragment;
+    }
+
+    int parse_number() {
+        int number = -1;
+        while( !at_end() && peek() >= '0' && peek() <= '9' ) {
+            number = std::max(number, 0) * 10 + (peek() - '0');
+            if( number > MaxRepeat ) { number = MaxRepeat + 1; }
+            ++_pos;
+        }
+        return number;
+    }
+
+    Fragment parse_atom() {
+        if( at_end() ) { _error = "missing expression"; return _set._empty_fragment(); }
+        const char ch = _text[_pos++];
+        switch( ch ) {
+            case '(': {
+                if( _text.substr(_pos).starts_with("?:") ) { _pos += 2; }
+                ++_groupLevel;
+                Fragment fragment = parse_alternation();
+                --_groupLevel;
+                if( at_end() || peek() != ')' ) { _error = "missing ')'"; return fragment; }
+                ++_pos;
+                return fragment;
+            }
+            case '[': return _set._byte_fragment( parse_class() );
+            case '.': return _set._byte_fragment( ByteSet{}.set() );
+            case '^': return _set._assertion_fragment( PatternSet::Kind::BEGIN );
+            case '$': return _set._assertion_fragment( PatternSet::Kind::END );
+            case '\\': {
+                if( at_end() ) { _error = "trailing '\\'"; return _set._empty_fragment(); }
+                return _set._byte_fragment( escape(_text[_pos++]) );
+            }
+            case '*': case '+': case '?': case '{':
+                _error = String{"nothing to repeat with '"} + ch + "'";
+                return _set._empty_fragment();
+            default:
+                return _set._byte_fragment( ByteSet{}.set(static_cast<unsigned char>(ch)) );
+        }
+    }
+
+    ByteSet parse_class() {
+        ByteSet bytes;
+        const bool negated = !at_end() && peek() == '^';
+        if( negated ) { ++_pos; }
+        bool first = true;
+        while( !at_end() && (peek() != ']' || first) ) {
+            first = false;
+            char ch = _text[_pos++];
+            if( ch == '\\' && !at_end() ) {
+                const char escaped = _text[_pos++];
+                const ByteSet set = escape(escaped);
+                if( set.count() != 1 ) { bytes |= set; continue; }
+                ch = escaped;
+            }
+            if( _pos + 1 < _text.size() && peek() == '-' && _text[_pos + 1] != ']' ) {
+                char last = _text[_pos + 1];
+                _pos += 2;
+                if( last == '\\' && !at_end() ) { last = _text[_pos++]; }
+                if( static_cast<unsigned char>(last) < static_cast<unsigned char>(ch) ) { _error = "invalid range in class"; return bytes; }
+                for( int c = static_cast<unsigned char>(ch) ; c <= static_cast<unsigned char>(last) ; ++c ) { bytes.set(c); }
+                continue;
+            }
+            bytes.set( static_cast<unsigned char>(ch) );
+        }
+        if( at_end() ) { _error = "missing ']'"; return bytes; }
+        ++_pos;
+        return negated ? ~bytes : bytes;
+    }
+
+    static ByteSet escape(char ch) {
+        ByteSet bytes;
+        switch( ch ) {
+            case 'd': case 'D':
+                for( int c = '0' ; c <= '9' ; ++c ) { bytes.set(c); }
+                return ch == 'D' ? ~bytes : bytes;
+            case 'w': case 'W':
+                for( int c = '0' ; c <= '9' ; ++c ) { bytes.set(c); }
+                for( int c = 'a' ; c <= 'z' ; ++c ) { bytes.set(c); bytes.set(c - 'a' + 'A'); }
+                bytes.set('_');
+                return ch == 'W' ? ~bytes : bytes;
+            case 's': case 'S':
+                for( char c : StringView{" \t\n\r\f\v"} ) { bytes.set( static_cast<unsigned char>(c) ); }
+                return ch == 'S' ? ~bytes : bytes;
+            case 'n': bytes.set('\n'); return bytes;
+            case 't': bytes.set('\t'); return bytes;
+            default : bytes.set( static_cast<unsigned char>(ch) ); return bytes;
+        }
+    }
+};
+
+//=============================== PATTERNS ================================//
+
+/**
+ * Adds a glob pattern that must match the whole name.
+ */
+void
+PatternSet::add_glob(StringView glob) {
+    Fragment fragment = _empty_fragment();
+    for( const char ch : glob ) {
+        if     ( ch == '*' ) { fragment = _concat(fragment, _star( _byte_fragment(ByteSet{}.set()) )); }
+        else if( ch == '?' ) { fragment = _concat(fragment, _byte_fragment(ByteSet{}.set())); }
+        else                 { fragment = _concat(fragment, _byte_fragment(ByteSet{}.set(static_cast<unsigned char>(ch)))); }
+    }
+    _add_root(fragment);
+}
+
+/**
+ * Adds a regular expression that matches anywhere in the name unless it is
+ * anchored with '^' and/or '$'.
+ * @param regex The regular expression.
+ * @param error Set to a description of the problem if the regex is invalid.
+ * @return `false` if the regex is invalid (nothing is added).
+ */
+bool
+PatternSet::add_regex(StringView regex, String& error) {
+    const size_t numberOfStates = _states.size();
+    Fragment fragment;
+    RegexParser parser{ *this, regex };
+    if( !parser.parse(fragment, error) ) {
+        _states.resize(numberOfStates);
+        return false;
+    }
+    // the leading ".*" is left out when the whole regex is anchored at the
+    // start, so the DFA gives up on a name as soon as it can't match
+    const bool anchoredStart = regex.starts_with('^') && !parser.has_top_level_alternation();
+    const auto anyText = [this]() { return _star( _byte_fragment(ByteSet{}.set()) ); };
+    if( !anchoredStart ) { fragment = _concat(anyText(), fragment); }
+    fragment = _concat(fragment, anyText());
+    _add_root(fragment);
+    return true;
+}
+
+/**
+ * Adds a pattern given on the command line: a regex if it is enclosed in
+ * slashes ("/layers\.\d+/"), otherwise a glob.
+ */
+bool
+PatternSet::add(StringView pattern, String& error) {
+    if( pattern.size() >= 2 && pattern.front() == '/' && pattern.back() == '/' ) {
+        return add_regex(pattern.substr(1, pattern.size() - 2), error);
+    }
+    add_glob(pattern);
+    return true;
+}
+
+//=============================== MATCHING ================================//
+
+/**
+ * Returns true if `name` matches any of the patterns.
+ */
+bool
+PatternSet::matches(StringView name) {
+    if( _roots.empty() ) { return false; }
+    if( _dfa.empty() || _dfa.size() > MaxDfaStates ) { _reset_dfa(); }
+
+    std::int32_t state = 0;
+    for( const char ch : name ) {
+        const auto byte = static_cast<unsigned char>(ch);
+        std::int32_t next = _dfa[state].next[byte];
+        if( next == Unknown ) { next = _compute_transition(state, byte); }
+        if( next == Dead    ) { return false; }
+        state = next;
+    }
+    return _dfa[state].accepting;
+}
+
+//============================ IMPLEMENTATION =============================//
+
+int
+PatternSet::_new_state(Kind kind, const ByteSet& bytes) {
+    _states.push_back({ kind, bytes, -1, -1 });
+    return static_cast<int>(_states.size() - 1);
+}
+
+PatternSet::Fragment
+PatternSet::_byte_fragment(const ByteSet& bytes) {
+    const int start = _new_state(Kind::BYTE, bytes);
+    const int end   = _new_state(Kind::EPSILON);
+    _states[start].next1 = end;
+    return { start, end };
+}
+
+PatternSet::Fragment
+PatternSet::_assertion_fragment(Kind kind) {
+    const int start = _new_state(kind);
+    const int end   = _new_state(Kind::EPSILON);
+    _states[start].next1 = end;
+    return { start, end };
+}
+
+PatternSet::Fragment
+PatternSet::_empty_fragment() {
+    const int state = _new_state(Kind::EPSILON);
+    return { state, state };
+}
+
+PatternSet::Fragment
+PatternSet::_concat(Fragment a, Fragment b) {
+    _states[a.end].next1 = b.start;
+    return { a.start, b.end };
+}
+
+PatternSet::Fragment
+PatternSet::_alternate(Fragment a, Fragment b) {
+    const int split = _new_state(Kind::EPSILON);
+    const int end   = _new_state(Kind::EPSILON);
+    _states[split].next1 = a.start;
+    _states[split].next2 = b.start;
+    _states[a.end].next1 = end;
+    _states[b.end].next1 = end;
+    return { split, end };
+}
+
+PatternSet::Fragment
+PatternSet::_star(Fragment a) {
+    const int split = _new_state(Kind::EPSILON);
+    const int end   = _new_state(Kind::EPSILON);
+    _states[split].next1 = a.start;
+    _states[split].next2 = end;
+    _states[a.end].next1 = split;
+    return { split, end };
+}
+
+PatternSet::Fragment
+PatternSet::_plus(Fragment a) {
+    const Fragment star = _star(a);
+    return { a.start, star.end };
+}
+
+PatternSet::Fragment
+PatternSet::_optional(Fragment a) {
+    const int split = _new_state(Kind::EPSILON);
+    _states[split].next1 = a.start;
+    _states[split].next2 = a.end;
+    return { split, a.end };
+}
+
+void
+PatternSet::_add_root(Fragment fragment) {
+    if( _match < 0 ) { _match = _new_state(Kind::EPSILON); }
+    _states[fragment.end].next1 = _match;
+    _roots.push_back(fragment.start);
+    _dfa.clear();
+}
+
+/**
+ * Drops every cached DFA state and creates the start state again.
+ */
+void
+PatternSet::_reset_dfa() {
+    _dfa.clear();
+    _dfaSets.clear();
+    _dfaIds.clear();
+    std::vector<int> start = _roots;
+    _dfa_state(start, true);
+}
+
+/**
+ * Replaces `nfaStates` by the states reachable from them without consuming
+ * a byte, keeping only the ones that consume bytes, the '$' assertions not
+ * passed and the match.
+ * @param atStart `true` to pass the '^' assertions (at the start of the name).
+ * @param atEnd   `true` to pass the '$' assertions (at the end of the name).
+ */
+void
+PatternSet::_closure(std::vector<int>& nfaStates, bool atStart, bool atEnd) {
+    if( _marks.size() < _states.size() ) { _marks.resize(_states.size(), 0); }
+    if( ++_generation == 0 ) { std::fill(_marks.begin(), _marks.end(), 0); _generation = 1; }
+    _stack.assign(nfaStates.begin(), nfaStates.end());
+    nfaStates.clear();
+    while( !_stack.empty() ) {
+        const int index = _stack.back();
+        _stack.pop_back();
+        if( index < 0 || _marks[index] == _generation ) { continue; }
+        _marks[index] = _generation;
+        const State& state = _states[index];
+        switch( state.kind ) {
+            case Kind::BYTE:
+                nfaStates.push_back(index);
+                break;
+            case Kind::BEGIN:
+                if( atStart ) { _stack.push_back(state.next1); }
+                break;
+            case Kind::END:
+                if( atEnd ) { _stack.push_back(state.next1); } else { nfaStates.push_back(index); }
+                break;
+            case Kind::EPSILON:
+                if( index == _match ) { nfaStates.push_back(index); break; }
+                _stack.push_back(state.next2);
+                _stack.push_back(state.next1);
+                break;
+        }
+    }
+    std::sort(nfaStates.begin(), nfaStates.end());
+}
+
+/**
+ * Returns the DFA state of a set of NFA states, creating it if needed.
+ * `nfaStates` is replaced by its closure.
+ * @param atStart `true` to create the start state (never shared with others,
+ *                as only there the '^' assertions pass).
+ */
+std::int32_t
+PatternSet::_dfa_state(std::vector<int>& nfaStates, bool atStart) {
+    // the name is accepted if it ends here and the match is reachable
+    // passing the pending '$' assertions
+    _endStates = nfaStates;
+    _closure(_endStates, atStart, true);
+    _closure(nfaStates, atStart, false);
+    if( nfaStates.empty() ) { return Dead; }
+
+    if( !atStart ) {
+        const auto it = _dfaIds.find(nfaStates);
+        if( it != _dfaIds.end() ) { return it->second; }
+    }
+    const auto id = static_cast<std::int32_t>(_dfa.size());
+    DfaState dfaState;
+    dfaState.next.fill(Unknown);
+    dfaState.accepting = std::binary_search(_endStates.begin(), _endStates.end(), _match);
+    _dfa.push_back(dfaState);
+    _dfaSets.push_back(nfaStates);
+    if( !atStart ) { _dfaIds.emplace(nfaStates, id); }
+    return id;
+}
+
+std::int32_t
+PatternSet::_compute_transition(std::int32_t from, unsigned char byte) {
+    std::vector<int> next;
+    for( const int index : _dfaSets[from] ) {
+        const State& state = _states[index];
+        if( state.kind == Kind::BYTE && state.bytes.test(byte) ) { next.push_back(state.next1); }
+    }
+    const std::int32_t to = next.empty() ? Dead : _dfa_state(next, false);
+    _dfa[from].next[byte] = to;
+    return to;
+}
@@ -0,0 +1,118 @@
+/*
+| File    : patternset.h
+| Purpose : Matches names against several glob/regex patterns with one DFA.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 13, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef PATTERNSET_H_
+#define PATTERNSET_H_
+#include <array>    // for std::array
+#include <bitset>   // for std::bitset
+#include <cstdint>  // for std::int32_t
+#include <map>      // for std::map
+#include <vector>   // for std::vector
+#include "common.h"
+
+/**
+ * A set of glob and regex patterns matched together, in a single pass over
+ * each name.
+ *
+ * Every pattern is compiled once to an NFA; the NFAs of all the patterns
+ * share one start, so a name matches the set if it matches any of them (OR).
+ * Names are then run through a DFA built lazily from that NFA: each DFA
+ * state and transition is computed the first time it is needed and cached,
+ * so after a few names matching costs one table lookup per byte and no
+ * allocation.
+ *
+ * Globs must match the whole name; '*' matches any sequence (dots
+ * included) and '?' any single character, as in `matches_glob()`.
+ * Regexes match anywhere in the name unless anchored with '^' and '$', and
+ * support literals, '.', classes ("[a-z_]", "[^0-9]"), the escapes \d \w \s
+ * (and \D \W \S), groups "(...)" / "(?:...)", alternation '|' and the
+ * quantifiers '*', '+', '?', "{m}", "{m,}", "{m,n}".
+ *
+ * Example usage:
+ * @code{.cpp}
+ * PatternSet patterns;
+ * String error;
+ * patterns.add_glob("*.attn_*.weight");
+ * if( !patterns.add_regex(R"(layers\.\d+\.mlp)", error) ) { std::cerr << error; }
+ * for( const auto& name : names ) {
+ *     if( patterns.matches(name) ) { std::cout << name << std::endl; }
+ * }
+ * @endcode
+ */
+class PatternSet
+{
+// PATTERNS
+public:
+    void add_glob(StringView glob);
+    bool add_regex(StringView regex, String& error);
+    bool add(StringView pattern, String& error);
+    [[nodiscard]] bool empty() const noexcept { return _roots.empty(); }
+
+// MATCHING
+public:
+    [[nodiscard]] bool matches(StringView name);
+
+// IMPLEMENTATION
+private:
+    using ByteSet = std::bitset<256>;
+    enum class Kind : std::uint8_t {
+        EPSILON, ///< goes to `next1` and `next2` without consuming anything
+        BYTE,    ///< consumes a byte in `bytes` and goes to `next1`
+        BEGIN,   ///< '^', goes to `next1` only at the start of the name
+        END      ///< '$', goes to `next1` only at the end of the name
+    };
+    struct State {
+        Kind    kind = Kind::EPSILON;
+        ByteSet bytes;
+        int     next1 = -1;
+        int     next2 = -1;
+    };
+    struct Fragment { int start; int end; };  ///< `end` is an epsilon state with no exits yet
+    struct DfaState {
+        std::array<std::int32_t, 256> next;   ///< Unknown until computed, Dead if no state follows
+        bool                          accepting = false;
+    };
+    static constexpr std::int32_t Unknown = -1;
+    static constexpr std::int32_t Dead    = -2;
+    static constexpr size_t MaxDfaStates  = 4096;
+    static constexpr size_t MaxNfaStates  = 100000;  ///< per regex, counted repetitions included
+
+    friend class RegexParser;
+    int      _new_state(Kind kind, const ByteSet& bytes = {});
+    Fragment _byte_fragment(const ByteSet& bytes);
+    Fragment _assertion_fragment(Kind kind);
+    Fragment _empty_fragment();
+    Fragment _concat(Fragment a, Fragment b);
+    Fragment _alternate(Fragment a, Fragment b);
+    Fragment _star(Fragment a);
+    Fragment _plus(Fragment a);
+    Fragment _optional(Fragment a);
+    void     _add_root(Fragment fragment);
+    void     _reset_dfa();
+    void     _closure(std::vector<int>& nfaStates, bool atStart, bool atEnd);
+    std::int32_t _dfa_state(std::vector<int>& nfaStates, bool atStart);
+    std::int32_t _compute_transition(std::int32_t from, unsigned char byte);
+private:
+    std::vector<State>    _states;
+    std::vector<int>      _roots;          ///< start of each pattern
+    int                   _match = -1;     ///< the accepting state, shared by every pattern
+    std::vector<DfaState> _dfa;
+    std::vector<std::vector<int>>         _dfaSets;  ///< NFA states of each DFA state
+    std::map<std::vector<int>, std::int32_t> _dfaIds;
+    std::vector<int>      _stack;          ///< scratch for the epsilon closures
+    std::vector<int>      _endStates;
+    std::vector<unsigned> _marks;
+    unsigned              _generation = 0;
+};
+
+
+#endif // PATTERNSET_H_
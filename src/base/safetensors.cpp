@@ -0,0 +1,329 @@
+/*
+| File    : safetensors.cpp
+| Purpose : Low-level access to the layout of .safetensors files (header and data offsets).
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 2, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <charconv>   // for std::to_chars
+#include <algorithm>  // for std::max, std::find, std::sort
+#include <filesystem> // for std::filesystem::path
+#include "safetensors.h"
+#include "json.h"
+#include "file.h"
+
+
+//================================ HELPERS ================================//
+
+std::uint64_t
+safetensors_dtype_size(StringView dtype) noexcept {
+    if( dtype == "F32" || dtype == "I32" || dtype == "U32" ) { return 4; }
+    if( dtype == "F16" || dtype == "BF16"|| dtype == "I16" || dtype == "U16" ) { return 2; }
+    if( dtype == "F64" || dtype == "I64" || dtype == "U64" ) { return 8; }
+    if( dtype == "I8"  || dtype == "U8"  || dtype == "BOOL" ) { return 1; }
+    if( dtype == "F8_E4M3" || dtype == "F8_E5M2" ) { return 1; }
+    return 0;
+}
+
+static void
+_append_number(String& out, std::uint64_t number) {
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+    out.append(buffer, result.ptr);
+}
+
+static std::uint64_t
+_read_u64_le(const unsigned char* bytes) noexcept {
+    std::uint64_t value = 0;
+    for( int i=7 ; i>=0 ; --i ) { value = (value << 8) | bytes[i]; }
+    return value;
+}
+
+//============================= CONSTRUCTION ==============================//
+
+/**
+ * Reads the layout of a .safetensors file.
+ *
+ * Only the 8-byte length prefix and the JSON header are read. The byte range
+ * of every tensor is validated against the size of the file.
+ *
+ * @param path      The path to the .safetensors file.
+ * @param readError Set to `ReadError::None` on success, or to the error found.
+ */
+SafetensorsFile
+SafetensorsFile::from_file(const String& path, ReadError& readError) {
+    File file;
+    if( !file.open_read(path) ) { readError = ReadError::FileNotFound; return {}; }
+
+    unsigned char prefix[8];
+    const std::uint64_t fileSize = file.size();
+    if( fileSize < 8 || !file.read_at(prefix, 8, 0) ) { readError = ReadError::InvalidFormat; return {}; }
+
+    const std::uint64_t headerSize = _read_u64_le(prefix);
+    if( headerSize > MaxHeaderSize   ) { readError = ReadError::HeaderTooLarge; return {}; }
+    if( 8 + headerSize > fileSize    ) { readError = ReadError::MissingData;    return {}; }
+
+    String json(headerSize, '\0');
+    if( !file.read_at(json.data(), headerSize, 8) ) { readError = ReadError::MissingData; return {}; }
+
+    auto safetensors = from_header(json, readError);
+    if( readError != ReadError::None ) { return {}; }
+    safetensors._path       = path;
+    safetensors._headerSize = headerSize;
+
+    // every tensor must lie inside the file
+    if( safetensors.data_size() > fileSize - safetensors.data_offset() ) {
+        readError = ReadError::MissingData;
+        return {};
+    }
+    return safetensors;
+}
+
+/**
+ * Builds the layout from the JSON text of a .safetensors header.
+ * @param json      The JSON header (without the 8-byte length prefix).
+ * @param readError Set to `ReadError::None` on success, or to the error found.
+ */
+SafetensorsFile
+SafetensorsFile::from_header(StringView json, ReadError& readError) {
+    SafetensorsFile safetensors;
+    safetensors._headerSize = json.size();
+
+    bool ok;
+    auto root = JsonValue::parse(json, ok);
+    if( !ok || !root.is_object() ) { readError = ReadError::InvalidFormat; return {}; }
+
+    safetensors._tensors.reserve( root.members().size() );
+    for( const auto& [name, value] : root.members() ) {
+
+        // "__metadata__" is a flat string-to-string map
+        if( name == "__metadata__" ) {
+            for( const auto& [key, entry] : value.members() ) {
+                if( entry.is_string() ) { safetensors._metadata.emplace_back(key, entry.as_string()); }
+            }
+            continue;
+        }
+
+        const auto& dtype   = value["dtype"];
+        const auto& shape   = value["shape"];
+        const auto& offsets = value["data_offsets"];
+        if( !dtype.is_string() || !shape.is_array() || !offsets.is_array() || offsets.items().size()!=2 ) {
+            readError = ReadError::InvalidFormat;
+            return {};
+        }
+        Tensor tensor;
+        tensor.name  = name;
+        tensor.dtype = dtype.as_string();
+        tensor.begin = offsets.items()[0].as_uint64();
+        tensor.end   = offsets.items()[1].as_uint64();
+        tensor.shape.reserve( shape.items().size() );
+        std::uint64_t numberOfElements = 1;
+        bool          overflows        = false;
+        for( const auto& dim : shape.items() ) {
+            const std::uint64_t dimension = dim.as_uint64();
+            overflows = overflows || (dimension != 0 && numberOfElements > UINT64_MAX / dimension);
+            numberOfElements *= dimension;
+            tensor.shape.push_back( dimension );
+        }
+        if( std::find(tensor.shape.begin(), tensor.shape.end(), 0) != tensor.shape.end() ) { overflows = false; }
+        // the byte range must match the number of elements (when the dtype is known),
+        // and a shape whose size doesn't fit in 64 bits can't match any range
+        const std::uint64_t elementSize = safetensors_dtype_size(tensor.dtype);
+        if( elementSize && (overflows || numberOfElements > UINT64_MAX / elementSize) ) {
+            readError = ReadError::InvalidFormat;
+            return {};
+        }
+        if( tensor.end < tensor.begin || (elementSize && numberOfElements*elementSize != tensor.size()) ) {
+            readError = ReadError::InvalidFormat;
+            return {};
+        }
+        safetensors._tensors.push_back( std::move(tensor) );
+    }
+    readError = ReadError::None;
+    return safetensors;
+}
+
+/**
+ * Returns the shard files listed in the "weight_map" of a sharded checkpoint
+ * index (e.g. 'model.safetensors.index.json'), in order of first appearance.
+ *
+ * @param indexPath The path to the .index.json file.
+ * @param readError Set to `ReadError::None` on success, or to the error found.
+ * @return The paths of the shards, relative to the directory of the index file.
+ */
+std::vector<String>
+SafetensorsFile::shards_of_index(const String& indexPath, ReadError& readError) {
+    File file;
+    if( !file.open_read(indexPath) ) { readError = ReadError::FileNotFound; return {}; }
+    String text(file.size(), '\0');
+    if( !file.read_at(text.data(), text.size(), 0) ) { readError = ReadError::MissingData; return {}; }
+
+    bool ok;
+    auto index = JsonValue::parse(text, ok);
+    if( !ok || !index["weight_map"].is_object() ) { readError = ReadError::InvalidFormat; return {}; }
+
+    const auto directory = std::filesystem::path(indexPath).parent_path();
+    std::vector<String> shardFiles, shardPaths;
+    for( const auto& [tensorName, shardFile] : index["weight_map"].members() ) {
+        if( std::find(shardFiles.begin(), shardFiles.end(), shardFile.as_string()) == shardFiles.end() ) {
+            shardFiles.push_back( shardFile.as_string() );
+            shardPaths.push_back( (directory / shardFile.as_string()).string() );
+        }
+    }
+    readError = ReadError::None;
+    return shardPaths;
+}
+
+//============================== ATTRIBUTES ===============================//
+
+/**
+ * Returns the size of the data section, as indexed by the tensors.
+ */
+std::uint64_t
+SafetensorsFile::data_size() const noexcept {
+    std::uint64_t size = 0;
+    for( const auto& tensor : _tensors ) { size = std::max(size, tensor.end); }
+    return size;
+}
+
+//=========================== HEADER GENERATION ===========================//
+
+/**
+ * Generates the binary header (length prefix + JSON) for a .safetensors file.
+ *
+ * The JSON is padded with trailing spaces, as allowed by the format, so that
+ * the data section starts at a multiple of `alignment` bytes.
+ *
+ * @param tensors   The tensors to describe, their `begin`/`end` must already
+ *                  be the offsets they will have in the new data section.
+ * @param metadata  The key/value pairs of the "__metadata__" entry.
+ * @param alignment The alignment of the data section (8 at least).
+ * @return The bytes that go at the start of the file, before the data section.
+ */
+String
+SafetensorsFile::build_header(const Tensors&  tensors,
+                              const Metadata& metadata,
+                              std::uint64_t   alignment // = 8
+){
+    String header(8, '\0');
+    header.reserve( 8 + 128 * (tensors.size() + 1) );
+    header += '{';
+
+    if( !metadata.empty() ) {
+        header += "\"__metadata__\":{";
+        for( size_t i=0 ; i<metadata.size() ; ++i ) {
+            if( i>0 ) { header += ','; }
+            append_json_string(header, metadata[i].first);
+            header += ':';
+            append_json_string(header, metadata[i].second);
+        }
+        header += '}';
+    }
+    for( const auto& tensor : tensors ) {
+        if( header.back() != '{' ) { header += ','; }
+        append_json_string(header, tensor.name);
+        header += ":{\"dtype\":";
+        append_json_string(header, tensor.dtype);
+        header += ",\"shape\":[";
+        for( size_t i=0 ; i<tensor.shape.size() ; ++i ) {
+            if( i>0 ) { header += ','; }
+            _append_number(header, tensor.shape[i]);
+        }
+        header += "],\"data_offsets\":[";
+        _append_number(header, tensor.begin);
+        header += ',';
+        _append_number(header, tensor.end);
+        header += "]}";
+    }
+    header += '}';
+
+    // pad with spaces so the data section starts aligned
+    alignment = std::max<std::uint64_t>(alignment, 8);
+    const std::uint64_t remainder = header.size() % alignment;
+    if( remainder != 0 ) { header.append(alignment - remainder, ' '); }
+
+    // write the little-endian length prefix
+    std::uint64_t headerSize = header.size() - 8;
+    for( int i=0 ; i<8 ; ++i ) {
+        header[i] = static_cast<char>(headerSize & 0xFF);
+        headerSize >>= 8;
+    }
+    return header;
+}
+
+/**
+ * Generates the JSON of a '<NAME>.safetensors.index.json' file, which maps
+ * every tensor of a sharded checkpoint to the shard that contains it.
+ *
+ * @param weightMap The (tensor name, shard filename) pairs, in any order.
+ * @param totalSize The sum of the size of all tensors, in bytes.
+ * @return The JSON text, with the tensors sorted by name.
+ */
+String
+SafetensorsFile::build_index(std::vector<std::pair<StringView, StringView>> weightMap,
+                             std::uint64_t totalSize
+){
+    std::sort(weightMap.begin(), weightMap.end());
+    String json = "{\n  \"metadata\": {\n    \"total_size\": ";
+    _append_number(json, totalSize);
+    json += "\n  },\n  \"weight_map\": {\n";
+    for( size_t i=0 ; i<weightMap.size() ; ++i ) {
+        json += "    ";
+        append_json_string(json, weightMap[i].first);
+        json += ": ";
+        append_json_string(json, weightMap[i].second);
+        json += (i+1 < weightMap.size()) ? ",\n" : "\n";
+    }
+    json += "  }\n}\n";
+    return json;
+}
+
+//============================= ALIGNED LAYOUT ============================//
+
+/**
+ * Appends a tensor to the layout of a new data section, at the next offset
+ * multiple of `alignment`. The gap before it, if any, is covered by a U8
+ * tensor named '__padding__.<N>' (N = its position in `tensors`).
+ *
+ * @param tensors   The layout, in data order; the tensor (and its padding) are appended.
+ * @param tensor    The tensor to place (a copy is appended with its new `begin`/`end`).
+ * @param alignment The alignment of the tensor data (0 or 1 = none).
+ * @param dataSize  The end of the data section, moved past the tensor.
+ * @return The offset of the tensor in the data section.
+ */
+std::uint64_t
+SafetensorsFile::add_aligned(Tensors&       tensors,
+                             const Tensor&  tensor,
+                             std::uint64_t  alignment,
+                             std::uint64_t& dataSize
+){
+    const std::uint64_t offset = align_up(dataSize, alignment);
+    if( offset > dataSize ) {
+        Tensor padding;
+        padding.name  = String(PaddingPrefix) + std::to_string(tensors.size());
+        padding.dtype = "U8";
+        padding.shape = { offset - dataSize };
+        padding.begin = dataSize;
+        padding.end   = offset;
+        tensors.push_back( std::move(padding) );
+    }
+    auto& added = tensors.emplace_back(tensor);
+    added.begin = offset;
+    added.end   = offset + tensor.size();
+    dataSize    = added.end;
+    return offset;
+}
+
+/**
+ * Returns the alignment of the data section of a file whose tensors are
+ * aligned to `alignment`: a page at least, so the data can be mapped, or
+ * the 8 bytes the format asks for when the tensors are not aligned (0).
+ */
+std::uint64_t
+SafetensorsFile::header_alignment(std::uint64_t alignment) noexcept {
+    return alignment > 0 ? std::max(alignment, PageSize) : 8;
+}
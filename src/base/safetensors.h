@@ -0,0 +1,113 @@
+/*
+| File    : safetensors.h
+| Purpose : Low-level access to the layout of .safetensors files (header and data offsets).
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 2, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef SAFETENSORS_H_
+#define SAFETENSORS_H_
+#include <cstdint>          // for std::uint64_t
+#include <vector>           // for std::vector
+#include <tin/readerror.h>  // for tin::ReadError
+#include "common.h"
+using tin::ReadError;
+
+/**
+ * Low-level access to the layout of a .safetensors file.
+ *
+ * `tin::TensorMap` is the right tool to inspect what a checkpoint contains,
+ * but the tools that rewrite checkpoints need the physical layout: the size
+ * of the JSON header and the exact byte range of every tensor. This class
+ * parses only the header and exposes that layout, it never reads tensor data.
+ *
+ * File layout:
+ *   [8 bytes: N, little-endian u64] [N bytes: JSON header] [data section]
+ * Each tensor's "data_offsets" are relative to the start of the data section.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * ReadError readError;
+ * auto file = SafetensorsFile::from_file("model.safetensors", readError);
+ * for( const auto& tensor : file.tensors() ) {
+ *     std::cout << tensor.name << " @ " << file.data_offset() + tensor.begin << std::endl;
+ * }
+ * @endcode
+ */
+class SafetensorsFile
+{
+public:
+    struct Tensor {
+        String                     name;
+        String                     dtype;     ///< safetensors dtype name ("F16", "BF16", "F32", ...)
+        std::vector<std::uint64_t> shape;
+        std::uint64_t              begin = 0; ///< first byte, relative to the data section
+        std::uint64_t              end   = 0; ///< one past the last byte, relative to the data section
+        [[nodiscard]] std::uint64_t size() const noexcept { return end - begin; }
+        [[nodiscard]] bool is_padding() const noexcept { return name.starts_with(PaddingPrefix); }
+    };
+    using Tensors  = std::vector<Tensor>;
+    using Metadata = std::vector<StringPair>;
+
+    static constexpr std::uint64_t MaxHeaderSize = 100'000'000; ///< same limit as the reference implementation
+    static constexpr std::uint64_t PageSize      = 4096;        ///< least alignment of the data of aligned files
+
+    /// Prefix of the filler tensors used to align the data of the real tensors.
+    /// (the format does not allow holes in the data section, so alignment
+    ///  padding has to be indexed by a tensor like any other byte)
+    static constexpr StringView PaddingPrefix = "__padding__.";
+
+// CONSTRUCTION
+public:
+    [[nodiscard]] static SafetensorsFile from_file(const String& path, ReadError& readError);
+    [[nodiscard]] static SafetensorsFile from_header(StringView json, ReadError& readError);
+    [[nodiscard]] static std::vector<String> shards_of_index(const String& indexPath, ReadError& readError);
+    SafetensorsFile() = default;
+
+// ATTRIBUTES
+public:
+    [[nodiscard]] const String&   path()        const noexcept { return _path;       }
+    [[nodiscard]] std::uint64_t   header_size() const noexcept { return _headerSize; }
+    [[nodiscard]] std::uint64_t   data_offset() const noexcept { return 8 + _headerSize; }
+    [[nodiscard]] std::uint64_t   data_size()   const noexcept;
+    [[nodiscard]] const Tensors&  tensors()     const noexcept { return _tensors;    }
+    [[nodiscard]] const Metadata& metadata()    const noexcept { return _metadata;   }
+
+// HEADER GENERATION
+public:
+    [[nodiscard]] static String build_header(const Tensors&  tensors,
+                                             const Metadata& metadata,
+                                             std::uint64_t   alignment = 8);
+    [[nodiscard]] static String build_index(std::vector<std::pair<StringView, StringView>> weightMap,
+                                            std::uint64_t totalSize);
+
+// ALIGNED LAYOUT
+public:
+    static std::uint64_t add_aligned(Tensors&       tensors,
+                                     const Tensor&  tensor,
+                                     std::uint64_t  alignment,
+                                     std::uint64_t& dataSize);
+    [[nodiscard]] static std::uint64_t header_alignment(std::uint64_t alignment) noexcept;
+
+// IMPLEMENTATION
+private:
+    String        _path;
+    std::uint64_t _headerSize = 0;
+    Tensors       _tensors;
+    Metadata      _metadata;
+};
+
+
+/**
+ * Returns the size in bytes of one element of the given safetensors dtype,
+ * or 0 if the dtype is unknown.
+ */
+[[nodiscard]] std::uint64_t safetensors_dtype_size(StringView dtype) noexcept;
+
+
+#endif // SAFETENSORS_H_
@@ -10,7 +10,6 @@
 |      CLI tools for inspecting and manipulating model checkpoint files
 \_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
 #include "table.h"
-#include <format>    // for std::format [C++20]
 #include <algorithm> // for std::max
 
 //======================= CONSTRUCTION/DESTRUCTION ========================//
@@ -19,25 +18,22 @@
  * Constructs a Table object with initial rows.
  * @param rows Initial rows to populate the table
  */
-Table::Table(const Rows& rows
-): _rows(rows)
+Table::Table(const Rows& rows)
 {
-    // calculate the number of columns based on initial rows
-    _numberOfColumns = 0;
-    for( const auto& row : _rows ) {
-        _numberOfColumns = std::max(_numberOfColumns, row.size());
-    }
+    _rowEnds.reserve(rows.size());
+    for( const auto& row : rows ) { add_row(row); }
 }
 
 //=============================== CAPACITY ================================//
 
 /**
  * Get the number of rows in the table
+ * (when streaming, only the rows not printed yet)
  * @return Number of rows
  */
 size_t
 Table::number_of_rows() const {
-    return _rows.size();
+    return _rowEnds.size();
 }
 
 size_t
@@ -50,14 +46,15 @@ Table::number_of_columns() const {
  * @return `true` if table has no rows, false otherwise
  */
 bool Table::empty() const {
-    return _rows.empty();
+    return _rowEnds.empty();
 }
 
 /**
  * Reserve space for a specified number of rows.
  */
 void Table::reserve(size_t numberOfRows) {
-    _rows.reserve(numberOfRows);
+    _rowEnds.reserve(numberOfRows);
+    _cellEnds.reserve(numberOfRows * std::max<size_t>(_numberOfColumns, 1));
 }
 
 //================================ FORMAT =================================//
@@ -74,8 +71,35 @@ void Table::set_max_widths(const std::initializer_list<Width>& maxWidths) {
     _maxColumnWidths = maxWidths;
 }
 
-void Table::set_colorizer(const Colorizer& colorizer) {
-    _colorizer = colorizer;
+/**
+ * Sets the escape codes written around the cells of each column.
+ * Columns without a style are printed as plain text.
+ */
+void Table::set_styles(const std::initializer_list<Style>& styles) {
+    _columnStyles = styles;
+}
+
+/**
+ * Sets a callable that writes the text of every cell in place of the table.
+ * The padding and the column styles are still written by the table.
+ * (`painter` only references the callable, which must outlive the table)
+ */
+void Table::set_painter(Painter painter) {
+    _painter = painter;
+}
+
+/**
+ * Prints the rows to `out` while they are being added, instead of keeping
+ * all of them until the table is printed.
+ *
+ * @param out       The sink that receives the rows.
+ * @param lookahead Number of rows used to compute the column widths before
+ *                  they are printed; 0 keeps every row until `flush()`,
+ *                  so the alignment is exact.
+ */
+void Table::set_streaming(OutputSink& out, size_t lookahead) {
+    _stream    = &out;
+    _lookahead = lookahead;
 }
 
 //=============================== MODIFIERS ===============================//
@@ -86,23 +110,23 @@ void Table::set_colorizer(const Colorizer& colorizer) {
  */
 void
 Table::add_row(const Row& row) {
-    _rows.push_back(row);
-    _numberOfColumns = std::max(_numberOfColumns, row.size());
+    for( const auto& text : row ) { _append_cell(text); }
+    _end_row(row.size());
 }
 
 void Table::add_row(std::initializer_list<std::string_view> values) {
-    Row row;
-    row.reserve(values.size());
-    for( auto& strview : values ) { row.push_back(std::string(strview));  }
-    _rows.push_back( std::move(row) );
-    _numberOfColumns = std::max(_numberOfColumns, values.size());
+    for( const auto& text : values ) { _append_cell(text); }
+    _end_row(values.size());
 }
 
 /**
  * Clear all rows from the table
  */
 void Table::clear() {
-    _rows.clear();
+    _arena.clear();
+    _cellEnds.clear();
+    _rowEnds.clear();
+    _streamedWidths.clear();
     _numberOfColumns = 0;
 }
 
@@ -111,97 +135,139 @@ void Table::clear() {
 // display the table
 // outputs the table row by row with proper column alignment.
 void
-Table::print(std::ostream& out // = std::cout
+Table::print(OutputSink& out // = OutputSink::standard_output()
 ) const {
 
     // if the table is empty there's nothing to do
-    if( _rows.empty() ) { return; }
+    if( _rowEnds.empty() ) { return; }
 
     // calculate widths of each column and output rows with proper alignment
-    auto columnWidths = _calculate_column_widths(_rows);
-    for( const auto& row : _rows ) {
-        _print_row(out, row, columnWidths, _columnAlignments);
+    auto columnWidths = _calculate_column_widths(_minColumnWidths);
+    for( size_t row=0 ; row<_rowEnds.size() ; ++row ) {
+        _print_row(out, row, columnWidths);
+    }
+}
+
+// display the table in any stream
+// (the rows are buffered and reach the stream in large blocks)
+void
+Table::print(std::ostream& out) const {
+    OutputSink sink{out};
+    print(sink);
+}
+
+/**
+ * Prints the pending rows of a streamed table and discards them.
+ *
+ * The widths are the ones of the rows already streamed, widened to fit the
+ * pending rows, so the columns stay aligned with the previous windows
+ * whenever possible.
+ */
+void
+Table::flush() {
+    if( !_stream || _rowEnds.empty() ) { return; }
+
+    _streamedWidths = _calculate_column_widths(_streamedWidths.empty() ? _minColumnWidths : _streamedWidths);
+    for( size_t row=0 ; row<_rowEnds.size() ; ++row ) {
+        _print_row(*_stream, row, _streamedWidths);
     }
+    _arena.clear();
+    _cellEnds.clear();
+    _rowEnds.clear();
 }
 
 //============================ IMPLEMENTATION =============================//
 
+/**
+ * Returns the text of a cell given its index in `_cellEnds`.
+ */
+std::string_view
+Table::_cell(size_t index) const noexcept {
+    const Offset begin = index > 0 ? _cellEnds[index-1] : 0;
+    return std::string_view{ _arena.data() + begin, _cellEnds[index] - begin };
+}
+
+void
+Table::_append_cell(std::string_view text) {
+    _arena.append(text);
+    _cellEnds.push_back( static_cast<Offset>(_arena.size()) );
+}
+
+void
+Table::_end_row(size_t numberOfCells) {
+    _rowEnds.push_back( static_cast<Offset>(_cellEnds.size()) );
+    _numberOfColumns = std::max(_numberOfColumns, numberOfCells);
+    if( _stream && _lookahead > 0 && _rowEnds.size() >= _lookahead ) { flush(); }
+}
+
 /**
  * private funciton Print a single row with proper alignment
- * @param row Row to print
+ * @param row Index of the row to print
  */
 void
-Table::_print_row(std::ostream&     os,
-                  const Row&        row,
-                  const Widths&     columnWidths,
-                  const Alignments& columnAlignments
+Table::_print_row(OutputSink&   out,
+                  size_t        row,
+                  const Widths& columnWidths
 ) const {
     static const std::string Separator = " ";
-    std::string text;
+    const size_t firstCell = row > 0 ? _rowEnds[row-1] : 0;
 
-    for( size_t i=0 ; i<row.size() ; ++i )
+    for( size_t i=0 ; i < _rowEnds[row] - firstCell ; ++i )
     {
-        if( i>0 ) { os << Separator; }
+        if( i>0 ) { out << Separator; }
         const Width width = i<columnWidths.size() ? columnWidths[i] : 0;
-        std::string text = row[i];
+        const std::string_view text = _cell(firstCell + i);
 
-        // if the width is 0 (or invalid), then print the text as is
-        // (this should never happen, but just in case)
-        if( width<=0 ) {
-            os << (_colorizer ? _colorizer(i,text) : text);
-            continue;
+        // spaces needed at each side to reach the width of the column
+        // (if the width is 0 or the text is longer, the text is printed as is)
+        const size_t padding = width > 0 ? static_cast<size_t>(width) - std::min<size_t>(width, text.length()) : 0;
+        size_t leftPadding = 0;
+        switch( i<_columnAlignments.size() ? _columnAlignments[i] : Align::LEFT ) {
+            case Align::LEFT:   leftPadding = 0;           break;
+            case Align::RIGHT:  leftPadding = padding;     break;
+            case Align::CENTER: leftPadding = padding / 2; break;
         }
 
-        // apply alignment to the test
-        const auto align = i<columnAlignments.size() ? columnAlignments[i] : Align::LEFT;
-        switch(align) {
-            case Align::LEFT:
-                text = std::format("{:<{}}", text, width);
-                break;
-            case Align::RIGHT:
-                text = std::format("{:>{}}", text, width);
-                break;
-            case Align::CENTER:
-                text = std::format("{:^{}}", text, width);
-                break;
-        }
-        // print colorized text
-        os << (_colorizer ? _colorizer(i,text) : text);
+        // print the padded text surrounded by the style of the column
+        const Style* style = i<_columnStyles.size() ? &_columnStyles[i] : nullptr;
+        if( style ) { out << style->prefix; }
+        out.fill(' ', leftPadding);
+        if( _painter ) { _painter(out, i, text); } else { out << text; }
+        out.fill(' ', padding - leftPadding);
+        if( style ) { out << style->suffix; }
     }
-    os << std::endl;
+    out << '\n';
 }
 
 /**
- * Calculates column widths based on content of all rows.
+ * Calculates column widths based on content of the stored rows.
  *
- * This method determines the maximum width needed for each column by analyzing 
- * the length of content in every row. It ensures that calculated widths do not 
+ * This method determines the maximum width needed for each column by analyzing
+ * the length of content in every row. It ensures that calculated widths do not
  * exceed specified maximums or fall below minimums per column.
  *
- * @param rows The input table rows to analyze for determining column widths.
+ * @param widths The initial widths (the minimums, or the widths already in use).
  * @return A vector containing the calculated optimal width for each column.
  */
 Table::Widths
-Table::_calculate_column_widths(const Rows& rows) const {
-    Widths widths;
-   
+Table::_calculate_column_widths(Widths widths) const {
+
     // if the table is empty there's nothing to do
-    if( _rows.empty() ) { return widths; }
+    if( _rowEnds.empty() ) { return widths; }
+
+    // make sure the `widths` vector is as large as the widest row
+    if( _numberOfColumns>widths.size() ) { widths.resize( _numberOfColumns, 0 ); }
 
-    // apply minimum column widths first
-    widths = _minColumnWidths;
-    
     // iterate over all rows to calculate the optimal column widths
-    for( const auto& row : _rows )
+    size_t firstCell = 0;
+    for( const Offset rowEnd : _rowEnds )
     {
-        // make sure the `widths` vector is at least as large as the current row
-        if( row.size()>widths.size() ) { widths.resize( row.size(), 0 ); }
-        
         // update column widths to be the maximum
-        for( size_t column = 0 ; column < row.size() ; ++column ) {
-            Width textLength( row[column].length() );
+        for( size_t column = 0 ; column < rowEnd - firstCell ; ++column ) {
+            Width textLength( _cell(firstCell + column).length() );
             widths[column] = std::max( widths[column], textLength );
         }
+        firstCell = rowEnd;
     }
     // ensure no calculated column width exceeds its specified maximum
     const size_t arraySize = std::min( widths.size(), _maxColumnWidths.size() );
@@ -214,6 +280,3 @@ Table::_calculate_column_widths(const Rows& rows) const {
 
     return widths;
 }
-
-
-
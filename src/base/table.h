@@ -13,15 +13,32 @@
 #ifndef TABLE_H_
 #define TABLE_H_
 #include <iostream>   // for std::ostream, std::cout
+#include <cstdint>    // for std::uint64_t
 #include <vector>     // for std::vector
 #include <string>     // for std::string
-#include <functional> // for std::function
+#include <concepts>   // for std::invocable
+#include <type_traits> // for std::is_same_v
+#include "outputsink.h"
 
 /**
  * A table class for easily display column-aligned data.
  * 
  * This class allows storing rows of string data and displaying them in a
  * formatted table with proper column alignment.
+ *
+ * The text of all the cells is stored back to back in a single buffer (the
+ * arena), so adding a row costs no allocation per cell. For very long
+ * listings the table can be streamed with `set_streaming()`: rows are
+ * printed as soon as a window of `lookahead` rows is complete, using the
+ * widths of the rows seen so far, and then discarded. Columns never shrink,
+ * but they may grow from one window to the next; a lookahead of 0 keeps
+ * every row until `flush()`, which gives the exact alignment.
+ *
+ * Colors are given per column with `set_styles()`: the prefix, the padded
+ * text and the suffix of each cell are written straight to the output
+ * buffer, so printing a colored table does not allocate per cell. Cells
+ * that need more than a fixed prefix/suffix can be written by a custom
+ * callable registered with `set_painter()`.
  * 
  * Example usage:
  * @code{cpp}
@@ -55,7 +72,33 @@ public:
     using Width        = int;
     using Widths       = std::vector<Width>;
     using Alignments   = std::vector<Align>;
-    using Colorizer    = std::function<std::string(int column, const std::string& text)>;
+    using Offset       = std::uint64_t; ///< a position in the arena, which can pass 4 GiB on huge listings
+
+    /// The escape codes written around every cell of a column.
+    struct Style {
+        std::string prefix; ///< written before the padded text (e.g. a color)
+        std::string suffix; ///< written after the padded text (e.g. the reset code)
+    };
+    using Styles = std::vector<Style>;
+
+    /// A non-owning reference to a callable that writes the text of a cell,
+    /// `void(OutputSink& out, size_t column, std::string_view text)`.
+    class Painter {
+    public:
+        Painter() = default;
+        template <typename Function>
+            requires (!std::is_same_v<std::remove_cv_t<Function>, Painter> && std::invocable<Function&, OutputSink&, size_t, std::string_view>)
+        Painter(Function& function) noexcept
+        : _object{ &function }
+        , _call{ [](void* object, OutputSink& out, size_t column, std::string_view text) {
+              (*static_cast<Function*>(object))(out, column, text); } }
+        { }
+        void operator()(OutputSink& out, size_t column, std::string_view text) const { _call(_object, out, column, text); }
+        explicit operator bool() const noexcept { return _call != nullptr; }
+    private:
+        void* _object = nullptr;
+        void (*_call)(void*, OutputSink&, size_t, std::string_view) = nullptr;
+    };
 
 // CONSTRUCTION/DESTRUCTION
 public:
@@ -82,7 +125,9 @@ public:
     void set_alignments(const std::initializer_list<Align>& alignments);
     void set_min_widths(const std::initializer_list<Width>& minWidths);
     void set_max_widths(const std::initializer_list<Width>& maxWidths);
-    void set_colorizer(const Colorizer& colorizer);  
+    void set_styles(const std::initializer_list<Style>& styles);
+    void set_painter(Painter painter);
+    void set_streaming(OutputSink& out, size_t lookahead);
 
 // MODIFIERS
 public:
@@ -93,19 +138,30 @@ public:
 
 // OUTPUT
 public:
-    void print(std::ostream& out = std::cout) const;
+    void print(OutputSink& out = OutputSink::standard_output()) const;
+    void print(std::ostream& out) const;
+    void flush();
 
 // IMPLEMENTATION
 private:
-    void   _print_row(std::ostream& out, const Row& row, const Widths& columnWidths, const Alignments& columnAlignments) const;
-    Widths _calculate_column_widths(const Rows& rows) const;
+    std::string_view _cell(size_t index) const noexcept;
+    void   _append_cell(std::string_view text);
+    void   _end_row(size_t numberOfCells);
+    void   _print_row(OutputSink& out, size_t row, const Widths& columnWidths) const;
+    Widths _calculate_column_widths(Widths widths) const;
 private:
-    Rows       _rows;
+    std::string         _arena;          ///< text of every cell, back to back
+    std::vector<Offset> _cellEnds;       ///< end of each cell in `_arena`
+    std::vector<Offset> _rowEnds;        ///< end of each row in `_cellEnds`
     size_t     _numberOfColumns = 0;
     Alignments _columnAlignments;
     Widths     _minColumnWidths;
     Widths     _maxColumnWidths;
-    Colorizer  _colorizer; 
+    Styles     _columnStyles;
+    Painter    _painter;                 ///< writes the text of the cells (the callable must outlive the table)
+    OutputSink* _stream    = nullptr;    ///< where rows are streamed to (nullptr = not streaming)
+    size_t      _lookahead = 0;          ///< rows kept to compute the widths before streaming them
+    Widths      _streamedWidths;         ///< widths used by the rows already streamed
 };
 
 
@@ -0,0 +1,637 @@
+/*
+| File    : catalog.cpp
+| Purpose : The on-disk catalog of the tensors of a library of checkpoints.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 17, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm>   // for std::sort, std::stable_sort, std::min
+#include <cstring>     // for std::memcpy
+#include <filesystem>  // for std::filesystem::rename, std::filesystem::directory_iterator
+#include <numeric>     // for std::iota
+#include "file.h"      // for File
+#include "catalog.h"
+#ifndef _WIN32
+#include <fcntl.h>     // for ::open
+#include <sys/mman.h>  // for ::mmap, ::munmap
+#include <sys/stat.h>  // for ::fstat
+#include <unistd.h>    // for ::close
+#endif
+namespace fs = std::filesystem;
+
+static std::uint64_t
+_hash(StringView text) noexcept {
+    std::uint64_t hash = 0xCBF29CE484222325;
+    for( const char ch : text ) { hash = (hash ^ static_cast<unsigned char>(ch)) * 0x100000001B3; }
+    return hash;
+}
+
+static std::uint64_t
+_mix(std::uint64_t value) noexcept {
+    value ^= value >> 30; value *= 0xBF58476D1CE4E5B9;
+    value ^= value >> 27; value *= 0x94D049BB133111EB;
+    return value ^ (value >> 31);
+}
+
+/**
+ * Writes the sections of a catalog one after the other, through a buffer.
+ */
+class SectionWriter
+{
+public:
+    explicit SectionWriter(File& file) : _file{file} { _buffer.reserve(BufferSize); }
+
+    bool append(const void* data, std::uint64_t size) {
+        const char* bytes = static_cast<const char*>(data);
+        while( size > 0 ) {
+            const auto chunk = std::min<std::uint64_t>(size, BufferSize - _buffer.size());
+            _buffer.insert(_buffer.end(), bytes, bytes + chunk);
+            bytes += chunk; size -= chunk;
+            if( _buffer.size() == BufferSize && !flush() ) { return false; }
+        }
+        return true;
+    }
+    template <typename T>
+    bool append(const std::vector<T>& items) { return append(items.data(), items.size() * sizeof(T)); }
+
+    /// Pads with zeros up to the next multiple of 8 and returns the offset.
+    std::uint64_t align() {
+        static const char Zeros[8] = {};
+        (void)append(Zeros, (8 - offset() % 8) % 8);
+        return offset();
+    }
+    bool flush() {
+        if( !_buffer.empty() && !_file.write_at(_buffer.data(), _buffer.size(), _flushed) ) { return false; }
+        _flushed += _buffer.size();
+        _buffer.clear();
+        return true;
+    }
+    [[nodiscard]] std::uint64_t offset() const noexcept { return _flushed + _buffer.size(); }
+
+private:
+    static constexpr std::uint64_t BufferSize = 1024 * 1024;
+    File&             _file;
+    std::vector<char> _buffer;
+    std::uint64_t     _flushed = 0;
+};
+
+/**
+ * Writes a string table with the strings of `pool` in the given order.
+ */
+static void
+_write_strings(SectionWriter& writer, const std::deque<String>& pool, const std::vector<std::uint32_t>& order) {
+    std::vector<std::uint64_t> offsets;
+    offsets.reserve(order.size() + 2);
+    offsets.push_back(order.size());
+    offsets.push_back(0);
+    for( const auto id : order ) { offsets.push_back( offsets.back() + pool[id].size() ); }
+    writer.append(offsets);
+    for( const auto id : order ) { writer.append(pool[id].data(), pool[id].size()); }
+}
+
+/**
+ * Writes the posting lists of `count` strings from pairs (string, entry),
+ * which are grouped by string with a counting sort, keeping their order.
+ */
+static void
+_write_postings(SectionWriter& writer, size_t count, const std::vector<std::uint32_t>& keys, const std::vector<std::uint32_t>& values) {
+    std::vector<std::uint64_t> first(count + 1, 0);
+    for( const auto key : keys ) { ++first[key + 1]; }
+    for( size_t i=0 ; i<count ; ++i ) { first[i+1] += first[i]; }
+    std::vector<std::uint32_t> entries(keys.size());
+    std::vector<std::uint64_t> next{ first.begin(), first.end() - 1 };
+    for( size_t i=0 ; i<keys.size() ; ++i ) { entries[ next[keys[i]]++ ] = values[i]; }
+    writer.append(first);
+    writer.append(entries);
+}
+
+//============================= CONSTRUCTION ==============================//
+
+Catalog::~Catalog() {
+    close();
+}
+
+/**
+ * Maps a catalog file in memory and validates it.
+ *
+ * Every offset of the string tables and posting lists is checked to be
+ * increasing and inside its section, and every id stored in the records
+ * and postings to be below the count of its table, so a truncated or
+ * corrupt catalog is refused here and the accessors never check bounds.
+ *
+ * @param path  The catalog file.
+ * @param error Set to a description of the problem if the catalog can't be opened.
+ * @return `true` on success.
+ */
+bool
+Catalog::open(const String& path, String& error) {
+    close();
+#ifdef _WIN32
+    ::File file;
+    if( !file.open_read(path) ) { error = "Unable to open the catalog '" + path + "'."; return false; }
+    _buffer.resize(file.size());
+    if( !file.read_at(_buffer.data(), _buffer.size(), 0) ) { error = "Unable to read the catalog '" + path + "'."; return false; }
+    _data = _buffer.data();
+    _size = _buffer.size();
+#else
+    const int handle = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if( handle < 0 ) { error = "Unable to open the catalog '" + path + "'."; return false; }
+    struct stat status;
+    void* data = MAP_FAILED;
+    if( ::fstat(handle, &status) == 0 && status.st_size > 0 ) {
+        data = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, handle, 0);
+    }
+    ::close(handle);
+    if( data == MAP_FAILED ) { error = "Unable to map the catalog '" + path + "' in memory."; return false; }
+    _data = static_cast<const char*>(data);
+    _size = static_cast<std::uint64_t>(status.st_size);
+#endif
+
+    Header header;
+    bool valid = _size >= sizeof(header);
+    if( valid ) {
+        std::memcpy(&header, _data, sizeof(header));
+        valid = StringView{header.magic, sizeof(header.magic)} == Magic && header.version == Version;
+    }
+    for( int section = 0 ; valid && section < SECTION_COUNT ; ++section ) {
+        valid = header.sections[section] % 8 == 0 && header.sections[section] <= _size &&
+                header.sections[section] >= (section == 0 ? sizeof(header) : header.sections[section-1]);
+    }
+    const auto end_of = [&](int section) { return section + 1 < SECTION_COUNT ? header.sections[section + 1] : _size; };
+    valid = valid && _map_table(PATHS,  header.sections[PATHS],  end_of(PATHS),  false, 0)
+                  && _map_table(NAMES,  header.sections[NAMES],  end_of(NAMES),  false, 0)
+                  && _map_table(DTYPES, header.sections[DTYPES], end_of(DTYPES), false, 0)
+                  && _map_table(SHAPES, header.sections[SHAPES], end_of(SHAPES), false, 0);
+    if( valid ) {
+        const std::uint64_t files      = _tables[PATHS].count;
+        const std::uint64_t maxTensors = (header.sections[NAME_POSTINGS] - header.sections[TENSORS]) / sizeof(TensorRecord);
+        _files   = reinterpret_cast<const FileRecord*>(_data + header.sections[FILES]);
+        _tensors = reinterpret_cast<const TensorRecord*>(_data + header.sections[TENSORS]);
+        valid = files <= (header.sections[TENSORS] - header.sections[FILES]) / sizeof(FileRecord);
+        if( valid && files > 0 ) {
+            const auto& last = _files[files-1];
+            valid = last.firstTensor <= maxTensors && last.tensorCount <= maxTensors - last.firstTensor;
+            _tensorCount = valid ? last.firstTensor + last.tensorCount : 0;
+        }
+        valid = valid && _map_table(NAME_POSTINGS,  header.sections[NAME_POSTINGS],  end_of(NAME_POSTINGS),  true, _tables[NAMES].count)
+                      && _map_table(DTYPE_POSTINGS, header.sections[DTYPE_POSTINGS], end_of(DTYPE_POSTINGS), true, _tables[DTYPES].count)
+                      && _map_table(SHAPE_POSTINGS, header.sections[SHAPE_POSTINGS], end_of(SHAPE_POSTINGS), true, _tables[SHAPES].count)
+                      && _check_records();
+    }
+    if( !valid ) {
+        close();
+        error = "The file '" + path + "' is not a valid catalog (or was written by another version of ckindex).";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Unmaps the catalog. Views returned before become invalid.
+ */
+void
+Catalog::close() noexcept {
+#ifndef _WIN32
+    if( _data && _buffer.empty() ) { ::munmap(const_cast<char*>(_data), _size); }
+#endif
+    _buffer.clear();
+    _data = nullptr;
+    _size = 0;
+    for( auto& table : _tables ) { table = {}; }
+    _files       = nullptr;
+    _tensors     = nullptr;
+    _tensorCount = 0;
+}
+
+//================================ RECORDS ================================//
+
+/**
+ * Returns the tensors of a file, in the order of the file.
+ */
+std::span<const Catalog::TensorRecord>
+Catalog::tensors_of(std::uint32_t file) const noexcept {
+    const auto& record = _files[file];
+    const auto  first  = std::min(record.firstTensor, _tensorCount);
+    return { _tensors + first, std::min<std::uint64_t>(record.tensorCount, _tensorCount - first) };
+}
+
+//================================ SEARCH =================================//
+
+/**
+ * Returns the range [first, last) of the names that start with `prefix`.
+ */
+std::pair<std::uint32_t, std::uint32_t>
+Catalog::names_with_prefix(StringView prefix) const noexcept {
+    // the names with the prefix follow the first one, so the end is the
+    // first name after it that doesn't start with the prefix
+    const std::uint32_t first = _lower_bound(NAMES, prefix);
+    std::uint32_t low = first, high = _count(NAMES);
+    while( low < high ) {
+        const std::uint32_t middle = low + (high - low) / 2;
+        if( _string(NAMES, middle).starts_with(prefix) ) { low = middle + 1; }
+        else                                              { high = middle;    }
+    }
+    return { first, low };
+}
+
+//============================ IMPLEMENTATION =============================//
+
+/**
+ * Maps the string table or posting lists that start at `offset` and checks
+ * that its offsets are increasing and that the data ends before `end`.
+ * (a string table stores its count, the posting lists have one per string)
+ */
+bool
+Catalog::_map_table(Section section, std::uint64_t offset, std::uint64_t end, bool isPostings, std::uint64_t count) {
+    if( !isPostings ) {
+        if( end - offset < 8 ) { return false; }
+        std::memcpy(&count, _data + offset, 8);
+        offset += 8;
+    }
+    if( count >= None || count >= (end - offset) / 8 ) { return false; }
+    auto& table   = _tables[section];
+    table.count   = count;
+    table.offsets = reinterpret_cast<const std::uint64_t*>(_data + offset);
+    table.bytes   = _data + offset + (count + 1) * 8;
+    const std::uint64_t unit = isPostings ? sizeof(std::uint32_t) : 1;
+    const std::uint64_t room = static_cast<std::uint64_t>(_data + end - table.bytes);
+    if( table.offsets[0] != 0 || table.offsets[count] > room / unit ) { return false; }
+    for( std::uint64_t i=0 ; i<count ; ++i ) {
+        if( table.offsets[i] > table.offsets[i+1] ) { return false; }
+    }
+    return true;
+}
+
+/**
+ * Checks that every file, tensor and posting entry refers to existing records.
+ */
+bool
+Catalog::_check_records() const noexcept {
+    const std::uint64_t files = _tables[PATHS].count;
+    for( std::uint64_t file=0 ; file<files ; ++file ) {
+        const auto& record = _files[file];
+        if( record.firstTensor > _tensorCount || record.tensorCount > _tensorCount - record.firstTensor ) { return false; }
+    }
+    for( std::uint64_t tensor=0 ; tensor<_tensorCount ; ++tensor ) {
+        const auto& record = _tensors[tensor];
+        if( record.name  >= _tables[NAMES].count  || record.dtype >= _tables[DTYPES].count ||
+            record.shape >= _tables[SHAPES].count || record.file  >= files )
+        {
+            return false;
+        }
+    }
+    // the names list tensors, the dtypes and shapes list files
+    const auto check_entries = [this](Section section, std::uint64_t limit) {
+        const auto& table   = _tables[section];
+        const auto* entries = reinterpret_cast<const std::uint32_t*>(table.bytes);
+        for( std::uint64_t i=0 ; i<table.offsets[table.count] ; ++i ) {
+            if( entries[i] >= limit ) { return false; }
+        }
+        return true;
+    };
+    return check_entries(NAME_POSTINGS, _tensorCount) && check_entries(DTYPE_POSTINGS, files) &&
+           check_entries(SHAPE_POSTINGS, files);
+}
+
+StringView
+Catalog::_string(Section section, std::uint32_t index) const noexcept {
+    const auto& table = _tables[section];
+    const auto  end   = table.offsets[index + 1];
+    const auto  begin = std::min(table.offsets[index], end);
+    return { table.bytes + begin, static_cast<size_t>(end - begin) };
+}
+
+/**
+ * Returns the index of the first string of a table that is not less than `text`.
+ */
+std::uint32_t
+Catalog::_lower_bound(Section section, StringView text) const noexcept {
+    std::uint32_t low = 0, high = _count(section);
+    while( low < high ) {
+        const std::uint32_t middle = low + (high - low) / 2;
+        if( _string(section, middle) < text ) { low = middle + 1; }
+        else                                  { high = middle;    }
+    }
+    return low;
+}
+
+/**
+ * Returns the index of `text` in a string table, or `None` if it isn't there.
+ */
+std::uint32_t
+Catalog::_find(Section section, StringView text) const noexcept {
+    const auto index = _lower_bound(section, text);
+    return index < _count(section) && _string(section, index) == text ? index : None;
+}
+
+std::span<const std::uint32_t>
+Catalog::_postings(Section section, std::uint32_t index) const noexcept {
+    const auto& table   = _tables[section];
+    const auto* entries = reinterpret_cast<const std::uint32_t*>(table.bytes);
+    const auto  end     = table.offsets[index + 1];
+    const auto  begin   = std::min(table.offsets[index], end);
+    return { entries + begin, static_cast<size_t>(end - begin) };
+}
+
+
+//=========================================================================//
+//                             CATALOG BUILDER                             //
+//=========================================================================//
+
+std::uint32_t
+CatalogBuilder::Pool::intern(StringView text) {
+    const auto it = ids.find(text);
+    if( it != ids.end() ) { return it->second; }
+    const auto id = static_cast<std::uint32_t>(strings.size());
+    ids.emplace(strings.emplace_back(text), id);
+    return id;
+}
+
+/**
+ * Adds a file to the catalog; its tensors are added with `add_tensor()`.
+ *
+ * @param path   The path of the file, as it will be stored.
+ * @param record Its identity (device, inode, size, mtime), flags and
+ *               content hash; the tensor fields are filled by the builder.
+ */
+CatalogBuilder::File&
+CatalogBuilder::add_file(String path, const Catalog::FileRecord& record) {
+    auto& file = _files.emplace_back();
+    file.path   = std::move(path);
+    file.record = record;
+    file.record.structuralHash = 0;
+    file.record.firstTensor    = 0;
+    file.record.tensorCount    = 0;
+    return file;
+}
+
+/**
+ * Adds a tensor to a file.
+ *
+ * The structural hash of the file is the sum of a hash of each tensor, so
+ * it doesn't depend on the order of the tensors in the file.
+ *
+ * @param shape The row-major dimensions as JSON, e.g. "[4096,4096]".
+ */
+void
+CatalogBuilder::add_tensor(File& file, StringView name, StringView dtype, StringView shape) {
+    file.tensors.push_back( _names.intern(name)   );
+    file.tensors.push_back( _dtypes.intern(dtype) );
+    file.tensors.push_back( _shapes.intern(shape) );
+    file.record.structuralHash += _mix( _hash(name) ^ _mix(_hash(dtype) + _hash(shape)) );
+    ++file.record.tensorCount;
+}
+
+/**
+ * Adds a file exactly as it is in another catalog, without reading it.
+ *
+ * The strings of the catalog are interned once, the first time a file
+ * uses them, so copying the files of a catalog costs about the same as
+ * copying its records.
+ */
+void
+CatalogBuilder::copy_file(const Catalog& catalog, std::uint32_t index) {
+    auto [it, isNew] = _copied.try_emplace(&catalog);
+    auto& copied = it->second;
+    if( isNew ) {
+        copied.names .assign(catalog.name_count(),  Catalog::None);
+        copied.dtypes.assign(catalog.dtype_count(), Catalog::None);
+        copied.shapes.assign(catalog.shape_count(), Catalog::None);
+    }
+    using Getter = StringView (Catalog::*)(std::uint32_t) const noexcept;
+    auto intern = [&](Pool& pool, std::vector<std::uint32_t>& ids, std::uint32_t id, Getter text) {
+        if( id >= ids.size() ) { return pool.intern({}); }
+        if( ids[id] == Catalog::None ) { ids[id] = pool.intern( (catalog.*text)(id) ); }
+        return ids[id];
+    };
+    auto& file = _files.emplace_back();
+    file.path   = String{ catalog.path(index) };
+    file.record = catalog.file(index);
+    const auto tensors = catalog.tensors_of(index);
+    file.record.tensorCount = static_cast<std::uint32_t>(tensors.size());
+    file.tensors.reserve(3 * tensors.size());
+    for( const auto& tensor : tensors ) {
+        file.tensors.push_back( intern(_names,  copied.names,  tensor.name,  &Catalog::name)  );
+        file.tensors.push_back( intern(_dtypes, copied.dtypes, tensor.dtype, &Catalog::dtype) );
+        file.tensors.push_back( intern(_shapes, copied.shapes, tensor.shape, &Catalog::shape) );
+    }
+}
+
+/**
+ * Writes the catalog to a temporary file and renames it over `path`.
+ *
+ * Files added twice with the same path keep the last one.
+ *
+ * @return `true` on success, otherwise `error` describes the problem.
+ */
+bool
+CatalogBuilder::write(const String& path, String& error) {
+    using TensorRecord = Catalog::TensorRecord;
+
+    // the strings in byte order, and the new id of each interned id
+    auto sort_pool = [](const Pool& pool, std::vector<std::uint32_t>& order, std::vector<std::uint32_t>& remap) {
+        order.resize(pool.strings.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](auto a, auto b) { return pool.strings[a] < pool.strings[b]; });
+        remap.resize(order.size());
+        for( std::uint32_t i=0 ; i<order.size() ; ++i ) { remap[order[i]] = i; }
+    };
+    std::vector<std::uint32_t> nameOrder, dtypeOrder, shapeOrder, nameIds, dtypeIds, shapeIds;
+    sort_pool(_names,  nameOrder,  nameIds);
+    sort_pool(_dtypes, dtypeOrder, dtypeIds);
+    sort_pool(_shapes, shapeOrder, shapeIds);
+
+    // the files in path order, the last one of each path
+    std::vector<std::uint32_t> files(_files.size());
+    std::iota(files.begin(), files.end(), 0);
+    std::stable_sort(files.begin(), files.end(), [&](auto a, auto b) { return _files[a].path < _files[b].path; });
+    std::vector<std::uint32_t> unique;
+    for( size_t i=0 ; i<files.size() ; ++i ) {
+        if( i+1 < files.size() && _files[files[i]].path == _files[files[i+1]].path ) { continue; }
+        unique.push_back(files[i]);
+    }
+
+    // records and the pairs of the posting lists
+    std::vector<Catalog::FileRecord> fileRecords;
+    std::vector<TensorRecord>        tensorRecords;
+    std::vector<std::uint32_t>       dtypeKeys, dtypeFiles, shapeKeys, shapeFiles;
+    std::vector<std::uint32_t>       lastDtypeFile(dtypeOrder.size(), Catalog::None);
+    std::vector<std::uint32_t>       lastShapeFile(shapeOrder.size(), Catalog::None);
+    fileRecords.reserve(unique.size());
+    for( std::uint32_t f=0 ; f<unique.size() ; ++f ) {
+        const auto& file = _files[unique[f]];
+        auto& record = fileRecords.emplace_back(file.record);
+        record.firstTensor = tensorRecords.size();
+        record.tensorCount = static_cast<std::uint32_t>(file.tensors.size() / 3);
+        for( size_t t=0 ; t<file.tensors.size() ; t+=3 ) {
+            const TensorRecord tensor{ nameIds[file.tensors[t]], dtypeIds[file.tensors[t+1]], shapeIds[file.tensors[t+2]], f };
+            tensorRecords.push_back(tensor);
+            if( lastDtypeFile[tensor.dtype] != f ) { lastDtypeFile[tensor.dtype] = f; dtypeKeys.push_back(tensor.dtype); dtypeFiles.push_back(f); }
+            if( lastShapeFile[tensor.shape] != f ) { lastShapeFile[tensor.shape] = f; shapeKeys.push_back(tensor.shape); shapeFiles.push_back(f); }
+        }
+    }
+    std::vector<std::uint32_t> nameKeys(tensorRecords.size()), tensorIndices(tensorRecords.size());
+    for( std::uint32_t t=0 ; t<tensorRecords.size() ; ++t ) { nameKeys[t] = tensorRecords[t].name; tensorIndices[t] = t; }
+
+    // the sections, then the header that points to them
+    const String partPath = path + ".part";
+    ::File output;
+    if( !output.create(partPath) ) { error = "Unable to create the file '" + partPath + "'."; return false; }
+    Catalog::Header header{};
+    std::memcpy(header.magic, Catalog::Magic.data(), sizeof(header.magic));
+    header.version = Catalog::Version;
+
+    std::deque<String> paths;
+    std::vector<std::uint32_t> pathOrder(unique.size());
+    for( std::uint32_t f=0 ; f<unique.size() ; ++f ) { paths.push_back(_files[unique[f]].path); pathOrder[f] = f; }
+
+    SectionWriter writer{ output };
+    writer.append(&header, sizeof(header));
+    header.sections[Catalog::PATHS]  = writer.align(); _write_strings(writer, paths,           pathOrder);
+    header.sections[Catalog::NAMES]  = writer.align(); _write_strings(writer, _names.strings,  nameOrder);
+    header.sections[Catalog::DTYPES] = writer.align(); _write_strings(writer, _dtypes.strings, dtypeOrder);
+    header.sections[Catalog::SHAPES] = writer.align(); _write_strings(writer, _shapes.strings, shapeOrder);
+    header.sections[Catalog::FILES]   = writer.align(); writer.append(fileRecords);
+    header.sections[Catalog::TENSORS] = writer.align(); writer.append(tensorRecords);
+    header.sections[Catalog::NAME_POSTINGS]  = writer.align(); _write_postings(writer, nameOrder.size(),  nameKeys,  tensorIndices);
+    header.sections[Catalog::DTYPE_POSTINGS] = writer.align(); _write_postings(writer, dtypeOrder.size(), dtypeKeys, dtypeFiles);
+    header.sections[Catalog::SHAPE_POSTINGS] = writer.align(); _write_postings(writer, shapeOrder.size(), shapeKeys, shapeFiles);
+    writer.align();
+
+    std::error_code errorCode;
+    if( !writer.flush() || !output.write_at(&header, sizeof(header), 0) || !output.sync() ) {
+        output.close();
+        fs::remove(partPath, errorCode);
+        error = "Unable to write the file '" + partPath + "'.";
+        return false;
+    }
+    output.close();
+    fs::rename(partPath, path, errorCode);
+    if( errorCode ) { error = "Unable to rename '" + partPath + "' to '" + path + "'."; return false; }
+    return true;
+}
+
+
+//=========================================================================//
+//                               CATALOG SET                               //
+//=========================================================================//
+
+/**
+ * Returns the path of a segment of a catalog: '<catalog>.seg.<N>'.
+ */
+String
+CatalogSet::segment_path(const String& path, std::uint64_t segment) {
+    return path + ".seg." + std::to_string(segment);
+}
+
+/**
+ * Returns the numbers of the segments of a catalog, in order.
+ */
+std::vector<std::uint64_t>
+CatalogSet::list_segments(const String& path) {
+    std::vector<std::uint64_t> segments;
+    const fs::path catalog   = fs::absolute(path);
+    const String   prefix    = catalog.filename().string() + ".seg.";
+    std::error_code errorCode;
+    for( auto it = fs::directory_iterator(catalog.parent_path(), errorCode) ; !errorCode && it != fs::directory_iterator() ; it.increment(errorCode) ) {
+        const String name = it->path().filename().string();
+        if( !name.starts_with(prefix) || name.size() == prefix.size() ) { continue; }
+        std::uint64_t number = 0;
+        bool isNumber = true;
+        for( size_t i = prefix.size() ; i < name.size() && isNumber ; ++i ) {
+            isNumber = name[i] >= '0' && name[i] <= '9';
+            number   = number * 10 + static_cast<std::uint64_t>(name[i] - '0');
+        }
+        if( isNumber ) { segments.push_back(number); }
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+/**
+ * Opens a catalog and its segments.
+ *
+ * @param path        The catalog file.
+ * @param error       Set to a description of the problem if it can't be opened.
+ * @param lastSegment Newer segments are ignored.
+ * @return `true` on success.
+ */
+bool
+CatalogSet::open(const String& path, String& error, std::uint64_t lastSegment) {
+    static const int MaxAttempts = 8;
+    for( int attempt = 0 ; attempt < MaxAttempts ; ++attempt ) {
+        // the segments are listed before the catalog is opened: a compaction
+        // renames its new catalog first and deletes the merged segments
+        // after, so a catalog opened later never misses a listed segment,
+        // and a listed segment deleted meanwhile is noticed below
+        const auto segments = list_segments(path);
+        close();
+        _layers.push_back( std::make_unique<Catalog>() );
+        if( !_layers.back()->open(path, error) ) { close(); return false; }
+
+        bool isComplete = true;
+        for( const auto segment : segments ) {
+            if( segment > lastSegment ) { break; }
+            auto layer = std::make_unique<Catalog>();
+            String segmentError;
+            if( !layer->open(segment_path(path, segment), segmentError) ) {
+                // a compaction deleted it after merging it into a new catalog
+                std::error_code errorCode;
+                if( !fs::exists(segment_path(path, segment), errorCode) ) { isComplete = false; break; }
+                close();
+                error = segmentError;
+                return false;
+            }
+            _layers.push_back( std::move(layer) );
+            _segments.push_back(segment);
+        }
+        if( isComplete ) { return true; }
+    }
+    close();
+    error = "The segments of the catalog '" + path + "' keep changing while it is opened.";
+    return false;
+}
+
+void
+CatalogSet::close() noexcept {
+    _layers.clear();
+    _segments.clear();
+}
+
+/**
+ * Returns whether a file of a layer is the current version of its path,
+ * not replaced by a newer layer nor removed.
+ */
+bool
+CatalogSet::is_live(size_t layer, std::uint32_t file) const noexcept {
+    const auto& catalog = *_layers[layer];
+    if( catalog.file(file).flags & Catalog::FileRecord::REMOVED ) { return false; }
+    if( layer + 1 == _layers.size() ) { return true; }
+    const auto path = catalog.path(file);
+    for( size_t newer = layer + 1 ; newer < _layers.size() ; ++newer ) {
+        if( _layers[newer]->find_path(path) != Catalog::None ) { return false; }
+    }
+    return true;
+}
+
+/**
+ * Finds the current version of a path.
+ *
+ * @return `false` if the path is not in the set, or was removed.
+ */
+bool
+CatalogSet::find(StringView path, size_t& layer, std::uint32_t& file) const noexcept {
+    for( size_t i = _layers.size() ; i-- > 0 ; ) {
+        const auto index = _layers[i]->find_path(path);
+        if( index == Catalog::None ) { continue; }
+        if( _layers[i]->file(index).flags & Catalog::FileRecord::REMOVED ) { return false; }
+        layer = i;
+        file  = index;
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,267 @@
+/*
+| File    : catalog.h
+| Purpose : The on-disk catalog of the tensors of a library of checkpoints.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 17, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CATALOG_H_
+#define CATALOG_H_
+#include <cstdint>        // for std::uint32_t, std::uint64_t
+#include <deque>          // for std::deque
+#include <memory>         // for std::unique_ptr
+#include <span>           // for std::span
+#include <unordered_map>  // for std::unordered_map
+#include <utility>        // for std::pair
+#include <vector>         // for std::vector
+#include "common.h"
+
+
+/*
+  Layout of a catalog file (little-endian, every section aligned to 8 bytes):
+
+    [Header]
+    [String table: paths ] [String table: names ] [String table: dtypes] [String table: shapes]
+    [FileRecord   x files  ]
+    [TensorRecord x tensors]    grouped by file, in file order
+    [Postings: names ]          tensors with each name
+    [Postings: dtypes]          files with a tensor of each dtype
+    [Postings: shapes]          files with a tensor of each shape
+
+  String table : u64 count, u64 offsets[count+1], the bytes of the strings
+                 (sorted in byte order, so they are searched in place)
+  Postings     : u64 first[count+1], u32 entries[], the entries of the
+                 string `i` are [first[i], first[i+1])
+*/
+
+/**
+ * A read-only view of a catalog file, mapped in memory.
+ *
+ * Nothing is parsed when the catalog is opened, only validated in one pass
+ * over its offsets and records: the sorted string tables are searched with
+ * a binary search and the posting lists are read in place, so a library of
+ * thousands of checkpoints answers in milliseconds. Files are numbered in
+ * the order of their paths, and names, dtypes and shapes in byte order.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * Catalog catalog;
+ * String  error;
+ * if( !catalog.open("models.ckindex", error) ) { std::cerr << error; }
+ * const auto name = catalog.find_name("lm_head.weight");
+ * for( auto tensor : catalog.tensors_named(name) ) {
+ *     std::cout << catalog.path( catalog.tensor(tensor).file ) << std::endl;
+ * }
+ * @endcode
+ */
+class Catalog
+{
+public:
+    static constexpr StringView    Magic   = "CKINDEX1";
+    static constexpr std::uint32_t Version = 1;
+    static constexpr std::uint32_t None    = 0xFFFFFFFF;
+
+    enum Section { PATHS, NAMES, DTYPES, SHAPES, FILES, TENSORS, NAME_POSTINGS, DTYPE_POSTINGS, SHAPE_POSTINGS, SECTION_COUNT };
+    struct Header {
+        char          magic[8];
+        std::uint32_t version;
+        std::uint32_t reserved;
+        std::uint64_t sections[SECTION_COUNT]; ///< offset of each section
+    };
+    struct FileRecord {
+        enum Flags : std::uint32_t { GGUF = 1, CONTENT_HASH = 2, REMOVED = 4 };
+        std::uint64_t device;
+        std::uint64_t inode;
+        std::uint64_t size;
+        std::int64_t  mtime;           ///< nanoseconds since the epoch
+        std::uint64_t structuralHash;  ///< names, dtypes and shapes, in any order
+        std::uint64_t contentHash;     ///< the data section (only with CONTENT_HASH)
+        std::uint64_t firstTensor;
+        std::uint32_t tensorCount;
+        std::uint32_t flags;
+    };
+    struct TensorRecord {
+        std::uint32_t name;
+        std::uint32_t dtype;
+        std::uint32_t shape;
+        std::uint32_t file;
+    };
+
+// CONSTRUCTION/DESTRUCTION
+public:
+    Catalog() = default;
+    Catalog(const Catalog&) = delete;
+    Catalog& operator=(const Catalog&) = delete;
+    ~Catalog();
+    bool open(const String& path, String& error);
+    void close() noexcept;
+
+// ATTRIBUTES
+public:
+    [[nodiscard]] bool          is_open()      const noexcept { return _data != nullptr; }
+    [[nodiscard]] std::uint32_t file_count()   const noexcept { return _count(PATHS);  }
+    [[nodiscard]] std::uint32_t name_count()   const noexcept { return _count(NAMES);  }
+    [[nodiscard]] std::uint32_t dtype_count()  const noexcept { return _count(DTYPES); }
+    [[nodiscard]] std::uint32_t shape_count()  const noexcept { return _count(SHAPES); }
+    [[nodiscard]] std::uint64_t tensor_count() const noexcept { return _tensorCount; }
+    [[nodiscard]] std::uint64_t size()         const noexcept { return _size; }
+
+// RECORDS
+public:
+    [[nodiscard]] StringView path (std::uint32_t file)  const noexcept { return _string(PATHS,  file);  }
+    [[nodiscard]] StringView name (std::uint32_t name)  const noexcept { return _string(NAMES,  name);  }
+    [[nodiscard]] StringView dtype(std::uint32_t dtype) const noexcept { return _string(DTYPES, dtype); }
+    [[nodiscard]] StringView shape(std::uint32_t shape) const noexcept { return _string(SHAPES, shape); }
+    [[nodiscard]] const FileRecord&   file  (std::uint32_t file)   const noexcept { return _files[file];     }
+    [[nodiscard]] const TensorRecord& tensor(std::uint64_t tensor) const noexcept { return _tensors[tensor]; }
+    [[nodiscard]] std::span<const TensorRecord> tensors_of(std::uint32_t file) const noexcept;
+
+// SEARCH
+public:
+    [[nodiscard]] std::uint32_t find_path (StringView path)  const noexcept { return _find(PATHS,  path);  }
+    [[nodiscard]] std::uint32_t find_name (StringView name)  const noexcept { return _find(NAMES,  name);  }
+    [[nodiscard]] std::uint32_t find_dtype(StringView dtype) const noexcept { return _find(DTYPES, dtype); }
+    [[nodiscard]] std::uint32_t find_shape(StringView shape) const noexcept { return _find(SHAPES, shape); }
+    [[nodiscard]] std::pair<std::uint32_t, std::uint32_t> names_with_prefix(StringView prefix) const noexcept;
+    [[nodiscard]] std::span<const std::uint32_t> tensors_named     (std::uint32_t name)  const noexcept { return _postings(NAME_POSTINGS,  name);  }
+    [[nodiscard]] std::span<const std::uint32_t> files_with_dtype  (std::uint32_t dtype) const noexcept { return _postings(DTYPE_POSTINGS, dtype); }
+    [[nodiscard]] std::span<const std::uint32_t> files_with_shape  (std::uint32_t shape) const noexcept { return _postings(SHAPE_POSTINGS, shape); }
+
+// IMPLEMENTATION
+private:
+    struct Table {
+        std::uint64_t        count   = 0;
+        const std::uint64_t* offsets = nullptr;  ///< `count + 1` offsets
+        const char*          bytes   = nullptr;  ///< strings, or u32 entries of postings
+    };
+    [[nodiscard]] std::uint32_t _count(Section section) const noexcept { return static_cast<std::uint32_t>(_tables[section].count); }
+    [[nodiscard]] StringView    _string(Section section, std::uint32_t index) const noexcept;
+    [[nodiscard]] std::uint32_t _lower_bound(Section section, StringView text) const noexcept;
+    [[nodiscard]] std::uint32_t _find(Section section, StringView text) const noexcept;
+    [[nodiscard]] std::span<const std::uint32_t> _postings(Section section, std::uint32_t index) const noexcept;
+    bool _map_table(Section section, std::uint64_t offset, std::uint64_t end, bool isPostings, std::uint64_t count);
+    [[nodiscard]] bool _check_records() const noexcept;
+private:
+    const char*         _data = nullptr;
+    std::uint64_t       _size = 0;
+    std::vector<char>   _buffer;  ///< the content, where files can't be mapped
+    Table               _tables[SECTION_COUNT];
+    const FileRecord*   _files   = nullptr;
+    const TensorRecord* _tensors = nullptr;
+    std::uint64_t       _tensorCount = 0;
+};
+
+
+/**
+ * Collects the tensors of a set of checkpoints and writes them as a catalog.
+ *
+ * Names, dtypes and shapes are interned while the files are added, so each
+ * distinct string is kept once however many files share it, and the
+ * structural hash of each file is accumulated from its tensors. `write()`
+ * sorts the strings and the files, builds the posting lists and replaces
+ * the catalog atomically (a temporary file renamed over the old one), so a
+ * reader never sees a half-written catalog.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * CatalogBuilder builder;
+ * auto& file = builder.add_file(path, record);
+ * builder.add_tensor(file, "lm_head.weight", "BF16", "[128256,4096]");
+ * builder.write("models.ckindex", error);
+ * @endcode
+ */
+class CatalogBuilder
+{
+public:
+    struct File {
+        String                     path;
+        Catalog::FileRecord        record{};
+        std::vector<std::uint32_t> tensors;  ///< name, dtype and shape ids, three per tensor
+    };
+
+// CONSTRUCTION
+public:
+    CatalogBuilder() = default;
+
+// ADDING FILES
+public:
+    File& add_file(String path, const Catalog::FileRecord& record);
+    void  add_tensor(File& file, StringView name, StringView dtype, StringView shape);
+    void  copy_file(const Catalog& catalog, std::uint32_t file);
+
+// WRITING
+public:
+    [[nodiscard]] size_t file_count() const noexcept { return _files.size(); }
+    bool write(const String& path, String& error);
+
+// IMPLEMENTATION
+private:
+    struct Pool {
+        std::deque<String>                            strings;  ///< stable, `ids` points to them
+        std::unordered_map<StringView, std::uint32_t> ids;
+        std::uint32_t intern(StringView text);
+    };
+private:
+    std::vector<File> _files;
+    Pool              _names, _dtypes, _shapes;
+    struct Copied {
+        std::vector<std::uint32_t> names, dtypes, shapes;  ///< ids interned, by id in the catalog
+    };
+    std::unordered_map<const Catalog*, Copied> _copied;
+};
+
+
+/**
+ * A catalog with the segments that `ckindex --watch` wrote after it.
+ *
+ * A segment is a small catalog, '<catalog>.seg.<N>', with the files that
+ * changed since the previous one; a file removed from the library is a
+ * record with the REMOVED flag and no tensors. Segments are only added, the
+ * catalog (layer 0) is never written while it is watched, and the newest
+ * layer that has a path has its current version. Compacting merges the
+ * segments into a new catalog and then deletes them, so a reader that
+ * finds a segment gone while it opens the set opens it again.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * CatalogSet catalogs;
+ * if( !catalogs.open("models.ckindex", error) ) { std::cerr << error; }
+ * for( size_t layer = 0 ; layer < catalogs.size() ; ++layer ) {
+ *     for( std::uint32_t file = 0 ; file < catalogs[layer].file_count() ; ++file ) {
+ *         if( catalogs.is_live(layer, file) ) { std::cout << catalogs[layer].path(file) << std::endl; }
+ *     }
+ * }
+ * @endcode
+ */
+class CatalogSet
+{
+public:
+    static constexpr std::uint64_t AllSegments = ~std::uint64_t{0};
+
+// OPENING
+public:
+    bool open(const String& path, String& error, std::uint64_t lastSegment = AllSegments);
+    void close() noexcept;
+    [[nodiscard]] static std::vector<std::uint64_t> list_segments(const String& path);
+    [[nodiscard]] static String segment_path(const String& path, std::uint64_t segment);
+
+// LAYERS
+public:
+    [[nodiscard]] size_t         size()                   const noexcept { return _layers.size(); }
+    [[nodiscard]] const Catalog& operator[](size_t layer) const noexcept { return *_layers[layer]; }
+    [[nodiscard]] const std::vector<std::uint64_t>& segments() const noexcept { return _segments; }
+    [[nodiscard]] bool is_live(size_t layer, std::uint32_t file) const noexcept;
+    [[nodiscard]] bool find(StringView path, size_t& layer, std::uint32_t& file) const noexcept;
+
+// IMPLEMENTATION
+private:
+    std::vector<std::unique_ptr<Catalog>> _layers;    ///< the catalog, then its segments
+    std::vector<std::uint64_t>            _segments;  ///< number of each segment
+};
+
+#endif // CATALOG_H_
@@ -0,0 +1,891 @@
+/*
+| File    : ckindex.cpp
+| Purpose : The `ckindex` command line tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 17, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm>     // for std::sort, std::min
+#include <atomic>        // for std::atomic
+#include <csignal>       // for std::signal, std::sig_atomic_t
+#include <cstring>       // for std::memcpy
+#include <filesystem>    // for std::filesystem::recursive_directory_iterator
+#include <map>           // for std::map
+#include <thread>        // for std::thread
+#include "colors.h"
+#include "file.h"
+#include "gguf.h"
+#include "jsonwriter.h"
+#include "messages.h"
+#include "parallel.h"
+#include "patternset.h"
+#include "safetensors.h"
+#include "watcher.h"
+#include "ckindex.h"
+#ifdef _WIN32
+    inline bool is_terminal_output() { return true; }
+#else
+#include <sys/stat.h> // for ::stat
+#include <unistd.h>   // for "::isatty()" and STDOUT_FILENO
+    inline bool is_terminal_output() { return ::isatty(STDOUT_FILENO) != 0; }
+#endif
+namespace fs = std::filesystem;
+
+/// Files are read in batches, so only the tensors of one batch are in
+/// memory before they are interned by the builder.
+static constexpr size_t BatchSize = 256;
+
+static bool
+_is_checkpoint(const fs::path& path) {
+    const auto extension = path.extension();
+    return extension == ".safetensors" || extension == ".gguf";
+}
+
+/**
+ * Parses the row-major dimensions of a shape written as "[4096,*]", with
+ * -1 for '*'. Returns `false` if the text is not a shape.
+ */
+static bool
+_parse_shape(StringView text, std::vector<std::int64_t>& dims) {
+    dims.clear();
+    size_t i = 0;
+    auto skip_spaces = [&]() { while( i < text.size() && text[i] == ' ' ) { ++i; } };
+    skip_spaces();
+    if( i == text.size() || text[i++] != '[' ) { return false; }
+    skip_spaces();
+    if( i < text.size() && text[i] == ']' ) { ++i; skip_spaces(); return i == text.size(); }
+    while( i < text.size() ) {
+        skip_spaces();
+        if( i < text.size() && text[i] == '*' ) { dims.push_back(-1); ++i; }
+        else {
+            std::int64_t value  = 0;
+            const size_t digits = i;
+            while( i < text.size() && text[i] >= '0' && text[i] <= '9' ) { value = value * 10 + (text[i++] - '0'); }
+            if( i == digits ) { return false; }
+            dims.push_back(value);
+        }
+        skip_spaces();
+        if( i < text.size() && text[i] == ',' ) { ++i; continue; }
+        if( i < text.size() && text[i] == ']' ) { ++i; skip_spaces(); return i == text.size(); }
+        return false;
+    }
+    return false;
+}
+
+/**
+ * Returns the shape as stored in the catalog, e.g. "[4096,4096]".
+ */
+template <typename Iterator>
+static String
+_shape_text(Iterator begin, Iterator end) {
+    String text = "[";
+    for( auto it = begin ; it != end ; ++it ) {
+        if( it != begin ) { text += ','; }
+        text += std::to_string(*it);
+    }
+    return text + "]";
+}
+
+/**
+ * Hashes a block of data, eight bytes at a time on four independent lanes
+ * so the multiplications don't wait for each other.
+ */
+static void
+_hash_block(std::uint64_t lanes[4], const char* data, size_t size) noexcept {
+    static constexpr std::uint64_t Prime = 0x9E3779B97F4A7C15;
+    size_t i = 0;
+    for( ; i + 32 <= size ; i += 32 ) {
+        for( int lane = 0 ; lane < 4 ; ++lane ) {
+            std::uint64_t word;
+            std::memcpy(&word, data + i + lane * 8, 8);
+            lanes[lane] = ((lanes[lane] ^ word) * Prime);
+            lanes[lane] ^= lanes[lane] >> 29;
+        }
+    }
+    for( ; i < size ; ++i ) { lanes[0] = (lanes[0] ^ static_cast<unsigned char>(data[i])) * Prime; }
+}
+
+/**
+ * Returns a 64-bit hash of the bytes [offset, end of file) of a file, or 0
+ * if it can't be read.
+ */
+static std::uint64_t
+_hash_content(const String& path, std::uint64_t offset) {
+    static constexpr std::uint64_t ChunkSize = 8 * 1024 * 1024;
+    File file;
+    if( !file.open_read(path) ) { return 0; }
+    const std::uint64_t size = file.size();
+    std::vector<char> chunk( std::min(ChunkSize, size > offset ? size - offset : 0) );
+    std::uint64_t lanes[4] = { 1, 2, 3, 4 };
+    for( std::uint64_t position = offset ; position < size ; position += ChunkSize ) {
+        // chunks are multiples of 32 bytes, so the lanes see the same words whatever the chunk size
+        const auto length = std::min(ChunkSize, size - position);
+        if( !file.read_at(chunk.data(), length, position) ) { return 0; }
+        _hash_block(lanes, chunk.data(), length);
+    }
+    std::uint64_t hash = size - offset;
+    for( const auto lane : lanes ) { hash = (hash ^ lane) * 0xFF51AFD7ED558CCD; hash ^= hash >> 32; }
+    return hash;
+}
+
+static String
+_to_hex(std::uint64_t value) {
+    char text[17];
+    std::snprintf(text, sizeof(text), "%016llx", static_cast<unsigned long long>(value));
+    return text;
+}
+
+static bool
+_equals_ignoring_case(StringView a, StringView b) noexcept {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+        return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+    });
+}
+
+//============================= CONSTRUCTION ==============================//
+
+CkIndex::CkIndex(const CkIndexArgs& args)
+: _args(args)
+{}
+
+//================================ HELPERS ================================//
+
+void
+CkIndex::print_help() const noexcept {
+    std::cout << _args.help_message  << std::endl;
+}
+
+void
+CkIndex::print_version() const noexcept {
+    std::cout << "ckindex (CheckpointTools ckindex) " << PROJECT_VERSION << std::endl;
+}
+
+/**
+ * Prints what an update did, and how long it took since `start`.
+ */
+void
+CkIndex::print_update(const String& label, const UpdateStats& stats, std::chrono::steady_clock::time_point start) const {
+    auto& c = Colors::instance();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    char elapsed[32];
+    std::snprintf(elapsed, sizeof(elapsed), "%.2f s", seconds);
+    std::cerr << c.info() << label << c.reset() << _args.catalog << ": "
+              << stats.read << " read, " << stats.unchanged << " unchanged, " << stats.removed << " removed"
+              << (stats.failed > 0 ? ", " + std::to_string(stats.failed) + " failed" : String{})
+              << " in " << elapsed << std::endl;
+}
+
+/**
+ * Fills the identity of a file (device, inode, size and modification time),
+ * which tells whether it changed since it was read.
+ *
+ * @return `false` if the file doesn't exist or is not a regular file.
+ */
+bool
+CkIndex::stat_file(const String& path, Catalog::FileRecord& record) {
+#ifdef _WIN32
+    std::error_code errorCode;
+    if( !fs::is_regular_file(path, errorCode) ) { return false; }
+    record.device = 0;
+    record.inode  = 0;
+    record.size   = fs::file_size(path, errorCode);
+    record.mtime  = fs::last_write_time(path, errorCode).time_since_epoch().count();
+    return !errorCode;
+#else
+    struct stat status;
+    if( ::stat(path.c_str(), &status) != 0 || !S_ISREG(status.st_mode) ) { return false; }
+    record.device = static_cast<std::uint64_t>(status.st_dev);
+    record.inode  = static_cast<std::uint64_t>(status.st_ino);
+    record.size   = static_cast<std::uint64_t>(status.st_size);
+    record.mtime  = static_cast<std::int64_t>(status.st_mtim.tv_sec) * 1'000'000'000 + status.st_mtim.tv_nsec;
+    return true;
+#endif
+}
+
+/**
+ * Reads the header of a .safetensors or .gguf file (and its data, to hash
+ * it, if `contentHash` is true) into `file.tensors`.
+ *
+ * @return `false` if the file can't be read, with the reason in `file.error`.
+ */
+bool
+CkIndex::read_file(ScannedFile& file, bool contentHash) {
+    ReadError     readError  = ReadError::None;
+    std::uint64_t dataOffset = 0;
+    file.record.flags = 0;
+    if( GgufFile::is_gguf_file(file.path) ) {
+        const auto gguf = GgufFile::from_file(file.path, readError);
+        file.tensors.reserve(3 * gguf.tensors().size());
+        for( const auto& tensor : gguf.tensors() ) {
+            file.tensors.push_back( tensor.name );
+            file.tensors.emplace_back( GgufFile::type_name(tensor.type) );
+            file.tensors.push_back( _shape_text(tensor.shape.rbegin(), tensor.shape.rend()) );
+        }
+        file.record.flags |= Catalog::FileRecord::GGUF;
+        dataOffset = gguf.data_offset();
+    } else {
+        const auto safetensors = SafetensorsFile::from_file(file.path, readError);
+        file.tensors.reserve(3 * safetensors.tensors().size());
+        for( const auto& tensor : safetensors.tensors() ) {
+            if( tensor.is_padding() ) { continue; }
+            file.tensors.push_back( tensor.name );
+            file.tensors.push_back( tensor.dtype );
+            file.tensors.push_back( _shape_text(tensor.shape.begin(), tensor.shape.end()) );
+        }
+        dataOffset = safetensors.data_offset();
+    }
+    if( readError != ReadError::None ) {
+        file.error = String{ Messages::read_error_description(readError) };
+        file.tensors.clear();
+        return false;
+    }
+    if( contentHash ) {
+        file.record.contentHash = _hash_content(file.path, dataOffset);
+        file.record.flags |= Catalog::FileRecord::CONTENT_HASH;
+    }
+    return true;
+}
+
+//================================= STEPS =================================//
+
+/**
+ * Returns whether a file is still the one in the catalog: same device,
+ * inode, size and modification time (and hashed, if hashes are wanted).
+ */
+bool
+CkIndex::is_unchanged(const Catalog::FileRecord& old, const Catalog::FileRecord& record) const noexcept {
+    const bool hasContentHash = (old.flags & Catalog::FileRecord::CONTENT_HASH) != 0;
+    return old.device == record.device && old.inode == record.inode && old.size == record.size &&
+           old.mtime  == record.mtime  && (hasContentHash || !_args.content_hash);
+}
+
+/**
+ * Reads a batch of files on several threads and adds them to a catalog;
+ * files that can't be read are reported and left out.
+ */
+void
+CkIndex::read_files(CatalogBuilder& builder, std::vector<ScannedFile>& files, UpdateStats& stats) const {
+    parallel_for(files.size(), static_cast<unsigned>(_args.threads), [&](size_t i) {
+        (void)read_file(files[i], _args.content_hash);
+    });
+    for( auto& file : files ) {
+        if( !file.error.empty() ) {
+            Messages::warning("Unable to read '" + file.path + "': " + file.error);
+            ++stats.failed;
+            continue;
+        }
+        auto& added = builder.add_file(file.path, file.record);
+        for( size_t t=0 ; t<file.tensors.size() ; t+=3 ) {
+            builder.add_tensor(added, file.tensors[t], file.tensors[t+1], file.tensors[t+2]);
+        }
+        ++stats.read;
+    }
+    files.clear();
+}
+
+/**
+ * Scans the inputs and writes the catalog again, reading only the files
+ * that are new or changed; the others are copied from the current catalog
+ * or from its segments, which are merged into it and deleted.
+ *
+ * Files of the current catalog that are outside the scanned directories
+ * are kept (and checked, like with --update) so a catalog can be built one
+ * directory at a time.
+ */
+CkIndex::UpdateStats
+CkIndex::update_catalog() const {
+    UpdateStats stats;
+    CatalogSet  current;
+    String      error;
+    std::error_code errorCode;
+    if( fs::exists(_args.catalog, errorCode) && !current.open(_args.catalog, error) ) {
+        Messages::warning(error + " It will be created again.");
+    }
+
+    // the files to catalog: those found in the inputs...
+    std::vector<String> roots, paths;
+    for( const auto& input : _args.inputs ) {
+        const auto root = fs::absolute(input, errorCode).lexically_normal();
+        if( fs::is_directory(root, errorCode) ) {
+            roots.push_back( (root / "").string() );
+            const auto options = fs::directory_options::skip_permission_denied;
+            for( auto it = fs::recursive_directory_iterator(root, options, errorCode) ; !errorCode && it != fs::recursive_directory_iterator() ; it.increment(errorCode) ) {
+                if( it->is_regular_file(errorCode) && _is_checkpoint(it->path()) ) { paths.push_back( it->path().string() ); }
+            }
+            if( errorCode ) { Messages::warning("Unable to scan the directory '" + root.string() + "' completely."); errorCode.clear(); }
+        }
+        else if( fs::exists(root, errorCode) ) {
+            roots.push_back( root.string() );
+            paths.push_back( root.string() );
+        }
+        else {
+            Messages::warning("The path '" + input + "' doesn't exist.");
+        }
+    }
+    // ...and those of the catalog that are not under any of the inputs
+    size_t live = 0;
+    for( size_t layer = 0 ; layer < current.size() ; ++layer ) {
+        for( std::uint32_t f=0 ; f<current[layer].file_count() ; ++f ) {
+            if( !current.is_live(layer, f) ) { continue; }
+            ++live;
+            const auto path = current[layer].path(f);
+            const bool isScanned = std::any_of(roots.begin(), roots.end(), [&](const String& root) {
+                return path == root || (root.ends_with('/') && path.starts_with(root));
+            });
+            if( !isScanned ) { paths.emplace_back(path); }
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+    // unchanged files are copied, the rest are read in batches on several threads
+    CatalogBuilder           builder;
+    std::vector<ScannedFile> pending;
+    size_t kept = 0;
+    for( const auto& path : paths ) {
+        Catalog::FileRecord record{};
+        if( !stat_file(path, record) ) { continue; }
+        size_t        layer;
+        std::uint32_t index;
+        if( current.find(path, layer, index) ) {
+            ++kept;
+            if( is_unchanged(current[layer].file(index), record) ) {
+                builder.copy_file(current[layer], index);
+                ++stats.unchanged;
+                continue;
+            }
+        }
+        pending.push_back({ path, record, {}, {} });
+        if( pending.size() == BatchSize ) { read_files(builder, pending, stats); }
+    }
+    read_files(builder, pending, stats);
+    stats.removed = live - std::min(live, kept);
+
+    const auto segments = current.segments();
+    current.close();
+    if( !builder.write(_args.catalog, error) ) { Messages::fatal_error(error); }
+    for( const auto segment : segments ) { fs::remove(CatalogSet::segment_path(_args.catalog, segment), errorCode); }
+    return stats;
+}
+
+/**
+ * Checks the files that changed and writes a new segment with the ones
+ * that were written (read again) or removed (recorded as removed).
+ *
+ * @param paths   The files with events since the last segment.
+ * @param segment The number of the new segment.
+ * @return What changed; nothing is written if nothing did.
+ */
+CkIndex::UpdateStats
+CkIndex::write_segment(const std::vector<String>& paths, std::uint64_t segment) const {
+    UpdateStats stats;
+    CatalogSet  current;
+    String      error;
+    if( !current.open(_args.catalog, error) ) { Messages::warning(error); return stats; }
+
+    CatalogBuilder           builder;
+    std::vector<ScannedFile> pending;
+    for( const auto& path : paths ) {
+        Catalog::FileRecord record{};
+        size_t        layer;
+        std::uint32_t index;
+        const bool isKnown = current.find(path, layer, index);
+        if( !stat_file(path, record) ) {
+            if( isKnown ) {
+                Catalog::FileRecord removed{};
+                removed.flags = Catalog::FileRecord::REMOVED;
+                builder.add_file(path, removed);
+                ++stats.removed;
+            }
+            continue;
+        }
+        if( isKnown && is_unchanged(current[layer].file(index), record) ) { ++stats.unchanged; continue; }
+        pending.push_back({ path, record, {}, {} });
+    }
+    read_files(builder, pending, stats);
+    if( builder.file_count() > 0 && !builder.write(CatalogSet::segment_path(_args.catalog, segment), error) ) {
+        Messages::warning(error);
+        return {};
+    }
+    return stats;
+}
+
+/**
+ * Merges the segments of a catalog, up to `lastSegment`, into a new
+ * catalog that replaces it, and deletes them.
+ *
+ * Newer segments are left alone, so new segments can be written while the
+ * catalog is compacted.
+ *
+ * @return The number of segments merged, or -1 on error.
+ */
+int
+CkIndex::compact(const String& path, std::uint64_t lastSegment, String& error) {
+    CatalogSet current;
+    if( !current.open(path, error, lastSegment) ) { return -1; }
+    if( current.segments().empty() ) { return 0; }
+
+    CatalogBuilder builder;
+    for( size_t layer = 0 ; layer < current.size() ; ++layer ) {
+        for( std::uint32_t f=0 ; f<current[layer].file_count() ; ++f ) {
+            if( current.is_live(layer, f) ) { builder.copy_file(current[layer], f); }
+        }
+    }
+    const auto segments = current.segments();
+    current.close();
+    if( !builder.write(path, error) ) { return -1; }
+    std::error_code errorCode;
+    for( const auto segment : segments ) { fs::remove(CatalogSet::segment_path(path, segment), errorCode); }
+    return static_cast<int>(segments.size());
+}
+
+/**
+ * Returns the files of the catalog and its segments that match the query
+ * of the arguments, in path order, each with the tensors that matched
+ * (every tensor of the file with --long and no tensor condition).
+ */
+std::vector<CkIndex::Match>
+CkIndex::query(const CatalogSet& catalogs) const {
+    std::vector<Match> matches;
+    for( size_t layer = 0 ; layer < catalogs.size() ; ++layer ) {
+        for( auto& match : _query_layer(catalogs[layer]) ) {
+            if( !catalogs.is_live(layer, match.file) ) { continue; }
+            match.layer = layer;
+            matches.push_back( std::move(match) );
+        }
+    }
+    if( catalogs.size() > 1 ) {
+        std::sort(matches.begin(), matches.end(), [&](const Match& a, const Match& b) {
+            return catalogs[a.layer].path(a.file) < catalogs[b.layer].path(b.file);
+        });
+    }
+    return matches;
+}
+
+/**
+ * Prints the files that matched: their paths, or with --long also their
+ * hashes and matching tensors; with --ndjson one JSON record per file.
+ */
+void
+CkIndex::print_matches(const CatalogSet& catalogs, const std::vector<Match>& matches) const {
+    if( _args.ndjson ) {
+        JsonWriter json{ OutputSink::standard_output() };
+        for( const auto& match : matches ) {
+            const auto& catalog = catalogs[match.layer];
+            const auto& record = catalog.file(match.file);
+            json.begin_object();
+            json.member("file", catalog.path(match.file));
+            json.member("size", record.size);
+            json.member("tensors", record.tensorCount);
+            json.member("structural_hash", _to_hex(record.structuralHash));
+            if( record.flags & Catalog::FileRecord::CONTENT_HASH ) { json.member("content_hash", _to_hex(record.contentHash)); }
+            if( _args.long_format || !_args.names.empty() || !_args.dtype.empty() || !_args.shape.empty() ) {
+                json.key("matches").begin_array();
+                for( const auto index : match.tensors ) {
+                    const auto& tensor = catalog.tensor(index);
+                    json.begin_object();
+                    json.member("name", catalog.name(tensor.name)).member("dtype", catalog.dtype(tensor.dtype));
+                    json.key("shape").raw(catalog.shape(tensor.shape));
+                    json.end_object();
+                }
+                json.end_array();
+            }
+            json.end_object().end_document();
+        }
+        OutputSink::standard_output().flush();
+        return;
+    }
+
+    auto& c = Colors::instance();
+    for( const auto& match : matches ) {
+        const auto& catalog = catalogs[match.layer];
+        if( !_args.long_format ) { std::cout << catalog.path(match.file) << '\n'; continue; }
+        const auto& record = catalog.file(match.file);
+        std::cout << c.primary() << catalog.path(match.file) << c.reset() << std::endl;
+        std::cout << c.info() << "  size: " << c.reset() << to_human_size(record.size)
+                  << c.info() << "  tensors: " << c.reset() << record.tensorCount
+                  << c.info() << "  structure: " << c.reset() << _to_hex(record.structuralHash);
+        if( record.flags & Catalog::FileRecord::CONTENT_HASH ) {
+            std::cout << c.info() << "  content: " << c.reset() << _to_hex(record.contentHash);
+        }
+        std::cout << '\n';
+        for( const auto index : match.tensors ) {
+            const auto& tensor = catalog.tensor(index);
+            std::cout << "  " << c.data() << catalog.name(tensor.name) << c.reset() << "  "
+                      << catalog.dtype(tensor.dtype) << "  " << c.data2() << catalog.shape(tensor.shape) << c.reset() << '\n';
+        }
+    }
+    std::cout.flush();
+}
+
+/**
+ * Prints the size of the catalog and how many files have tensors of each dtype.
+ */
+void
+CkIndex::print_stats(const CatalogSet& catalogs) const {
+    auto& c = Colors::instance();
+    std::uint64_t files = 0, bytes = 0, tensors = 0, size = 0;
+    std::vector<std::pair<String, size_t>> dtypes;  // sorted by dtype
+    for( size_t layer = 0 ; layer < catalogs.size() ; ++layer ) {
+        const auto& catalog = catalogs[layer];
+        size += catalog.size();
+        for( std::uint32_t f=0 ; f<catalog.file_count() ; ++f ) {
+            if( !catalogs.is_live(layer, f) ) { continue; }
+            ++files;
+            bytes   += catalog.file(f).size;
+            tensors += catalog.file(f).tensorCount;
+        }
+        for( std::uint32_t d=0 ; d<catalog.dtype_count() ; ++d ) {
+            const String dtype{ catalog.dtype(d) };
+            auto it = std::lower_bound(dtypes.begin(), dtypes.end(), dtype, [](const auto& pair, const String& key) { return pair.first < key; });
+            if( it == dtypes.end() || it->first != dtype ) { it = dtypes.insert(it, { dtype, 0 }); }
+            for( const auto file : catalog.files_with_dtype(d) ) { it->second += catalogs.is_live(layer, file); }
+        }
+    }
+
+    std::cout << c.info() << "Catalog   : " << c.reset() << _args.catalog << " (" << to_human_size(size) << ")" << std::endl;
+    if( catalogs.size() > 1 ) {
+        std::cout << c.info() << "Segments  : " << c.reset() << catalogs.size() - 1 << " (merged by the next update or compaction)" << std::endl;
+    }
+    std::cout << c.info() << "Files     : " << c.reset() << to_human_count(files) << " (" << to_human_size(bytes) << ")" << std::endl;
+    std::cout << c.info() << "Tensors   : " << c.reset() << to_human_count(tensors);
+    if( catalogs.size() == 1 ) {
+        std::cout << ", " << to_human_count(catalogs[0].name_count()) << " distinct names, "
+                  << to_human_count(catalogs[0].shape_count()) << " distinct shapes";
+    }
+    std::cout << std::endl;
+    std::cout << c.info() << "Dtypes    : " << c.reset();
+    bool isFirst = true;
+    for( const auto& [dtype, count] : dtypes ) {
+        if( count == 0 ) { continue; }
+        std::cout << (isFirst ? "" : ", ") << dtype << " (" << count << " files)";
+        isFirst = false;
+    }
+    std::cout << std::endl;
+}
+
+//================================ WATCHING ===============================//
+
+/// Set by SIGINT and SIGTERM, which interrupt the wait for changes.
+static volatile std::sig_atomic_t StopRequested = 0;
+
+static void
+_request_stop(int) {
+    StopRequested = 1;
+}
+
+/**
+ * Updates the catalog, then keeps it current while the directories of the
+ * arguments change, until the process is interrupted.
+ *
+ * The files with events are collected until none of them had an event for
+ * the debounce time (a download closes and renames its file several
+ * times), then checked and written to a new segment. Once there are
+ * `MaxSegments` segments they are merged into the catalog on another
+ * thread, while new segments keep being written. Between events the
+ * process sleeps in the kernel.
+ */
+int
+CkIndex::watch() const {
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t MaxSegments = 8;
+    auto& c = Colors::instance();
+
+    if( _args.inputs.empty() ) {
+        Messages::fatal_error("No directory to watch.", {
+            "Use: ckindex --watch CATALOG DIR..." });
+    }
+    DirectoryWatcher watcher;
+    String error;
+    if( !watcher.open(error) ) { Messages::fatal_error(error); }
+
+    auto start = Clock::now();
+    print_update("Updated   : ", update_catalog(), start);
+    std::vector<String> roots;
+    for( const auto& input : _args.inputs ) {
+        std::error_code errorCode;
+        const auto root = fs::absolute(input, errorCode).lexically_normal();
+        if( !fs::is_directory(root, errorCode) ) { Messages::warning("Only directories are watched, '" + input + "' is not."); continue; }
+        roots.push_back(root.string());
+        watcher.add_tree(roots.back());
+    }
+    std::cerr << c.info() << "Watching  : " << c.reset() << watcher.watch_count() << " directories (Ctrl+C to stop)" << std::endl;
+    std::signal(SIGINT,  _request_stop);
+    std::signal(SIGTERM, _request_stop);
+
+    const auto debounce = std::chrono::milliseconds(_args.debounce);
+    std::map<String, Clock::time_point> pending;  ///< files with events, and when they are due
+    std::thread       compaction;
+    std::atomic<bool> isCompacting{ false };
+    auto segments    = CatalogSet::list_segments(_args.catalog);
+    auto nextSegment = segments.empty() ? std::uint64_t{1} : segments.back() + 1;
+    auto join_compaction = [&]() { if( compaction.joinable() ) { compaction.join(); } };
+
+    std::vector<DirectoryWatcher::Event> events;
+    while( !StopRequested ) {
+        // sleep until there are events, or until the first pending file is due
+        int timeout = -1;
+        if( !pending.empty() ) {
+            auto due = Clock::time_point::max();
+            for( const auto& [path, time] : pending ) { due = std::min(due, time); }
+            timeout = static_cast<int>( std::max<std::int64_t>(0, std::chrono::ceil<std::chrono::milliseconds>(due - Clock::now()).count()) );
+        }
+        events.clear();
+        if( !watcher.wait(timeout, events) ) { Messages::error("The directories can't be watched anymore."); break; }
+
+        const auto now = Clock::now();
+        bool isLost = false;
+        for( const auto& event : events ) {
+            switch( event.change ) {
+                case DirectoryWatcher::Change::WRITTEN:
+                case DirectoryWatcher::Change::REMOVED:
+                    if( _is_checkpoint(event.path) ) { pending[event.path] = now + debounce; }
+                    break;
+                case DirectoryWatcher::Change::TREE_REMOVED: {
+                    // every file of the catalog under the directory
+                    CatalogSet current;
+                    const String prefix = event.path + "/";
+                    if( !current.open(_args.catalog, error) ) { break; }
+                    for( size_t layer = 0 ; layer < current.size() ; ++layer ) {
+                        for( std::uint32_t f=0 ; f<current[layer].file_count() ; ++f ) {
+                            const auto path = current[layer].path(f);
+                            if( path.starts_with(prefix) && current.is_live(layer, f) ) { pending[String{path}] = now + debounce; }
+                        }
+                    }
+                    break;
+                }
+                case DirectoryWatcher::Change::EVENTS_LOST:
+                    isLost = true;
+                    break;
+            }
+        }
+        if( isLost ) {
+            Messages::warning("Too many changes at once, the directories are scanned again.");
+            join_compaction();
+            start = Clock::now();
+            print_update("Updated   : ", update_catalog(), start);
+            pending.clear();
+            nextSegment = 1;
+            continue;
+        }
+
+        // the files that had no events during the debounce time
+        std::vector<String> due;
+        for( auto it = pending.begin() ; it != pending.end() ; ) {
+            if( it->second <= now ) { due.push_back(it->first); it = pending.erase(it); }
+            else                    { ++it; }
+        }
+        if( !due.empty() ) {
+            start = Clock::now();
+            const auto stats = write_segment(due, nextSegment);
+            if( stats.read + stats.removed > 0 ) {
+                print_update("Segment " + std::to_string(nextSegment) + " : ", stats, start);
+                ++nextSegment;
+            }
+        }
+
+        // merge the segments in the background once there are enough
+        if( !isCompacting && compaction.joinable() ) { compaction.join(); }
+        if( !isCompacting && CatalogSet::list_segments(_args.catalog).size() >= MaxSegments ) {
+            isCompacting = true;
+            compaction = std::thread([this, &isCompacting, &c, lastSegment = nextSegment - 1]() {
+                String compactionError;
+                const auto begin  = Clock::now();
+                const int  merged = compact(_args.catalog, lastSegment, compactionError);
+                if( merged < 0 ) { Messages::warning(compactionError); }
+                else {
+                    const double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+                    char elapsed[32];
+                    std::snprintf(elapsed, sizeof(elapsed), "%.2f s", seconds);
+                    std::cerr << c.info() << "Compacted : " << c.reset() << merged << " segments in " << elapsed << std::endl;
+                }
+                isCompacting = false;
+            });
+        }
+    }
+    join_compaction();
+    return 0;
+}
+
+//================================ RUNNING ================================//
+
+int
+CkIndex::run() {
+
+    // if the color option is set to "auto", disable colors when outputting to a non-terminal
+    if( _args.when_color == "auto" || _args.when_color == "tty" || _args.when_color == "if-tty" ) {
+        if( !is_terminal_output() ) { Colors::instance().disable_colors(); }
+    }
+    // if the color option is set to "never", disable colors regardless of output type
+    else if ( _args.when_color == "never" || _args.when_color == "no" || _args.when_color == "none") {
+        Colors::instance().disable_colors();
+    }
+
+    // if help was requested, show the help message and exit
+    if( _args.help ) { print_help(); return 0; }
+
+    // if version was requested, show the version and exit
+    if( _args.version ) { print_version(); return 0; }
+
+    // if the user didn't provide the catalog, show an error message and exit
+    if( _args.catalog.empty() ) {
+        Messages::fatal_error("No catalog provided. Please specify the catalog file.", {
+            "To get help on how to use this tool, run: ckindex --help"
+        });
+    }
+
+    const bool isQuery = !_args.names.empty() || !_args.dtype.empty() || !_args.shape.empty() || !_args.hash.empty() ||
+                         _args.long_format || _args.ndjson;
+    if( _args.watch ) { return watch(); }
+    if( !_args.inputs.empty() || _args.update ) {
+        const auto start = std::chrono::steady_clock::now();
+        const auto stats = update_catalog();
+        print_update("Updated   : ", stats, start);
+        if( !isQuery && !_args.stats ) { return 0; }
+    }
+
+    CatalogSet catalogs;
+    String     error;
+    if( !catalogs.open(_args.catalog, error) ) {
+        std::error_code errorCode;
+        if( fs::exists(_args.catalog, errorCode) ) { Messages::fatal_error(error); }
+        Messages::fatal_error(error, { "Create it with: ckindex " + _args.catalog + " DIR..." });
+    }
+    if( _args.stats || !isQuery ) { print_stats(catalogs); return 0; }
+    const auto matches = query(catalogs);
+    print_matches(catalogs, matches);
+    return matches.empty() ? 1 : 0;
+}
+
+//============================ IMPLEMENTATION =============================//
+
+/**
+ * Returns the files of one catalog that match the query, in path order.
+ */
+std::vector<CkIndex::Match>
+CkIndex::_query_layer(const Catalog& catalog) const {
+    const bool byName  = !_args.names.empty();
+    const bool byDtype = !_args.dtype.empty();
+    const bool byShape = !_args.shape.empty();
+
+    // the dtypes and shapes accepted, both tables are small
+    std::vector<std::uint8_t> dtypeOk, shapeOk;
+    if( byDtype ) {
+        dtypeOk.resize(catalog.dtype_count(), 0);
+        for( std::uint32_t d=0 ; d<catalog.dtype_count() ; ++d ) { dtypeOk[d] = _equals_ignoring_case(catalog.dtype(d), _args.dtype); }
+    }
+    if( byShape ) {
+        std::vector<std::int64_t> pattern, dims;
+        if( !_parse_shape(_args.shape, pattern) ) {
+            Messages::fatal_error("Invalid shape: '" + _args.shape + "'.", {
+                "The expected format is a list of dimensions, e.g. '[4096,4096]' or '[*,4096]'." });
+        }
+        shapeOk.resize(catalog.shape_count(), 0);
+        for( std::uint32_t s=0 ; s<catalog.shape_count() ; ++s ) {
+            shapeOk[s] = _parse_shape(catalog.shape(s), dims) && dims.size() == pattern.size() &&
+                         std::equal(dims.begin(), dims.end(), pattern.begin(), [](auto dim, auto want) { return want < 0 || dim == want; });
+        }
+    }
+    auto tensor_ok = [&](const Catalog::TensorRecord& tensor) {
+        return (!byDtype || dtypeOk[tensor.dtype]) && (!byShape || shapeOk[tensor.shape]);
+    };
+
+    // the tensors that match, grouped by file
+    std::vector<std::vector<std::uint64_t>> tensorsOf;
+    std::vector<std::uint8_t>               isMatch(catalog.file_count(), 0);
+    if( byName ) {
+        tensorsOf.resize(catalog.file_count());
+        // exact names are searched, and the patterns are matched against the
+        // names that start with their literal prefix ("model.layers." of
+        // "model.layers.*.mlp.*"), or against every name if there is a regex
+        std::vector<std::uint32_t> names;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> ranges;
+        PatternSet patterns;
+        bool hasRegex = false;
+        for( const auto& name : _args.names ) {
+            const bool isRegex = name.size() >= 2 && name.front() == '/' && name.back() == '/';
+            const auto wildcard = name.find_first_of("*?");
+            if( !isRegex && wildcard == String::npos ) {
+                const auto id = catalog.find_name(name);
+                if( id != Catalog::None ) { names.push_back(id); }
+                continue;
+            }
+            String error;
+            if( !patterns.add(name, error) ) { Messages::fatal_error("Invalid pattern: '" + name + "'.", { error }); }
+            if( isRegex ) { hasRegex = true; }
+            else          { ranges.push_back( catalog.names_with_prefix(StringView{name}.substr(0, wildcard)) ); }
+        }
+        if( hasRegex ) { ranges = { { 0, catalog.name_count() } }; }
+        std::sort(ranges.begin(), ranges.end());
+        std::uint32_t scanned = 0;
+        for( auto [first, last] : ranges ) {
+            for( std::uint32_t n = std::max(first, scanned) ; n < last ; ++n ) {
+                if( patterns.matches(catalog.name(n)) ) { names.push_back(n); }
+            }
+            scanned = std::max(scanned, last);
+        }
+        std::sort(names.begin(), names.end());
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+        for( const auto name : names ) {
+            for( const auto index : catalog.tensors_named(name) ) {
+                const auto& tensor = catalog.tensor(index);
+                if( tensor.file < isMatch.size() && tensor_ok(tensor) ) {
+                    isMatch[tensor.file] = 1;
+                    tensorsOf[tensor.file].push_back(index);
+                }
+            }
+        }
+    }
+    else if( byDtype || byShape ) {
+        // the posting lists of the dtype (or the shape) give the candidates,
+        // their tensors are checked only when both conditions are given
+        auto& accepted = byDtype ? dtypeOk : shapeOk;
+        for( std::uint32_t id=0 ; id<accepted.size() ; ++id ) {
+            if( !accepted[id] ) { continue; }
+            for( const auto file : (byDtype ? catalog.files_with_dtype(id) : catalog.files_with_shape(id)) ) {
+                if( file < isMatch.size() ) { isMatch[file] = 1; }
+            }
+        }
+        if( (byDtype && byShape) || _args.long_format ) {
+            tensorsOf.resize(catalog.file_count());
+            for( std::uint32_t f=0 ; f<catalog.file_count() ; ++f ) {
+                if( !isMatch[f] ) { continue; }
+                const auto first = catalog.file(f).firstTensor;
+                const auto tensors = catalog.tensors_of(f);
+                for( size_t t=0 ; t<tensors.size() ; ++t ) {
+                    if( tensor_ok(tensors[t]) ) { tensorsOf[f].push_back(first + t); }
+                }
+                isMatch[f] = !tensorsOf[f].empty();
+            }
+        }
+    }
+    else {
+        std::fill(isMatch.begin(), isMatch.end(), 1);
+    }
+
+    // the files, filtered by hash
+    std::uint64_t hash = 0;
+    if( !_args.hash.empty() ) {
+        char* end = nullptr;
+        hash = std::strtoull(_args.hash.c_str(), &end, 16);
+        if( end == _args.hash.c_str() || *end != '\0' ) { Messages::fatal_error("Invalid hash: '" + _args.hash + "'."); }
+    }
+    std::vector<Match> matches;
+    for( std::uint32_t f=0 ; f<catalog.file_count() ; ++f ) {
+        if( !isMatch[f] ) { continue; }
+        const auto& record = catalog.file(f);
+        if( !_args.hash.empty() && record.structuralHash != hash &&
+            !((record.flags & Catalog::FileRecord::CONTENT_HASH) && record.contentHash == hash) ) { continue; }
+        auto& match = matches.emplace_back();
+        match.file = f;
+        if( !tensorsOf.empty() ) { match.tensors = std::move(tensorsOf[f]); }
+        else if( _args.long_format ) {
+            for( std::uint64_t t=0 ; t<catalog.tensors_of(f).size() ; ++t ) { match.tensors.push_back(record.firstTensor + t); }
+        }
+    }
+    return matches;
+}
@@ -0,0 +1,78 @@
+/*
+| File    : ckindex.h
+| Purpose : The `ckindex` command line tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 17, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKINDEX_H_
+#define CKINDEX_H_
+#include <chrono>           // for std::chrono::steady_clock
+#include <vector>
+#include "common.h"
+#include "catalog.h"        // for Catalog, CatalogBuilder
+#include "ckindex_args.h"   // for CkIndexArgs
+
+
+class CkIndex
+{
+public:
+    /// What an update did.
+    struct UpdateStats {
+        size_t unchanged = 0;
+        size_t read      = 0;  ///< new or changed files
+        size_t removed   = 0;
+        size_t failed    = 0;  ///< files that couldn't be read
+    };
+    /// A file read from disk, before it is added to the catalog.
+    struct ScannedFile {
+        String              path;
+        Catalog::FileRecord record{};
+        std::vector<String> tensors;  ///< name, dtype and shape of each tensor
+        String              error;
+    };
+    /// A file that matches a query, with the tensors that matched.
+    struct Match {
+        size_t                     layer = 0;  ///< the catalog or segment of the file
+        std::uint32_t              file;
+        std::vector<std::uint64_t> tensors;
+    };
+
+// MAIN
+public:
+    CkIndex(const CkIndexArgs& args);
+    [[nodiscard]] int run();
+
+// STEPS
+public:
+    UpdateStats        update_catalog() const;
+    UpdateStats        write_segment(const std::vector<String>& paths, std::uint64_t segment) const;
+    int                watch() const;
+    std::vector<Match> query(const CatalogSet& catalogs) const;
+    void print_matches(const CatalogSet& catalogs, const std::vector<Match>& matches) const;
+    void print_stats(const CatalogSet& catalogs) const;
+
+// HELPERS
+public:
+    [[nodiscard]] static bool read_file(ScannedFile& file, bool contentHash);
+    [[nodiscard]] static bool stat_file(const String& path, Catalog::FileRecord& record);
+    [[nodiscard]] static int  compact(const String& path, std::uint64_t lastSegment, String& error);
+    [[nodiscard]] bool is_unchanged(const Catalog::FileRecord& old, const Catalog::FileRecord& record) const noexcept;
+    void read_files(CatalogBuilder& builder, std::vector<ScannedFile>& files, UpdateStats& stats) const;
+    void print_update(const String& label, const UpdateStats& stats, std::chrono::steady_clock::time_point start) const;
+    void print_help() const noexcept;
+    void print_version() const noexcept;
+
+// IMPLEMENTATION
+private:
+    std::vector<Match> _query_layer(const Catalog& catalog) const;
+private:
+    const CkIndexArgs _args;
+};
+
+#endif // CKINDEX_H_
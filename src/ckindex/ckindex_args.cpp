@@ -0,0 +1,126 @@
+/*
+| File    : ckindex_args.cpp
+| Purpose : The arguments of the `ckindex` command line
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 17, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include "common.h"
+#include "ckindex_args.h"
+#include "argument.h"
+#include "messages.h"
+
+//============================= CONSTRUCTION ==============================//
+
+/**
+ * Constructs a new CkIndexArgs object by parsing command line arguments.
+ *
+ * @param argc The number of command line arguments passed to the program.
+ * @param argv An array of C strings representing the command line arguments.
+ */
+CkIndexArgs::CkIndexArgs(int argc, char* argv[])
+: help_message{R"(
+Usage: ckindex [OPTIONS] CATALOG [DIR|FILE...]
+
+  Keeps a catalog of the tensors of a library of .safetensors and .gguf
+  files (names, dtypes, shapes and a structural hash of each file) and
+  answers questions about the whole library without opening the files.
+
+  With directories or files after the catalog, they are scanned (the
+  directories recursively) and the catalog is created or updated. Only the
+  files that are new or whose inode, size or modification time changed are
+  read again; files that disappeared are removed.
+
+  The catalog is a single file with sorted string tables and posting lists
+  that is mapped in memory, so a query only reads the entries it needs.
+
+  With --watch, ckindex keeps running after the update and follows the
+  directories (Linux only): files that are written, renamed or removed are
+  checked once they had no changes for the debounce time, and recorded in
+  small segments next to the catalog ('CATALOG.seg.N'). Queries read the
+  catalog and its segments; every few segments they are merged into the
+  catalog in the background, and any update merges them too.
+
+  OPTIONS:
+    -n, --name <PATTERN>        Files with a tensor whose name matches (exact name, glob or /regex/)
+    -s, --shape <SHAPE>         ... with this shape, e.g. "[4096,4096]" or "[*,4096]"
+    -d, --dtype <DTYPE>         ... with this dtype, e.g. F32, BF16, Q4_K
+    --hash <HEX>                Files with this structural or content hash
+    -l, --long                  List the matching tensors and the hashes of each file
+    --ndjson                    Output one JSON record per file
+    --stats                     Print a summary of the catalog
+
+    -u, --update                Check the files already in the catalog and read the changed ones
+    --content-hash              Also hash the tensor data of the files that are read
+    -t, --threads <N>           Number of files read at the same time (default: one per core)
+    -w, --watch                 Keep the catalog current while the directories change
+    --debounce <MS>             Wait this long after the last change of a file (default: 2000)
+
+    --nc, --no-color            Disable color output.
+    -h  , --help                Show this help message and exit.
+    -v  , --version             Show version information and exit.
+
+  Examples:
+    ckindex models.ckindex /srv/models
+    ckindex --update models.ckindex
+    ckindex --watch models.ckindex /srv/models
+    ckindex --name lm_head.weight --shape '[*,4096]' models.ckindex
+    ckindex --dtype F32 models.ckindex
+    ckindex --long --name '/layers\.\d+\.mlp\.gate_proj/' --dtype BF16 models.ckindex
+)"}
+{
+    for( int i=1 ; i < argc ; ++i )
+    {
+        auto arg = Argument{i, argc, argv};
+
+        // parse the options
+        if( arg.is_option() ) {
+        //-QUERIES:
+            if     (arg.is( "-n", "--name"         )) { names.push_back( arg.value(i) ); }
+            else if(arg.is( "-s", "--shape"        )) { shape = arg.value(i); }
+            else if(arg.is( "-d", "--dtype"        )) { dtype = arg.value(i); }
+            else if(arg.is(       "--hash"         )) { hash  = arg.value(i); }
+            else if(arg.is( "-l", "--long"         )) { long_format = true; }
+            else if(arg.is(       "--ndjson"       )) { ndjson = true; }
+            else if(arg.is(       "--stats"        )) { stats  = true; }
+        //-UPDATES:
+            else if(arg.is( "-u", "--update"       )) { update = true; }
+            else if(arg.is(       "--content-hash" )) { content_hash = true; }
+            else if(arg.is( "-t", "--threads"      )) { threads = to_integer(arg.value(i)); }
+            else if(arg.is( "-w", "--watch"        )) { watch = true; }
+            else if(arg.is(       "--debounce"     )) { debounce = to_integer(arg.value(i), -1); }
+        //-EXTRA:
+            else if(arg.is( "-h", "--help"         )) { help = true; }
+            else if(arg.is( "-v", "--version"      )) { version = true; }
+            else if(arg.is( "--color"              )) { when_color = arg.value(i);  }
+            else if(arg.is( "--nc", "--no-color"   )) { when_color = "never"; }
+            else {
+                // if an unknown argument is encountered, display a fatal error message
+                Messages::fatal_error( "Unknown argument: " + arg.name(), {
+                    "Try `ckindex --help` for more information." });
+            }
+            // check if the user provided a value that was not consumed by the option
+            if( arg.has_value() && !arg.was_value_consumed() ) {
+                Messages::fatal_error( "The argument '"+ arg.name() +"' no expects a value and '"+ arg.value(i) +"' was provided.", {
+                    "Try `ckindex --help` for more information." });
+            }
+        }
+        // handle positional arguments, arguments without a preceding hyphen
+        // (the first one is the catalog, the rest are scanned into it)
+        else {
+            if( catalog.empty() ) { catalog = arg.name();           }
+            else                  { inputs.push_back( arg.name() ); }
+        }
+    }
+
+    if( threads < 0 ) {
+        Messages::fatal_error("The number of threads must be a positive number.");
+    }
+    if( debounce < 0 ) {
+        Messages::fatal_error("The debounce time must be a number of milliseconds.");
+    }
+}
@@ -0,0 +1,82 @@
+/*
+| File    : ckindex_args.h
+| Purpose : The arguments of the `ckindex` command line
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 17, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKINDEX_ARGS_H_
+#define CKINDEX_ARGS_H_
+#include <iostream>
+#include <vector>
+#include "common.h"
+
+
+struct CkIndexArgs
+{
+// CONSTRUCTION/DESTRUCTION
+public:
+    CkIndexArgs(int argc, char* argv[]);
+    CkIndexArgs() = default;
+    CkIndexArgs(const CkIndexArgs&) = default;
+    CkIndexArgs(CkIndexArgs&&) noexcept = default;
+    ~CkIndexArgs() = default;
+
+// PUBLIC MEMBERS
+public:
+    String              catalog;                ///< The catalog file
+    std::vector<String> inputs;                 ///< Directories and files to add to the catalog
+    std::vector<String> names;                  ///< Tensor names, globs or /regexes/ to look for
+    String        shape       = "";             ///< Shape of the tensors to look for, e.g. "[4096,*]"
+    String        dtype       = "";             ///< Dtype of the tensors to look for
+    String        hash        = "";             ///< Structural or content hash of the files to look for
+    bool          update      = false;          ///< true = rescan the files already in the catalog
+    bool          content_hash = false;         ///< true = also hash the tensor data of new files
+    bool          watch       = false;          ///< true = keep the catalog current until interrupted
+    int           debounce    = 2000;           ///< Milliseconds without events before a file is read
+    bool          long_format = false;          ///< true = list the matching tensors of each file
+    bool          ndjson      = false;          ///< true = one JSON record per file
+    bool          stats       = false;          ///< true = print a summary of the catalog
+    int           threads     = 0;              ///< Number of files parsed at the same time (0 = default)
+    String        when_color  = "auto";         ///< When to use color in output
+    bool          help        = false;          ///< true = print usage and exit
+    bool          version     = false;          ///< true = print version and exit
+    const char * const help_message = nullptr;
+};
+
+/**
+ * Overloads the insertion operator (<<) for printing CkIndexArgs objects to an output stream.
+ *
+ * @param os   The output stream where the Args data will be printed.
+ * @param args The Args object being printed to the stream.
+ * @return A reference `os` for chaining.
+ */
+inline std::ostream&
+operator<<(std::ostream& os, const CkIndexArgs& args) {
+    os << "Args:"                                           << std::endl;
+    os << "  catalog: "      << args.catalog                << std::endl;
+    os << "  inputs: "       << args.inputs.size()          << std::endl;
+    os << "  names: "        << args.names.size()           << std::endl;
+    os << "  shape: "        << args.shape                  << std::endl;
+    os << "  dtype: "        << args.dtype                  << std::endl;
+    os << "  hash: "         << args.hash                   << std::endl;
+    os << "  update: "       << to_string(args.update)      << std::endl;
+    os << "  content_hash: " << to_string(args.content_hash) << std::endl;
+    os << "  watch: "        << to_string(args.watch)       << std::endl;
+    os << "  debounce: "     << args.debounce               << std::endl;
+    os << "  long_format: "  << to_string(args.long_format) << std::endl;
+    os << "  ndjson: "       << to_string(args.ndjson)      << std::endl;
+    os << "  stats: "        << to_string(args.stats)       << std::endl;
+    os << "  threads: "      << args.threads                << std::endl;
+    os << "  when_color: "   << args.when_color             << std::endl;
+    os << "  help: "         << to_string(args.help)        << std::endl;
+    os << "  version: "      << to_string(args.version);
+    return os;
+}
+
+#endif // CKINDEX_ARGS_H_
@@ -0,0 +1,19 @@
+/*
+| File    : main.cpp
+| Purpose : Main entry point for the `ckindex` command tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 17, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include "ckindex_args.h"
+#include "ckindex.h"
+
+int main(int argc, char* argv[]) {
+    CkIndexArgs args{argc, argv};
+    CkIndex     ckindex{args};
+    return ckindex.run();
+}
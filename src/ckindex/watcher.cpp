@@ -0,0 +1,143 @@
+/*
+| File    : watcher.cpp
+| Purpose : Reports the files that change under a set of directories.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 18, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <filesystem>      // for std::filesystem::recursive_directory_iterator
+#include "watcher.h"
+#ifdef __linux__
+#include <cerrno>          // for errno, EINTR
+#include <poll.h>          // for ::poll
+#include <sys/inotify.h>   // for ::inotify_init1, ::inotify_add_watch
+#include <unistd.h>        // for ::read, ::close
+#endif
+namespace fs = std::filesystem;
+
+#ifdef __linux__
+/// Events of the directories: files closed after writing, and entries
+/// created, moved or deleted (new directories are created empty, their
+/// files arrive with their own events once they are watched).
+static constexpr std::uint32_t WatchMask = IN_CLOSE_WRITE | IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_ONLYDIR;
+#endif
+
+//============================= CONSTRUCTION ==============================//
+
+DirectoryWatcher::~DirectoryWatcher() {
+#ifdef __linux__
+    if( _handle >= 0 ) { ::close(_handle); }
+#endif
+}
+
+/**
+ * Prepares the watcher.
+ *
+ * @return `false` if the system doesn't support it, with the reason in `error`.
+ */
+bool
+DirectoryWatcher::open(String& error) {
+#ifdef __linux__
+    _handle = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if( _handle < 0 ) { error = "Unable to create an inotify instance."; return false; }
+    return true;
+#else
+    error = "Watching directories is only supported on Linux.";
+    return false;
+#endif
+}
+
+//================================ WATCHING ===============================//
+
+/**
+ * Watches a directory and every directory under it.
+ *
+ * @param directory The root of the tree.
+ * @param files     If not null, receives a WRITTEN event for each file that
+ *                  is already in the tree (the tree was just created or
+ *                  moved in, so no event will report them).
+ * @return The number of directories added.
+ */
+size_t
+DirectoryWatcher::add_tree(const String& directory, std::vector<Event>* files) {
+    size_t added = 0;
+#ifdef __linux__
+    auto add = [&](const fs::path& path) {
+        const int watch = ::inotify_add_watch(_handle, path.c_str(), WatchMask);
+        if( watch < 0 ) { return; }
+        _directories[watch] = path.string();
+        ++added;
+    };
+    std::error_code errorCode;
+    add(directory);
+    const auto options = fs::directory_options::skip_permission_denied;
+    for( auto it = fs::recursive_directory_iterator(directory, options, errorCode) ; !errorCode && it != fs::recursive_directory_iterator() ; it.increment(errorCode) ) {
+        if( it->is_directory(errorCode) && !it->is_symlink(errorCode) ) { add(it->path()); }
+        else if( files && it->is_regular_file(errorCode) ) { files->push_back({ Change::WRITTEN, it->path().string() }); }
+    }
+#else
+    (void)directory; (void)files;
+#endif
+    return added;
+}
+
+/**
+ * Waits for changes and appends them to `events`.
+ *
+ * @param timeoutMilliseconds The longest wait, -1 = until there are changes.
+ * @param events              Receives the changes, in the order they happened;
+ *                            it may stay empty if the wait was interrupted by
+ *                            a signal or timed out.
+ * @return `false` if the watcher can't read the changes anymore.
+ */
+bool
+DirectoryWatcher::wait(int timeoutMilliseconds, std::vector<Event>& events) {
+#ifdef __linux__
+    pollfd request{ _handle, POLLIN, 0 };
+    const int ready = ::poll(&request, 1, timeoutMilliseconds);
+    if( ready < 0 ) { return errno == EINTR; }
+    if( ready == 0 ) { return true; }
+
+    alignas(inotify_event) char buffer[64 * 1024];
+    for( ;; ) {
+        const auto size = ::read(_handle, buffer, sizeof(buffer));
+        if( size < 0 ) { return errno == EAGAIN || errno == EINTR; }
+        if( size == 0 ) { return true; }
+        for( const char* next = buffer ; next < buffer + size ; ) {
+            const auto* event = reinterpret_cast<const inotify_event*>(next);
+            next += sizeof(inotify_event) + event->len;
+
+            if( event->mask & IN_Q_OVERFLOW ) { events.push_back({ Change::EVENTS_LOST, {} }); continue; }
+            if( event->mask & IN_IGNORED    ) { _directories.erase(event->wd); continue; }
+            const auto directory = _directories.find(event->wd);
+            if( directory == _directories.end() || event->len == 0 ) { continue; }
+            const String path = (fs::path(directory->second) / event->name).string();
+
+            if( event->mask & IN_ISDIR ) {
+                if( event->mask & (IN_CREATE | IN_MOVED_TO) ) { add_tree(path, &events); }
+                else if( event->mask & (IN_MOVED_FROM | IN_DELETE) ) {
+                    // the watches of a tree moved out would keep reporting it
+                    // from its new place, so they are removed
+                    const String prefix = path + "/";
+                    for( auto it = _directories.begin() ; it != _directories.end() ; ) {
+                        if( it->second == path || it->second.starts_with(prefix) ) {
+                            ::inotify_rm_watch(_handle, it->first);
+                            it = _directories.erase(it);
+                        } else { ++it; }
+                    }
+                    events.push_back({ Change::TREE_REMOVED, path });
+                }
+            }
+            else if( event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO) ) { events.push_back({ Change::WRITTEN, path }); }
+            else if( event->mask & (IN_MOVED_FROM | IN_DELETE)    ) { events.push_back({ Change::REMOVED, path }); }
+        }
+    }
+#else
+    (void)timeoutMilliseconds; (void)events;
+    return false;
+#endif
+}
@@ -0,0 +1,76 @@
+/*
+| File    : watcher.h
+| Purpose : Reports the files that change under a set of directories.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 18, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef WATCHER_H_
+#define WATCHER_H_
+#include <unordered_map>  // for std::unordered_map
+#include <vector>         // for std::vector
+#include "common.h"
+
+
+/**
+ * Watches directory trees with inotify and reports the files that were
+ * written, moved in, moved out or removed.
+ *
+ * Every directory of a tree needs its own watch, so a directory that is
+ * created or moved in is added (and the files already inside it reported)
+ * as soon as its event is read. A file is reported when it is closed after
+ * writing or renamed into place, never while it is being written, and the
+ * process sleeps in `wait()` until the kernel has events, so watching costs
+ * no CPU while the library doesn't change. Only available on Linux.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * DirectoryWatcher watcher;
+ * if( !watcher.open(error) ) { std::cerr << error; }
+ * watcher.add_tree("/srv/models");
+ * std::vector<DirectoryWatcher::Event> events;
+ * while( watcher.wait(-1, events) ) {
+ *     for( const auto& event : events ) { std::cout << event.path << std::endl; }
+ * }
+ * @endcode
+ */
+class DirectoryWatcher
+{
+public:
+    enum class Change {
+        WRITTEN,       ///< the file was written or moved in
+        REMOVED,       ///< the file was removed or moved out
+        TREE_REMOVED,  ///< the directory and everything under it
+        EVENTS_LOST    ///< the kernel dropped events, everything must be checked again
+    };
+    struct Event {
+        Change change;
+        String path;
+    };
+
+// CONSTRUCTION/DESTRUCTION
+public:
+    DirectoryWatcher() = default;
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+    ~DirectoryWatcher();
+    bool open(String& error);
+
+// WATCHING
+public:
+    size_t add_tree(const String& directory, std::vector<Event>* files = nullptr);
+    bool   wait(int timeoutMilliseconds, std::vector<Event>& events);
+    [[nodiscard]] size_t watch_count() const noexcept { return _directories.size(); }
+
+// IMPLEMENTATION
+private:
+    int                                  _handle = -1;
+    std::unordered_map<int, String>      _directories;  ///< the directory of each watch
+};
+
+#endif // WATCHER_H_
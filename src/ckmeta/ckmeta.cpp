@@ -0,0 +1,459 @@
+/*
+| File    : ckmeta.cpp
+| Purpose : The `ckmeta` command line tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 8, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm>     // for std::find_if, std::replace_if
+#include <charconv>      // for std::from_chars
+#include <chrono>        // for std::chrono::steady_clock
+#include <filesystem>    // for std::filesystem::path
+#include "table.h"
+#include "colors.h"
+#include "messages.h"
+#include "safetensors.h"
+#include "ckmeta.h"
+#ifdef _WIN32
+    inline bool is_terminal_output() { return true; }
+#else
+#include <unistd.h> // for "::isatty()" and STDOUT_FILENO
+    inline bool is_terminal_output() { return ::isatty(STDOUT_FILENO) != 0; }
+#endif
+namespace fs = std::filesystem;
+
+/// A .safetensors header that doesn't fit grows by whole pages, so the data
+/// section keeps its position inside a filesystem block and can be cloned.
+static constexpr std::uint64_t PageSize = 4096;
+
+/*
+  Journal of an in-place edit ('<file>.ckmeta-journal'):
+    [8 bytes: magic] [u64: size of the file] [u64: N] [N bytes: previous header]
+  The magic number is written (and synced) last, a journal without it is
+  incomplete and means the file was never touched.
+*/
+static constexpr StringView    JournalMagic      = "CKMJRNL1";
+static constexpr std::uint64_t JournalHeaderSize = 24;
+
+/**
+ * Flushes the directory entry of a file that was just created, renamed or
+ * removed, so the change survives a crash (no-op where directories can't
+ * be opened).
+ */
+static void
+_sync_directory(const String& path) {
+    File directory;
+    auto parent = fs::path(path).parent_path();
+    if( directory.open_read(parent.empty() ? String{"."} : parent.string()) ) { (void)directory.sync(); }
+}
+
+template <typename T>
+static String
+_encode_number(StringView text, bool& ok) {
+    T value{};
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    ok = result.ec == std::errc() && result.ptr == text.data() + text.size();
+    return String( reinterpret_cast<const char*>(&value), sizeof(value) );
+}
+
+static StringView
+_type_name(GgufFile::ValueType type) noexcept {
+    static constexpr StringView Names[] = {
+        "uint8", "int8", "uint16", "int16", "uint32", "int32", "float32", "bool", "string", "array", "uint64", "int64", "float64"
+    };
+    const auto index = static_cast<size_t>(type);
+    return index < std::size(Names) ? Names[index] : "unknown";
+}
+
+//============================= CONSTRUCTION ==============================//
+
+CkMeta::CkMeta(const CkMetaArgs& args)
+: _args(args)
+{}
+
+//================================ HELPERS ================================//
+
+void
+CkMeta::print_help() const noexcept {
+    std::cout << _args.help_message  << std::endl;
+}
+
+void
+CkMeta::print_version() const noexcept {
+    std::cout << "ckmeta (CheckpointTools ckmeta) " << PROJECT_VERSION << std::endl;
+}
+
+/**
+ * Returns the path of the journal used while the header of a file is edited in place.
+ */
+String
+CkMeta::journal_path(const String& path) {
+    return path + ".ckmeta-journal";
+}
+
+/**
+ * Encodes a value given as text with the binary representation of a GGUF type.
+ *
+ * @param type The type of the value (arrays are not supported).
+ * @param text The value as written by the user, e.g. "42", "0.5", "true".
+ * @param ok   Set to `false` if the text is not a valid value of that type.
+ * @return The encoded value, as stored in a GgufFile::KeyValue.
+ */
+String
+CkMeta::encode_value(GgufFile::ValueType type, StringView text, bool& ok) {
+    using ValueType = GgufFile::ValueType;
+    ok = true;
+    switch( type ) {
+        case ValueType::STRING:  return GgufFile::KeyValue::from_string({}, text).value;
+        case ValueType::UINT8:   return _encode_number<std::uint8_t >(text, ok);
+        case ValueType::INT8:    return _encode_number<std::int8_t  >(text, ok);
+        case ValueType::UINT16:  return _encode_number<std::uint16_t>(text, ok);
+        case ValueType::INT16:   return _encode_number<std::int16_t >(text, ok);
+        case ValueType::UINT32:  return _encode_number<std::uint32_t>(text, ok);
+        case ValueType::INT32:   return _encode_number<std::int32_t >(text, ok);
+        case ValueType::UINT64:  return _encode_number<std::uint64_t>(text, ok);
+        case ValueType::INT64:   return _encode_number<std::int64_t >(text, ok);
+        case ValueType::FLOAT32: return _encode_number<float >(text, ok);
+        case ValueType::FLOAT64: return _encode_number<double>(text, ok);
+        case ValueType::BOOL:
+            if( text == "true"  || text == "1" ) { return String(1, '\1'); }
+            if( text == "false" || text == "0" ) { return String(1, '\0'); }
+            break;
+        default:
+            break;
+    }
+    ok = false;
+    return {};
+}
+
+//================================= STEPS =================================//
+
+/**
+ * Rolls back an in-place edit that was interrupted, restoring the header
+ * saved in the journal of the file.
+ *
+ * @return `true` if a journal was found.
+ */
+bool
+CkMeta::recover_journal(const String& path) const {
+    const String journalPath = journal_path(path);
+    std::error_code errorCode;
+    if( !fs::exists(journalPath, errorCode) ) { return false; }
+    if( _args.dry_run ) {
+        Messages::warning("The last edit of '" + path + "' was interrupted, it will be rolled back.");
+        return true;
+    }
+
+    File          journal;
+    char          magic[JournalMagic.size()];
+    std::uint64_t fields[2]; // file size, header size
+    const bool isComplete = journal.open_read(journalPath)                &&
+                            journal.read_at(magic, sizeof(magic), 0)      &&
+                            StringView{magic, sizeof(magic)} == JournalMagic &&
+                            journal.read_at(fields, sizeof(fields), sizeof(magic));
+    if( isComplete ) {
+        File file;
+        if( !file.open_read_write(path) || file.size() != fields[0] || fields[1] > fields[0] ) {
+            Messages::fatal_error("The journal of an interrupted edit doesn't match the file.", {
+                "File: " + path, "Journal: " + journalPath, "Check the file and remove the journal manually." });
+        }
+        String previous(fields[1], '\0');
+        if( !journal.read_at(previous.data(), previous.size(), JournalHeaderSize) ||
+            !file.write_at(previous.data(), previous.size(), 0) || !file.sync() )
+        {
+            Messages::fatal_error("Unable to restore the header saved in the journal.", {
+                "File: " + path, "Journal: " + journalPath });
+        }
+        Messages::warning("The last edit of '" + path + "' was interrupted, its previous header was restored.");
+    }
+    journal.close();
+    fs::remove(journalPath, errorCode);
+    _sync_directory(journalPath);
+    return true;
+}
+
+/**
+ * Applies the edits to the metadata of a .safetensors file and builds its new header.
+ *
+ * The JSON is padded with spaces up to the current data offset when it fits.
+ * Otherwise the header grows by whole pages, which leaves room for the next
+ * edits and keeps the data section in the same position inside a page.
+ */
+CkMeta::Layout
+CkMeta::plan_safetensors(const String& path) const {
+    ReadError readError = ReadError::None;
+    auto safetensors = SafetensorsFile::from_file(path, readError);
+    if( readError != ReadError::None ) { Messages::fatal_read_error(readError, path); }
+
+    Layout layout;
+    auto   metadata = safetensors.metadata();
+    for( const auto& edit : _args.edits ) {
+        auto it = std::find_if(metadata.begin(), metadata.end(), [&](const auto& pair) { return pair.first == edit.key; });
+        if( edit.remove ) {
+            if( it == metadata.end() ) { Messages::warning("The key '" + edit.key + "' doesn't exist in '" + path + "'."); continue; }
+            metadata.erase(it);
+            layout.changes.push_back({ "delete", edit.key, "" });
+        }
+        else if( it == metadata.end() ) {
+            metadata.emplace_back(edit.key, edit.value);
+            layout.changes.push_back({ "add", edit.key, edit.value });
+        }
+        else if( it->second != edit.value ) {
+            it->second = edit.value;
+            layout.changes.push_back({ "set", edit.key, edit.value });
+        }
+    }
+
+    std::error_code errorCode;
+    layout.dataOffset = safetensors.data_offset();
+    layout.fileSize   = fs::file_size(path, errorCode);
+
+    String header = SafetensorsFile::build_header(safetensors.tensors(), metadata);
+    while( header.back() == ' ' ) { header.pop_back(); }
+    std::uint64_t dataOffset = layout.dataOffset;
+    if( header.size() > dataOffset ) { dataOffset += align_up(header.size() - dataOffset, PageSize); }
+    header.resize(dataOffset, ' ');
+
+    std::uint64_t headerSize = dataOffset - 8;
+    for( int i=0 ; i<8 ; ++i ) {
+        header[i] = static_cast<char>(headerSize & 0xFF);
+        headerSize >>= 8;
+    }
+    layout.header  = std::move(header);
+    layout.inPlace = dataOffset == layout.dataOffset && !_args.rewrite && _args.output.empty();
+    return layout;
+}
+
+/**
+ * Applies the edits to the key/value pairs of a .gguf file and builds its new header.
+ *
+ * The data section starts at the first aligned offset after the header, so
+ * the edit can only be done in place if the new header ends inside the same
+ * alignment block as the current one.
+ */
+CkMeta::Layout
+CkMeta::plan_gguf(const String& path) const {
+    ReadError readError = ReadError::None;
+    auto gguf = GgufFile::from_file(path, readError);
+    if( readError != ReadError::None ) { Messages::fatal_read_error(readError, path); }
+
+    Layout layout;
+    auto   metadata = gguf.metadata();
+    for( const auto& edit : _args.edits ) {
+        if( edit.key == "general.alignment" ) {
+            Messages::fatal_error("The key 'general.alignment' can't be edited.", {
+                "It defines the position of the tensor data in the file." });
+        }
+        auto it = std::find_if(metadata.begin(), metadata.end(), [&](const auto& keyValue) { return keyValue.key == edit.key; });
+        if( edit.remove ) {
+            if( it == metadata.end() ) { Messages::warning("The key '" + edit.key + "' doesn't exist in '" + path + "'."); continue; }
+            metadata.erase(it);
+            layout.changes.push_back({ "delete", edit.key, "" });
+        }
+        else if( it == metadata.end() ) {
+            metadata.push_back( GgufFile::KeyValue::from_string(edit.key, edit.value) );
+            layout.changes.push_back({ "add", edit.key, edit.value });
+        }
+        else {
+            bool ok;
+            auto value = encode_value(it->type, edit.value, ok);
+            if( !ok ) {
+                Messages::fatal_error("Invalid value '" + edit.value + "' for the key '" + edit.key + "'.", {
+                    "The key holds a value of type '" + String{ _type_name(it->type) } + "' in '" + path + "'." });
+            }
+            if( value != it->value ) {
+                it->value = std::move(value);
+                layout.changes.push_back({ "set", edit.key, edit.value });
+            }
+        }
+    }
+
+    std::error_code errorCode;
+    layout.dataOffset = gguf.data_offset();
+    layout.fileSize   = fs::file_size(path, errorCode);
+    layout.header     = GgufFile::build_header(gguf.tensors(), metadata, gguf.alignment());
+    layout.inPlace    = layout.header.size() == layout.dataOffset && !_args.rewrite && _args.output.empty();
+    return layout;
+}
+
+/**
+ * Prints the keys that change and how the new header will be written.
+ */
+void
+CkMeta::print_layout(const String& path, const Layout& layout) const {
+    static const int MaxWidth = 50;
+    auto& c = Colors::instance();
+
+    std::cout << c.info() << "File      : " << c.reset() << path << std::endl;
+    if( layout.changes.empty() ) {
+        std::cout << c.info() << "Changes   : " << c.reset() << "none, the metadata already has these values" << std::endl;
+        return;
+    }
+    Table table;
+    table.set_styles({ {c.data2(), c.reset()}, {c.primary(), c.reset()}, {c.data(), c.reset()} });
+    for( const auto& change : layout.changes ) {
+        auto value = change.value;
+        if( value.length() > MaxWidth ) { value = value.substr(0, MaxWidth-3) + "..."; }
+        std::replace_if(value.begin(), value.end(), [](char ch) { return ch == '\n' || ch == '\r' || ch == '\t'; }, ' ');
+        table.add_row({ change.action, change.key, value });
+    }
+    std::cout << table;
+    std::cout << c.info() << "Header    : " << c.reset() << to_human_size(layout.dataOffset) << " -> "
+              << to_human_size(layout.header.size())
+              << (layout.inPlace ? ", rewritten in place" : ", written to a new file") << std::endl;
+}
+
+/**
+ * Overwrites the header of a file with the new one, which has exactly the
+ * same size.
+ *
+ * The previous header is saved in a journal first, so if the process or the
+ * system dies while the header is being written, `recover_journal()` can
+ * restore it; the journal is removed once the new header is on disk.
+ */
+void
+CkMeta::write_in_place(const String& path, const Layout& layout) const {
+    File file;
+    if( !file.open_read_write(path) ) { Messages::fatal_error("Unable to open the file for writing.", { "File: " + path }); }
+
+    String previous(layout.dataOffset, '\0');
+    if( !file.read_at(previous.data(), previous.size(), 0) ) { Messages::fatal_read_error(ReadError::MissingData, path); }
+
+    // 1) save the current header
+    const String        journalPath = journal_path(path);
+    const std::uint64_t fields[2]   = { layout.fileSize, previous.size() };
+    File journal;
+    if( !journal.create(journalPath)                                                  ||
+        !journal.write_at(fields, sizeof(fields), JournalMagic.size())                ||
+        !journal.write_at(previous.data(), previous.size(), JournalHeaderSize)        ||
+        !journal.sync()                                                               ||
+        !journal.write_at(JournalMagic.data(), JournalMagic.size(), 0)                ||
+        !journal.sync() )
+    {
+        std::error_code errorCode;
+        journal.close();
+        fs::remove(journalPath, errorCode);
+        Messages::fatal_error("Unable to write the journal file.", { "File: " + journalPath });
+    }
+    journal.close();
+    _sync_directory(journalPath);
+
+    // 2) replace it
+    if( !file.write_at(layout.header.data(), layout.header.size(), 0) || !file.sync() ) {
+        Messages::fatal_error("Unable to write the new header.", {
+            "File: " + path, "The previous header will be restored the next time ckmeta opens the file." });
+    }
+    file.close();
+
+    // 3) the edit is complete
+    std::error_code errorCode;
+    fs::remove(journalPath, errorCode);
+    _sync_directory(journalPath);
+}
+
+/**
+ * Writes the new header followed by the data section of the current file
+ * into a temporary file, then renames it over the current one (or to the
+ * --output path). The original file is untouched until the rename.
+ *
+ * @return How the data section was transferred.
+ */
+File::CopyMethod
+CkMeta::write_new_file(const String& path, const Layout& layout) const {
+    const String target   = _args.output.empty() ? path : _args.output;
+    const String partPath = target + ".part";
+    std::error_code errorCode;
+
+    File input, output;
+    if( !input.open_read(path) ) { Messages::fatal_read_error(ReadError::FileNotFound, path); }
+    if( !output.create(partPath) ) { Messages::fatal_error("Unable to create the output file.", { "File: " + partPath }); }
+
+    auto method = File::CopyMethod::NONE;
+    const std::uint64_t dataSize = layout.fileSize - layout.dataOffset;
+    if( !output.write_at(layout.header.data(), layout.header.size(), 0)                          ||
+        !output.copy_from(input, layout.dataOffset, dataSize, layout.header.size(), &method)     ||
+        !output.sync() )
+    {
+        output.close();
+        fs::remove(partPath, errorCode);
+        Messages::fatal_error("Unable to write the output file.", { "File: " + partPath });
+    }
+    output.close();
+
+    if( _args.output.empty() ) { fs::permissions(partPath, fs::status(path, errorCode).permissions(), errorCode); }
+    fs::rename(partPath, target, errorCode);
+    if( errorCode ) { Messages::fatal_error("Unable to rename the output file.", { "File: " + target }); }
+    _sync_directory(target);
+    return method;
+}
+
+//================================ RUNNING ================================//
+
+int
+CkMeta::run() {
+
+    // if the color option is set to "auto", disable colors when outputting to a non-terminal
+    if( _args.when_color == "auto" || _args.when_color == "tty" || _args.when_color == "if-tty" ) {
+        if( !is_terminal_output() ) { Colors::instance().disable_colors(); }
+    }
+    // if the color option is set to "never", disable colors regardless of output type
+    else if ( _args.when_color == "never" || _args.when_color == "no" || _args.when_color == "none") {
+        Colors::instance().disable_colors();
+    }
+
+    // if help was requested, show the help message and exit
+    if( _args.help ) { print_help(); return 0; }
+
+    // if version was requested, show the version and exit
+    if( _args.version ) { print_version(); return 0; }
+
+    // if the user didn't provide any file, show an error message and exit
+    if( _args.inputs.empty() ) {
+        Messages::fatal_error("No file provided. Please specify one or more .safetensors or .gguf files.", {
+            "To get help on how to use this tool, run: ckmeta --help"
+        });
+    }
+    if( _args.edits.empty() ) {
+        Messages::fatal_error("No changes provided.", {
+            "Use --set KEY=VALUE or --delete KEY to edit the metadata,",
+            "or run `ckshow --metadata FILE` to list it."
+        });
+    }
+
+    auto& c = Colors::instance();
+    for( size_t i=0 ; i<_args.inputs.size() ; ++i ) {
+        const auto& path  = _args.inputs[i];
+        const auto  start = std::chrono::steady_clock::now();
+        if( i > 0 ) { std::cout << std::endl; }
+
+        recover_journal(path);
+        const auto layout = GgufFile::is_gguf_file(path) ? plan_gguf(path) : plan_safetensors(path);
+        print_layout(path, layout);
+        if( _args.dry_run || (layout.changes.empty() && _args.output.empty()) ) { continue; }
+
+        String data;
+        if( layout.inPlace ) {
+            write_in_place(path, layout);
+            data = "untouched";
+        }
+        else {
+            const auto size = to_human_size(layout.fileSize - layout.dataOffset);
+            switch( write_new_file(path, layout) ) {
+                case File::CopyMethod::CLONE:         data = size + " cloned (reflink)";        break;
+                case File::CopyMethod::KERNEL_COPY:   data = size + " copied by the kernel";   break;
+                case File::CopyMethod::BUFFERED_COPY: data = size + " copied";                 break;
+                case File::CopyMethod::NONE:          data = "empty";                          break;
+            }
+        }
+        const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        char elapsed[32];
+        std::snprintf(elapsed, sizeof(elapsed), "%.2f ms", milliseconds);
+        std::cout << c.info() << "Data      : " << c.reset() << data << std::endl
+                  << c.info() << "Elapsed   : " << c.reset() << elapsed << std::endl;
+    }
+    return 0;
+}
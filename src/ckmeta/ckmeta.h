@@ -0,0 +1,67 @@
+/*
+| File    : ckmeta.h
+| Purpose : The `ckmeta` command line tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 8, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKMETA_H_
+#define CKMETA_H_
+#include <vector>
+#include "common.h"
+#include "file.h"          // for File
+#include "gguf.h"          // for GgufFile
+#include "ckmeta_args.h"   // for CkMetaArgs
+
+
+class CkMeta
+{
+public:
+    /// One key that changes, as shown to the user.
+    struct Change {
+        String action; ///< "add", "set" or "delete"
+        String key;
+        String value;
+    };
+
+    /// The new header of a file and where it goes.
+    struct Layout {
+        std::vector<Change> changes;
+        String              header;          ///< every byte before the data section
+        std::uint64_t       dataOffset = 0;  ///< current start of the data section
+        std::uint64_t       fileSize   = 0;  ///< current size of the file
+        bool                inPlace    = false; ///< true = `header` replaces the current one byte for byte
+    };
+
+// MAIN
+public:
+    CkMeta(const CkMetaArgs& args);
+    [[nodiscard]] int run();
+
+// STEPS
+public:
+    bool   recover_journal(const String& path) const;
+    Layout plan_safetensors(const String& path) const;
+    Layout plan_gguf(const String& path) const;
+    void   print_layout(const String& path, const Layout& layout) const;
+    void   write_in_place(const String& path, const Layout& layout) const;
+    File::CopyMethod write_new_file(const String& path, const Layout& layout) const;
+
+// HELPERS
+public:
+    [[nodiscard]] static String journal_path(const String& path);
+    [[nodiscard]] static String encode_value(GgufFile::ValueType type, StringView text, bool& ok);
+    void print_help() const noexcept;
+    void print_version() const noexcept;
+
+// IMPLEMENTATION
+private:
+    const CkMetaArgs _args;
+};
+
+#endif // CKMETA_H_
@@ -0,0 +1,138 @@
+/*
+| File    : ckmeta_args.cpp
+| Purpose : The arguments of the `ckmeta` command line
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 8, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <string>   // for std::string
+#include "common.h"
+#include "ckmeta_args.h"
+#include "argument.h"
+#include "messages.h"
+#include "file.h"
+
+
+static CkMetaArgs::Edit
+_parse_set(const String& value) {
+    const auto equal = value.find('=');
+    if( equal == String::npos || equal == 0 ) {
+        Messages::fatal_error("Invalid assignment: '" + value + "'.", {
+            "The expected format is KEY=VALUE, e.g. 'modelspec.license=MIT'." });
+    }
+    return { value.substr(0, equal), value.substr(equal + 1) };
+}
+
+static CkMetaArgs::Edit
+_parse_set_file(const String& value) {
+    auto edit = _parse_set(value);
+    File file;
+    const String path = edit.value;
+    if( !file.open_read(path) ) {
+        Messages::fatal_error("Unable to open the file '" + path + "'.", {
+            "The expected format is KEY=FILE, e.g. 'modelspec.license=LICENSE.txt'." });
+    }
+    edit.value.assign(file.size(), '\0');
+    if( !file.read_at(edit.value.data(), edit.value.size(), 0) ) {
+        Messages::fatal_error("Unable to read the file '" + path + "'.");
+    }
+    return edit;
+}
+
+//============================= CONSTRUCTION ==============================//
+
+/**
+ * Constructs a new CkMetaArgs object by parsing command line arguments.
+ *
+ * @param argc The number of command line arguments passed to the program.
+ * @param argv An array of C strings representing the command line arguments.
+ */
+CkMetaArgs::CkMetaArgs(int argc, char* argv[])
+: help_message{R"(
+Usage: ckmeta [OPTIONS] file...
+
+  Edits the metadata of .safetensors files (the "__metadata__" entry of the
+  header) and .gguf files (the key/value pairs) without rewriting the
+  tensor data.
+
+  When the new header fits in the space of the current one (for
+  .safetensors, including the trailing spaces that pad the JSON), only the
+  header bytes are rewritten, in place. A copy of the old header is kept in
+  '<file>.ckmeta-journal' until the new one is on disk, so an interrupted
+  edit is rolled back the next time ckmeta opens the file.
+
+  Otherwise a new file is written next to the original and renamed over it:
+  the new header followed by the data section, which is cloned (reflink on
+  Btrfs, XFS, ...) or copied by the kernel. New .safetensors headers get
+  extra room so later edits fit in place. The data section of a .gguf file
+  starts right after its header, so a .gguf header that changes its size
+  usually needs a real copy.
+
+  Values of .safetensors files are always strings. In .gguf files an
+  existing key keeps its type (string, integer, float or bool) and new
+  keys are strings; array values can't be edited.
+
+  OPTIONS:
+    -s, --set <KEY=VALUE>       Set a key, adding it if it doesn't exist
+    --set-file <KEY=FILE>       Set a key to the content of a text file
+    -d, --delete <KEY>          Delete a key
+    -o, --output <FILE>         Write the edited file here, leaving the input untouched
+    --rewrite                   Always write a new file, even if the header fits in place
+    --dry-run                   Print what would be done without writing anything
+
+    --nc, --no-color            Disable color output.
+    -h  , --help                Show this help message and exit.
+    -v  , --version             Show version information and exit.
+
+  Examples:
+    ckmeta --set modelspec.license=MIT 'model.safetensors'
+    ckmeta --set-file modelspec.description=README.md --delete training_args 'model.safetensors'
+    ckmeta --set general.name='My Model' 'model-Q4_K.gguf'
+    ckmeta --set modelspec.author=me model-0000*-of-00004.safetensors
+)"}
+{
+    for( int i=1 ; i < argc ; ++i )
+    {
+        auto arg = Argument{i, argc, argv};
+
+        // parse the options
+        if( arg.is_option() ) {
+        //-EDITS:
+            if     (arg.is( "-s", "--set"        )) { edits.push_back( _parse_set(arg.value(i)) ); }
+            else if(arg.is(       "--set-file"   )) { edits.push_back( _parse_set_file(arg.value(i)) ); }
+            else if(arg.is( "-d", "--delete"     )) { edits.push_back({ arg.value(i), "", true }); }
+        //-OUTPUT:
+            else if(arg.is( "-o", "--output"     )) { output  = arg.value(i); }
+            else if(arg.is(       "--rewrite"    )) { rewrite = true; }
+            else if(arg.is(       "--dry-run"    )) { dry_run = true; }
+        //-EXTRA:
+            else if(arg.is( "-h", "--help"       )) { help = true; }
+            else if(arg.is( "-v", "--version"    )) { version = true; }
+            else if(arg.is( "--color"            )) { when_color = arg.value(i);  }
+            else if(arg.is( "--nc", "--no-color" )) { when_color = "never"; }
+            else {
+                // if an unknown argument is encountered, display a fatal error message
+                Messages::fatal_error( "Unknown argument: " + arg.name(), {
+                    "Try `ckmeta --help` for more information." });
+            }
+            // check if the user provided a value that was not consumed by the option
+            if( arg.has_value() && !arg.was_value_consumed() ) {
+                Messages::fatal_error( "The argument '"+ arg.name() +"' no expects a value and '"+ arg.value(i) +"' was provided.", {
+                    "Try `ckmeta --help` for more information." });
+            }
+        }
+        // handle positional arguments, arguments without a preceding hyphen
+        // (every positional argument is a file to edit)
+        else {
+            inputs.push_back( arg.name() );
+        }
+    }
+
+    if( !output.empty() && inputs.size() > 1 ) {
+        Messages::fatal_error("--output can only be used with a single input file.");
+    }
+}
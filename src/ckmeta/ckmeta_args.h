@@ -0,0 +1,71 @@
+/*
+| File    : ckmeta_args.h
+| Purpose : The arguments of the `ckmeta` command line
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 8, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKMETA_ARGS_H_
+#define CKMETA_ARGS_H_
+#include <iostream>
+#include <vector>
+#include "common.h"
+
+
+struct CkMetaArgs
+{
+    /// One change to the metadata, applied in the order given on the command line.
+    struct Edit {
+        String key;
+        String value;
+        bool   remove = false; ///< true = delete the key (`value` is unused)
+    };
+
+// CONSTRUCTION/DESTRUCTION
+public:
+    CkMetaArgs(int argc, char* argv[]);
+    CkMetaArgs() = default;
+    CkMetaArgs(const CkMetaArgs&) = default;
+    CkMetaArgs(CkMetaArgs&&) noexcept = default;
+    ~CkMetaArgs() = default;
+
+// PUBLIC MEMBERS
+public:
+    std::vector<String> inputs;                 ///< The files to edit (.safetensors or .gguf)
+    std::vector<Edit>   edits;                  ///< The changes to apply to every file
+    String        output      = "";             ///< Write the edited file here instead of in place
+    bool          rewrite     = false;          ///< true = never edit the header in place
+    String        when_color  = "auto";         ///< When to use color in output
+    bool          dry_run     = false;          ///< true = only print what would be done
+    bool          help        = false;          ///< true = print usage and exit
+    bool          version     = false;          ///< true = print version and exit
+    const char * const help_message = nullptr;
+};
+
+/**
+ * Overloads the insertion operator (<<) for printing CkMetaArgs objects to an output stream.
+ *
+ * @param os   The output stream where the Args data will be printed.
+ * @param args The Args object being printed to the stream.
+ * @return A reference `os` for chaining.
+ */
+inline std::ostream&
+operator<<(std::ostream& os, const CkMetaArgs& args) {
+    os << "Args:"                                          << std::endl;
+    os << "  inputs: "      << args.inputs.size()          << std::endl;
+    os << "  edits: "       << args.edits.size()           << std::endl;
+    os << "  output: "      << args.output                 << std::endl;
+    os << "  rewrite: "     << to_string(args.rewrite)     << std::endl;
+    os << "  when_color: "  << args.when_color             << std::endl;
+    os << "  dry_run: "     << to_string(args.dry_run)     << std::endl;
+    os << "  help: "        << to_string(args.help)        << std::endl;
+    os << "  version: "     << to_string(args.version);
+    return os;
+}
+
+#endif // CKMETA_ARGS_H_
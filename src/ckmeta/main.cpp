@@ -0,0 +1,19 @@
+/*
+| File    : main.cpp
+| Purpose : Main entry point for the `ckmeta` command tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 8, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include "ckmeta_args.h"
+#include "ckmeta.h"
+
+int main(int argc, char* argv[]) {
+    CkMetaArgs args{argc, argv};
+    CkMeta     ckmeta{args};
+    return ckmeta.run();
+}
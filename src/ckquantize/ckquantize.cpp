@@ -0,0 +1,612 @@
+/*
+| File    : ckquantize.cpp
+| Purpose : The `ckquantize` command line tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 6, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm>     // for std::any_of, std::count_if, std::max, std::min, std::mismatch, std::reverse
+#include <chrono>        // for std::chrono::steady_clock
+#include <cstring>       // for std::memcmp, std::memcpy
+#include <filesystem>    // for std::filesystem::path
+#include <map>           // for std::map
+#include <mutex>         // for std::mutex
+#include <unordered_map> // for std::unordered_map
+#include <unordered_set> // for std::unordered_set
+#include <tin/tensormap.h>
+#include "table.h"
+#include "colors.h"
+#include "messages.h"
+#include "file.h"
+#include "minifloat.h"
+#include "parallel.h"
+#include "safetensors.h"
+#include "quants.h"
+#include "ckquantize.h"
+#ifdef _WIN32
+    inline bool is_terminal_output() { return true; }
+#else
+#include <unistd.h> // for "::isatty()" and STDOUT_FILENO
+    inline bool is_terminal_output() { return ::isatty(STDOUT_FILENO) != 0; }
+#endif
+namespace fs = std::filesystem;
+using tin::TensorMap;
+using tin::SortBy;
+
+/// Keys of the input metadata that are regenerated for the output file.
+static constexpr StringView RegeneratedKeys[] = {
+    "general.alignment", "general.file_type", "general.quantization_version"
+};
+
+
+//============================= CONSTRUCTION ==============================//
+
+CkQuantize::CkQuantize(const CkQuantizeArgs& args)
+: _args(args)
+{}
+
+//================================ HELPERS ================================//
+
+void
+CkQuantize::print_help() const noexcept {
+    std::cout << _args.help_message  << std::endl;
+}
+
+void
+CkQuantize::print_version() const noexcept {
+    std::cout << "ckquantize (CheckpointTools ckquantize) " << PROJECT_VERSION << std::endl;
+}
+
+/**
+ * Returns true if tensors of the given dtype can be decoded and quantized.
+ */
+bool
+CkQuantize::is_convertible(StringView dtype) noexcept {
+    return dtype == "F32" || dtype == "F16" || dtype == "BF16" || dtype == "F64" ||
+           dtype == "F8_E4M3" || dtype == "F8_E5M2";
+}
+
+/**
+ * Converts `count` elements of a floating point dtype to float.
+ * (the input may be unaligned, so elements are loaded with memcpy)
+ */
+void
+CkQuantize::to_float(StringView dtype, const char* input, float* output, size_t count) {
+    if( dtype == "F32" ) {
+        std::memcpy(output, input, count * sizeof(float));
+    }
+    else if( dtype == "F16" || dtype == "BF16" ) {
+        const bool isBF16 = dtype == "BF16";
+        for( size_t i=0 ; i<count ; ++i ) {
+            std::uint16_t bits; std::memcpy(&bits, input + 2*i, sizeof(bits));
+            output[i] = isBF16 ? bf16_to_float(bits) : f16_to_float(bits);
+        }
+    }
+    else if( dtype == "F64" ) {
+        for( size_t i=0 ; i<count ; ++i ) {
+            double value; std::memcpy(&value, input + 8*i, sizeof(value));
+            output[i] = static_cast<float>(value);
+        }
+    }
+    else if( dtype == "F8_E4M3" ) {
+        for( size_t i=0 ; i<count ; ++i ) { output[i] = f8_e4m3_to_float(static_cast<std::uint8_t>(input[i])); }
+    }
+    else if( dtype == "F8_E5M2" ) {
+        for( size_t i=0 ; i<count ; ++i ) { output[i] = f8_e5m2_to_float(static_cast<std::uint8_t>(input[i])); }
+    }
+}
+
+/**
+ * Returns the value of "general.file_type" (llama_ftype) for a file whose
+ * tensors are mostly of the given ggml type.
+ */
+std::uint32_t
+CkQuantize::file_type(std::uint32_t type) noexcept {
+    switch( type ) {
+        case ggml_type::F32:  return 0;
+        case ggml_type::F16:  return 1;
+        case ggml_type::Q4_0: return 2;
+        case ggml_type::Q8_0: return 7;
+        case ggml_type::Q4_K: return 14;
+        case ggml_type::Q6_K: return 18;
+        case ggml_type::BF16: return 32;
+        default:              return 0;
+    }
+}
+
+/**
+ * Returns the ggml type a source tensor is converted to.
+ *
+ * The first override matching the tensor name wins. Without an override,
+ * one-dimensional tensors (norms, biases) stay in F32 as llama.cpp expects.
+ * Rows that are not a multiple of the block size can't be quantized with
+ * that type, so a type with smaller blocks is used instead.
+ */
+std::uint32_t
+CkQuantize::target_type(const SourceTensor& tensor) const {
+    if( !is_convertible(tensor.dtype) ) { return GgufFile::type_from_name(tensor.dtype); }
+
+    std::uint32_t type       = _args.type;
+    bool          overridden = false;
+    for( const auto& typeOverride : _args.overrides ) {
+        if( matches_glob(typeOverride.pattern, tensor.name) ) {
+            type       = typeOverride.type;
+            overridden = true;
+            break;
+        }
+    }
+    if( !overridden && tensor.shape.size() <= 1 ) { return ggml_type::F32; }
+
+    const std::uint64_t rowLength = tensor.shape.empty() ? 1 : tensor.shape[0];
+    while( rowLength % GgufFile::type_block_size(type) != 0 ) {
+        switch( type ) {
+            case ggml_type::Q4_K: type = ggml_type::Q4_0; break;
+            case ggml_type::Q6_K: type = ggml_type::Q8_0; break;
+            default:              type = ggml_type::F16;  break;
+        }
+    }
+    return type;
+}
+
+/**
+ * Returns the path of the output file, '<NAME>-<TYPE>.gguf' next to the
+ * first input unless one was given with --output. (for the FP8 export it
+ * is the output directory, '<NAME>-F8_E4M3')
+ */
+String
+CkQuantize::output_path() const {
+    if( !_args.output.empty() ) { return _args.output; }
+    const fs::path input = _args.inputs.front();
+    String name = input.filename().string();
+    for( StringView extension : { ".safetensors.index.json", ".safetensors", ".gguf" } ) {
+        if( name.ends_with(extension) ) { name.resize(name.size() - extension.size()); break; }
+    }
+    if( _args.type == CkQuantizeArgs::F8_E4M3 ) { return (input.parent_path() / (name + "-F8_E4M3")).string(); }
+    return (input.parent_path() / (name + "-" + String{ GgufFile::type_name(_args.type) } + ".gguf")).string();
+}
+
+//================================= STEPS =================================//
+
+/**
+ * Reads the layout of one input file, or of every shard listed in an index file.
+ */
+void
+CkQuantize::_add_input(const String& path) {
+    ReadError readError;
+
+    // an index file lists the shards in its "weight_map"
+    if( path.ends_with(".json") ) {
+        _indexName = fs::path(path).filename().string();
+        auto shardPaths = SafetensorsFile::shards_of_index(path, readError);
+        if( readError == ReadError::InvalidFormat ) {
+            Messages::fatal_error("Invalid index file, no 'weight_map' found.", { "File: " + path });
+        }
+        if( readError != ReadError::None ) { Messages::fatal_read_error(readError, path); }
+        for( const auto& shardPath : shardPaths ) { _add_input(shardPath); }
+        return;
+    }
+
+    const size_t source = _inputPaths.size();
+    _inputPaths.push_back(path);
+    _inputMetadata.emplace_back();
+
+    // a GGUF input provides the tensors and key/values as they are
+    if( GgufFile::is_gguf_file(path) ) {
+        if( _args.inputs.size() > 1 ) {
+            Messages::fatal_error("A .gguf file can't be combined with other inputs.", { "File: " + path });
+        }
+        auto gguf = GgufFile::from_file(path, readError);
+        if( readError != ReadError::None ) { Messages::fatal_read_error(readError, path); }
+        for( const auto& tensor : gguf.tensors() ) {
+            _tensors.push_back({ tensor.name, String{ GgufFile::type_name(tensor.type) }, tensor.shape,
+                                 source, gguf.data_offset() + tensor.offset, tensor.size });
+        }
+        for( const auto& keyValue : gguf.metadata() ) {
+            if( std::find(std::begin(RegeneratedKeys), std::end(RegeneratedKeys), keyValue.key) != std::end(RegeneratedKeys) ) { continue; }
+            _metadata.push_back(keyValue);
+            if( keyValue.type == GgufFile::ValueType::STRING ) { _inputMetadata.back().emplace_back(keyValue.key, keyValue.as_string()); }
+        }
+        return;
+    }
+
+    // safetensors shapes are row-major, ggml lists the innermost dimension first
+    auto safetensors = SafetensorsFile::from_file(path, readError);
+    if( readError != ReadError::None ) { Messages::fatal_read_error(readError, path); }
+    for( const auto& tensor : safetensors.tensors() ) {
+        if( tensor.is_padding() ) { continue; }
+        auto shape = tensor.shape;
+        std::reverse(shape.begin(), shape.end());
+        if( shape.empty() ) { shape.push_back(1); }
+        _tensors.push_back({ tensor.name, tensor.dtype, std::move(shape),
+                             source, safetensors.data_offset() + tensor.begin, tensor.size() });
+    }
+    _inputMetadata.back() = safetensors.metadata();
+    if( source == 0 ) {
+        for( const auto& [key, value] : safetensors.metadata() ) {
+            _metadata.push_back( GgufFile::KeyValue::from_string(key, value) );
+        }
+    }
+}
+
+/**
+ * Reads the layout of every input file and collects all their tensors.
+ */
+void
+CkQuantize::load_inputs() {
+    for( const auto& path : _args.inputs ) { _add_input(path); }
+
+    std::unordered_set<StringView> names;
+    for( const auto& tensor : _tensors ) {
+        if( !names.insert(tensor.name).second ) {
+            Messages::fatal_error("The tensor '" + tensor.name + "' is present in more than one input file.");
+        }
+        if( !is_convertible(tensor.dtype) && GgufFile::type_from_name(tensor.dtype) == GgufFile::UnknownType ) {
+            Messages::fatal_error("The tensor '" + tensor.name + "' has an unsupported dtype: " + tensor.dtype + ".", {
+                "Only floating point, signed integer and ggml quantized tensors can be stored in GGUF." });
+        }
+    }
+}
+
+/**
+ * Chooses the type of every tensor and computes the layout of the output file.
+ */
+CkQuantize::Plan
+CkQuantize::plan_quantization() const {
+    Plan plan;
+    plan.tensors.reserve(_tensors.size());
+    plan.sources.reserve(_tensors.size());
+    for( size_t i=0 ; i<_tensors.size() ; ++i ) {
+        const auto& source = _tensors[i];
+        std::uint64_t numberOfElements = 1;
+        for( const auto dimension : source.shape ) { numberOfElements *= dimension; }
+
+        GgufFile::Tensor tensor;
+        tensor.name   = source.name;
+        tensor.shape  = source.shape;
+        tensor.type   = target_type(source);
+        tensor.offset = align_up(plan.dataSize, _args.alignment);
+        tensor.size   = GgufFile::type_size(tensor.type, numberOfElements);
+        plan.dataSize   = tensor.offset + tensor.size;
+        plan.inputSize += source.size;
+        plan.tensors.push_back( std::move(tensor) );
+        plan.sources.push_back( i );
+    }
+
+    plan.metadata = _metadata;
+    plan.metadata.push_back( GgufFile::KeyValue::from_uint32("general.quantization_version", 2) );
+    plan.metadata.push_back( GgufFile::KeyValue::from_uint32("general.file_type", file_type(_args.type)) );
+    if( _args.alignment != GgufFile::DefaultAlignment ) {
+        plan.metadata.push_back( GgufFile::KeyValue::from_uint32("general.alignment", static_cast<std::uint32_t>(_args.alignment)) );
+    }
+    plan.header = GgufFile::build_header(plan.tensors, plan.metadata, _args.alignment);
+    return plan;
+}
+
+/**
+ * Prints how many tensors go to each type and the resulting size.
+ */
+void
+CkQuantize::print_plan(const Plan& plan) const {
+    using Align = Table::Align;
+    auto& c = Colors::instance();
+
+    struct TypeSummary { size_t count = 0; std::uint64_t inputSize = 0; std::uint64_t outputSize = 0; };
+    std::map<std::uint32_t, TypeSummary> summaries;
+    for( size_t i=0 ; i<plan.tensors.size() ; ++i ) {
+        auto& summary = summaries[plan.tensors[i].type];
+        summary.count      += 1;
+        summary.inputSize  += _tensors[plan.sources[i]].size;
+        summary.outputSize += plan.tensors[i].size;
+    }
+
+    Table table;
+    table.set_alignments({Align::LEFT, Align::RIGHT, Align::RIGHT, Align::RIGHT});
+    table.set_styles({ {c.primary(), c.reset()}, {c.data2(), c.reset()}, {c.data2(), c.reset()}, {c.data(), c.reset()} });
+    for( const auto& [type, summary] : summaries ) {
+        table.add_row({ String{ GgufFile::type_name(type) }, std::to_string(summary.count) + " tensors",
+                        to_human_size(summary.inputSize), to_human_size(summary.outputSize) });
+    }
+    std::cout << table;
+
+    char ratio[32];
+    std::snprintf(ratio, sizeof(ratio), "%.2fx", plan.file_size() ? static_cast<double>(plan.inputSize) / plan.file_size() : 0.0);
+    std::cout << std::endl
+              << c.info() << "Output    : " << c.reset() << output_path() << std::endl
+              << c.info() << "Size      : " << c.reset() << to_human_size(plan.inputSize) << " -> "
+              << to_human_size(plan.file_size()) << " (" << ratio << " smaller)" << std::endl;
+}
+
+/**
+ * Quantizes all the tensors concurrently into the output file.
+ *
+ * The file is preallocated and its header written first. Each tensor is
+ * split in groups of whole rows that are read, decoded to float, quantized
+ * and written at their final offset by any thread, so large tensors keep
+ * all the cores busy. The file is written to a temporary name and renamed
+ * only when complete.
+ */
+void
+CkQuantize::write_gguf(const Plan& plan) const {
+    struct Job { size_t tensor; std::uint64_t first; std::uint64_t count; }; // rows, or bytes when copying
+
+    // open inputs
+    std::vector<File> inputFiles(_inputPaths.size());
+    for( size_t i=0 ; i<_inputPaths.size() ; ++i ) {
+        if( !inputFiles[i].open_read(_inputPaths[i]) ) { Messages::fatal_read_error(ReadError::FileNotFound, _inputPaths[i]); }
+    }
+
+    // create the output and build the list of jobs
+    const String path = output_path();
+    File output;
+    if( !output.create(path + ".part") || !output.resize(plan.file_size()) ||
+        !output.write_at(plan.header.data(), plan.header.size(), 0) )
+    {
+        Messages::fatal_error("Unable to create the output file.", { "File: " + path + ".part" });
+    }
+    std::vector<Job> jobs;
+    for( size_t t=0 ; t<plan.tensors.size() ; ++t ) {
+        const auto& source = _tensors[plan.sources[t]];
+        if( !is_convertible(source.dtype) ) {
+            for( std::uint64_t done=0 ; done < source.size ; done += CopyChunkSize ) {
+                jobs.push_back({ t, done, std::min(CopyChunkSize, source.size - done) });
+            }
+            continue;
+        }
+        const std::uint64_t rowLength = plan.tensors[t].shape[0];
+        if( rowLength == 0 ) { continue; }
+        const std::uint64_t numberOfRows = source.size / safetensors_dtype_size(source.dtype) / rowLength;
+        const std::uint64_t rowsPerJob   = std::max<std::uint64_t>(1, JobElements / rowLength);
+        for( std::uint64_t row=0 ; row < numberOfRows ; row += rowsPerJob ) {
+            jobs.push_back({ t, row, std::min(rowsPerJob, numberOfRows - row) });
+        }
+    }
+
+    // quantize all the jobs in parallel
+    std::mutex errorMutex;
+    String     errorMessage;
+    parallel_for(jobs.size(), static_cast<unsigned>(std::max(_args.threads, 0)), [&](size_t i) {
+        thread_local std::vector<char>  inputBuffer, outputBuffer;
+        thread_local std::vector<float> floatBuffer;
+        const auto& job    = jobs[i];
+        const auto& tensor = plan.tensors[job.tensor];
+        const auto& source = _tensors[plan.sources[job.tensor]];
+        const std::uint64_t outputOffset = plan.header.size() + tensor.offset;
+        bool ok;
+        if( !is_convertible(source.dtype) ) {
+            inputBuffer.resize( std::max<std::uint64_t>(inputBuffer.size(), job.count) );
+            ok = inputFiles[source.source].read_at(inputBuffer.data(), job.count, source.offset + job.first) &&
+                 output.write_at(inputBuffer.data(), job.count, outputOffset + job.first);
+        }
+        else {
+            const std::uint64_t rowLength      = tensor.shape[0];
+            const std::uint64_t count          = job.count * rowLength;
+            const std::uint64_t elementSize    = safetensors_dtype_size(source.dtype);
+            const std::uint64_t outputRowBytes = GgufFile::type_size(tensor.type, rowLength);
+            inputBuffer.resize ( std::max<std::uint64_t>(inputBuffer.size(),  count * elementSize)          );
+            floatBuffer.resize ( std::max<std::uint64_t>(floatBuffer.size(),  count)                        );
+            outputBuffer.resize( std::max<std::uint64_t>(outputBuffer.size(), job.count * outputRowBytes)   );
+            ok = inputFiles[source.source].read_at(inputBuffer.data(), count * elementSize, source.offset + job.first * rowLength * elementSize);
+            if( ok ) {
+                to_float(source.dtype, inputBuffer.data(), floatBuffer.data(), count);
+                ok = quantize_row(tensor.type, floatBuffer.data(), outputBuffer.data(), static_cast<std::int64_t>(count)) &&
+                     output.write_at(outputBuffer.data(), job.count * outputRowBytes, outputOffset + job.first * outputRowBytes);
+            }
+        }
+        if( !ok ) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if( errorMessage.empty() ) { errorMessage = "Failed to write the tensor '" + tensor.name + "' into '" + path + "'"; }
+        }
+    });
+    if( !errorMessage.empty() ) { Messages::fatal_error(errorMessage); }
+
+    // commit the file
+    std::error_code errorCode;
+    if( !output.sync() ) { Messages::fatal_error("Unable to flush the output file.", { "File: " + path }); }
+    output.close();
+    fs::rename(path + ".part", path, errorCode);
+    if( errorCode ) { Messages::fatal_error("Unable to rename the output file.", { "File: " + path }); }
+}
+
+/**
+ * Checks that the output file loads through TensorMap with the planned tensors.
+ */
+void
+CkQuantize::verify_gguf(const Plan& plan) const {
+    const String path = output_path();
+    ReadError readError = ReadError::None;
+    auto tensorMap = TensorMap::from_file(path, readError);
+    if( readError != ReadError::None ) { Messages::fatal_read_error(readError, path); }
+
+    auto tensors = tensorMap.collect_tensors(SortBy::NAME);
+    if( tensors.size() != plan.tensors.size() ) {
+        Messages::fatal_error("The output file has " + std::to_string(tensors.size()) + " tensors, expected " +
+                              std::to_string(plan.tensors.size()) + ".", { "File: " + path });
+    }
+}
+
+/**
+ * Compares every tensor of the output file, byte for byte, with the tensor
+ * of the same name in a reference .gguf (e.g. the output of `llama-quantize
+ * --pure` for the same input and type) and prints the ones that differ.
+ *
+ * @return true if both files have the same tensors, types and data.
+ */
+bool
+CkQuantize::compare_gguf() const {
+    using Align = Table::Align;
+    auto& c = Colors::instance();
+    enum class Result { IDENTICAL, DIFFERENT, OTHER_TYPE, OTHER_SHAPE, MISSING, READ_FAILED };
+
+    const String path = output_path();
+    ReadError readError;
+    const auto output = GgufFile::from_file(path, readError);
+    if( readError != ReadError::None ) { Messages::fatal_read_error(readError, path); }
+    const auto reference = GgufFile::from_file(_args.compare, readError);
+    if( readError != ReadError::None ) { Messages::fatal_read_error(readError, _args.compare); }
+
+    File outputFile, referenceFile;
+    if( !outputFile.open_read(path)              ) { Messages::fatal_read_error(ReadError::FileNotFound, path);          }
+    if( !referenceFile.open_read(_args.compare)  ) { Messages::fatal_read_error(ReadError::FileNotFound, _args.compare); }
+    std::unordered_map<StringView, const GgufFile::Tensor*> referenceTensors;
+    for( const auto& tensor : reference.tensors() ) { referenceTensors.emplace(tensor.name, &tensor); }
+
+    // each tensor is compared in chunks, stopping at the first difference
+    const auto& tensors = output.tensors();
+    std::vector<Result>        results(tensors.size(), Result::IDENTICAL);
+    std::vector<std::uint64_t> firstBlocks(tensors.size(), 0);
+    parallel_for(tensors.size(), static_cast<unsigned>(std::max(_args.threads, 0)), [&](size_t t) {
+        thread_local std::vector<char> outputBuffer, referenceBuffer;
+        const auto& tensor = tensors[t];
+        const auto  it     = referenceTensors.find(tensor.name);
+        if( it == referenceTensors.end() ) { results[t] = Result::MISSING; return; }
+        const auto& other = *it->second;
+        if( other.type  != tensor.type  ) { results[t] = Result::OTHER_TYPE;  return; }
+        if( other.shape != tensor.shape ) { results[t] = Result::OTHER_SHAPE; return; }
+
+        const std::uint64_t blockSize = std::max<std::uint64_t>(1, GgufFile::type_size(tensor.type, GgufFile::type_block_size(tensor.type)));
+        for( std::uint64_t done=0 ; done < tensor.size ; done += CopyChunkSize ) {
+            const std::uint64_t count = std::min(CopyChunkSize, tensor.size - done);
+            outputBuffer.resize( std::max<std::uint64_t>(outputBuffer.size(), count) );
+            referenceBuffer.resize( std::max<std::uint64_t>(referenceBuffer.size(), count) );
+            if( !outputFile.read_at(outputBuffer.data(), count, output.data_offset() + tensor.offset + done) ||
+                !referenceFile.read_at(referenceBuffer.data(), count, reference.data_offset() + other.offset + done) )
+            {
+                results[t] = Result::READ_FAILED;
+                return;
+            }
+            if( std::memcmp(outputBuffer.data(), referenceBuffer.data(), count) != 0 ) {
+                const auto mismatch = std::mismatch(outputBuffer.begin(), outputBuffer.begin() + static_cast<std::ptrdiff_t>(count), referenceBuffer.begin());
+                firstBlocks[t] = (done + static_cast<std::uint64_t>(mismatch.first - outputBuffer.begin())) / blockSize;
+                results[t]     = Result::DIFFERENT;
+                return;
+            }
+        }
+    });
+
+    Table table;
+    table.set_alignments({Align::LEFT, Align::LEFT, Align::LEFT});
+    table.set_styles({ {c.primary(), c.reset()}, {c.data2(), c.reset()}, {c.warning(), c.reset()} });
+    size_t identical = 0;
+    for( size_t t=0 ; t<tensors.size() ; ++t ) {
+        const auto& tensor = tensors[t];
+        const auto  type   = String{ GgufFile::type_name(tensor.type) };
+        switch( results[t] ) {
+            case Result::IDENTICAL:   ++identical; break;
+            case Result::DIFFERENT:   table.add_row({ tensor.name, type, "differs from block " + std::to_string(firstBlocks[t]) }); break;
+            case Result::OTHER_TYPE:  table.add_row({ tensor.name, type, "is " + String{ GgufFile::type_name(referenceTensors.at(tensor.name)->type) } + " in the reference" }); break;
+            case Result::OTHER_SHAPE: table.add_row({ tensor.name, type, "has another shape in the reference" }); break;
+            case Result::MISSING:     table.add_row({ tensor.name, type, "is not in the reference" }); break;
+            case Result::READ_FAILED: table.add_row({ tensor.name, type, "can't be read" }); break;
+        }
+    }
+    std::unordered_set<StringView> outputNames;
+    for( const auto& tensor : tensors ) { outputNames.insert(tensor.name); }
+    size_t extra = 0;
+    for( const auto& tensor : reference.tensors() ) {
+        if( outputNames.contains(tensor.name) ) { continue; }
+        table.add_row({ tensor.name, String{ GgufFile::type_name(tensor.type) }, "is only in the reference" });
+        ++extra;
+    }
+    std::cout << std::endl << table;
+    std::cout << c.info() << "Reference : " << c.reset() << _args.compare << std::endl
+              << c.info() << "Identical : " << c.reset() << identical << " of " << tensors.size() << " tensors" << std::endl;
+    return identical == tensors.size() && extra == 0;
+}
+
+//================================ RUNNING ================================//
+
+int
+CkQuantize::run() {
+
+    // if the color option is set to "auto", disable colors when outputting to a non-terminal
+    if( _args.when_color == "auto" || _args.when_color == "tty" || _args.when_color == "if-tty" ) {
+        if( !is_terminal_output() ) { Colors::instance().disable_colors(); }
+    }
+    // if the color option is set to "never", disable colors regardless of output type
+    else if ( _args.when_color == "never" || _args.when_color == "no" || _args.when_color == "none") {
+        Colors::instance().disable_colors();
+    }
+
+    // if help was requested, show the help message and exit
+    if( _args.help ) { print_help(); return 0; }
+
+    // if version was requested, show the version and exit
+    if( _args.version ) { print_version(); return 0; }
+
+    // if the user didn't provide any file, show an error message and exit
+    if( _args.inputs.empty() ) {
+        Messages::fatal_error("No file provided. Please specify a .safetensors or .gguf file.", {
+            "To get help on how to use this tool, run: ckquantize --help"
+        });
+    }
+
+    // (the FP8 export checks each of its output files once they are known)
+    const bool isFp8 = _args.type == CkQuantizeArgs::F8_E4M3;
+    std::error_code errorCode;
+    if( !isFp8 && !_args.force && !_args.dry_run && fs::exists(output_path(), errorCode) ) {
+        Messages::fatal_error("The output file already exists.", {
+            "File: " + output_path(), "Use --force to overwrite it." });
+    }
+
+    load_inputs();
+    if( _tensors.empty() ) { Messages::fatal_error("The input files don't contain any tensor."); }
+
+    // the names and key/values of a .safetensors input are copied as they are,
+    // which llama.cpp can't load, so that output is only written on request
+    const bool hasArchitecture = std::any_of(_metadata.begin(), _metadata.end(), [](const auto& keyValue) {
+        return keyValue.key == "general.architecture"; });
+    if( !isFp8 && !hasArchitecture && !_args.raw ) {
+        Messages::fatal_error("The input has no 'general.architecture', the output would not load in llama.cpp.", {
+            "It would keep the original tensor names and have no hyperparameters or tokenizer.",
+            "Convert the checkpoint with convert_hf_to_gguf.py and quantize that .gguf instead,",
+            "or use --raw to write the raw tensor container anyway." });
+    }
+
+    // the FP8 export writes .safetensors, which only holds plain dtypes and string metadata
+    if( isFp8 ) {
+        for( const auto& tensor : _tensors ) {
+            if( safetensors_dtype_size(tensor.dtype) != 0 ) { continue; }
+            Messages::fatal_error("The tensor '" + tensor.name + "' is stored as " + tensor.dtype + ", which can't be exported to F8_E4M3.", {
+                "Only a F32/F16/BF16 .gguf file (or a .safetensors input) can be exported with '-q F8_E4M3'." });
+        }
+        const auto dropped = std::count_if(_metadata.begin(), _metadata.end(), [](const auto& keyValue) {
+            return keyValue.type != GgufFile::ValueType::STRING; });
+        if( dropped > 0 ) {
+            Messages::warning(std::to_string(dropped) + " key/values of the .gguf input are not strings (hyperparameters, "
+                              "tokenizer arrays, ...) and are not stored in the .safetensors '__metadata__'.");
+        }
+    }
+
+    std::uint64_t inputSize = 0;
+    const auto start = std::chrono::steady_clock::now();
+    if( isFp8 ) {
+        auto plan = plan_fp8();
+        print_fp8_plan(plan);
+        if( _args.dry_run ) { return 0; }
+        write_fp8(plan);
+        if( _args.verify ) { verify_fp8(plan); }
+        inputSize = plan.inputSize;
+    }
+    else {
+        auto plan = plan_quantization();
+        print_plan(plan);
+        if( _args.dry_run ) { return 0; }
+        write_gguf(plan);
+        if( _args.verify ) { verify_gguf(plan); }
+        inputSize = plan.inputSize;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    char elapsed[64];
+    std::snprintf(elapsed, sizeof(elapsed), "%.2f s (%.1f MiB/s)", seconds,
+                  seconds > 0 ? static_cast<double>(inputSize) / (1024.0 * 1024.0) / seconds : 0.0);
+    std::cout << Colors::instance().info() << "Elapsed   : " << Colors::instance().reset() << elapsed << std::endl;
+
+    // (after the timing, the comparison reads both files again)
+    if( !_args.compare.empty() && !compare_gguf() ) { return 1; }
+    return 0;
+}
@@ -0,0 +1,107 @@
+/*
+| File    : ckquantize.h
+| Purpose : The `ckquantize` command line tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 6, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKQUANTIZE_H_
+#define CKQUANTIZE_H_
+#include <vector>
+#include "common.h"
+#include "gguf.h"             // for GgufFile
+#include "safetensors.h"      // for SafetensorsFile
+#include "ckquantize_args.h"  // for CkQuantizeArgs
+
+
+class CkQuantize
+{
+public:
+    /// A tensor of one of the input files, independent of the input format.
+    struct SourceTensor {
+        String                     name;
+        String                     dtype;      ///< "F32", "F16", "BF16", ... or the ggml type name of a GGUF tensor
+        std::vector<std::uint64_t> shape;      ///< dimensions in ggml order (ne[0] is the row length)
+        size_t                     source = 0; ///< index of the input file
+        std::uint64_t              offset = 0; ///< absolute offset of the first byte in the input file
+        std::uint64_t              size   = 0; ///< size in bytes
+    };
+
+    /// The output file, with the type chosen for each tensor and its precomputed header.
+    struct Plan {
+        GgufFile::Tensors   tensors;       ///< output tensor infos, with their final offsets
+        std::vector<size_t> sources;       ///< index of the source tensor of each output tensor
+        GgufFile::Metadata  metadata;
+        String              header;        ///< key/values + tensor infos + alignment padding
+        std::uint64_t       dataSize  = 0;
+        std::uint64_t       inputSize = 0; ///< sum of the size of all source tensors
+        [[nodiscard]] std::uint64_t file_size() const noexcept { return header.size() + dataSize; }
+    };
+
+    /// One of the .safetensors files written by the FP8 export.
+    struct Fp8Shard {
+        String                   filename;
+        SafetensorsFile::Tensors tensors;  ///< header entries, each F8_E4M3 weight followed by its scale
+        std::vector<size_t>      sources;  ///< source tensor of each entry (`NoSource` for the scales)
+        String                   header;   ///< length prefix + JSON header
+        std::uint64_t            dataSize = 0;
+        [[nodiscard]] std::uint64_t file_size() const noexcept { return header.size() + dataSize; }
+    };
+    struct Fp8Plan {
+        std::vector<Fp8Shard> shards;
+        std::uint64_t         inputSize = 0; ///< sum of the size of all source tensors
+    };
+    static constexpr size_t NoSource = static_cast<size_t>(-1);
+
+// MAIN
+public:
+    CkQuantize(const CkQuantizeArgs& args);
+    [[nodiscard]] int run();
+
+// STEPS
+public:
+    void load_inputs();
+    Plan plan_quantization() const;
+    void print_plan(const Plan& plan) const;
+    void write_gguf(const Plan& plan) const;
+    void verify_gguf(const Plan& plan) const;
+    bool compare_gguf() const;
+
+// FP8 EXPORT
+public:
+    Fp8Plan plan_fp8() const;
+    void    print_fp8_plan(const Fp8Plan& plan) const;
+    void    write_fp8(const Fp8Plan& plan) const;
+    void    verify_fp8(const Fp8Plan& plan) const;
+
+// HELPERS
+public:
+    [[nodiscard]] std::uint32_t  target_type(const SourceTensor& tensor) const;
+    [[nodiscard]] String         fp8_dtype(const SourceTensor& tensor) const;
+    [[nodiscard]] String         output_path() const;
+    [[nodiscard]] static bool    is_convertible(StringView dtype) noexcept;
+    [[nodiscard]] static std::uint32_t file_type(std::uint32_t type) noexcept;
+    static void to_float(StringView dtype, const char* input, float* output, size_t count);
+    void print_help() const noexcept;
+    void print_version() const noexcept;
+
+// IMPLEMENTATION
+private:
+    static constexpr std::uint64_t JobElements   = 4 * 1024 * 1024;  ///< elements converted by each job (whole rows, at least one)
+    static constexpr std::uint64_t CopyChunkSize = 32 * 1024 * 1024; ///< tensors copied unchanged are split in chunks of this size
+    void _add_input(const String& path);
+private:
+    const CkQuantizeArgs      _args;
+    std::vector<String>       _inputPaths;
+    std::vector<SafetensorsFile::Metadata> _inputMetadata; ///< "__metadata__" of each input file
+    String                    _indexName;  ///< filename of the input .index.json, if any
+    std::vector<SourceTensor> _tensors;
+    GgufFile::Metadata        _metadata;   ///< key/values to copy to the output
+};
+
+#endif // CKQUANTIZE_H_
@@ -0,0 +1,187 @@
+/*
+| File    : ckquantize_args.cpp
+| Purpose : The arguments of the `ckquantize` command line
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 6, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <string>   // for std::string
+#include "common.h"
+#include "ckquantize_args.h"
+#include "argument.h"
+#include "messages.h"
+#include "gguf.h"
+
+
+static std::uint32_t
+_parse_type(const String& name) {
+    if( name == "F8_E4M3" || name == "f8_e4m3" || name == "FP8" || name == "fp8" ) { return CkQuantizeArgs::F8_E4M3; }
+    const auto type = GgufFile::type_from_name(name);
+    switch( type ) {
+        case ggml_type::F32:  case ggml_type::F16:  case ggml_type::BF16:
+        case ggml_type::Q8_0: case ggml_type::Q4_0: case ggml_type::Q4_K: case ggml_type::Q6_K:
+            return type;
+    }
+    Messages::fatal_error("Unsupported type: '" + name + "'.", {
+        "Valid types are 'Q8_0', 'Q4_0', 'Q4_K', 'Q6_K', 'F16', 'BF16', 'F32' and 'F8_E4M3'." });
+}
+
+static bool
+_parse_scale(const String& granularity) {
+    if( granularity == "tensor"  ) { return false; }
+    if( granularity == "channel" ) { return true;  }
+    Messages::fatal_error("Unknown scale granularity: '" + granularity + "'.", {
+        "Valid values are 'tensor' and 'channel'." });
+}
+
+static CkQuantizeArgs::TypeOverride
+_parse_override(const String& value) {
+    const auto equal = value.rfind('=');
+    if( equal == String::npos || equal == 0 ) {
+        Messages::fatal_error("Invalid override: '" + value + "'.", {
+            "The expected format is PATTERN=TYPE, e.g. 'output.weight=Q6_K'." });
+    }
+    return { value.substr(0, equal), _parse_type(value.substr(equal + 1)) };
+}
+
+//============================= CONSTRUCTION ==============================//
+
+/**
+ * Constructs a new CkQuantizeArgs object by parsing command line arguments.
+ *
+ * @param argc The number of command line arguments passed to the program.
+ * @param argv An array of C strings representing the command line arguments.
+ */
+CkQuantizeArgs::CkQuantizeArgs(int argc, char* argv[])
+: help_message{R"(
+Usage: ckquantize [OPTIONS] file...
+
+  Converts a checkpoint to a .gguf file with its tensors quantized to one of
+  the ggml block formats. The input can be one or more .safetensors files,
+  the .index.json file of a sharded checkpoint, or a F32/F16/BF16 .gguf file.
+
+  A .gguf input keeps its architecture, hyperparameters and tokenizer, so
+  the output is ready to be loaded by llama.cpp. A .safetensors input has
+  none of them and its tensors keep their original names ('model.layers.N...',
+  not 'blk.N...'), so llama.cpp can't load the result and the conversion is
+  refused. For llama.cpp, convert the checkpoint first with its
+  convert_hf_to_gguf.py (e.g. '--outtype f16') and quantize that .gguf;
+  use --raw to write the raw tensor container anyway (e.g. for other ggml
+  based runtimes that map the names themselves).
+
+  With '-q F8_E4M3' the output is instead a directory with one .safetensors
+  file per input file (and the index when there is more than one), in the
+  layout of FP8 serving runtimes: each quantized 'X.weight' is stored as
+  F8_E4M3 together with a F32 'X.weight_scale' tensor, one value per tensor
+  or one per output channel (--scale). Weights are divided by the scale,
+  rounded to nearest even and saturated to +/-448. Only 2D '.weight'
+  tensors are quantized; embeddings ('*embed*') and the output head
+  ('lm_head.*') are kept, as is anything matched by an override to BF16,
+  F16 or F32 (e.g. --override '*.mlp.gate.weight=BF16'). A .gguf input
+  must be F32/F16/BF16, its quantized tensors are refused, and only its
+  string key/values are kept in the '__metadata__' of the output files.
+
+  Tensors are split in groups of rows that are quantized in parallel and
+  written directly at their final offset. One-dimensional tensors (norms,
+  biases) are kept in F32, and tensors whose rows are not a multiple of the
+  block size fall back to a compatible type (Q4_K -> Q4_0, Q6_K -> Q8_0,
+  then F16). Integer and already quantized tensors are copied unchanged.
+
+  OPTIONS:
+    -q, --type <TYPE>          Type of the quantized tensors (default: Q8_0)
+                                 Q8_0, Q4_0, Q4_K, Q6_K, F16, BF16, F32 or F8_E4M3
+    --override <PATTERN=TYPE>  Use TYPE for the tensors matching PATTERN ('*' and '?'
+                               wildcards). Can be repeated, the first match wins.
+    --scale <tensor|channel>   Granularity of the F8_E4M3 scales (default: tensor)
+    -o, --output <PATH>        Output .gguf file, or directory for F8_E4M3
+                               (default: '<NAME>-<TYPE>.gguf' or '<NAME>-F8_E4M3' next to the input)
+    -a, --align <SIZE>         Alignment of the tensor data (default: 32)
+    -t, --threads <N>          Number of threads (default: one per core)
+    -f, --force                Overwrite the output file if it exists
+    --raw                      Accept an input without 'general.architecture' (see above)
+    --no-verify                Don't check that the output loads through TensorMap
+    --compare <FILE>           Compare the output, tensor by tensor and byte by byte, with the .gguf FILE
+                               (e.g. written by 'llama-quantize --pure' from the same input); exits
+                               with 1 if any tensor differs
+    --dry-run                  Print the quantization plan without writing anything
+
+    --nc, --no-color           Disable color output.
+    -h  , --help               Show this help message and exit.
+    -v  , --version            Show version information and exit.
+
+  Examples:
+    ckquantize -q Q4_K --override 'output.weight=Q6_K' 'model-F16.gguf'
+    ckquantize --raw 'model.safetensors'
+    ckquantize -q Q4_K --raw --override '*.v_proj.weight=Q6_K' -o model-q4.gguf 'model.safetensors.index.json'
+    ckquantize -q F8_E4M3 --scale channel -o fp8/ 'model.safetensors.index.json'
+)"}
+{
+    for( int i=1 ; i < argc ; ++i )
+    {
+        auto arg = Argument{i, argc, argv};
+
+        // parse the options
+        if( arg.is_option() ) {
+        //-QUANTIZATION:
+            if     (arg.is( "-q", "--type"       )) { type      = _parse_type(arg.value(i)); }
+            else if(arg.is(       "--override"   )) { overrides.push_back( _parse_override(arg.value(i)) ); }
+            else if(arg.is(       "--scale"      )) { per_channel = _parse_scale(arg.value(i)); }
+        //-OUTPUT:
+            else if(arg.is( "-o", "--output"     )) { output    = arg.value(i); }
+            else if(arg.is( "-a", "--align"      )) { alignment = to_size(arg.value(i)); }
+            else if(arg.is( "-t", "--threads"    )) { threads   = to_integer(arg.value(i)); }
+            else if(arg.is( "-f", "--force"      )) { force     = true; }
+            else if(arg.is(       "--raw"        )) { raw       = true; }
+            else if(arg.is(       "--no-verify"  )) { verify    = false; }
+            else if(arg.is(       "--compare"    )) { compare   = arg.value(i); }
+            else if(arg.is(       "--dry-run"    )) { dry_run   = true; }
+        //-EXTRA:
+            else if(arg.is( "-h", "--help"       )) { help = true; }
+            else if(arg.is( "-v", "--version"    )) { version = true; }
+            else if(arg.is( "--color"            )) { when_color = arg.value(i);  }
+            else if(arg.is( "--nc", "--no-color" )) { when_color = "never"; }
+            else {
+                // if an unknown argument is encountered, display a fatal error message
+                Messages::fatal_error( "Unknown argument: " + arg.name(), {
+                    "Try `ckquantize --help` for more information." });
+            }
+            // check if the user provided a value that was not consumed by the option
+            if( arg.has_value() && !arg.was_value_consumed() ) {
+                Messages::fatal_error( "The argument '"+ arg.name() +"' no expects a value and '"+ arg.value(i) +"' was provided.", {
+                    "Try `ckquantize --help` for more information." });
+            }
+        }
+        // handle positional arguments, arguments without a preceding hyphen
+        // (every positional argument is an input file)
+        else {
+            inputs.push_back( arg.name() );
+        }
+    }
+
+    // F8_E4M3 tensors only exist in .safetensors, ggml block types only in GGUF
+    for( const auto& typeOverride : overrides ) {
+        const bool isGgufOnly = typeOverride.type == ggml_type::Q8_0 || typeOverride.type == ggml_type::Q4_0 ||
+                                typeOverride.type == ggml_type::Q4_K || typeOverride.type == ggml_type::Q6_K;
+        if( (type == F8_E4M3 && isGgufOnly) || (type != F8_E4M3 && typeOverride.type == F8_E4M3) ) {
+            Messages::fatal_error("The override '" + typeOverride.pattern + "' uses a type that can't be mixed with the output type.", {
+                "F8_E4M3 tensors are only written by '-q F8_E4M3', in .safetensors files,",
+                "and Q8_0, Q4_0, Q4_K and Q6_K tensors only in .gguf files." });
+        }
+    }
+
+    // only a .gguf output can be compared with the output of llama-quantize
+    if( type == F8_E4M3 && !compare.empty() ) {
+        Messages::fatal_error("The option '--compare' can't be used with '-q F8_E4M3'.", {
+            "It compares the output with a .gguf file." });
+    }
+
+    // GGUF requires a power of two alignment, multiple of 8
+    if( alignment < 8 || (alignment & (alignment - 1)) != 0 ) {
+        Messages::fatal_error("The alignment must be a power of two, 8 at least.", {
+            "Valid alignments are for example '32', '64' or '4K'." });
+    }
+}
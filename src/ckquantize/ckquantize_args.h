@@ -0,0 +1,89 @@
+/*
+| File    : ckquantize_args.h
+| Purpose : The arguments of the `ckquantize` command line
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 6, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKQUANTIZE_ARGS_H_
+#define CKQUANTIZE_ARGS_H_
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "common.h"
+#include "quants.h"  // for ggml_type
+
+
+struct CkQuantizeArgs
+{
+    /// Not a ggml type: selects the FP8 (e4m3) export to .safetensors instead of GGUF.
+    static constexpr std::uint32_t F8_E4M3 = 0xF8E4;
+
+    /// A tensor name pattern ('*' and '?' wildcards) and the type forced for the matching tensors.
+    struct TypeOverride {
+        String        pattern;
+        std::uint32_t type;
+    };
+
+// CONSTRUCTION/DESTRUCTION
+public:
+    CkQuantizeArgs(int argc, char* argv[]);
+    CkQuantizeArgs() = default;
+    CkQuantizeArgs(const CkQuantizeArgs&) = default;
+    CkQuantizeArgs(CkQuantizeArgs&&) noexcept = default;
+    ~CkQuantizeArgs() = default;
+
+// PUBLIC MEMBERS
+public:
+    std::vector<String>       inputs;                   ///< The files to read (.safetensors, .index.json or .gguf)
+    String                    output     = "";          ///< Output .gguf file (empty = derived from the input name)
+    std::uint32_t             type       = ggml_type::Q8_0; ///< Default ggml type of the quantized tensors
+    std::vector<TypeOverride> overrides;                ///< Per-pattern types, the first match wins
+    bool                      per_channel = false;      ///< true = one FP8 scale per output channel
+    std::uint64_t             alignment  = 32;          ///< Alignment of the tensor data
+    int                       threads    = 0;           ///< Number of threads (0 = one per core)
+    String                    when_color = "auto";      ///< When to use color in output
+    bool                      dry_run    = false;       ///< true = only print the quantization plan
+    bool                      verify     = true;        ///< true = check that the output loads through TensorMap
+    String                    compare    = "";          ///< Reference .gguf compared byte for byte with the output
+    bool                      force      = false;       ///< true = overwrite an existing output file
+    bool                      raw        = false;       ///< true = accept an input without 'general.architecture'
+    bool                      help       = false;       ///< true = print usage and exit
+    bool                      version    = false;       ///< true = print version and exit
+    const char * const help_message = nullptr;
+};
+
+/**
+ * Overloads the insertion operator (<<) for printing CkQuantizeArgs objects to an output stream.
+ *
+ * @param os   The output stream where the Args data will be printed.
+ * @param args The Args object being printed to the stream.
+ * @return A reference `os` for chaining.
+ */
+inline std::ostream&
+operator<<(std::ostream& os, const CkQuantizeArgs& args) {
+    os << "Args:"                                          << std::endl;
+    os << "  inputs: "      << args.inputs.size()          << std::endl;
+    os << "  output: "      << args.output                 << std::endl;
+    os << "  type: "        << args.type                   << std::endl;
+    os << "  overrides: "   << args.overrides.size()       << std::endl;
+    os << "  per_channel: " << to_string(args.per_channel) << std::endl;
+    os << "  alignment: "   << args.alignment              << std::endl;
+    os << "  threads: "     << args.threads                << std::endl;
+    os << "  when_color: "  << args.when_color             << std::endl;
+    os << "  dry_run: "     << to_string(args.dry_run)     << std::endl;
+    os << "  verify: "      << to_string(args.verify)      << std::endl;
+    os << "  compare: "     << args.compare                << std::endl;
+    os << "  force: "       << to_string(args.force)       << std::endl;
+    os << "  raw: "         << to_string(args.raw)         << std::endl;
+    os << "  help: "        << to_string(args.help)        << std::endl;
+    os << "  version: "     << to_string(args.version);
+    return os;
+}
+
+#endif // CKQUANTIZE_ARGS_H_
@@ -0,0 +1,391 @@
+/*
+| File    : ckquantize_fp8.cpp
+| Purpose : FP8 (e4m3) export of the `ckquantize` command line tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 7, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm>     // for std::max, std::min, std::reverse
+#include <filesystem>    // for std::filesystem::path
+#include <fstream>       // for std::ofstream
+#include <map>           // for std::map
+#include <mutex>         // for std::mutex
+#include <tin/tensormap.h>
+#include "table.h"
+#include "colors.h"
+#include "messages.h"
+#include "file.h"
+#include "parallel.h"
+#include "quants.h"
+#include "ckquantize.h"
+namespace fs = std::filesystem;
+using tin::TensorMap;
+using tin::SortBy;
+
+/// Largest finite F8_E4M3 value, the absolute maximum of a tensor is mapped to it.
+static constexpr float F8MaxValue = 448.0f;
+
+/// Smallest absolute maximum used to compute a scale (avoids dividing by zero).
+static constexpr float MinAbsoluteMax = 1e-12f;
+
+/**
+ * Returns the number of output channels of a tensor (its first dimension in
+ * PyTorch order, the last one in ggml order), each one with its own scale
+ * in per-channel mode.
+ */
+static std::uint64_t
+_output_channels(const CkQuantize::SourceTensor& tensor) noexcept {
+    return tensor.shape.empty() ? 1 : tensor.shape.back();
+}
+
+static std::uint32_t
+_ggml_type_of(StringView dtype) noexcept {
+    return dtype == "BF16" ? ggml_type::BF16 : dtype == "F16" ? ggml_type::F16 : ggml_type::F32;
+}
+
+//================================ HELPERS ================================//
+
+/**
+ * Returns the dtype a source tensor is stored with in the FP8 export.
+ *
+ * The first override matching the tensor name wins. Without an override,
+ * only the 2D '.weight' tensors of linear layers are quantized; embeddings
+ * and the output head are kept because runtimes load them unquantized.
+ * Tensors that are not quantized keep their original dtype unless an
+ * override asks for another one.
+ */
+String
+CkQuantize::fp8_dtype(const SourceTensor& tensor) const {
+    if( !is_convertible(tensor.dtype) ) { return tensor.dtype; }
+
+    for( const auto& typeOverride : _args.overrides ) {
+        if( !matches_glob(typeOverride.pattern, tensor.name) ) { continue; }
+        if( typeOverride.type == CkQuantizeArgs::F8_E4M3 ) { return tensor.shape.size() >= 2 ? "F8_E4M3" : tensor.dtype; }
+        return String{ GgufFile::type_name(typeOverride.type) };
+    }
+    const bool isLinearWeight = tensor.shape.size() == 2 && tensor.name.ends_with(".weight");
+    const bool isKept = matches_glob("*embed*", tensor.name) || matches_glob("lm_head.*", tensor.name);
+    return isLinearWeight && !isKept ? "F8_E4M3" : tensor.dtype;
+}
+
+//============================== FP8 EXPORT ===============================//
+
+/**
+ * Computes the layout of the output files: one per input file, with the
+ * same name, where every quantized weight is followed by its scale.
+ */
+CkQuantize::Fp8Plan
+CkQuantize::plan_fp8() const {
+    Fp8Plan plan;
+    plan.shards.resize(_inputPaths.size());
+    for( size_t s=0 ; s<_inputPaths.size() ; ++s ) {
+        String filename = fs::path(_inputPaths[s]).filename().string();
+        if( filename.ends_with(".gguf") ) { filename.resize(filename.size() - 5); filename += ".safetensors"; }
+        plan.shards[s].filename = filename;
+    }
+
+    const auto add_entry = [](Fp8Shard& shard, String name, String dtype, std::vector<std::uint64_t> shape, size_t source) {
+        std::uint64_t numberOfElements = 1;
+        for( const auto dimension : shape ) { numberOfElements *= dimension; }
+        SafetensorsFile::Tensor entry;
+        entry.name  = std::move(name);
+        entry.dtype = std::move(dtype);
+        entry.shape = std::move(shape);
+        entry.begin = shard.dataSize;
+        entry.end   = shard.dataSize + numberOfElements * safetensors_dtype_size(entry.dtype);
+        shard.dataSize = entry.end;
+        shard.tensors.push_back( std::move(entry) );
+        shard.sources.push_back( source );
+    };
+
+    for( size_t i=0 ; i<_tensors.size() ; ++i ) {
+        const auto& source = _tensors[i];
+        auto&       shard  = plan.shards[source.source];
+        auto        shape  = source.shape;
+        std::reverse(shape.begin(), shape.end());
+
+        // "X.weight" -> "X.weight_scale", shaped [1] or [channels, 1]
+        const auto dtype = fp8_dtype(source);
+        add_entry(shard, source.name, dtype, shape, i);
+        if( dtype == "F8_E4M3" ) {
+            std::vector<std::uint64_t> scaleShape = { 1 };
+            if( _args.per_channel ) { scaleShape = { _output_channels(source), 1 }; }
+            add_entry(shard, source.name + "_scale", "F32", std::move(scaleShape), NoSource);
+        }
+        plan.inputSize += source.size;
+    }
+    for( size_t s=0 ; s<plan.shards.size() ; ++s ) {
+        auto& shard = plan.shards[s];
+        shard.header = SafetensorsFile::build_header(shard.tensors, _inputMetadata[s], _args.alignment);
+    }
+    return plan;
+}
+
+/**
+ * Prints how many tensors are stored with each dtype and the resulting size.
+ */
+void
+CkQuantize::print_fp8_plan(const Fp8Plan& plan) const {
+    using Align = Table::Align;
+    auto& c = Colors::instance();
+
+    struct DtypeSummary { size_t count = 0; std::uint64_t inputSize = 0; std::uint64_t outputSize = 0; };
+    std::map<String, DtypeSummary> summaries;
+    std::uint64_t outputSize = 0;
+    for( const auto& shard : plan.shards ) {
+        for( size_t e=0 ; e<shard.tensors.size() ; ++e ) {
+            const bool isScale = shard.sources[e] == NoSource;
+            auto& summary = summaries[isScale ? "F32 (scales)" : shard.tensors[e].dtype];
+            summary.count      += 1;
+            summary.inputSize  += isScale ? 0 : _tensors[shard.sources[e]].size;
+            summary.outputSize += shard.tensors[e].size();
+        }
+        outputSize += shard.file_size();
+    }
+
+    Table table;
+    table.set_alignments({Align::LEFT, Align::RIGHT, Align::RIGHT, Align::RIGHT});
+    table.set_styles({ {c.primary(), c.reset()}, {c.data2(), c.reset()}, {c.data2(), c.reset()}, {c.data(), c.reset()} });
+    for( const auto& [dtype, summary] : summaries ) {
+        table.add_row({ dtype, std::to_string(summary.count) + " tensors",
+                        to_human_size(summary.inputSize), to_human_size(summary.outputSize) });
+    }
+    std::cout << table;
+
+    char ratio[32];
+    std::snprintf(ratio, sizeof(ratio), "%.2fx", outputSize ? static_cast<double>(plan.inputSize) / outputSize : 0.0);
+    std::cout << std::endl
+              << c.info() << "Output    : " << c.reset() << output_path() << "/ (" << plan.shards.size() << " file(s))" << std::endl
+              << c.info() << "Scales    : " << c.reset() << (_args.per_channel ? "per output channel" : "per tensor") << std::endl
+              << c.info() << "Size      : " << c.reset() << to_human_size(plan.inputSize) << " -> "
+              << to_human_size(outputSize) << " (" << ratio << " smaller)" << std::endl;
+}
+
+/**
+ * Writes all the output files concurrently.
+ *
+ * With per-tensor scales, a first parallel pass reads the quantized tensors
+ * to find their absolute maximum. The second pass reads every tensor again
+ * in groups of whole rows and writes it at its final offset: quantized
+ * weights are divided by their scale and rounded to F8_E4M3 (in per-channel
+ * mode the scale of each row is computed right there, so the data is read
+ * only once), the rest is converted or copied unchanged. The scales are
+ * written last, and every file is renamed only when complete.
+ */
+void
+CkQuantize::write_fp8(const Fp8Plan& plan) const {
+    enum class Kind { COPY, CONVERT, QUANTIZE };
+    struct Work {
+        size_t              shard;
+        size_t              entry;
+        const SourceTensor* source;
+        Kind                kind;
+        std::uint64_t       rowLength;
+        std::vector<float>  scales;  ///< one per tensor, or one per output channel
+    };
+    struct Job { size_t work; std::uint64_t first; std::uint64_t count; }; // rows, or bytes when copying
+
+    // open inputs
+    std::vector<File> inputFiles(_inputPaths.size());
+    for( size_t i=0 ; i<_inputPaths.size() ; ++i ) {
+        if( !inputFiles[i].open_read(_inputPaths[i]) ) { Messages::fatal_read_error(ReadError::FileNotFound, _inputPaths[i]); }
+    }
+
+    // create outputs (never over the inputs, they have the same names)
+    const String outputDir = output_path();
+    std::error_code errorCode;
+    fs::create_directories(outputDir, errorCode);
+    std::vector<File>   outputFiles(plan.shards.size());
+    std::vector<String> outputPaths(plan.shards.size());
+    for( size_t s=0 ; s<plan.shards.size() ; ++s ) {
+        const auto& shard = plan.shards[s];
+        outputPaths[s] = (fs::path(outputDir) / shard.filename).string();
+        if( fs::equivalent(outputPaths[s], _inputPaths[s], errorCode) ) {
+            Messages::fatal_error("The output file would overwrite its input.", { "File: " + outputPaths[s] });
+        }
+        if( !_args.force && fs::exists(outputPaths[s], errorCode) ) {
+            Messages::fatal_error("The output file already exists.", { "File: " + outputPaths[s], "Use --force to overwrite it." });
+        }
+        if( !outputFiles[s].create(outputPaths[s] + ".part")  ||
+            !outputFiles[s].resize(shard.file_size())          ||
+            !outputFiles[s].write_at(shard.header.data(), shard.header.size(), 0) )
+        {
+            Messages::fatal_error("Unable to create the output file.", { "File: " + outputPaths[s] + ".part" });
+        }
+    }
+
+    // one work item per tensor and the jobs they are split into
+    std::vector<Work> works;
+    for( size_t s=0 ; s<plan.shards.size() ; ++s ) {
+        const auto& shard = plan.shards[s];
+        for( size_t e=0 ; e<shard.tensors.size() ; ++e ) {
+            if( shard.sources[e] == NoSource ) { continue; }
+            const auto& source = _tensors[shard.sources[e]];
+            const auto& dtype  = shard.tensors[e].dtype;
+            const Kind  kind   = dtype == "F8_E4M3" ? Kind::QUANTIZE : dtype == source.dtype ? Kind::COPY : Kind::CONVERT;
+            const std::uint64_t channels  = _output_channels(source);
+            const std::uint64_t rowLength = kind == Kind::QUANTIZE ? (channels ? source.size / safetensors_dtype_size(source.dtype) / channels : 0) : 1;
+            works.push_back({ s, e, &source, kind, rowLength, {} });
+            if( kind == Kind::QUANTIZE ) { works.back().scales.assign(_args.per_channel ? channels : 1, 1.0f); }
+        }
+    }
+    std::vector<Job> jobs;
+    for( size_t w=0 ; w<works.size() ; ++w ) {
+        const auto& work = works[w];
+        if( work.kind == Kind::COPY ) {
+            for( std::uint64_t done=0 ; done < work.source->size ; done += CopyChunkSize ) {
+                jobs.push_back({ w, done, std::min(CopyChunkSize, work.source->size - done) });
+            }
+            continue;
+        }
+        if( work.rowLength == 0 ) { continue; }
+        const std::uint64_t numberOfRows = work.source->size / safetensors_dtype_size(work.source->dtype) / work.rowLength;
+        const std::uint64_t rowsPerJob   = std::max<std::uint64_t>(1, JobElements / work.rowLength);
+        for( std::uint64_t row=0 ; row < numberOfRows ; row += rowsPerJob ) {
+            jobs.push_back({ w, row, std::min(rowsPerJob, numberOfRows - row) });
+        }
+    }
+
+    std::mutex errorMutex;
+    String     errorMessage;
+    const auto report_error = [&](const String& message) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if( errorMessage.empty() ) { errorMessage = message; }
+    };
+    const unsigned numberOfThreads = static_cast<unsigned>(std::max(_args.threads, 0));
+
+    // reads `job.count` rows of a work item as floats
+    const auto read_rows = [&](const Job& job, std::vector<char>& inputBuffer, std::vector<float>& floatBuffer) {
+        const auto&         work        = works[job.work];
+        const std::uint64_t count       = job.count * work.rowLength;
+        const std::uint64_t elementSize = safetensors_dtype_size(work.source->dtype);
+        inputBuffer.resize( std::max<std::uint64_t>(inputBuffer.size(), count * elementSize) );
+        floatBuffer.resize( std::max<std::uint64_t>(floatBuffer.size(), count) );
+        if( !inputFiles[work.source->source].read_at(inputBuffer.data(), count * elementSize,
+                                                     work.source->offset + job.first * work.rowLength * elementSize) )
+        {
+            return false;
+        }
+        to_float(work.source->dtype, inputBuffer.data(), floatBuffer.data(), count);
+        return true;
+    };
+
+    // first pass: absolute maximum of each quantized tensor (per-tensor scales only)
+    if( !_args.per_channel ) {
+        std::vector<float> jobMaximums(jobs.size(), 0.0f);
+        parallel_for(jobs.size(), numberOfThreads, [&](size_t i) {
+            thread_local std::vector<char>  inputBuffer;
+            thread_local std::vector<float> floatBuffer;
+            const auto& job = jobs[i];
+            if( works[job.work].kind != Kind::QUANTIZE ) { return; }
+            if( !read_rows(job, inputBuffer, floatBuffer) ) { report_error("Failed to read the tensor '" + works[job.work].source->name + "'"); return; }
+            jobMaximums[i] = absolute_max(floatBuffer.data(), static_cast<std::int64_t>(job.count * works[job.work].rowLength));
+        });
+        if( !errorMessage.empty() ) { Messages::fatal_error(errorMessage); }
+
+        std::vector<float> maximums(works.size(), 0.0f);
+        for( size_t i=0 ; i<jobs.size() ; ++i ) { maximums[jobs[i].work] = std::max(maximums[jobs[i].work], jobMaximums[i]); }
+        for( size_t w=0 ; w<works.size() ; ++w ) {
+            if( works[w].kind == Kind::QUANTIZE ) { works[w].scales[0] = std::max(maximums[w], MinAbsoluteMax) / F8MaxValue; }
+        }
+    }
+
+    // second pass: quantize, convert or copy every tensor
+    parallel_for(jobs.size(), numberOfThreads, [&](size_t i) {
+        thread_local std::vector<char>  inputBuffer, outputBuffer;
+        thread_local std::vector<float> floatBuffer;
+        const auto& job    = jobs[i];
+        auto&       work   = works[job.work];
+        const auto& entry  = plan.shards[work.shard].tensors[work.entry];
+        auto&       output = outputFiles[work.shard];
+        const std::uint64_t outputOffset = plan.shards[work.shard].header.size() + entry.begin;
+        bool ok;
+        if( work.kind == Kind::COPY ) {
+            inputBuffer.resize( std::max<std::uint64_t>(inputBuffer.size(), job.count) );
+            ok = inputFiles[work.source->source].read_at(inputBuffer.data(), job.count, work.source->offset + job.first) &&
+                 output.write_at(inputBuffer.data(), job.count, outputOffset + job.first);
+        }
+        else {
+            ok = read_rows(job, inputBuffer, floatBuffer);
+            const std::uint64_t count       = job.count * work.rowLength;
+            const std::uint64_t elementSize = safetensors_dtype_size(entry.dtype);
+            outputBuffer.resize( std::max<std::uint64_t>(outputBuffer.size(), count * elementSize) );
+            if( ok && work.kind == Kind::CONVERT ) {
+                quantize_row(_ggml_type_of(entry.dtype), floatBuffer.data(), outputBuffer.data(), static_cast<std::int64_t>(count));
+            }
+            else if( ok ) {
+                const auto  rowLength = static_cast<std::int64_t>(work.rowLength);
+                auto* const quantized = reinterpret_cast<std::uint8_t*>(outputBuffer.data());
+                for( std::uint64_t row=0 ; row < job.count ; ++row ) {
+                    const float* values = floatBuffer.data() + row * work.rowLength;
+                    float scale = work.scales[0];
+                    if( _args.per_channel ) {
+                        scale = std::max(absolute_max(values, rowLength), MinAbsoluteMax) / F8MaxValue;
+                        work.scales[job.first + row] = scale;
+                    }
+                    quantize_row_f8_e4m3(values, quantized + row * work.rowLength, rowLength, scale);
+                }
+            }
+            ok = ok && output.write_at(outputBuffer.data(), count * elementSize, outputOffset + job.first * work.rowLength * elementSize);
+        }
+        if( !ok ) { report_error("Failed to write the tensor '" + entry.name + "' into '" + outputPaths[work.shard] + "'"); }
+    });
+    if( !errorMessage.empty() ) { Messages::fatal_error(errorMessage); }
+
+    // the scales go right after their weight
+    for( const auto& work : works ) {
+        if( work.kind != Kind::QUANTIZE ) { continue; }
+        const auto& shard = plan.shards[work.shard];
+        const auto& entry = shard.tensors[work.entry + 1];
+        if( !outputFiles[work.shard].write_at(work.scales.data(), work.scales.size() * sizeof(float), shard.header.size() + entry.begin) ) {
+            Messages::fatal_error("Failed to write the tensor '" + entry.name + "'", { "File: " + outputPaths[work.shard] });
+        }
+    }
+
+    // commit each file
+    for( size_t s=0 ; s<plan.shards.size() ; ++s ) {
+        if( !outputFiles[s].sync() ) { Messages::fatal_error("Unable to flush the output file.", { "File: " + outputPaths[s] }); }
+        outputFiles[s].close();
+        fs::rename(outputPaths[s] + ".part", outputPaths[s], errorCode);
+        if( errorCode ) { Messages::fatal_error("Unable to rename the output file.", { "File: " + outputPaths[s] }); }
+    }
+
+    // a sharded checkpoint needs its index, now including the scales
+    if( plan.shards.size() > 1 ) {
+        std::vector<std::pair<StringView, StringView>> weightMap;
+        std::uint64_t totalSize = 0;
+        for( const auto& shard : plan.shards ) {
+            for( const auto& tensor : shard.tensors ) { weightMap.emplace_back(tensor.name, shard.filename); }
+            totalSize += shard.dataSize;
+        }
+        const String json = SafetensorsFile::build_index(std::move(weightMap), totalSize);
+        const auto   path = (fs::path(outputDir) / (_indexName.empty() ? String{"model.safetensors.index.json"} : _indexName)).string();
+        std::ofstream file(path, std::ios::binary);
+        if( !file.write(json.data(), static_cast<std::streamsize>(json.size())) ) {
+            Messages::fatal_error("Unable to write the index file.", { "File: " + path });
+        }
+    }
+}
+
+/**
+ * Checks that every output file loads through TensorMap with the planned tensors.
+ */
+void
+CkQuantize::verify_fp8(const Fp8Plan& plan) const {
+    for( const auto& shard : plan.shards ) {
+        const String path = (fs::path(output_path()) / shard.filename).string();
+        ReadError readError = ReadError::None;
+        auto tensorMap = TensorMap::from_file(path, readError);
+        if( readError != ReadError::None ) { Messages::fatal_read_error(readError, path); }
+
+        auto tensors = tensorMap.collect_tensors(SortBy::NAME);
+        if( tensors.size() != shard.tensors.size() ) {
+            Messages::fatal_error("The output file has " + std::to_string(tensors.size()) + " tensors, expected " +
+                                  std::to_string(shard.tensors.size()) + ".", { "File: " + path });
+        }
+    }
+}
@@ -0,0 +1,19 @@
+/*
+| File    : main.cpp
+| Purpose : Main entry point for the `ckquantize` command tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 6, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include "ckquantize_args.h"
+#include "ckquantize.h"
+
+int main(int argc, char* argv[]) {
+    CkQuantizeArgs args{argc, argv};
+    CkQuantize     ckquantize{args};
+    return ckquantize.run();
+}
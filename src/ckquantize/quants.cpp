@@ -0,0 +1,389 @@
+/*
+| File    : quants.cpp
+| Purpose : Block quantizers for the ggml formats (Q8_0, Q4_0, Q4_K, Q6_K).
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 6, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm> // for std::min, std::max
+#include <bit>       // for std::bit_cast
+#include <cmath>     // for std::fabs, std::round
+#include <cstring>   // for std::memcpy, std::memset
+#include "minifloat.h"
+#include "quants.h"
+
+static constexpr int   QK     = 32;    // elements per block of Q8_0 and Q4_0
+static constexpr int   QK_K   = 256;   // elements per super-block of the k-quants
+static constexpr float GroupMaxEps = 1e-15f;
+
+struct BlockQ8_0 { std::uint16_t d; std::int8_t  qs[QK];   };
+struct BlockQ4_0 { std::uint16_t d; std::uint8_t qs[QK/2]; };
+struct BlockQ4_K { std::uint16_t d; std::uint16_t dmin; std::uint8_t scales[12]; std::uint8_t qs[QK_K/2]; };
+struct BlockQ6_K { std::uint8_t ql[QK_K/2]; std::uint8_t qh[QK_K/4]; std::int8_t scales[QK_K/16]; std::uint16_t d; };
+static_assert(sizeof(BlockQ8_0) ==  34, "wrong Q8_0 block size");
+static_assert(sizeof(BlockQ4_0) ==  18, "wrong Q4_0 block size");
+static_assert(sizeof(BlockQ4_K) == 144, "wrong Q4_K block size");
+static_assert(sizeof(BlockQ6_K) == 210, "wrong Q6_K block size");
+
+
+//================================ HELPERS ================================//
+
+/**
+ * Rounds to the nearest integer, ties to even, for |value| < 2^22.
+ * (adding 1.5*2^23 leaves the rounded integer in the low mantissa bits,
+ * which vectorizes, unlike a call to lrintf)
+ */
+static inline int
+_nearest_int(float value) noexcept {
+    const float shifted = value + 12582912.0f;
+    return static_cast<int>(std::bit_cast<std::uint32_t>(shifted) & 0x007FFFFF) - 0x00400000;
+}
+
+/**
+ * Finds the scale and minimum that best represent `n` weighted values with
+ * integers in [0, nmax] (ggml's make_qkx2_quants). The grid search starts
+ * from the plain min/max fit and tries `nstep` slightly different scales,
+ * keeping the one with the lowest weighted squared error.
+ */
+static float
+_make_qkx2_quants(int n, int nmax, const float* x, const float* weights, std::uint8_t* L, float* theMin,
+                  std::uint8_t* Laux, float rmin, float rdelta, int nstep) noexcept
+{
+    float min = x[0], max = x[0];
+    float sumW = weights[0], sumX = sumW * x[0];
+    for( int i=1 ; i<n ; ++i ) {
+        min   = std::min(min, x[i]);
+        max   = std::max(max, x[i]);
+        sumW += weights[i];
+        sumX += weights[i] * x[i];
+    }
+    if( min > 0 ) { min = 0; }
+    if( max == min ) {
+        std::memset(L, 0, n);
+        *theMin = -min;
+        return 0.0f;
+    }
+    float iscale = nmax / (max - min);
+    float scale  = 1 / iscale;
+    float bestError = 0;
+    for( int i=0 ; i<n ; ++i ) {
+        const int l = std::max(0, std::min(nmax, _nearest_int(iscale * (x[i] - min))));
+        L[i] = static_cast<std::uint8_t>(l);
+        const float diff = scale * L[i] + min - x[i];
+        bestError += weights[i] * diff * diff;
+    }
+    for( int step=0 ; step<=nstep ; ++step ) {
+        iscale = (rmin + rdelta * step + nmax) / (max - min);
+        float sumL = 0, sumL2 = 0, sumXL = 0;
+        for( int i=0 ; i<n ; ++i ) {
+            const int l = std::max(0, std::min(nmax, _nearest_int(iscale * (x[i] - min))));
+            Laux[i] = static_cast<std::uint8_t>(l);
+            sumL  += weights[i] * l;
+            sumL2 += weights[i] * l * l;
+            sumXL += weights[i] * l * x[i];
+        }
+        const float D = sumW * sumL2 - sumL * sumL;
+        if( D > 0 ) {
+            float thisScale = (sumW * sumXL - sumX * sumL) / D;
+            float thisMin   = (sumL2 * sumX - sumL * sumXL) / D;
+            if( thisMin > 0 ) {
+                thisMin   = 0;
+                thisScale = sumXL / sumL2;
+            }
+            float error = 0;
+            for( int i=0 ; i<n ; ++i ) {
+                const float diff = thisScale * Laux[i] + thisMin - x[i];
+                error += weights[i] * diff * diff;
+            }
+            if( error < bestError ) {
+                std::memcpy(L, Laux, n);
+                bestError = error;
+                scale     = thisScale;
+                min       = thisMin;
+            }
+        }
+    }
+    *theMin = -min;
+    return scale;
+}
+
+/**
+ * Finds the symmetric scale that best represents `n` values with integers
+ * in [-nmax, nmax-1], weighting each value by its square (ggml's
+ * make_qx_quants with rmse_type=1).
+ */
+static float
+_make_qx_quants(int n, int nmax, const float* x, std::int8_t* L) noexcept {
+    float max = 0, amax = 0;
+    for( int i=0 ; i<n ; ++i ) {
+        const float ax = std::fabs(x[i]);
+        if( ax > amax ) { amax = ax; max = x[i]; }
+    }
+    if( amax < GroupMaxEps ) {
+        std::memset(L, 0, n);
+        return 0.0f;
+    }
+    float iscale = -nmax / max;
+    float sumLX = 0, sumL2 = 0;
+    for( int i=0 ; i<n ; ++i ) {
+        const int l = std::max(-nmax, std::min(nmax - 1, _nearest_int(iscale * x[i])));
+        L[i] = static_cast<std::int8_t>(l + nmax);
+        const float w = x[i] * x[i];
+        sumLX += w * x[i] * l;
+        sumL2 += w * l * l;
+    }
+    float scale = sumL2 ? sumLX / sumL2 : 0.0f;
+    float best  = scale * sumLX;
+    for( int step=-9 ; step<=9 ; ++step ) {
+        if( step == 0 ) { continue; }
+        iscale = -(nmax + 0.1f * step) / max;
+        sumLX = sumL2 = 0;
+        for( int i=0 ; i<n ; ++i ) {
+            const int l = std::max(-nmax, std::min(nmax - 1, _nearest_int(iscale * x[i])));
+            const float w = x[i] * x[i];
+            sumLX += w * x[i] * l;
+            sumL2 += w * l * l;
+        }
+        if( sumL2 > 0 && sumLX * sumLX > best * sumL2 ) {
+            for( int i=0 ; i<n ; ++i ) {
+                const int l = std::max(-nmax, std::min(nmax - 1, _nearest_int(iscale * x[i])));
+                L[i] = static_cast<std::int8_t>(l + nmax);
+            }
+            scale = sumLX / sumL2;
+            best  = scale * sumLX;
+        }
+    }
+    return scale;
+}
+
+static inline void
+_get_scale_min_k4(int j, const std::uint8_t* q, std::uint8_t& d, std::uint8_t& m) noexcept {
+    if( j < 4 ) {
+        d = q[j] & 63;
+        m = q[j + 4] & 63;
+    } else {
+        d = static_cast<std::uint8_t>((q[j + 4] & 0xF) | ((q[j - 4] >> 6) << 4));
+        m = static_cast<std::uint8_t>((q[j + 4] >>  4) | ((q[j - 0] >> 6) << 4));
+    }
+}
+
+//============================== QUANTIZERS ===============================//
+
+/**
+ * Q8_0: one scale per 32 values, scale = max|x| / 127.
+ * The values are rounded half away from zero, with roundf like ggml, not
+ * with `_nearest_int` (ties to even) as the other quantizers.
+ */
+void
+quantize_row_q8_0(const float* x, void* y, std::int64_t k) noexcept {
+    auto* blocks = static_cast<BlockQ8_0*>(y);
+    for( std::int64_t b=0 ; b<k/QK ; ++b, x+=QK ) {
+        float amax = 0.0f;
+        for( int j=0 ; j<QK ; ++j ) { amax = std::max(amax, std::fabs(x[j])); }
+        const float d  = amax / 127.0f;
+        const float id = d ? 1.0f / d : 0.0f;
+        blocks[b].d = float_to_f16(d);
+        for( int j=0 ; j<QK ; ++j ) { blocks[b].qs[j] = static_cast<std::int8_t>(std::round(x[j] * id)); }
+    }
+}
+
+/**
+ * Q4_0: one scale per 32 values, chosen so the value with the largest
+ * magnitude maps exactly to -8.
+ */
+void
+quantize_row_q4_0(const float* x, void* y, std::int64_t k) noexcept {
+    auto* blocks = static_cast<BlockQ4_0*>(y);
+    for( std::int64_t b=0 ; b<k/QK ; ++b, x+=QK ) {
+        float amax = 0.0f, max = 0.0f;
+        for( int j=0 ; j<QK ; ++j ) {
+            if( amax < std::fabs(x[j]) ) { amax = std::fabs(x[j]); max = x[j]; }
+        }
+        const float d  = max / -8;
+        const float id = d ? 1.0f / d : 0.0f;
+        blocks[b].d = float_to_f16(d);
+        for( int j=0 ; j<QK/2 ; ++j ) {
+            const int q0 = std::min(15, static_cast<int>(static_cast<std::int8_t>(x[j]          * id + 8.5f)));
+            const int q1 = std::min(15, static_cast<int>(static_cast<std::int8_t>(x[j + QK/2]   * id + 8.5f)));
+            blocks[b].qs[j] = static_cast<std::uint8_t>(q0 | (q1 << 4));
+        }
+    }
+}
+
+/**
+ * Q4_K: super-blocks of 256 values in 8 sub-blocks of 32, each one with its
+ * own 6-bit scale and minimum, which are themselves scaled by two f16 values.
+ */
+void
+quantize_row_q4_k(const float* x, void* y, std::int64_t k) noexcept {
+    auto* blocks = static_cast<BlockQ4_K*>(y);
+    std::uint8_t L[QK_K], Laux[32];
+    float weights[32], mins[QK_K/32], scales[QK_K/32];
+
+    for( std::int64_t b=0 ; b<k/QK_K ; ++b, x+=QK_K ) {
+        auto& block = blocks[b];
+        float maxScale = 0, maxMin = 0;
+        for( int j=0 ; j<QK_K/32 ; ++j ) {
+            float sumX2 = 0;
+            for( int l=0 ; l<32 ; ++l ) { sumX2 += x[32*j + l] * x[32*j + l]; }
+            const float avX = std::sqrt(sumX2 / 32);
+            for( int l=0 ; l<32 ; ++l ) { weights[l] = avX + std::fabs(x[32*j + l]); }
+            scales[j] = _make_qkx2_quants(32, 15, x + 32*j, weights, L + 32*j, &mins[j], Laux, -1.0f, 0.1f, 20);
+            maxScale  = std::max(maxScale, scales[j]);
+            maxMin    = std::max(maxMin,   mins[j]);
+        }
+
+        const float invScale = maxScale > 0 ? 63.0f / maxScale : 0.0f;
+        const float invMin   = maxMin   > 0 ? 63.0f / maxMin   : 0.0f;
+        std::memset(block.scales, 0, sizeof(block.scales));
+        for( int j=0 ; j<QK_K/32 ; ++j ) {
+            const auto ls = static_cast<std::uint8_t>(std::min(63, _nearest_int(invScale * scales[j])));
+            const auto lm = static_cast<std::uint8_t>(std::min(63, _nearest_int(invMin   * mins[j])));
+            if( j < 4 ) {
+                block.scales[j]     = ls;
+                block.scales[j + 4] = lm;
+            } else {
+                block.scales[j + 4]  = static_cast<std::uint8_t>((ls & 0xF) | ((lm & 0xF) << 4));
+                block.scales[j - 4] |= static_cast<std::uint8_t>((ls >> 4) << 6);
+                block.scales[j - 0] |= static_cast<std::uint8_t>((lm >> 4) << 6);
+            }
+        }
+        block.d    = float_to_f16(maxScale / 63.0f);
+        block.dmin = float_to_f16(maxMin   / 63.0f);
+
+        for( int j=0 ; j<QK_K/32 ; ++j ) {
+            std::uint8_t sc, m;
+            _get_scale_min_k4(j, block.scales, sc, m);
+            const float d = f16_to_float(block.d) * sc;
+            if( !d ) { continue; }
+            const float dm = f16_to_float(block.dmin) * m;
+            for( int i=0 ; i<32 ; ++i ) {
+                L[32*j + i] = static_cast<std::uint8_t>(std::max(0, std::min(15, _nearest_int((x[32*j + i] + dm) / d))));
+            }
+        }
+        std::uint8_t* q = block.qs;
+        for( int j=0 ; j<QK_K ; j+=64, q+=32 ) {
+            for( int l=0 ; l<32 ; ++l ) { q[l] = static_cast<std::uint8_t>(L[j + l] | (L[j + l + 32] << 4)); }
+        }
+    }
+}
+
+/**
+ * Q6_K: super-blocks of 256 values in 16 sub-blocks of 16, each one with an
+ * 8-bit scale, and 6-bit values split in a 4-bit and a 2-bit plane.
+ */
+void
+quantize_row_q6_k(const float* x, void* y, std::int64_t k) noexcept {
+    auto* blocks = static_cast<BlockQ6_K*>(y);
+    std::int8_t L[QK_K];
+    float scales[QK_K/16];
+
+    for( std::int64_t b=0 ; b<k/QK_K ; ++b, x+=QK_K ) {
+        auto& block = blocks[b];
+        float maxScale = 0, maxAbsScale = 0;
+        for( int ib=0 ; ib<QK_K/16 ; ++ib ) {
+            scales[ib] = _make_qx_quants(16, 32, x + 16*ib, L + 16*ib);
+            if( std::fabs(scales[ib]) > maxAbsScale ) {
+                maxAbsScale = std::fabs(scales[ib]);
+                maxScale    = scales[ib];
+            }
+        }
+        if( maxAbsScale < GroupMaxEps ) {
+            std::memset(&block, 0, sizeof(block));
+            continue;
+        }
+        const float iscale = -128.0f / maxScale;
+        block.d = float_to_f16(1 / iscale);
+        for( int ib=0 ; ib<QK_K/16 ; ++ib ) {
+            block.scales[ib] = static_cast<std::int8_t>(std::min(127, _nearest_int(iscale * scales[ib])));
+        }
+        for( int j=0 ; j<QK_K/16 ; ++j ) {
+            const float d = f16_to_float(block.d) * block.scales[j];
+            if( !d ) { continue; }
+            for( int i=0 ; i<16 ; ++i ) {
+                const int l = std::max(-32, std::min(31, _nearest_int(x[16*j + i] / d)));
+                L[16*j + i] = static_cast<std::int8_t>(l + 32);
+            }
+        }
+        std::uint8_t* ql = block.ql;
+        std::uint8_t* qh = block.qh;
+        for( int j=0 ; j<QK_K ; j+=128, ql+=64, qh+=32 ) {
+            for( int l=0 ; l<32 ; ++l ) {
+                const int q1 = L[j + l +  0] & 0xF;
+                const int q2 = L[j + l + 32] & 0xF;
+                const int q3 = L[j + l + 64] & 0xF;
+                const int q4 = L[j + l + 96] & 0xF;
+                ql[l +  0] = static_cast<std::uint8_t>(q1 | (q3 << 4));
+                ql[l + 32] = static_cast<std::uint8_t>(q2 | (q4 << 4));
+                qh[l] = static_cast<std::uint8_t>((L[j + l] >> 4) | ((L[j + l + 32] >> 4) << 2) |
+                                                  ((L[j + l + 64] >> 4) << 4) | ((L[j + l + 96] >> 4) << 6));
+            }
+        }
+    }
+}
+
+//================================== FP8 ==================================//
+
+float
+absolute_max(const float* x, std::int64_t k) noexcept {
+    // independent lanes, so the compiler can keep them in one SIMD register
+    // (a single running maximum is a reduction it won't reorder)
+    constexpr int Lanes = 8;
+    float lanes[Lanes] = {};
+    std::int64_t i = 0;
+    for( ; i + Lanes <= k ; i += Lanes ) {
+        for( int j=0 ; j<Lanes ; ++j ) { lanes[j] = std::max(lanes[j], std::fabs(x[i + j])); }
+    }
+    for( ; i < k ; ++i ) { lanes[0] = std::max(lanes[0], std::fabs(x[i])); }
+    float amax = lanes[0];
+    for( int j=1 ; j<Lanes ; ++j ) { amax = std::max(amax, lanes[j]); }
+    return amax;
+}
+
+void
+quantize_row_f8_e4m3(const float* x, std::uint8_t* y, std::int64_t k, float scale) noexcept {
+    // Adding a power of two whose last mantissa bit weighs as much as the
+    // last bit of the result makes the FPU round the value, ties to even.
+    // Its exponent is clamped to that of the smallest normal (so subnormals
+    // come out right) and to that of 448 (larger values saturate below).
+    // Everything else is integer arithmetic without branches, so the loop
+    // is vectorized; a float comparison or select here would prevent it.
+    for( std::int64_t i=0 ; i<k ; ++i ) {
+        const std::uint32_t bits     = std::bit_cast<std::uint32_t>(x[i] / scale);
+        const std::uint32_t absolute = bits & 0x7FFFFFFF;
+        const std::uint32_t exponent = std::min<std::uint32_t>(std::max<std::uint32_t>(absolute >> 23, 121), 136);
+        const std::uint32_t magic    = (exponent + 20) << 23;
+        const std::uint32_t rounded  = std::bit_cast<std::uint32_t>(std::bit_cast<float>(absolute) + std::bit_cast<float>(magic)) - magic;
+        const std::uint32_t fields   = std::min<std::uint32_t>(((exponent - 121) << 3) + rounded, 0x7E);
+        const std::uint32_t nanMask  = 0u - static_cast<std::uint32_t>(absolute > 0x7F800000);
+        y[i] = static_cast<std::uint8_t>(((bits >> 24) & 0x80) | fields | (nanMask & 0x7F));
+    }
+}
+
+bool
+quantize_row(std::uint32_t type, const float* x, void* y, std::int64_t k) noexcept {
+    switch( type ) {
+        case ggml_type::F32:
+            std::memcpy(y, x, static_cast<size_t>(k) * sizeof(float));
+            return true;
+        case ggml_type::F16: {
+            auto* out = static_cast<std::uint16_t*>(y);
+            for( std::int64_t i=0 ; i<k ; ++i ) { out[i] = float_to_f16(x[i]); }
+            return true;
+        }
+        case ggml_type::BF16: {
+            auto* out = static_cast<std::uint16_t*>(y);
+            for( std::int64_t i=0 ; i<k ; ++i ) { out[i] = float_to_bf16(x[i]); }
+            return true;
+        }
+        case ggml_type::Q8_0: quantize_row_q8_0(x, y, k); return true;
+        case ggml_type::Q4_0: quantize_row_q4_0(x, y, k); return true;
+        case ggml_type::Q4_K: quantize_row_q4_k(x, y, k); return true;
+        case ggml_type::Q6_K: quantize_row_q6_k(x, y, k); return true;
+        default: return false;
+    }
+}
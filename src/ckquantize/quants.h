@@ -0,0 +1,73 @@
+/*
+| File    : quants.h
+| Purpose : Block quantizers for the ggml formats (Q8_0, Q4_0, Q4_K, Q6_K).
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 6, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef QUANTS_H_
+#define QUANTS_H_
+#include <cstdint>
+
+
+/*
+  The block layouts and the algorithms follow the reference (non-SIMD)
+  implementation in ggml, the one `llama-quantize` uses without an
+  importance matrix, including how each format rounds. `ckquantize
+  --compare` checks an output against one written by `llama-quantize --pure`.
+
+  +--------+-------+-------+-------------------------------------------------+
+  | Type   | Block | Bytes | Layout                                          |
+  | ------ | ----- | ----- | ----------------------------------------------- |
+  | Q8_0   |   32  |   34  | f16 scale, 32 x int8                            |
+  | Q4_0   |   32  |   18  | f16 scale, 32 x 4-bit (offset 8)                |
+  | Q4_K   |  256  |  144  | f16 scale, f16 min, 8 x 6-bit scale/min, 4-bit  |
+  | Q6_K   |  256  |  210  | 4-bit low, 2-bit high, 16 x int8 scales, f16    |
+  +--------+-------+-------+-------------------------------------------------+
+
+  Every function quantizes `k` values (a multiple of the block size) from
+  `x` into `y`, which must have room for k / block * bytes bytes.
+*/
+
+namespace ggml_type {
+    constexpr std::uint32_t F32  = 0;
+    constexpr std::uint32_t F16  = 1;
+    constexpr std::uint32_t Q4_0 = 2;
+    constexpr std::uint32_t Q8_0 = 8;
+    constexpr std::uint32_t Q4_K = 12;
+    constexpr std::uint32_t Q6_K = 14;
+    constexpr std::uint32_t BF16 = 30;
+}
+
+void quantize_row_q8_0(const float* x, void* y, std::int64_t k) noexcept;
+void quantize_row_q4_0(const float* x, void* y, std::int64_t k) noexcept;
+void quantize_row_q4_k(const float* x, void* y, std::int64_t k) noexcept;
+void quantize_row_q6_k(const float* x, void* y, std::int64_t k) noexcept;
+
+/**
+ * Returns the largest absolute value of `k` values (0 if k is 0).
+ */
+float absolute_max(const float* x, std::int64_t k) noexcept;
+
+/**
+ * Converts `k` values divided by `scale` to F8_E4M3, rounding to nearest
+ * even and saturating to +/-448. The loop is branch-free, so it is
+ * vectorized like the block quantizers.
+ */
+void quantize_row_f8_e4m3(const float* x, std::uint8_t* y, std::int64_t k, float scale) noexcept;
+
+/**
+ * Converts `k` values to the given ggml type (F32, F16, BF16 or one of the
+ * quantized types above).
+ *
+ * @return false if the type is not supported.
+ */
+bool quantize_row(std::uint32_t type, const float* x, void* y, std::int64_t k) noexcept;
+
+
+#endif // QUANTS_H_
@@ -0,0 +1,435 @@
+/*
+| File    : ckrepack.cpp
+| Purpose : The `ckrepack` command line tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 2, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm>     // for std::any_of, std::sort, std::max, std::min
+#include <filesystem>    // for std::filesystem::path
+#include <fstream>       // for std::ofstream
+#include <mutex>         // for std::mutex
+#include <queue>         // for std::priority_queue
+#include <unordered_map> // for std::unordered_map
+#include <unordered_set> // for std::unordered_set
+#include "table.h"
+#include "colors.h"
+#include "messages.h"
+#include "file.h"
+#include "parallel.h"
+#include "ckrepack.h"
+#ifdef _WIN32
+    inline bool is_terminal_output() { return true; }
+#else
+#include <unistd.h> // for "::isatty()" and STDOUT_FILENO
+    inline bool is_terminal_output() { return ::isatty(STDOUT_FILENO) != 0; }
+#endif
+namespace fs = std::filesystem;
+
+/// Tensors larger than this are copied in several independent chunks.
+static constexpr std::uint64_t CopyChunkSize = 32 * 1024 * 1024;
+
+
+//============================= CONSTRUCTION ==============================//
+
+CkRepack::CkRepack(const CkRepackArgs& args)
+: _args(args)
+{}
+
+//================================ HELPERS ================================//
+
+void
+CkRepack::print_help() const noexcept {
+    std::cout << _args.help_message  << std::endl;
+}
+
+void
+CkRepack::print_version() const noexcept {
+    std::cout << "ckrepack (CheckpointTools ckrepack) " << PROJECT_VERSION << std::endl;
+}
+
+/**
+ * Returns the name of the module group a tensor belongs to.
+ *
+ * The group is the name up to the first numeric component (the block index),
+ * e.g. "model.layers.12.mlp.up_proj.weight" -> "model.layers.12". Tensors
+ * without a numeric component are grouped by their parent module, e.g.
+ * "model.embed_tokens.weight" -> "model.embed_tokens".
+ */
+String
+CkRepack::module_group(StringView tensorName) {
+    size_t start = 0;
+    while( start < tensorName.size() ) {
+        size_t end = tensorName.find('.', start);
+        if( end == StringView::npos ) { break; }
+        auto component = tensorName.substr(start, end - start);
+        if( !component.empty() && std::all_of(component.begin(), component.end(), [](char ch) { return ch>='0' && ch<='9'; }) ) {
+            return String{ tensorName.substr(0, end) };
+        }
+        start = end + 1;
+    }
+    auto lastDot = tensorName.rfind('.');
+    return String{ lastDot != StringView::npos ? tensorName.substr(0, lastDot) : tensorName };
+}
+
+//================================= STEPS =================================//
+
+/**
+ * Reads the layout of one input file, or of every shard listed in an index file.
+ */
+void
+CkRepack::_add_input(const String& path) {
+    ReadError readError;
+
+    // an index file lists the shards in its "weight_map"
+    if( path.ends_with(".json") ) {
+        _indexPaths.push_back(path);
+        auto shardPaths = SafetensorsFile::shards_of_index(path, readError);
+        if( readError == ReadError::InvalidFormat ) {
+            Messages::fatal_error("Invalid index file, no 'weight_map' found.", { "File: " + path });
+        }
+        if( readError != ReadError::None ) { Messages::fatal_read_error(readError, path); }
+        for( const auto& shardPath : shardPaths ) { _add_input(shardPath); }
+        return;
+    }
+
+    auto safetensors = SafetensorsFile::from_file(path, readError);
+    if( readError != ReadError::None ) { Messages::fatal_read_error(readError, path); }
+    _inputs.push_back( std::move(safetensors) );
+}
+
+/**
+ * Reads the layout of every input file and collects all their tensors.
+ */
+void
+CkRepack::load_inputs() {
+    for( const auto& path : _args.inputs ) { _add_input(path); }
+
+    // collect tensors only after all inputs are loaded
+    // (pointers into `_inputs` must remain valid)
+    std::unordered_set<StringView> names;
+    for( size_t source=0 ; source<_inputs.size() ; ++source ) {
+        for( const auto& tensor : _inputs[source].tensors() ) {
+            if( tensor.is_padding() ) { continue; }
+            if( !names.insert(tensor.name).second ) {
+                Messages::fatal_error("The tensor '" + tensor.name + "' is present in more than one input file.");
+            }
+            _tensors.push_back({ &tensor, source });
+        }
+    }
+}
+
+/**
+ * Distributes the tensors into shards balanced by size.
+ *
+ * Module groups are placed largest-first on the currently smallest shard
+ * (LPT scheduling). A group larger than the target shard size can't be kept
+ * together without unbalancing the plan, so its tensors are placed one by one.
+ */
+CkRepack::ShardPlan
+CkRepack::plan_shards() const {
+    ShardPlan plan;
+    for( const auto& source : _tensors ) { plan.totalSize += source.tensor->size(); }
+
+    // number of shards requested (directly or through the target shard size)
+    // when only the alignment changes, the number of shards is preserved
+    size_t numberOfShards = _args.shards > 0 ? _args.shards : (_args.shard_size > 0 ? 1 : _inputs.size());
+    if( _args.shard_size > 0 ) {
+        numberOfShards = std::max<size_t>(numberOfShards, (plan.totalSize + _args.shard_size - 1) / _args.shard_size);
+    }
+    numberOfShards = std::max<size_t>(1, std::min(numberOfShards, _tensors.size()));
+    const std::uint64_t target = (plan.totalSize + numberOfShards - 1) / numberOfShards;
+
+    // build module groups, splitting those that would not fit in one shard
+    struct Group { String name; std::uint64_t size = 0; std::vector<size_t> members; };
+    std::vector<Group> groups;
+    std::unordered_map<String, size_t> groupIndices;
+    for( size_t i=0 ; i<_tensors.size() ; ++i ) {
+        auto name = module_group(_tensors[i].tensor->name);
+        auto [it, inserted] = groupIndices.try_emplace(name, groups.size());
+        if( inserted ) { groups.push_back({ name, 0, {} }); }
+        groups[it->second].size += _tensors[i].tensor->size();
+        groups[it->second].members.push_back(i);
+    }
+    std::vector<Group> placeable;
+    for( auto& group : groups ) {
+        if( group.size <= target || group.members.size() == 1 ) { placeable.push_back( std::move(group) ); continue; }
+        for( size_t i : group.members ) { placeable.push_back({ _tensors[i].tensor->name, _tensors[i].tensor->size(), {i} }); }
+    }
+    std::sort(placeable.begin(), placeable.end(), [](const Group& a, const Group& b) {
+        return a.size != b.size ? a.size > b.size : a.name < b.name;
+    });
+
+    // place each group on the least loaded shard
+    using Load = std::pair<std::uint64_t, size_t>; // (bytes, shard index)
+    std::priority_queue<Load, std::vector<Load>, std::greater<Load>> loads;
+    plan.shards.resize(numberOfShards);
+    for( size_t s=0 ; s<numberOfShards ; ++s ) { loads.push({0, s}); }
+    for( const auto& group : placeable ) {
+        auto [load, s] = loads.top(); loads.pop();
+        for( size_t i : group.members ) { plan.shards[s].sources.push_back(_tensors[i]); }
+        loads.push({ load + group.size, s });
+    }
+
+    // drop empty shards (only possible with very few, very large groups)
+    std::erase_if(plan.shards, [](const Shard& shard) { return shard.sources.empty(); });
+    numberOfShards = plan.shards.size();
+
+    // sort tensors by name inside each shard, then compute offsets and headers
+    // (when aligning, the gap before each tensor is indexed by a padding tensor)
+    plan.alignment = _args.alignment;
+    const auto& metadata = _inputs.front().metadata();
+    for( size_t s=0 ; s<numberOfShards ; ++s ) {
+        auto& shard = plan.shards[s];
+        std::sort(shard.sources.begin(), shard.sources.end(), [](const SourceTensor& a, const SourceTensor& b) {
+            return a.tensor->name < b.tensor->name;
+        });
+        for( const auto& source : shard.sources ) {
+            const std::uint64_t end    = shard.dataSize;
+            const std::uint64_t offset = SafetensorsFile::add_aligned(shard.tensors, *source.tensor, plan.alignment, shard.dataSize);
+            shard.paddingSize += offset - end;
+            shard.offsets.push_back( offset );
+        }
+        const std::uint64_t headerAlignment = SafetensorsFile::header_alignment(plan.alignment);
+        shard.header = SafetensorsFile::build_header(shard.tensors, metadata, headerAlignment);
+
+        if( numberOfShards == 1 && _inputs.size() == 1 ) {
+            shard.filename = fs::path(_inputs.front().path()).filename().string();
+        } else if( numberOfShards == 1 ) {
+            shard.filename = _args.name + ".safetensors";
+        } else {
+            char number[32];
+            std::snprintf(number, sizeof(number), "-%05zu-of-%05zu", s+1, numberOfShards);
+            shard.filename = _args.name + number + ".safetensors";
+        }
+    }
+    return plan;
+}
+
+/**
+ * Prints the shard plan and how unbalanced it is.
+ *
+ * The imbalance is the tensor bytes of the largest shard relative to the mean,
+ * i.e. how much longer the slowest worker takes compared to a perfect split.
+ */
+void
+CkRepack::print_plan(const ShardPlan& plan) const {
+    using Align = Table::Align;
+    auto& c = Colors::instance();
+
+    std::uint64_t maxSize = 0, minSize = UINT64_MAX;
+    for( const auto& shard : plan.shards ) {
+        maxSize = std::max(maxSize, shard.tensor_size());
+        minSize = std::min(minSize, shard.tensor_size());
+    }
+    const double meanSize = plan.shards.empty() ? 0.0 : static_cast<double>(plan.totalSize) / plan.shards.size();
+
+    Table table;
+    table.set_alignments({Align::LEFT, Align::RIGHT, Align::RIGHT, Align::RIGHT});
+    table.set_styles({ {c.primary(), c.reset()}, {c.data2(), c.reset()}, {c.data(), c.reset()}, {c.data2(), c.reset()} });
+    for( const auto& shard : plan.shards ) {
+        char deviation[32];
+        std::snprintf(deviation, sizeof(deviation), "%+.2f%%", meanSize>0 ? 100.0 * (shard.tensor_size() - meanSize) / meanSize : 0.0);
+        table.add_row({ shard.filename, std::to_string(shard.sources.size()) + " tensors", to_human_size(shard.file_size()), deviation });
+    }
+    std::cout << table;
+
+    char imbalance[64];
+    std::snprintf(imbalance, sizeof(imbalance), "%.2f%%", meanSize>0 ? 100.0 * (maxSize - meanSize) / meanSize : 0.0);
+    std::cout << std::endl
+              << c.info() << "Total size: " << c.reset() << to_human_size(plan.totalSize)
+              << " in " << plan.shards.size() << " shard(s)" << std::endl
+              << c.info() << "Imbalance : " << c.reset() << imbalance
+              << " (largest " << to_human_size(maxSize) << ", smallest " << to_human_size(minSize) << ")" << std::endl;
+
+    if( plan.alignment > 0 ) {
+        std::uint64_t paddingSize = 0;
+        for( const auto& shard : plan.shards ) { paddingSize += shard.paddingSize; }
+        std::cout << c.info() << "Alignment : " << c.reset() << to_human_size(plan.alignment)
+                  << " (" << to_human_size(paddingSize) << " of padding between tensors)" << std::endl;
+    }
+}
+
+/**
+ * Writes all the shards concurrently.
+ *
+ * Every shard is preallocated and its header is written first, then the
+ * tensor data is copied with positional reads/writes at the precomputed
+ * offsets. Large tensors are split in chunks so that all threads stay busy
+ * even when a few tensors dominate the checkpoint size. Each shard is written
+ * to a temporary name and renamed only when complete.
+ */
+void
+CkRepack::write_shards(const ShardPlan& plan) const {
+    struct CopyJob { size_t source; std::uint64_t sourceOffset; size_t shard; std::uint64_t shardOffset; std::uint64_t size; };
+
+    // open inputs
+    std::vector<File> inputFiles(_inputs.size());
+    for( size_t i=0 ; i<_inputs.size() ; ++i ) {
+        if( !inputFiles[i].open_read(_inputs[i].path()) ) { Messages::fatal_read_error(ReadError::FileNotFound, _inputs[i].path()); }
+    }
+
+    // create outputs and build the list of copy jobs
+    std::error_code errorCode;
+    fs::create_directories(_args.output_dir, errorCode);
+    std::vector<File>   outputFiles(plan.shards.size());
+    std::vector<String> outputPaths(plan.shards.size());
+    std::vector<CopyJob> jobs;
+    for( size_t s=0 ; s<plan.shards.size() ; ++s ) {
+        const auto& shard = plan.shards[s];
+        outputPaths[s] = (fs::path(_args.output_dir) / shard.filename).string();
+        if( !outputFiles[s].create(outputPaths[s] + ".part")  ||
+            !outputFiles[s].resize(shard.file_size())          ||
+            !outputFiles[s].write_at(shard.header.data(), shard.header.size(), 0) )
+        {
+            Messages::fatal_error("Unable to create the output file.", { "File: " + outputPaths[s] + ".part" });
+        }
+        for( size_t t=0 ; t<shard.sources.size() ; ++t ) {
+            const auto& source = shard.sources[t];
+            const std::uint64_t sourceOffset = _inputs[source.source].data_offset() + source.tensor->begin;
+            const std::uint64_t shardOffset  = shard.header.size() + shard.offsets[t];
+            for( std::uint64_t done=0 ; done < source.tensor->size() ; done += CopyChunkSize ) {
+                jobs.push_back({ source.source, sourceOffset + done, s, shardOffset + done,
+                                 std::min(CopyChunkSize, source.tensor->size() - done) });
+            }
+        }
+    }
+
+    // copy all chunks in parallel
+    std::mutex errorMutex;
+    String     errorMessage;
+    parallel_for(jobs.size(), static_cast<unsigned>(std::max(_args.threads, 0)), [&](size_t i) {
+        thread_local std::vector<char> buffer;
+        const auto& job = jobs[i];
+        buffer.resize( std::max<std::uint64_t>(buffer.size(), job.size) );
+        if( !inputFiles[job.source].read_at(buffer.data(), job.size, job.sourceOffset) ||
+            !outputFiles[job.shard].write_at(buffer.data(), job.size, job.shardOffset) )
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if( errorMessage.empty() ) { errorMessage = "Failed to copy tensor data into '" + outputPaths[job.shard] + "'"; }
+        }
+    });
+    if( !errorMessage.empty() ) { Messages::fatal_error(errorMessage); }
+
+    // commit each shard
+    for( size_t s=0 ; s<plan.shards.size() ; ++s ) {
+        if( !outputFiles[s].sync() ) { Messages::fatal_error("Unable to flush the output file.", { "File: " + outputPaths[s] }); }
+        outputFiles[s].close();
+        fs::rename(outputPaths[s] + ".part", outputPaths[s], errorCode);
+        if( errorCode ) { Messages::fatal_error("Unable to rename the output file.", { "File: " + outputPaths[s] }); }
+    }
+}
+
+/**
+ * Writes the `<NAME>.safetensors.index.json` file that maps each tensor to its shard.
+ */
+void
+CkRepack::write_index(const ShardPlan& plan) const {
+    std::vector<std::pair<StringView, StringView>> weightMap;
+    std::uint64_t totalSize = 0;
+    for( const auto& shard : plan.shards ) {
+        for( const auto& source : shard.sources ) { weightMap.emplace_back(source.tensor->name, shard.filename); }
+        totalSize += shard.tensor_size();
+    }
+    const String json = SafetensorsFile::build_index(std::move(weightMap), totalSize);
+
+    const auto path = (fs::path(_args.output_dir) / (_args.name + ".safetensors.index.json")).string();
+    std::ofstream file(path, std::ios::binary);
+    if( !file.write(json.data(), static_cast<std::streamsize>(json.size())) ) {
+        Messages::fatal_error("Unable to write the index file.", { "File: " + path });
+    }
+}
+
+/**
+ * Removes the files of the previous layout left in the output directory.
+ *
+ * Loaders look for '<NAME>.safetensors.index.json' and the shards it lists,
+ * so an index left there after repacking into one file, or an old shard
+ * after repacking into fewer shards, would be loaded instead of (or along
+ * with) the new files. The candidates are the index files given as input,
+ * the '<NAME>.safetensors.index.json' of the output directory when a single
+ * file is written, and the shards listed by any of them; only those inside
+ * the output directory that are not part of the new layout are removed.
+ */
+void
+CkRepack::remove_stale_files(const ShardPlan& plan) const {
+    auto& c = Colors::instance();
+    const fs::path outputDir = _args.output_dir;
+    const fs::path newIndex  = outputDir / (_args.name + ".safetensors.index.json");
+    std::error_code errorCode;
+
+    std::vector<String> indexPaths = _indexPaths;
+    if( plan.shards.size() == 1 && fs::exists(newIndex, errorCode) ) { indexPaths.push_back(newIndex.string()); }
+    std::vector<String> candidates;
+    for( const auto& indexPath : indexPaths ) {
+        ReadError readError;
+        for( auto& shardPath : SafetensorsFile::shards_of_index(indexPath, readError) ) { candidates.push_back( std::move(shardPath) ); }
+        candidates.push_back(indexPath);
+    }
+
+    std::vector<fs::path> keptPaths;
+    for( const auto& shard : plan.shards ) { keptPaths.push_back(outputDir / shard.filename); }
+    if( plan.shards.size() > 1 ) { keptPaths.push_back(newIndex); }
+    size_t removed = 0;
+    for( const auto& candidate : candidates ) {
+        const fs::path path      = candidate;
+        const fs::path directory = path.has_parent_path() ? path.parent_path() : fs::path(".");
+        if( !fs::is_regular_file(path, errorCode) || !fs::equivalent(directory, outputDir, errorCode) ) { continue; }
+        if( std::any_of(keptPaths.begin(), keptPaths.end(), [&](const fs::path& kept) { return fs::equivalent(path, kept, errorCode); }) ) { continue; }
+        if( fs::remove(path, errorCode) ) { ++removed; }
+        else { Messages::warning("Unable to remove '" + candidate + "' of the previous layout."); }
+    }
+    if( removed > 0 ) {
+        std::cout << c.info() << "Removed   : " << c.reset() << removed << " file(s) of the previous layout" << std::endl;
+    }
+}
+
+//================================ RUNNING ================================//
+
+int
+CkRepack::run() {
+
+    // if the color option is set to "auto", disable colors when outputting to a non-terminal
+    if( _args.when_color == "auto" || _args.when_color == "tty" || _args.when_color == "if-tty" ) {
+        if( !is_terminal_output() ) { Colors::instance().disable_colors(); }
+    }
+    // if the color option is set to "never", disable colors regardless of output type
+    else if ( _args.when_color == "never" || _args.when_color == "no" || _args.when_color == "none") {
+        Colors::instance().disable_colors();
+    }
+
+    // if help was requested, show the help message and exit
+    if( _args.help ) { print_help(); return 0; }
+
+    // if version was requested, show the version and exit
+    if( _args.version ) { print_version(); return 0; }
+
+    // if the user didn't provide any file, show an error message and exit
+    if( _args.inputs.empty() ) {
+        Messages::fatal_error("No file provided. Please specify one or more .safetensors files.", {
+            "To get help on how to use this tool, run: ckrepack --help"
+        });
+    }
+    if( _args.shards <= 0 && _args.shard_size == 0 && _args.alignment == 0 ) {
+        Messages::fatal_error("No output layout provided.", {
+            "Use --shards <N> or --shard-size <SIZE> to define the new shards,",
+            "or --align <SIZE> to align the tensors of the current ones."
+        });
+    }
+
+    load_inputs();
+    if( _tensors.empty() ) { Messages::fatal_error("The input files don't contain any tensor."); }
+
+    auto plan = plan_shards();
+    print_plan(plan);
+    if( _args.dry_run ) { return 0; }
+
+    write_shards(plan);
+    if( plan.shards.size() > 1 ) { write_index(plan); }
+    remove_stale_files(plan);
+    return 0;
+}
@@ -0,0 +1,79 @@
+/*
+| File    : ckrepack.h
+| Purpose : The `ckrepack` command line tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 2, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKREPACK_H_
+#define CKREPACK_H_
+#include <vector>
+#include "common.h"
+#include "safetensors.h"    // for SafetensorsFile
+#include "ckrepack_args.h"  // for CkRepackArgs
+
+
+class CkRepack
+{
+public:
+    /// A tensor of one of the input files.
+    struct SourceTensor {
+        const SafetensorsFile::Tensor* tensor; ///< the tensor as described in its input file
+        size_t                         source; ///< index of the input file
+    };
+
+    /// One of the output files, with its tensors and precomputed header.
+    struct Shard {
+        String                       filename;
+        std::vector<SourceTensor>    sources;   ///< tensors in the order they are written
+        std::vector<std::uint64_t>   offsets;   ///< offset of each source tensor in the data section
+        SafetensorsFile::Tensors     tensors;   ///< header entries (source tensors + alignment padding)
+        String                       header;    ///< length prefix + JSON header
+        std::uint64_t                dataSize    = 0;
+        std::uint64_t                paddingSize = 0; ///< bytes added to align the tensors
+        [[nodiscard]] std::uint64_t  file_size()   const noexcept { return header.size() + dataSize; }
+        [[nodiscard]] std::uint64_t  tensor_size() const noexcept { return dataSize - paddingSize;    }
+    };
+
+    struct ShardPlan {
+        std::vector<Shard> shards;
+        std::uint64_t      totalSize = 0; ///< sum of the size of all tensors
+        std::uint64_t      alignment = 0; ///< alignment of every tensor (0 = packed)
+    };
+
+// MAIN
+public:
+    CkRepack(const CkRepackArgs& args);
+    [[nodiscard]] int run();
+
+// STEPS
+public:
+    void      load_inputs();
+    ShardPlan plan_shards() const;
+    void      print_plan(const ShardPlan& plan) const;
+    void      write_shards(const ShardPlan& plan) const;
+    void      write_index(const ShardPlan& plan) const;
+    void      remove_stale_files(const ShardPlan& plan) const;
+
+// HELPERS
+public:
+    [[nodiscard]] static String module_group(StringView tensorName);
+    void print_help() const noexcept;
+    void print_version() const noexcept;
+
+// IMPLEMENTATION
+private:
+    void _add_input(const String& path);
+private:
+    const CkRepackArgs           _args;
+    std::vector<SafetensorsFile> _inputs;
+    std::vector<String>          _indexPaths;  ///< the .index.json files given as input
+    std::vector<SourceTensor>    _tensors;
+};
+
+#endif // CKREPACK_H_
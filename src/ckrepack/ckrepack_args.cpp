@@ -0,0 +1,114 @@
+/*
+| File    : ckrepack_args.cpp
+| Purpose : The arguments of the `ckrepack` command line
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 2, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <string>   // for std::string
+#include "common.h"
+#include "ckrepack_args.h"
+#include "argument.h"
+#include "messages.h"
+
+
+//============================= CONSTRUCTION ==============================//
+
+/**
+ * Constructs a new CkRepackArgs object by parsing command line arguments.
+ *
+ * @param argc The number of command line arguments passed to the program.
+ * @param argv An array of C strings representing the command line arguments.
+ */
+CkRepackArgs::CkRepackArgs(int argc, char* argv[])
+: help_message{R"(
+Usage: ckrepack [OPTIONS] file...
+
+  Rewrites one .safetensors file, or an existing sharded set, into a new set
+  of shards balanced by size. Tensors of the same module (e.g. all tensors
+  under 'model.layers.12') are kept in the same shard whenever possible.
+  When more than one shard is produced, a '<NAME>.safetensors.index.json'
+  file is generated too.
+
+  The input can be any number of .safetensors files or the .index.json file
+  of a sharded checkpoint. Once the new files are written, the index files
+  of the previous layout in the output directory (an input index, or the
+  '<NAME>.safetensors.index.json' when only one file is produced) and the
+  old shards they list are removed, so loaders don't pick them up.
+
+  With --align, every tensor is placed at an offset multiple of the given
+  alignment and the header is padded so the data section starts on a page
+  boundary. The format does not allow unindexed bytes, so the gaps are
+  covered by small U8 tensors named '__padding__.<N>', excluded from the
+  index file. Stock readers load them as regular tensors:
+  safetensors.load_file() returns them and a strict load_state_dict()
+  rejects them as unexpected keys, so drop the '__padding__.' prefix after
+  loading (or load with strict=False).
+  Without --shards/--shard-size the number of shards is kept.
+
+  OPTIONS:
+    -n, --shards <N>         Number of shards to produce
+    -s, --shard-size <SIZE>  Target size of each shard, e.g. '5G' or '500M'
+    -a, --align <SIZE>       Align every tensor to SIZE bytes, e.g. '64', '4K' or '2M'
+    -o, --output <DIR>       Directory where the new files are written (default: current directory)
+    --name <NAME>            Base name of the generated files (default: 'model')
+    -t, --threads <N>        Number of threads used to write the shards (default: one per core)
+    --dry-run                Print the shard plan without writing anything
+
+    --nc, --no-color         Disable color output.
+    -h  , --help             Show this help message and exit.
+    -v  , --version          Show version information and exit.
+
+  Examples:
+    ckrepack --shards 4 -o out/ 'model.safetensors'
+    ckrepack --shard-size 2G -o out/ 'model.safetensors.index.json'
+    ckrepack --align 4K -o aligned/ 'model.safetensors'
+)"}
+{
+    for( int i=1 ; i < argc ; ++i )
+    {
+        auto arg = Argument{i, argc, argv};
+
+        // parse the options
+        if( arg.is_option() ) {
+        //-LAYOUT:
+            if     (arg.is( "-n", "--shards"     )) { shards     = to_integer(arg.value(i)); }
+            else if(arg.is( "-s", "--shard-size" )) { shard_size = to_size(arg.value(i));    }
+            else if(arg.is( "-a", "--align"      )) { alignment  = to_size(arg.value(i));    }
+            else if(arg.is( "-o", "--output"     )) { output_dir = arg.value(i); }
+            else if(arg.is(       "--name"       )) { name       = arg.value(i); }
+            else if(arg.is( "-t", "--threads"    )) { threads    = to_integer(arg.value(i)); }
+            else if(arg.is(       "--dry-run"    )) { dry_run    = true; }
+        //-EXTRA:
+            else if(arg.is( "-h", "--help"       )) { help = true; }
+            else if(arg.is( "-v", "--version"    )) { version = true; }
+            else if(arg.is( "--color"            )) { when_color = arg.value(i);  }
+            else if(arg.is( "--nc", "--no-color" )) { when_color = "never"; }
+            else {
+                // if an unknown argument is encountered, display a fatal error message
+                Messages::fatal_error( "Unknown argument: " + arg.name(), {
+                    "Try `ckrepack --help` for more information." });
+            }
+            // check if the user provided a value that was not consumed by the option
+            if( arg.has_value() && !arg.was_value_consumed() ) {
+                Messages::fatal_error( "The argument '"+ arg.name() +"' no expects a value and '"+ arg.value(i) +"' was provided.", {
+                    "Try `ckrepack --help` for more information." });
+            }
+        }
+        // handle positional arguments, arguments without a preceding hyphen
+        // (every positional argument is an input file)
+        else {
+            inputs.push_back( arg.name() );
+        }
+    }
+
+    // the alignment must be a power of two
+    if( alignment != 0 && (alignment & (alignment - 1)) != 0 ) {
+        Messages::fatal_error("The alignment must be a power of two.", {
+            "Valid alignments are for example '64', '4K' or '2M'." });
+    }
+}
@@ -0,0 +1,70 @@
+/*
+| File    : ckrepack_args.h
+| Purpose : The arguments of the `ckrepack` command line
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 2, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKREPACK_ARGS_H_
+#define CKREPACK_ARGS_H_
+#include <iostream>
+#include <vector>
+#include "common.h"
+
+
+struct CkRepackArgs
+{
+// CONSTRUCTION/DESTRUCTION
+public:
+    CkRepackArgs(int argc, char* argv[]);
+    CkRepackArgs() = default;
+    CkRepackArgs(const CkRepackArgs&) = default;
+    CkRepackArgs(CkRepackArgs&&) noexcept = default;
+    ~CkRepackArgs() = default;
+
+// PUBLIC MEMBERS
+public:
+    std::vector<String> inputs;                 ///< The files to read (.safetensors or .index.json)
+    String        output_dir  = ".";            ///< Directory where the new files are written
+    String        name        = "model";        ///< Base name of the generated shards
+    int           shards      = 0;              ///< Number of shards to produce (0 = from shard_size)
+    std::uint64_t shard_size  = 0;              ///< Target size in bytes of each shard (0 = from shards)
+    std::uint64_t alignment   = 0;              ///< Alignment of the tensor data (0 = packed)
+    int           threads     = 0;              ///< Number of writer threads (0 = one per core)
+    String        when_color  = "auto";         ///< When to use color in output
+    bool          dry_run     = false;          ///< true = only print the shard plan
+    bool          help        = false;          ///< true = print usage and exit
+    bool          version     = false;          ///< true = print version and exit
+    const char * const help_message = nullptr;
+};
+
+/**
+ * Overloads the insertion operator (<<) for printing CkRepackArgs objects to an output stream.
+ *
+ * @param os   The output stream where the Args data will be printed.
+ * @param args The Args object being printed to the stream.
+ * @return A reference `os` for chaining.
+ */
+inline std::ostream&
+operator<<(std::ostream& os, const CkRepackArgs& args) {
+    os << "Args:"                                          << std::endl;
+    os << "  inputs: "      << args.inputs.size()          << std::endl;
+    os << "  output_dir: "  << args.output_dir             << std::endl;
+    os << "  name: "        << args.name                   << std::endl;
+    os << "  shards: "      << args.shards                 << std::endl;
+    os << "  shard_size: "  << args.shard_size             << std::endl;
+    os << "  alignment: "   << args.alignment              << std::endl;
+    os << "  threads: "     << args.threads                << std::endl;
+    os << "  when_color: "  << args.when_color             << std::endl;
+    os << "  dry_run: "     << to_string(args.dry_run)     << std::endl;
+    os << "  help: "        << to_string(args.help)        << std::endl;
+    os << "  version: "     << to_string(args.version);
+    return os;
+}
+
+#endif // CKREPACK_ARGS_H_
@@ -0,0 +1,19 @@
+/*
+| File    : main.cpp
+| Purpose : Main entry point for the `ckrepack` command tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 2, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include "ckrepack_args.h"
+#include "ckrepack.h"
+
+int main(int argc, char* argv[]) {
+    CkRepackArgs args{argc, argv};
+    CkRepack     ckrepack{args};
+    return ckrepack.run();
+}
@@ -9,12 +9,25 @@
 |                              CheckpointTools
 |      CLI tools for inspecting and manipulating model checkpoint files
 \_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
-#include <format> // for std::format() [C++20]
+#include <algorithm> // for std::max, std::min, std::sort
+#include <cstdio>        // for std::snprintf
+#include <filesystem>    // for std::filesystem::file_size
+#include <functional>    // for std::hash
+#include <map>           // for std::map
+#include <optional>      // for std::optional
+#include <unordered_map> // for std::unordered_map
 #include <tin/tensormap.h>
-#include <tin/tensortree.h>
 #include "table.h"
 #include "colors.h"
+#include "outputsink.h"
 #include "messages.h"
+#include "arrowwriter.h"
+#include "ckshow_batch.h"
+#include "ckshow_cache.h"
+#include "ckshow_daemon.h"
+#include "ckshow_identify.h"
+#include "ckshow_nametree.h"
+#include "ckshow_query.h"
 #include "ckshow.h"
 #ifdef _WIN32
     inline bool is_terminal_output() { return true; }
@@ -28,8 +41,20 @@ using namespace tin;
 
 //============================= CONSTRUCTION ==============================//
 
-CkShow::CkShow(const CkShowArgs& args)
+/**
+ * Prepares the tool to run the command described by `args`.
+ *
+ * @param args  The parsed command line.
+ * @param out   Where the output goes (the standard output by default).
+ * @param cache If not null, the headers are taken from this cache instead
+ *              of being read for every run.
+ */
+CkShow::CkShow(const CkShowArgs& args, OutputSink& out, HeaderCache* cache)
 : _args(args)
+, _out(out)
+, _cache(cache)
+, _terminal(&out == &OutputSink::standard_output() && is_terminal_output())
+, _path(args.resolve(args.filename))
 {}
 
 //================================ HELPERS ================================//
@@ -68,126 +93,759 @@ CkShow::to_string(tin::StorageType storageType) const noexcept {
     return it != map.end() ? it->second : unknown;
 }
 
+/**
+ * Returns the short name of a storage type as used in JSON output ("i32", "[str]", ...).
+ */
+StringView
+CkShow::type_name(tin::StorageType storageType) const noexcept {
+    StringView name = to_string(storageType);
+    while( !name.empty() && name.front() == ' ' ) { name.remove_prefix(1); }
+    while( !name.empty() && name.back()  == ' ' ) { name.remove_suffix(1); }
+    return name;
+}
+
 void
 CkShow::print_help() const noexcept {
-    std::cout << _args.help_message  << std::endl;
+    _out << _args.help_message << '\n';
 }
 
 void
 CkShow::print_version() const noexcept {
-    std::cout << "ckshow (CheckpointTools ckshow) " << PROJECT_VERSION << std::endl;
+    _out << "ckshow (CheckpointTools ckshow) " << PROJECT_VERSION << '\n';
 }
 
+/**
+ * Ends an NDJSON record and flushes the output once a batch is complete.
+ *
+ * The output is only flushed between records, and only after a large
+ * batch of them, so every write(2) carries whole lines.
+ */
 void
-CkShow::fatal_read_error(ReadError readError) {
-    switch(readError) {
-        case ReadError::FileNotFound:
-            Messages::fatal_error("File not found.");
-            break;
+CkShow::end_ndjson_record(JsonWriter& json) const {
+    static const size_t BatchSize = 256 * 1024;
+    json.end_object().end_document();
+    auto& out = _out;
+    if( out.pending() >= BatchSize ) { out.flush(); }
+}
 
-        case ReadError::InvalidFormat:
-            Messages::fatal_error("This is probably not a valid .safetensors or .gguf file.");
-            break;
+/**
+ * Compiles the patterns of `--match` and the expression of `--where`; an
+ * invalid regex or expression is a fatal error.
+ */
+void
+CkShow::compile_selection(PatternSet& patterns, TensorQuery& query) const {
+    String error;
+    for( const auto& pattern : _args.patterns ) {
+        if( !patterns.add(pattern, error) ) {
+            Messages::fatal_error(error, {
+                "Patterns enclosed in slashes are regular expressions, e.g. --match '/layers\\.[0-9]+\\.mlp/'",
+                "Any other pattern is a glob where '*' matches any text, e.g. --match '*.mlp.*'" });
+        }
+    }
+    if( !_args.where.empty() && !query.compile(_args.where, error) ) {
+        Messages::fatal_error(error, {
+            "Conditions compare name, dtype, shape, rank, numel, bytes, offset or dims[i], e.g. --where 'rank == 2 && bytes > 16MB'",
+            "Texts go in quotes and are matched with ~ as a glob or a /regex/, e.g. --where 'name ~ \"*.mlp.*\"'" });
+    }
+}
 
-        case ReadError::UnsupportedVersion:
-            Messages::fatal_error("The file may be from an older or newer version of the format that this tool does not support.");
-            break;
+/**
+ * Narrows the inventory to the tensors selected by `--prefix`, `--match` and
+ * `--where`, and sorts them in the `--sort` order.
+ * The patterns and the expression are compiled once here.
+ */
+void
+CkShow::select_tensors(TensorInventory& inventory) const {
+    PatternSet  patterns;
+    TensorQuery query;
+    compile_selection(patterns, query);
+    inventory.select(_args.prefix, patterns);
+    if( !_args.where.empty() ) { query.select(inventory); }
+    if( _args.sort == "name" ) { inventory.sort_by_name();   }
+    else                       { inventory.sort_naturally(); }
+}
 
-        case ReadError::HeaderTooLarge:
-            Messages::fatal_error("The file header may be corrupted, incomplete, or have other issues that prevent it from being read correctly.");
-            break;
+/**
+ * Returns the architectures recognized by `--identify`: the builtin ones
+ * and the ones of `--signatures`, which must be valid.
+ */
+ArchitectureTable
+CkShow::architectures() const {
+    auto table = ArchitectureTable::builtin();
+    if( !_args.signatures.empty() ) {
+        String error;
+        if( !table.load(_args.resolve(_args.signatures), error) ) {
+            Messages::fatal_error(error, {
+                R"(The file must be a JSON array like [{"name": "My DiT", "keys": ["blocks.#.attn.qkv.weight"]}])" });
+        }
+    }
+    return table;
+}
 
-        case ReadError::MemoryAllocationFailed:
-            Messages::fatal_error("There may not be enough memory available to read this file, or it is corrupted in a way that prevents allocation of enough memory.");
-            break;
+/**
+ * Checks the arguments that are the same for every file (the patterns, the
+ * expression and the signatures), so a batch reports an error in them once
+ * instead of once per file. An invalid one is a fatal error.
+ */
+void
+CkShow::check_arguments() const {
+    PatternSet  patterns;
+    TensorQuery query;
+    compile_selection(patterns, query);
+    if( _args.command == Command::IDENTIFY ) { (void)architectures(); }
+}
 
-        case ReadError::MissingData:
-            Messages::fatal_error("The file is missing some required data, which may indicate corruption or have other issues that prevent it from being read correctly.");
-            break;
-            
-        default:
-            Messages::fatal_error("An unknown error occurred while reading the file.");
+/**
+ * Returns the inventory of the file, from the cache when there is one (the
+ * copy of a cached inventory shares its header and is already sorted in
+ * natural order). A file that can't be read is a fatal error.
+ */
+TensorInventory
+CkShow::load_inventory() const {
+    ReadError readError = ReadError::None;
+    if( _cache ) {
+        const auto cached = _cache->inventory(_path, readError);
+        if( !cached ) { fatal_read_error(readError); }
+        return *cached;
     }
+    TensorInventory inventory{ _path, readError };
+    if( readError != ReadError::None ) { fatal_read_error(readError); }
+    return inventory;
+}
+
+/**
+ * Returns the TensorMap of the file, from the cache when there is one.
+ * A file that can't be read is a fatal error.
+ */
+std::shared_ptr<const TensorMap>
+CkShow::load_tensor_map() const {
+    ReadError readError = ReadError::None;
+    std::shared_ptr<const TensorMap> tensorMap;
+    if( _cache ) { tensorMap = _cache->tensor_map(_path, readError); }
+    else         { tensorMap.reset( new TensorMap(TensorMap::from_file(_path, readError)) ); }
+    if( readError != ReadError::None ) { fatal_read_error(readError); }
+    return tensorMap;
+}
+
+void
+CkShow::fatal_read_error(ReadError readError) const {
+    Messages::fatal_read_error(readError, _args.filename);
 }
 
 //============================== SUBCOMMANDS ==============================//
 
 
+/**
+ * Stores the shape of a tensor as text in `text`, e.g. "[4096,4096]".
+ * (`shape` is scratch space, reused between calls)
+ */
+static const String&
+_shape_text(String& text, const TensorInventory::Entry& entry, std::vector<std::int64_t>& shape) {
+    entry.shape(shape);
+    text = "[";
+    for( size_t k = 0 ; k < shape.size() ; ++k ) { if( k ) { text += ','; } text += std::to_string(shape[k]); }
+    text += ']';
+    return text;
+}
+
+/// Mixes `value` into the hash `seed` (order dependent).
+static std::uint64_t
+_hash_combine(std::uint64_t seed, std::uint64_t value) noexcept {
+    // splitmix64 finalizer applied to the sum, so equal inputs in other positions don't cancel
+    std::uint64_t x = seed * 0x9E3779B97F4A7C15ull + value;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * Tensor count, parameters, bytes, dtypes and structural hash of every
+ * subtree of a NameTree.
+ *
+ * The hash covers the names relative to the subtree, the shapes and the
+ * dtypes of its tensors, but not the name of the subtree itself, so two
+ * blocks with the same layout ("layers.0", "layers.1") hash the same.
+ */
+struct SubtreeSizes {
+    struct Totals {
+        std::uint64_t tensors    = 0;
+        std::uint64_t parameters = 0;
+        std::uint64_t bytes      = 0;
+        std::uint64_t dtypes     = 0; ///< bit i set = the subtree has tensors of `dtypes[i]`
+        std::uint64_t hash       = 0; ///< structural hash
+
+        Totals& operator+=(const Totals& other) noexcept {
+            tensors += other.tensors; parameters += other.parameters; bytes += other.bytes; dtypes |= other.dtypes;
+            return *this;
+        }
+    };
+    std::vector<Totals>     nodes;    ///< indexed like the nodes of the tree
+    std::vector<StringView> dtypes;   ///< every dtype found (beyond 64 they share the last bit)
+    std::vector<size_t>     byName;   ///< indices of `dtypes` in alphabetical order
+
+    explicit SubtreeSizes(const NameTree& tree) : nodes(tree.number_of_nodes()) {
+        _sum_subtree(tree, 0);
+        byName.resize(dtypes.size());
+        for( size_t i = 0 ; i < byName.size() ; ++i ) { byName[i] = i; }
+        std::sort(byName.begin(), byName.end(), [&](size_t a, size_t b) { return dtypes[a] < dtypes[b]; });
+    }
+
+    /// Stores in `text` the dtypes of a subtree, e.g. "BF16,F32".
+    const String& dtype_mix(std::uint64_t mask, String& text) const {
+        text.clear();
+        for( const auto i : byName ) {
+            if( (mask & (std::uint64_t{1} << std::min<size_t>(i, 63))) == 0 ) { continue; }
+            if( !text.empty() ) { text += ','; }
+            text.append(dtypes[i]);
+        }
+        return text;
+    }
+
+private:
+    // post-order: the totals of a node are its tensors plus the totals of its
+    // subnodes, and its hash combines theirs with their names relative to it
+    const Totals& _sum_subtree(const NameTree& tree, std::uint32_t index) {
+        const std::hash<StringView> hash_text;
+        Totals totals;
+        const auto& node = tree.node(index);
+        const size_t start = node.length > 0 ? node.length + 1 : 0;
+        for( auto tensor = node.firstTensor ; tensor != NameTree::None ; tensor = tree.next_tensor(tensor) ) {
+            const auto& entry = tree.tensor(tensor);
+            totals.tensors    += 1;
+            totals.parameters += entry.elements();
+            totals.bytes      += entry.size;
+            totals.dtypes     |= std::uint64_t{1} << _dtype_bit(entry.dtype);
+            totals.hash = _hash_combine(totals.hash, hash_text(entry.name.substr(start)));
+            totals.hash = _hash_combine(totals.hash, hash_text(entry.dtype));
+            for( const auto dimension : *entry.dims ) { totals.hash = _hash_combine(totals.hash, dimension); }
+        }
+        for( auto subnode = node.firstChild ; subnode != NameTree::None ; subnode = tree.node(subnode).nextSibling ) {
+            const auto& subtotals = _sum_subtree(tree, subnode);
+            totals += subtotals;
+            totals.hash = _hash_combine(totals.hash, hash_text(tree.name(tree.node(subnode)).substr(start)));
+            totals.hash = _hash_combine(totals.hash, subtotals.hash);
+        }
+        return nodes[index] = totals;
+    }
+    size_t _dtype_bit(StringView dtype) {
+        if( _last < dtypes.size() && dtypes[_last] == dtype ) { return std::min<size_t>(_last, 63); }
+        _last = static_cast<size_t>( std::find(dtypes.begin(), dtypes.end(), dtype) - dtypes.begin() );
+        if( _last == dtypes.size() ) { dtypes.push_back(dtype); }
+        return std::min<size_t>(_last, 63);
+    }
+    size_t _last = 0;
+};
+
+/**
+ * The state shared by the recursive calls that fill the tree table.
+ */
+struct TreeTable {
+    Table&              table;
+    const NameTree&     tree;
+    const SubtreeSizes* sizes;       ///< nullptr = no size columns
+    bool                fold;        ///< true = show repeated blocks once
+    String              name, shapeText, number, mix;
+    std::vector<std::int64_t> shape;
+};
+
+/**
+ * A group of sibling blocks with the same structure, e.g. "layers.0" to
+ * "layers.79", shown as a single subnode.
+ */
+struct Fold {
+    StringView                 stem;     ///< the name of the blocks before their number ("" or "block")
+    StringView                 rest;     ///< the name of the blocks after their number ("" or ".mlp")
+    std::vector<std::uint64_t> numbers;  ///< the numbers of the blocks
+    std::uint32_t              first;    ///< the block that is shown
+    SubtreeSizes::Totals       totals;   ///< of all the blocks
+};
+
+/**
+ * Groups the subnodes of a node whose names relative to it differ only in
+ * the number that ends their first component ("0", "1", ..., "block0.mlp",
+ * "block1.mlp", ...) and whose subtrees have the same structure. Returns
+ * the groups of two or more blocks, and sets `foldOf[i]` to the group of
+ * the i-th subnode (or -1 when the subnode is shown as usual).
+ */
+static std::vector<Fold>
+_find_folds(const NameTree& tree, const SubtreeSizes& sizes, const NameTree::Node& node, std::vector<int>& foldOf) {
+    struct Block { std::uint64_t hash; StringView stem, rest; std::uint64_t number; std::uint32_t index; size_t position; };
+    std::vector<Block> blocks;
+    const size_t start = node.length > 0 ? node.length + 1 : 0;
+    size_t position = 0;
+    for( auto index = node.firstChild ; index != NameTree::None ; index = tree.node(index).nextSibling, ++position ) {
+        const StringView label     = tree.name(tree.node(index)).substr(start);
+        const StringView component = label.substr(0, label.find('.'));
+        const size_t     digits    = component.size() - (component.find_last_not_of("0123456789") + 1);
+        if( digits == 0 || digits > 18 ) { continue; }
+        const StringView stem = component.substr(0, component.size() - digits);
+        blocks.push_back({ sizes.nodes[index].hash, stem, label.substr(component.size()),
+                           std::stoull(String{component.substr(stem.size())}), index, position });
+    }
+    foldOf.assign(position, -1);
+
+    // equal blocks become adjacent, each group keeps the order of its blocks
+    auto same = [](const Block& a, const Block& b) { return a.hash == b.hash && a.stem == b.stem && a.rest == b.rest; };
+    std::stable_sort(blocks.begin(), blocks.end(), [](const Block& a, const Block& b) {
+        if( a.hash != b.hash ) { return a.hash < b.hash; }
+        return a.stem != b.stem ? a.stem < b.stem : a.rest < b.rest; });
+    std::vector<Fold> folds;
+    for( size_t i = 0, end = 0 ; i < blocks.size() ; i = end ) {
+        for( end = i + 1 ; end < blocks.size() && same(blocks[end], blocks[i]) ; ++end ) { }
+        if( end - i < 2 ) { continue; }
+        Fold fold{ blocks[i].stem, blocks[i].rest, {}, blocks[i].index, {} };
+        for( size_t k = i ; k < end ; ++k ) {
+            fold.numbers.push_back(blocks[k].number);
+            fold.totals += sizes.nodes[blocks[k].index];
+            foldOf[blocks[k].position] = static_cast<int>(folds.size());
+        }
+        std::sort(fold.numbers.begin(), fold.numbers.end());
+        folds.push_back( std::move(fold) );
+    }
+    return folds;
+}
+
+/**
+ * Writes the numbers of a fold as ranges: "[0-79]", "[0-3,5,7-9]".
+ */
 static void
-_fill_table_recursively(Table& table, const TensorTreeNode& node) {
-    String nodeName = node.name();
+_append_fold_label(String& text, const std::vector<std::uint64_t>& numbers) {
+    text += '[';
+    for( size_t i = 0 ; i < numbers.size() ; ) {
+        size_t last = i;
+        while( last + 1 < numbers.size() && numbers[last + 1] == numbers[last] + 1 ) { ++last; }
+        if( i > 0 ) { text += ','; }
+        text += std::to_string(numbers[i]);
+        if( last > i ) { text += '-'; text += std::to_string(numbers[last]); }
+        i = last + 1;
+    }
+    text += ']';
+}
 
-    for( auto tensorPtr: node.tensor_pointers(SortBy::NAME) ) {
-        String tensorName( tensorPtr->relative_name(nodeName) );
-        String shape     ( tensorPtr->shape().to_string()     );
-        String dtype     ( tensorPtr->dtype().to_string()     );
+/**
+ * Adds to the table the tensors of a node, followed by each of its subnodes
+ * (a row with the name of the subnode, then its content).
+ * With `--sizes` every row also has parameters and bytes, and the rows of
+ * the subnodes show the totals of their subtree and their dtypes.
+ * With `--fold` each group of repeated blocks is shown once, with the
+ * totals of the whole group, by listing the content of its first block
+ * (the rows inside it are those of one block).
+ *
+ * @param nodeIndex   The node to add.
+ * @param displayName The name printed for the node ("model.layers.[0-79]"
+ *                    when it represents a fold, otherwise its own name).
+ */
+static void
+_fill_table_recursively(TreeTable& t, std::uint32_t nodeIndex, StringView displayName) {
+    const auto& node = t.tree.node(nodeIndex);
+    const size_t start = node.length > 0 ? node.length + 1 : 0;
 
-        if( !nodeName.empty() ) { tensorName = nodeName + "|" + tensorName; }
-        table.add_row({ shape, dtype, tensorName });
+    for( auto index = node.firstTensor ; index != NameTree::None ; index = t.tree.next_tensor(index) ) {
+        const auto& tensor = t.tree.tensor(index);
+        if( !displayName.empty() ) { t.name.assign(displayName); t.name += '|'; t.name.append(tensor.name.substr(start)); }
+        else                       { t.name.assign(tensor.name); }
+        _shape_text(t.shapeText, tensor, t.shape);
+        if( t.sizes ) { t.table.add_row({ t.shapeText, tensor.dtype, to_human_count(tensor.elements()), to_human_size(tensor.size), t.name }); }
+        else          { t.table.add_row({ t.shapeText, tensor.dtype, t.name }); }
     }
 
-    for( auto subnodePtr: node.subnode_pointers(SortBy::NAME) ) {
-        table.add_row({ "", "", subnodePtr->name() });
-        _fill_table_recursively(table, *subnodePtr);
+    std::vector<int>  foldOf;
+    std::vector<Fold> folds;
+    if( t.fold && t.sizes ) { folds = _find_folds(t.tree, *t.sizes, node, foldOf); }
+
+    String subnodeName;
+    size_t position = 0;
+    for( auto index = node.firstChild ; index != NameTree::None ; index = t.tree.node(index).nextSibling, ++position ) {
+        const Fold* fold = !foldOf.empty() && foldOf[position] >= 0 ? &folds[ static_cast<size_t>(foldOf[position]) ] : nullptr;
+        if( fold && fold->first != index ) { continue; }
+
+        subnodeName.assign(displayName);
+        if( !displayName.empty() ) { subnodeName += '.'; }
+        if( fold ) {
+            subnodeName.append(fold->stem);
+            _append_fold_label(subnodeName, fold->numbers);
+            subnodeName.append(fold->rest);
+        }
+        else       { subnodeName.append( t.tree.name(t.tree.node(index)).substr(start) ); }
+
+        t.name.assign(subnodeName);
+        if( fold ) { t.name += " x"; t.name += std::to_string(fold->numbers.size()); }
+        if( t.sizes ) {
+            const auto& totals = fold ? fold->totals : t.sizes->nodes[index];
+            t.number = std::to_string(totals.tensors) + (totals.tensors == 1 ? " tensor" : " tensors");
+            t.table.add_row({ t.number, t.sizes->dtype_mix(totals.dtypes, t.mix),
+                              to_human_count(totals.parameters), to_human_size(totals.bytes), t.name });
+        }
+        else { t.table.add_row({ "", "", t.name }); }
+        _fill_table_recursively(t, index, subnodeName);
     }
 }
 
 
+/**
+ * Lists the tensors grouped in the nodes of their name tree.
+ * The tree is built from the name-sorted inventory (see NameTree), so the
+ * memory used is a few integers per tensor, and the rows are printed in
+ * blocks of `lookahead` rows while the tree is walked. With `--sizes` or
+ * `--fold` the totals and structural hashes of every subtree are computed in
+ * one pass before the first row (folded blocks always show their totals,
+ * so `--fold` adds the size columns).
+ */
 void
-CkShow::list_tensors(const TensorMap& tensorMap) const {
+CkShow::list_tensors(const TensorInventory& inventory) const {
     using Align = Table::Align;
 
     auto& c = Colors::instance();
-    TensorTree tensorTree{ tensorMap };
-    tensorTree.flatten_single_tensor_subnodes();
+    NameTree tree{ inventory };
+    std::optional<SubtreeSizes> sizes;
+    if( _args.sizes || _args.fold ) { sizes.emplace(tree); }
 
     Table table;
-    table.set_alignments({Align::RIGHT, Align::RIGHT, Align::LEFT});
-    table.set_max_widths({           0,            0,           0});
-    table.set_min_widths({           0,            0,           0});
-    // implementar el colorizador como un lambda que recibe index de columna y string y devuelve string
-    table.set_colorizer([&c](int column, const String& text) {
-        switch( column ) {
-            case 0: return c.data()    + text + c.reset(); break;
-            case 1: return c.data2()   + text + c.reset(); break;
-            case 2: return c.primary() + text + c.reset(); break;
+    if( sizes ) {
+        table.set_alignments({Align::RIGHT, Align::RIGHT, Align::RIGHT, Align::RIGHT, Align::LEFT});
+        table.set_styles({ {c.data(), c.reset()}, {c.data2(), c.reset()}, {c.data2(), c.reset()}, {c.data2(), c.reset()}, {c.primary(), c.reset()} });
+    } else {
+        table.set_alignments({Align::RIGHT, Align::RIGHT, Align::LEFT});
+        table.set_max_widths({           0,            0,           0});
+        table.set_min_widths({           0,            0,           0});
+        table.set_styles({ {c.data(), c.reset()}, {c.data2(), c.reset()}, {c.primary(), c.reset()} });
+    }
+
+    auto& out = _out;
+    table.set_streaming(out, static_cast<size_t>(std::max(_args.lookahead, 0)));
+    TreeTable treeTable{ table, tree, sizes ? &*sizes : nullptr, _args.fold, {}, {}, {}, {}, {} };
+    _fill_table_recursively(treeTable, 0, "");
+    table.flush();
+    out << '\n';
+}
+
+static void
+_write_tree_recursively(JsonWriter& json, const NameTree& tree, const SubtreeSizes* sizes, std::uint32_t nodeIndex) {
+    const auto& node = tree.node(nodeIndex);
+    json.begin_object();
+    json.member("name", tree.name(node));
+    if( sizes ) {
+        const auto& totals = sizes->nodes[nodeIndex];
+        json.member("tensor_count", totals.tensors);
+        json.member("parameters", totals.parameters);
+        json.member("bytes", totals.bytes);
+        json.key("dtypes").begin_array();
+        for( const auto i : sizes->byName ) {
+            if( totals.dtypes & (std::uint64_t{1} << std::min<size_t>(i, 63)) ) { json.value(sizes->dtypes[i]); }
         }
-        return text;
-    });
-    _fill_table_recursively(table, tensorTree.root());
-    std::cout << table << std::endl;
+        json.end_array();
+    }
+    json.key("tensors").begin_array();
+    for( auto index = node.firstTensor ; index != NameTree::None ; index = tree.next_tensor(index) ) {
+        const StringView name = tree.tensor(index).name;
+        json.value( node.length > 0 ? name.substr(node.length + 1) : name );
+    }
+    json.end_array();
+    json.key("nodes").begin_array();
+    for( auto index = node.firstChild ; index != NameTree::None ; index = tree.node(index).nextSibling ) {
+        _write_tree_recursively(json, tree, sizes, index);
+    }
+    json.end_array();
+    json.end_object();
 }
 
+/**
+ * Lists the tensors as a JSON document: a flat array with the name, shape
+ * and dtype of every tensor, followed by the hierarchy shown by the human
+ * listing (each node holds the names of its tensors relative to the node,
+ * and with `--sizes` the totals and dtypes of its subtree).
+ */
 void
-CkShow::list_tensors_columns(const TensorMap& tensorMap) const {
-    auto sortedTensors = tensorMap.collect_tensors(SortBy::NAME);
+CkShow::list_tensors_json(const TensorInventory& inventory) const {
+    NameTree tree{ inventory };
+    std::optional<SubtreeSizes> sizes;
+    if( _args.sizes ) { sizes.emplace(tree); }
+    std::vector<std::int64_t> shape;
 
-    size_t nameMaxLen = 0, shapeMaxLen = 0;
-    for(const auto& tensor : sortedTensors) {
-        auto shapeString = tensor.shape().to_string("[]", ",");
-        nameMaxLen = std::max(nameMaxLen, tensor.name().length());
-        shapeMaxLen = std::max(shapeMaxLen, shapeString.length());
+    JsonWriter json{ _out };
+    json.begin_object();
+    json.member("file", _args.filename);
+    json.member("tensor_count", inventory.entries().size());
+    json.key("tensors").begin_array();
+    for( const auto& entry : inventory.entries() ) {
+        entry.shape(shape);
+        json.begin_object();
+        json.member("name", entry.name);
+        json.key("shape").begin_array();
+        for( const auto dimension : shape ) { json.value(dimension); }
+        json.end_array();
+        json.member("dtype", entry.dtype);
+        json.end_object();
     }
-    
-    for(const auto& tensor : sortedTensors) {
-        auto shapeString = tensor.shape().to_string("[]", ",");
-        std::cout << std::format("{:<{}}   {:<{}}  {}\n",
-            tensor.name(), nameMaxLen,
-            shapeString, shapeMaxLen,
-            tensor.dtype());
+    json.end_array();
+    json.key("tree");
+    _write_tree_recursively(json, tree, sizes ? &*sizes : nullptr, 0);
+    json.end_object().end_document();
+}
+
+/**
+ * Returns the name up to its first numeric component ("model.layers.12"
+ * for "model.layers.12.mlp.up_proj.weight"), which groups the tensors of
+ * each repeated block, or the name without its last component if it has
+ * no numeric component ("lm_head" for "lm_head.weight").
+ */
+static StringView
+_name_prefix(StringView name) noexcept {
+    size_t start = 0;
+    while( start < name.size() ) {
+        size_t end = name.find('.', start);
+        if( end == StringView::npos ) { break; }
+        const auto component = name.substr(start, end - start);
+        if( !component.empty() && component.find_first_not_of("0123456789") == StringView::npos ) {
+            return name.substr(0, end);
+        }
+        start = end + 1;
     }
+    const auto dot = name.rfind('.');
+    return dot == StringView::npos ? StringView{} : name.substr(0, dot);
 }
 
+/**
+ * Writes the tensor inventory as an Arrow IPC stream, in `--sort` order.
+ *
+ * The stream includes the offset and size of every tensor, so it is built
+ * from the inventory rather than from the TensorMap. Shapes are row-major
+ * for both formats. `prefix` is the block the tensor belongs to (see
+ * `_name_prefix()`); `file`, `prefix` and `dtype` are dictionary-encoded.
+ */
 void
-CkShow::list_tensors_csv(const TensorMap& tensorMap, bool includeHeader /* = true */) const {
-    auto sortedTensors = tensorMap.collect_tensors(SortBy::NAME);
-    if(includeHeader) {
-        std::cout << "name,shape,dtype" << std::endl;
+CkShow::list_tensors_arrow(const TensorInventory& inventory) const {
+    enum { FILENAME, NAME, PREFIX, DTYPE, SHAPE, OFFSET, BYTES, ELEMENTS };
+    using Type = ArrowWriter::Type;
+    ArrowWriter arrow{ _out, {
+        {"file", Type::DICTIONARY}, {"name",   Type::STRING}, {"prefix", Type::DICTIONARY}, {"dtype",    Type::DICTIONARY},
+        {"shape", Type::INT64_LIST}, {"offset", Type::INT64 }, {"bytes",  Type::INT64     }, {"elements", Type::INT64     } } };
+    std::vector<std::int64_t> shape;
+    for( const auto& entry : inventory.entries() ) {
+        entry.shape(shape);
+        arrow.add_dictionary(FILENAME, _args.filename)
+             .add_string(NAME, entry.name)
+             .add_dictionary(PREFIX, _name_prefix(entry.name))
+             .add_dictionary(DTYPE, entry.dtype)
+             .add_int64_list(SHAPE, shape)
+             .add_int64(OFFSET, static_cast<std::int64_t>(entry.offset))
+             .add_int64(BYTES, static_cast<std::int64_t>(entry.size))
+             .add_int64(ELEMENTS, static_cast<std::int64_t>(entry.elements()))
+             .end_row();
     }
-    for(const auto& tensor : sortedTensors) {
-        auto tensor_shape = tensor.shape().to_string("", "x");
-        std::cout << tensor.name() << ", " << tensor_shape << ", " << tensor.dtype() << std::endl;
+    arrow.finish();
+}
+
+/**
+ * Lists the tensors down to `--depth` levels of their names.
+ *
+ * Nothing below the depth limit is materialized: a single pass over the
+ * name-sorted inventory keeps the stack of open groups (one per level) and
+ * adds the tensor, parameter and byte counts of each tensor to them. Tensors
+ * whose names end above the limit are listed on their own.
+ */
+void
+CkShow::list_tensors_depth(const TensorInventory& inventory) const {
+    struct Group {
+        StringView    name;          ///< full prefix, e.g. "model.layers.0"
+        size_t        level;         ///< 1 = first component of the names
+        std::uint64_t tensors    = 0;
+        std::uint64_t parameters = 0;
+        std::uint64_t bytes      = 0;
+    };
+    struct Row {
+        bool   isGroup;
+        size_t index;                ///< into `groups` or into the inventory
+        size_t level;                ///< indentation: groups that contain it
+    };
+    const size_t depth = static_cast<size_t>(std::max(_args.depth, 1));
+    const auto   entries = inventory.entries();
+    std::vector<Group>  groups;
+    std::vector<Row>    rows;
+    std::vector<size_t> open;        ///< open[k] = group of level k+1
+    std::vector<size_t> dots;
+
+    for( size_t i = 0 ; i < entries.size() ; ++i ) {
+        const auto& entry = entries[i];
+        // the ends of the group components of this name
+        dots.clear();
+        for( size_t pos = entry.name.find('.') ; pos != StringView::npos && dots.size() < depth ; pos = entry.name.find('.', pos + 1) ) {
+            dots.push_back(pos);
+        }
+        // close the groups that don't contain this tensor and open the new ones
+        size_t level = 0;
+        while( level < open.size() && level < dots.size() && groups[open[level]].name == entry.name.substr(0, dots[level]) ) { ++level; }
+        open.resize(level);
+        for( ; level < dots.size() ; ++level ) {
+            open.push_back(groups.size());
+            rows.push_back({ true, groups.size(), level });
+            groups.push_back({ entry.name.substr(0, dots[level]), level + 1 });
+        }
+        const auto elements = entry.elements();
+        for( const auto index : open ) {
+            auto& group = groups[index];
+            group.tensors    += 1;
+            group.parameters += elements;
+            group.bytes      += entry.size;
+        }
+        if( open.size() < depth ) { rows.push_back({ false, i, open.size() }); }
+    }
+
+    auto& out = _out;
+    if( _args.format == Format::JSON || _args.format == Format::NDJSON ) {
+        const bool ndjson = _args.format == Format::NDJSON;
+        JsonWriter json{ out };
+        std::vector<std::int64_t> shape;
+        if( !ndjson ) {
+            json.begin_object();
+            json.member("file", _args.filename);
+            json.member("depth", depth);
+            json.key("rows").begin_array();
+        }
+        for( const auto& row : rows ) {
+            json.begin_object();
+            if( ndjson ) { json.member("file", _args.filename); }
+            if( row.isGroup ) {
+                const auto& group = groups[row.index];
+                json.member("group", group.name);
+                json.member("level", group.level);
+                json.member("tensors", group.tensors);
+                json.member("parameters", group.parameters);
+                json.member("bytes", group.bytes);
+            }
+            else {
+                const auto& entry = entries[row.index];
+                entry.shape(shape);
+                json.member("name", entry.name);
+                json.key("shape").begin_array();
+                for( const auto dimension : shape ) { json.value(dimension); }
+                json.end_array();
+                json.member("dtype", entry.dtype);
+                json.member("parameters", entry.elements());
+                json.member("bytes", entry.size);
+            }
+            if( ndjson ) { end_ndjson_record(json); } else { json.end_object(); }
+        }
+        if( !ndjson ) { json.end_array().end_object().end_document(); }
+        return;
+    }
+
+    std::vector<std::int64_t> shape;
+    String shapeText;
+    auto shape_text = [&](const TensorInventory::Entry& entry) -> const String& {
+        return _shape_text(shapeText, entry, shape);
+    };
+
+    // plain: one tab-separated line per row, the first field tells its kind
+    if( _args.format == Format::PLAIN ) {
+        for( const auto& row : rows ) {
+            if( row.isGroup ) {
+                const auto& group = groups[row.index];
+                out << "group\t" << group.name << '\t' << group.tensors << '\t' << group.parameters << '\t' << group.bytes << '\n';
+            } else {
+                const auto& entry = entries[row.index];
+                out << "tensor\t" << entry.name << '\t' << shape_text(entry) << '\t' << entry.dtype << '\t'
+                    << entry.elements() << '\t' << entry.size << '\n';
+            }
+        }
+        return;
     }
+
+    // human: groups show their totals and the tensors above the limit their
+    // shape and dtype, with names relative to the group that contains them
+    using Align = Table::Align;
+    auto& c = Colors::instance();
+    Table table;
+    table.set_alignments({Align::RIGHT, Align::RIGHT, Align::RIGHT, Align::LEFT});
+    table.set_styles({ {c.data(), c.reset()}, {c.data2(), c.reset()}, {c.data2(), c.reset()}, {c.primary(), c.reset()} });
+    table.set_streaming(out, 0);
+    String name;
+    for( const auto& row : rows ) {
+        const StringView fullName = row.isGroup ? groups[row.index].name : entries[row.index].name;
+        size_t start = 0;
+        for( size_t k = 0 ; k < row.level ; ++k ) { start = fullName.find('.', start) + 1; }
+        name.assign(2 * row.level, ' ');
+        name.append(fullName.substr(start));
+        if( row.isGroup ) {
+            const auto& group = groups[row.index];
+            name += ".*";
+            table.add_row({ std::to_string(group.tensors) + (group.tensors == 1 ? " tensor" : " tensors"), to_human_size(group.bytes), to_human_count(group.parameters), name });
+        }
+        else {
+            const auto& entry = entries[row.index];
+            table.add_row({ shape_text(entry), entry.dtype, to_human_count(entry.elements()), name });
+        }
+    }
+    table.flush();
+    out << '\n';
+}
+
+/**
+ * Lists the tensors one per line, in `--sort` order.
+ *
+ * This is the listing of the plain and NDJSON formats, and of the tensors
+ * selected by `--prefix`, `--match` and `--where`: there the human listing
+ * is flat and the JSON document has no tree, as a filtered set of names
+ * doesn't describe the hierarchy of the file.
+ */
+void
+CkShow::list_tensors_flat(const TensorInventory& inventory) const {
+    const auto entries = inventory.entries();
+    auto& out = _out;
+
+    if( _args.format == Format::JSON || _args.format == Format::NDJSON ) {
+        const bool ndjson = _args.format == Format::NDJSON;
+        JsonWriter json{ out };
+        std::vector<std::int64_t> shape;
+        if( !ndjson ) {
+            json.begin_object();
+            json.member("file", _args.filename);
+            json.member("tensor_count", entries.size());
+            json.key("tensors").begin_array();
+        }
+        for( const auto& entry : entries ) {
+            entry.shape(shape);
+            json.begin_object();
+            if( ndjson ) { json.member("file", _args.filename); }
+            json.member("name", entry.name);
+            json.key("shape").begin_array();
+            for( const auto dimension : shape ) { json.value(dimension); }
+            json.end_array();
+            json.member("dtype", entry.dtype);
+            if( ndjson ) { end_ndjson_record(json); } else { json.end_object(); }
+        }
+        if( !ndjson ) { json.end_array().end_object().end_document(); }
+        return;
+    }
+
+    std::vector<std::int64_t> shape;
+    String shapeText;
+    if( _args.format == Format::PLAIN ) {
+        size_t nameMaxLen = 0, shapeMaxLen = 0;
+        for( const auto& entry : entries ) {
+            nameMaxLen  = std::max(nameMaxLen, entry.name.size());
+            shapeMaxLen = std::max(shapeMaxLen, _shape_text(shapeText, entry, shape).size());
+        }
+        for( const auto& entry : entries ) {
+            _shape_text(shapeText, entry, shape);
+            out << entry.name;
+            out.fill(' ', nameMaxLen - entry.name.size() + 3) << shapeText;
+            out.fill(' ', shapeMaxLen - shapeText.size() + 2) << entry.dtype << '\n';
+        }
+        return;
+    }
+
+    using Align = Table::Align;
+    auto& c = Colors::instance();
+    Table table;
+    table.set_alignments({Align::RIGHT, Align::RIGHT, Align::LEFT});
+    table.set_styles({ {c.data(), c.reset()}, {c.data2(), c.reset()}, {c.primary(), c.reset()} });
+    table.set_streaming(out, static_cast<size_t>(std::max(_args.lookahead, 0)));
+    for( const auto& entry : entries ) {
+        table.add_row({ _shape_text(shapeText, entry, shape), entry.dtype, entry.name });
+    }
+    table.flush();
+    out << '\n';
 }
 
 void
@@ -196,14 +854,7 @@ CkShow::list_metadata(const TensorMap& tensorMap) const {
 
     Table table;
     auto& c = Colors::instance();
-    table.set_colorizer([&c](int column, const String& text) {
-        switch( column ) {
-            case 0: return c.data2()   + text + c.reset(); break;
-            case 1: return c.primary() + text + c.reset(); break;
-            case 2: return c.data()    + text + c.reset(); break;
-        }
-        return text;
-    });
+    table.set_styles({ {c.data2(), c.reset()}, {c.primary(), c.reset()}, {c.data(), c.reset()} });
 
     // extraer key y variant
     for( const auto& [key, variant]: tensorMap.metadata()) {
@@ -223,34 +874,387 @@ CkShow::list_metadata(const TensorMap& tensorMap) const {
 
         table.add_row({type, key+":", value});
     }
-    std::cout << table << std::endl;
+    auto& out = _out;
+    table.print(out);
+    out << '\n';
+}
+
+/**
+ * Lists the metadata one entry per line as "key<TAB>type<TAB>value", with
+ * the full value (line breaks and tabs inside it are replaced by spaces).
+ */
+void
+CkShow::list_metadata_plain(const TensorMap& tensorMap) const {
+    auto& out = _out;
+    for( const auto& [key, variant]: tensorMap.metadata()) {
+        auto value = variant.as_string();
+        std::replace_if(value.begin(), value.end(), [](char ch) { return ch == '\n' || ch == '\r' || ch == '\t'; }, ' ');
+        out << key << '\t' << type_name( variant.storage_type() ) << '\t' << value << '\n';
+    }
+}
+
+/**
+ * Returns true if `text` follows the JSON grammar for numbers
+ * (no leading '+' or zeros, no "inf"/"nan", digits on both sides of the point).
+ */
+static bool
+_is_json_number(StringView text) noexcept {
+    size_t i = 0;
+    auto digits = [&]() { const size_t start = i; while( i<text.size() && text[i]>='0' && text[i]<='9' ) { ++i; } return i - start; };
+    if( i<text.size() && text[i]=='-' ) { ++i; }
+    if( i<text.size() && text[i]=='0' ) { ++i; } else if( digits() == 0 ) { return false; }
+    if( i<text.size() && text[i]=='.' ) { ++i; if( digits() == 0 ) { return false; } }
+    if( i<text.size() && (text[i]=='e' || text[i]=='E') ) {
+        ++i;
+        if( i<text.size() && (text[i]=='+' || text[i]=='-') ) { ++i; }
+        if( digits() == 0 ) { return false; }
+    }
+    return i == text.size();
+}
+
+/**
+ * Writes a metadata value, as a JSON number or boolean when the entry
+ * stores one, otherwise as a string.
+ */
+static void
+_write_metadata_value(JsonWriter& json, tin::StorageType storageType, const String& text) {
+    using tin::StorageType;
+    switch( storageType ) {
+        case StorageType::BOOL:
+            if( text == "true" || text == "false" ) { json.raw(text); return; }
+            break;
+        case StorageType::INT8:  case StorageType::INT16:  case StorageType::INT32:  case StorageType::INT64:
+        case StorageType::UINT8: case StorageType::UINT16: case StorageType::UINT32: case StorageType::UINT64:
+        case StorageType::FLOAT32: case StorageType::FLOAT64: {
+            if( _is_json_number(text) ) { json.raw(text); return; }
+            break;
+        }
+        default:
+            break;
+    }
+    json.value(text);
+}
+
+/**
+ * Lists the metadata as a JSON document, with the type and the full value of every entry.
+ */
+void
+CkShow::list_metadata_json(const TensorMap& tensorMap) const {
+    JsonWriter json{ _out };
+    json.begin_object();
+    json.member("file", _args.filename);
+    json.key("metadata").begin_object();
+    for( const auto& [key, variant]: tensorMap.metadata()) {
+        json.key(key).begin_object();
+        json.member("type", type_name( variant.storage_type() ));
+        json.key("value");
+        _write_metadata_value(json, variant.storage_type(), variant.as_string());
+        json.end_object();
+    }
+    json.end_object();
+    json.end_object().end_document();
+}
+
+/**
+ * Lists the metadata as NDJSON, one self-contained record per key.
+ */
+void
+CkShow::list_metadata_ndjson(const TensorMap& tensorMap) const {
+    JsonWriter json{ _out };
+    for( const auto& [key, variant]: tensorMap.metadata()) {
+        json.begin_object();
+        json.member("file", _args.filename);
+        json.member("key", key);
+        json.member("type", type_name( variant.storage_type() ));
+        json.key("value");
+        _write_metadata_value(json, variant.storage_type(), variant.as_string());
+        end_ndjson_record(json);
+    }
 }
 
 void
 CkShow::print_metadata(const TensorMap& tensorMap, StringView key) const {
-    std::cout << tensorMap.metadata().get(key).as_string() << std::endl;
+    const auto& variant = tensorMap.metadata().get(key);
+    if( _args.format == Format::JSON || _args.format == Format::NDJSON ) {
+        JsonWriter json{ _out };
+        json.begin_object();
+        if( _args.format == Format::NDJSON ) { json.member("file", _args.filename); }
+        json.member("key", key);
+        json.member("type", type_name( variant.storage_type() ));
+        json.key("value");
+        _write_metadata_value(json, variant.storage_type(), variant.as_string());
+        json.end_object().end_document();
+        return;
+    }
+    _out << variant.as_string() << '\n';
+}
+
+/**
+ * Lists the alignment of the data of every tensor in a .safetensors file and
+ * how much padding `ckrepack --align` would add for the common alignments.
+ *
+ * The alignment of a tensor is the largest power of two that divides its
+ * absolute offset in the file, which is what matters when the file is mapped
+ * into memory (the mapping itself is always page-aligned). The bytes a
+ * repack would add are the growth of the whole file, header included.
+ */
+void
+CkShow::list_alignment(const SafetensorsFile& safetensors) const {
+    using Align = Table::Align;
+    static const std::uint64_t MaxAlignment = 2 * 1024 * 1024;
+    static const std::uint64_t Alignments[] = { 64, SafetensorsFile::PageSize, MaxAlignment };
+
+    auto& c = Colors::instance();
+    std::vector<const SafetensorsFile::Tensor*> tensors;
+    for( const auto& tensor : safetensors.tensors() ) {
+        if( !tensor.is_padding() ) { tensors.push_back(&tensor); }
+    }
+    std::sort(tensors.begin(), tensors.end(), [](auto* a, auto* b) { return a->begin < b->begin; });
+
+    auto tensor_alignment = [&](const SafetensorsFile::Tensor* tensor) {
+        const std::uint64_t offset = safetensors.data_offset() + tensor->begin;
+        return std::min(offset & (~offset + 1), MaxAlignment);
+    };
+
+    // what a repacked file would add: the layout `ckrepack` writes (tensors
+    // in name order, placed by SafetensorsFile::add_aligned) and its header,
+    // so the entries of the padding tensors and the spaces that align the
+    // header are counted too
+    struct Repack { std::uint64_t alignment; size_t misaligned; std::uint64_t added; };
+    std::vector<Repack> repacks;
+    auto byName = tensors;
+    std::sort(byName.begin(), byName.end(), [](auto* a, auto* b) { return a->name < b->name; });
+    const std::uint64_t currentSize = safetensors.data_offset() + safetensors.data_size();
+    SafetensorsFile::Tensors layout;
+    for( std::uint64_t alignment : Alignments ) {
+        size_t        misaligned = 0;
+        std::uint64_t dataSize   = 0;
+        layout.clear();
+        for( const auto* tensor : byName ) {
+            if( (safetensors.data_offset() + tensor->begin) % alignment != 0 ) { ++misaligned; }
+            SafetensorsFile::add_aligned(layout, *tensor, alignment, dataSize);
+        }
+        const std::uint64_t headerAlignment = SafetensorsFile::header_alignment(alignment);
+        const std::uint64_t newSize = SafetensorsFile::build_header(layout, safetensors.metadata(), headerAlignment).size() + dataSize;
+        repacks.push_back({ alignment, misaligned, newSize > currentSize ? newSize - currentSize : 0 });
+    }
+
+    auto& out = _out;
+    if( _args.format == Format::NDJSON ) {
+        JsonWriter json{ out };
+        for( const auto* tensor : tensors ) {
+            json.begin_object();
+            json.member("file", _args.filename);
+            json.member("name", tensor->name);
+            json.member("offset", safetensors.data_offset() + tensor->begin);
+            json.member("alignment", tensor_alignment(tensor));
+            end_ndjson_record(json);
+        }
+        return;
+    }
+    if( _args.format == Format::JSON ) {
+        JsonWriter json{ out };
+        json.begin_object();
+        json.member("file", _args.filename);
+        json.member("data_offset", safetensors.data_offset());
+        json.key("tensors").begin_array();
+        for( const auto* tensor : tensors ) {
+            json.begin_object();
+            json.member("name", tensor->name);
+            json.member("offset", safetensors.data_offset() + tensor->begin);
+            json.member("alignment", tensor_alignment(tensor));
+            json.end_object();
+        }
+        json.end_array();
+        json.key("repack").begin_array();
+        for( const auto& repack : repacks ) {
+            json.begin_object();
+            json.member("alignment", repack.alignment);
+            json.member("misaligned", repack.misaligned);
+            json.member("added_padding", repack.added);
+            json.end_object();
+        }
+        json.end_array();
+        json.end_object().end_document();
+        return;
+    }
+
+    Table table;
+    table.set_alignments({Align::RIGHT, Align::RIGHT, Align::LEFT});
+    table.set_styles({ {c.data(), c.reset()}, {c.data2(), c.reset()}, {c.primary(), c.reset()} });
+    for( const auto* tensor : tensors ) {
+        const std::uint64_t alignment = tensor_alignment(tensor);
+        table.add_row({ std::to_string(safetensors.data_offset() + tensor->begin), (alignment==MaxAlignment ? ">=" : "") + to_human_size(alignment), tensor->name });
+    }
+    table.print(out);
+    out << '\n';
+
+    for( const auto& repack : repacks ) {
+        const auto size = to_human_size(repack.alignment);
+        out << c.info();
+        out.fill(' ', 8 - std::min<size_t>(8, size.length())) << size << c.reset() << ": "
+            << repack.misaligned << " of " << tensors.size() << " tensors misaligned, a repack would add "
+            << to_human_size(repack.added) << " of padding and header\n";
+    }
+}
+
+/**
+ * Prints a summary of the file: its size, the number of tensors and
+ * metadata entries, and how many tensors use each dtype.
+ * (with --ndjson the summary is a single record, one line per file)
+ */
+void
+CkShow::print_summary(const TensorMap& tensorMap) const {
+    std::error_code error;
+    const auto fileSize = std::filesystem::file_size(_path, error);
+
+    size_t numberOfTensors = 0, numberOfMetadata = 0;
+    std::map<String, size_t> dtypes;
+    for( const auto& tensor : tensorMap.collect_tensors(SortBy::NAME) ) {
+        ++dtypes[ tensor.dtype().to_string() ];
+        ++numberOfTensors;
+    }
+    for( [[maybe_unused]] const auto& entry : tensorMap.metadata() ) { ++numberOfMetadata; }
+
+    auto& out = _out;
+    if( _args.format == Format::JSON || _args.format == Format::NDJSON ) {
+        JsonWriter json{ out };
+        json.begin_object();
+        json.member("file", _args.filename);
+        json.member("size", error ? 0 : fileSize);
+        json.member("tensor_count", numberOfTensors);
+        json.member("metadata_count", numberOfMetadata);
+        json.key("dtypes").begin_object();
+        for( const auto& [dtype, count] : dtypes ) { json.member(dtype, count); }
+        json.end_object();
+        json.end_object().end_document();
+        return;
+    }
+
+    auto& c = Colors::instance();
+    const bool human = _args.format == Format::HUMAN;
+    auto dtypesText = String{};
+    for( const auto& [dtype, count] : dtypes ) {
+        if( !dtypesText.empty() ) { dtypesText += human ? ", " : " "; }
+        dtypesText += dtype + (human ? " x " : ":") + std::to_string(count);
+    }
+    out << c.info() << "File     : " << c.reset() << _args.filename << '\n';
+    out << c.info() << "Size     : " << c.reset() << (human ? to_human_size(error ? 0 : fileSize) : std::to_string(error ? 0 : fileSize)) << '\n';
+    out << c.info() << "Tensors  : " << c.reset() << numberOfTensors  << '\n';
+    out << c.info() << "Metadata : " << c.reset() << numberOfMetadata << '\n';
+    out << c.info() << "DTypes   : " << c.reset() << dtypesText       << '\n';
+}
+
+/**
+ * Prints the architecture of the file and the components found in it, as
+ * recognized by `ArchitectureTable` (plus the signatures of `--signatures`),
+ * and the structural signature of the file.
+ */
+void
+CkShow::print_identity(const TensorInventory& inventory) const {
+    const auto table = architectures();
+    const Fingerprint fingerprint{ inventory };
+    const auto found = table.identify(fingerprint);
+    char signature[17];
+    std::snprintf(signature, sizeof(signature), "%016llx", static_cast<unsigned long long>(fingerprint.signature()));
+
+    auto& out = _out;
+    if( _args.format == Format::JSON || _args.format == Format::NDJSON ) {
+        JsonWriter json{ out };
+        json.begin_object();
+        json.member("file", _args.filename);
+        if( found.empty() ) { json.key("architecture").null(); }
+        else                { json.member("architecture", found.front()->name); }
+        json.key("components").begin_array();
+        for( size_t i = 1 ; i < found.size() ; ++i ) { json.value(found[i]->name); }
+        json.end_array();
+        json.member("signature", StringView{signature});
+        json.end_object().end_document();
+        return;
+    }
+
+    auto& c = Colors::instance();
+    String components;
+    for( size_t i = 1 ; i < found.size() ; ++i ) {
+        if( !components.empty() ) { components += ", "; }
+        components += found[i]->name;
+    }
+    out << c.info() << "File         : " << c.reset() << _args.filename << '\n';
+    out << c.info() << "Architecture : " << c.reset() << (found.empty() ? StringView{"unknown"} : StringView{found.front()->name}) << '\n';
+    if( !components.empty() ) {
+        out << c.info() << "Components   : " << c.reset() << components << '\n';
+    }
+    out << c.info() << "Signature    : " << c.reset() << signature << '\n';
 }
 
 //================================ RUNNING ================================//
 
+/**
+ * Warns about `--sizes` and `--fold` when the listing ignores them: both
+ * shape the human tree, and `--sizes` also the JSON tree; the flat, depth
+ * and Arrow listings have fixed columns.
+ */
+static void
+_warn_tree_only_options(const CkShowArgs& args, bool humanTree, bool jsonTree) {
+    if( args.fold && !humanTree ) {
+        Messages::warning("The option `--fold` only applies to the human tree listing, it is ignored here.");
+    }
+    if( args.sizes && !humanTree && !jsonTree ) {
+        Messages::warning("The option `--sizes` only applies to the tree listing (human or --json), it is ignored here.");
+    }
+}
+
 int
 CkShow::run() {
     ReadError readError;
+    bool      colors = true;
 
     // if the color option is set to "auto", disable colors when outputting to a non-terminal
     if( _args.when_color == "auto" || _args.when_color == "tty" || _args.when_color == "if-tty" ) {
-        if( !is_terminal_output() ) { Colors::instance().disable_colors(); }
+        colors = _terminal;
     }
     // if the color option is set to "never", disable colors regardless of output type
     else if ( _args.when_color == "never" || _args.when_color == "no" || _args.when_color == "none") {
-        Colors::instance().disable_colors();
+        colors = false;
     }
 
+    // machine-readable formats never carry color codes
+    if( _args.format != Format::HUMAN ) { colors = false; }
+
+    // (the colors are shared by the threads of the daemon, so they are only
+    // written when they actually change)
+    if( !colors && Colors::instance().are_colors_enabled() ) { Colors::instance().disable_colors(); }
+
     // if help was requested, show the help message and exit
-    if( _args.help ) { print_help(); return 0; }
+    if( _args.help ) { print_help(); _out.flush(); return 0; }
 
     // if version was requested, show the version and exit
-    if( _args.version ) { print_version(); return 0; }
+    if( _args.version ) { print_version(); _out.flush(); return 0; }
+
+    // the daemon and its client take the place of the command
+    if( !_args.serve.empty() || !_args.connect.empty() ) {
+        if( _cache ) { Messages::fatal_error("The options `--serve` and `--connect` can't be sent to the daemon."); }
+        if( !_args.connect.empty() ) { return CkShowDaemon::request(_args.connect, _args.forwarded); }
+        CkShowDaemon daemon{ _args.serve, static_cast<size_t>(_args.cache_size) * 1024 * 1024,
+                             static_cast<unsigned>(_args.threads) };
+        return daemon.serve();
+    }
+    if( _args.cache_stats ) {
+        Messages::fatal_error("The cache statistics are answered by a daemon.", {
+            "Use: ckshow --connect SOCKET --cache-stats" });
+    }
+
+    // (accepted by the arguments, but no extraction exists yet)
+    if( _args.command == Command::EXTRACT_THUMBNAIL ) {
+        Messages::fatal_error("The thumbnail extraction is not available yet.", {
+            "The thumbnail, when there is one, is stored in the metadata, e.g. ckshow --metadata --name 'modelspec.thumbnail' FILE" });
+    }
+
+    // several files are run one by one, each with its own output
+    if( _args.batch ) {
+        CkShowBatch batch{ _args, _out, _cache };
+        return batch.run();
+    }
 
     // if the user didn't provide any file, show an error message and exit
     if(_args.filename.empty()) {
@@ -259,21 +1263,78 @@ CkShow::run() {
         });
     }
 
+    // the Arrow stream is binary and needs the physical layout of the file
+    if( _args.format == Format::ARROW ) {
+        if( _args.command != Command::LIST_TENSORS ) {
+            Messages::fatal_error("The Arrow output is only available for the tensor listing.", {
+                "Remove `--metadata`, `--alignment`, `--summary` or `--identify`, or use `--json`/`--ndjson` instead." });
+        }
+        if( _terminal ) {
+            Messages::fatal_error("The Arrow output is binary and will not be written to a terminal.", {
+                "Redirect it to a file or a pipe, e.g. `ckshow --arrow model.safetensors > model.arrows`" });
+        }
+        _warn_tree_only_options(_args, false, false);
+        auto inventory = load_inventory();
+        select_tensors(inventory);
+        list_tensors_arrow(inventory);
+        _out.flush();
+        return 0;
+    }
+
+    // every tensor listing works on the sorted inventory
+    if( _args.command == Command::LIST_TENSORS ) {
+        const bool filtered  = !_args.prefix.empty() || !_args.patterns.empty() || !_args.where.empty();
+        const bool tree      = _args.format == Format::HUMAN || _args.format == Format::JSON;
+        const bool treeShown = _args.depth <= 0 && !filtered && tree;
+        _warn_tree_only_options(_args, treeShown && _args.format == Format::HUMAN, treeShown && _args.format == Format::JSON);
+        auto inventory = load_inventory();
+        select_tensors(inventory);
+        if     ( _args.depth > 0 )              { list_tensors_depth(inventory); }
+        else if( filtered || !tree )            { list_tensors_flat(inventory);  }
+        else if( _args.format == Format::JSON ) { list_tensors_json(inventory);  }
+        else                                    { list_tensors(inventory);       }
+        _out.flush();
+        return 0;
+    }
+
+    // the architecture is recognized from the inventory alone
+    if( _args.command == Command::IDENTIFY ) {
+        const auto inventory = load_inventory();
+        print_identity(inventory);
+        _out.flush();
+        return 0;
+    }
+
+    // the alignment report needs the physical layout of the file
+    if( _args.command == Command::LIST_ALIGNMENT ) {
+        auto safetensors = SafetensorsFile::from_file(_path, readError);
+        if( readError != ReadError::None ) {
+            Messages::fatal_error("The alignment report is only available for .safetensors files.", {
+                Messages::read_error_description(readError), "File: " + _args.filename });
+        }
+        list_alignment(safetensors);
+        _out.flush();
+        return 0;
+    }
+
     // load the checkpoint file
-    auto tensorMap = TensorMap::from_file(_args.filename, readError);
-    if(readError != ReadError::None) { fatal_read_error(readError); }
+    const auto tensorMap = load_tensor_map();
 
     // std::cout << std::endl;
     // std::cout << _args << std::endl;
     // std::cout << std::endl;
 
-    if(_args.command == Command::LIST_METADATA) {
-        if(!_args.name.empty()) { print_metadata(tensorMap, _args.name); }
-        else                    { list_metadata(tensorMap); }
-    } else {
-        // print the names of all tensors in the file
-        list_tensors(tensorMap);
+    if(_args.command == Command::SUMMARY) {
+        print_summary(*tensorMap);
+    }
+    else if(_args.command == Command::LIST_METADATA) {
+        if     (!_args.name.empty())            { print_metadata(*tensorMap, _args.name); }
+        else if(_args.format == Format::NDJSON) { list_metadata_ndjson(*tensorMap); }
+        else if(_args.format == Format::JSON )  { list_metadata_json(*tensorMap);  }
+        else if(_args.format == Format::PLAIN)  { list_metadata_plain(*tensorMap); }
+        else                                    { list_metadata(*tensorMap);       }
     }
 
+    _out.flush();
     return 0;
 }
@@ -12,39 +12,67 @@
 #pragma once
 #ifndef CKSHOW_H_
 #define CKSHOW_H_
+#include <memory>           // for std::shared_ptr
 #include <tin/readerror.h>  // for tin::ReadError
 #include <tin/tensormap.h>  // for tin::TensorMap
 #include "common.h"
+#include "safetensors.h"    // for SafetensorsFile
+#include "jsonwriter.h"     // for JsonWriter
+#include "ckshow_identify.h" // for ArchitectureTable
+#include "ckshow_inventory.h" // for TensorInventory
+#include "ckshow_query.h"   // for TensorQuery
 #include "ckshow_args.h"    // for CkShowArgs
+#include "outputsink.h"     // for OutputSink
 using tin::TensorMap;
 using tin::ReadError;
+class HeaderCache;
 
 class CkShow
 {
 // MAIN
 public:
-    CkShow(const CkShowArgs& args);
+    CkShow(const CkShowArgs& args, OutputSink& out = OutputSink::standard_output(), HeaderCache* cache = nullptr);
     [[nodiscard]] int run();
 
 // SUBCOMMANDS
 public:
-    void list_tensors(const TensorMap& tensorMap) const;
-    void list_tensors_columns(const TensorMap& tensorMap) const;
-    void list_tensors_csv(const TensorMap& tensorMap, bool includeHeaders=true) const;
+    void list_tensors(const TensorInventory& inventory) const;
+    void list_tensors_json(const TensorInventory& inventory) const;
+    void list_tensors_arrow(const TensorInventory& inventory) const;
+    void list_tensors_depth(const TensorInventory& inventory) const;
+    void list_tensors_flat(const TensorInventory& inventory) const;
     void list_metadata(const TensorMap& tensorMap) const;
+    void list_metadata_plain(const TensorMap& tensorMap) const;
+    void list_metadata_json(const TensorMap& tensorMap) const;
+    void list_metadata_ndjson(const TensorMap& tensorMap) const;
     void print_metadata(const TensorMap& tensorMap, StringView key) const;
+    void list_alignment(const SafetensorsFile& safetensors) const;
+    void print_summary(const TensorMap& tensorMap) const;
+    void print_identity(const TensorInventory& inventory) const;
 
 // HELPERS
 public:
     const String& to_string(tin::StorageType storageType) const noexcept;
+    StringView    type_name(tin::StorageType storageType) const noexcept;
     void print_help() const noexcept;
     void print_version() const noexcept;
-    [[noreturn]] static void fatal_read_error(ReadError error);
+    void end_ndjson_record(JsonWriter& json) const;
+    void compile_selection(PatternSet& patterns, TensorQuery& query) const;
+    void select_tensors(TensorInventory& inventory) const;
+    [[nodiscard]] ArchitectureTable architectures() const;
+    void check_arguments() const;
+    [[nodiscard]] TensorInventory                  load_inventory() const;
+    [[nodiscard]] std::shared_ptr<const TensorMap> load_tensor_map() const;
+    [[noreturn]] void fatal_read_error(ReadError error) const;
 
 
 // IMPLEMENTATION
 private:
     const CkShowArgs _args;
+    OutputSink&      _out;
+    HeaderCache*     _cache;     ///< null = the headers are read on every run
+    const bool       _terminal;  ///< true = `_out` is the standard output and a terminal
+    const String     _path;      ///< the file that is read (the filename, resolved)
 };
 
 #endif // CKSHOW_H_
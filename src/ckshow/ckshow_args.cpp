@@ -12,6 +12,7 @@
 #include <format>   // for std::format
 #include <string>   // for std::string
 #include <charconv> // for std::from_chars
+#include <filesystem> // for std::filesystem::path
 #include "common.h"
 #include "ckshow_args.h"
 #include "argument.h"
@@ -33,21 +34,67 @@
  */
 CkShowArgs::CkShowArgs(int argc, char* argv[])
 : help_message{R"(
-Usage: ckshow [OPTIONS] file
+Usage: ckshow [OPTIONS] FILE...
 
-  Allows you to compile and manage the OpenDiffusion project in Linux.
+  Shows the tensors, metadata and layout of .safetensors and .gguf files.
+
+  With several files (or with @LIST or --files-from), the files are read on
+  several threads and their outputs are printed in the order of the
+  arguments; a file that can't be read is reported and the rest continue.
+  The human and plain listings of each file start with '==> FILE <=='.
 
   OPTIONS:
     -n, --name <NAME>      Show the value of a tensor (or metadata) with the given key. e.g. 'model.layer.1.bias'
     -m, --metadata         Print metadata information related to the checkpoint file
     -p, --prefix <PREFIX>  Filter the tensor names by a prefix to display only matching tensors
-    -d, --depth <DEPTH>    Specify the depth level of the hierarchical index to display
+    --match <PATTERN>      Only show the tensors whose names match PATTERN, a glob ('*.attn.*') or a
+                           regular expression between slashes ('/layers\.[0-9]+\.mlp/'); can be
+                           given several times to show the tensors that match any of them
+    --where <EXPRESSION>   Only show the tensors for which EXPRESSION holds, a condition on name, dtype,
+                           shape, rank, numel, bytes, offset and dims[i], e.g.
+                           'dtype == "F32" && bytes > 16MB && rank == 2 && name ~ "model.layers.*.mlp.*"'
+    -d, --depth <DEPTH>    Show the tensors down to DEPTH name components; deeper tensors are summarized
+                           as groups with their tensor count, size and number of parameters
+    --sizes                Add the parameters and bytes of every tensor to the tree listing, and the totals
+                           and dtypes of every node (e.g. to compare input_blocks with output_blocks);
+                           also adds the totals to the tree of --json
+    --fold                 Show the blocks repeated with the same structure once, e.g. "layers.[0-79] x80",
+                           with the totals of all of them (adds the --sizes columns); human tree only
+    --sort <ORDER>         Order of the tensor names: 'natural' (default) compares the numbers in them by
+                           value (layers.2 before layers.10), 'name' compares them byte by byte
+    -a, --alignment        Show the alignment of each tensor and the padding a `ckrepack --align` would add
+    -s, --summary          Show a summary of the file: size, number of tensors and metadata, dtypes
+    --identify             Recognize the architecture of the file (SDXL, Flux, Llama, a VAE, a LoRA...)
+                           from the names and shapes of its tensors, without reading their data
+    --signatures <FILE>    Also recognize the architectures in FILE, a JSON array of {"name", "keys",
+                           "shapes"} where the keys are tensor names with '#' for the layer numbers
+    --lookahead <ROWS>     Rows used to align the columns of each block of the listing (default: 4096, 0 = whole listing)
     --thumbnail            Extract the thumbnail from the .safetensors file and save it as a .jpg image
+                           (not available yet)
+
+  Several files:
+    @LIST                  Also read the files listed in LIST, one path per line (a file whose name
+                           starts with '@' is given as './@name')
+    --files-from <LIST>    Also read the files listed in LIST after the other ones, '-' = the standard
+                           input; each file is read as soon as its line arrives
+    -t, --threads <N>      Files read at the same time (default: one per core); with --serve,
+                           commands answered at the same time (default: one per core, at least 4)
 
   Output formats:
     -u, --human            Output in a human-readable format with clear formatting (default)
     -b, --basic            Output in a plain, easily parseable format for scripts or tools
     -j, --json             Output data in JSON format when available
+    --ndjson               Output one JSON record per line (per tensor, per metadata key, or per file
+                           with --summary); every record includes the file it comes from
+    --arrow                Output the tensor inventory as an Arrow IPC stream (file, name, prefix, dtype,
+                           shape, offset, bytes, elements), e.g. `ckshow --arrow model.safetensors > model.arrows`
+
+  Daemon:
+    --serve <SOCKET>       Keep running and answer the commands sent to the Unix socket SOCKET, keeping
+                           the parsed headers of the recent files in memory (checked with stat before reuse)
+    --cache-size <MB>      Memory for the parsed headers kept by --serve (default: 256)
+    --connect <SOCKET>     Send the command to the daemon listening on SOCKET and print its answer
+    --cache-stats          With --connect, print the counters of the cache of the daemon
 
     --nc, --no-color       Disable color output.
     -h  , --help           Show this help message and exit.
@@ -55,25 +102,51 @@ Usage: ckshow [OPTIONS] file
 
   Examples:
     ckshow --prefix model.layer.1.bias 'checkpoint.safetensors'
+    ckshow --match '*.attn.*' --match '/norm[0-9]*\.weight$/' 'checkpoint.safetensors'
+    ckshow --where 'rank == 2 && dims[0] > 4 * dims[1]' --ndjson 'checkpoint.safetensors'
+    ckshow --identify --ndjson 'checkpoint.safetensors'
+    find /srv/models -name '*.safetensors' | ckshow --summary --ndjson --files-from -
     ckshow --no-color 'checkpoint.safetensors'
+    ckshow --serve /run/ckshow.sock &
+    ckshow --connect /run/ckshow.sock --summary 'checkpoint.safetensors'
 )"}
 {
     for( int i=1 ; i < argc ; ++i )
     {
         auto arg = Argument{i, argc, argv};
+        const int first = i;
 
         // parse the options
         if( arg.is_option() ) {
         //-COMMAND:
             if     (arg.is( "-n", "--name"       )) { name    = arg.value(i); }
             else if(arg.is( "-m", "--metadata"   )) { command = Command::LIST_METADATA; }
+            else if(arg.is( "-a", "--alignment"  )) { command = Command::LIST_ALIGNMENT; }
+            else if(arg.is( "-s", "--summary"    )) { command = Command::SUMMARY; }
+            else if(arg.is(       "--identify"   )) { command = Command::IDENTIFY; }
             else if(arg.is(       "--thumbnail"  )) { command = Command::EXTRACT_THUMBNAIL; }
             else if(arg.is( "-p", "--prefix"     )) { prefix  = arg.value(i); }
+            else if(arg.is(       "--match"      )) { patterns.push_back( arg.value(i) ); }
+            else if(arg.is(       "--where"      )) { where   = arg.value(i); }
             else if(arg.is( "-d", "--depth"      )) { depth   = to_integer(arg.value(i)); }
+            else if(arg.is(       "--lookahead"  )) { lookahead = to_integer(arg.value(i)); }
+            else if(arg.is(       "--sizes"      )) { sizes   = true; }
+            else if(arg.is(       "--fold"       )) { fold    = true; }
+            else if(arg.is(       "--sort"       )) { sort    = arg.value(i); }
+            else if(arg.is(       "--signatures" )) { signatures = arg.value(i); }
+            else if(arg.is(       "--files-from" )) { files_from = arg.value(i); }
         //-FORMATS:
             else if(arg.is( "-u", "--human"      )) { format = Format::HUMAN; }
             else if(arg.is( "-b", "--basic"      )) { format = Format::PLAIN; }
             else if(arg.is( "-j", "--json"       )) { format = Format::JSON;  }
+            else if(arg.is(       "--ndjson"     )) { format = Format::NDJSON; }
+            else if(arg.is(       "--arrow"      )) { format = Format::ARROW;  }
+        //-DAEMON:
+            else if(arg.is(       "--serve"      )) { serve      = arg.value(i); }
+            else if(arg.is(       "--cache-size" )) { cache_size = to_integer(arg.value(i), -1); }
+            else if(arg.is( "-t", "--threads"    )) { threads    = to_integer(arg.value(i), -1); }
+            else if(arg.is(       "--connect"    )) { connect    = arg.value(i); }
+            else if(arg.is(       "--cache-stats")) { cache_stats = true; }
         //-EXTRA:
             else if(arg.is( "-h", "--help"       )) { help = true; }
             else if(arg.is( "-v", "--version"    )) { version = true; }            
@@ -92,15 +165,42 @@ Usage: ckshow [OPTIONS] file
                 Messages::fatal_error( "The argument '"+ arg.name() +"' no expects a value and '"+ arg.value(i) +"' was provided.", {
                     "Try `ckshow --help` for more information." });
             }
+            if( arg.is("--sort") && sort != "natural" && sort != "name" ) {
+                Messages::fatal_error( "Unknown sort order: '" + sort + "'", {
+                    "Use `--sort natural` (layers.2 before layers.10) or `--sort name` (byte order)." });
+            }
         }
         // handle positional arguments, arguments without a preceding hyphen
-        // (assume the positional argument is the filename)
+        // (the files to read, and the @lists of files)
         else {
-            if( filename.empty() ) { filename = arg.name();  }
-            else {
-                Messages::fatal_error("Too many files specified, you can only specify one.", {
-                    "The additional file '" + arg.name() + "' is not required." });
-            }
+            inputs.push_back( arg.name() );
         }
+        // everything but the socket of `--connect` is sent to the daemon as it was typed
+        if( !arg.is("--connect") ) {
+            for( int k = first ; k <= i ; ++k ) { forwarded.emplace_back(argv[k]); }
+        }
+    }
+
+    // a single file runs alone, anything else is a batch
+    batch = inputs.size() > 1 || !files_from.empty() || (inputs.size() == 1 && inputs.front().starts_with('@'));
+    if( !batch && !inputs.empty() ) { filename = inputs.front(); }
+
+    if( cache_size <= 0 ) {
+        Messages::fatal_error("The cache size must be a positive number of megabytes.");
     }
+    if( threads < 0 ) {
+        Messages::fatal_error("The number of threads must be a positive number.");
+    }
+}
+
+//================================ HELPERS ================================//
+
+/**
+ * Returns the path where a file named in the arguments is opened: relative
+ * paths are relative to `directory`, if the arguments have one.
+ */
+String
+CkShowArgs::resolve(const String& path) const {
+    if( path.empty() || directory.empty() || std::filesystem::path(path).is_absolute() ) { return path; }
+    return (std::filesystem::path(directory) / path).string();
 }
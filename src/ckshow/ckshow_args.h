@@ -13,18 +13,25 @@
 #ifndef CKSHOW_ARGS_H_
 #define CKSHOW_ARGS_H_
 #include <iostream>
+#include <vector>   // for std::vector
 #include "common.h"
 
 
 enum class Command {
     LIST_TENSORS,
     LIST_METADATA,
+    LIST_ALIGNMENT,
+    SUMMARY,
+    IDENTIFY,
     EXTRACT_THUMBNAIL
 };
 inline String to_string(Command command) {
     switch (command) {
         case Command::LIST_TENSORS     : return "Command::LIST_TENSORS";
         case Command::LIST_METADATA    : return "Command::LIST_METADATA";
+        case Command::LIST_ALIGNMENT   : return "Command::LIST_ALIGNMENT";
+        case Command::SUMMARY          : return "Command::SUMMARY";
+        case Command::IDENTIFY         : return "Command::IDENTIFY";
         case Command::EXTRACT_THUMBNAIL: return "Command::EXTRACT_THUMBNAIL";
         default: return "<unknown>";
     }
@@ -34,13 +41,17 @@ inline String to_string(Command command) {
 enum class Format {
     HUMAN,
     PLAIN,
-    JSON
+    JSON,
+    NDJSON,
+    ARROW
 };
 inline String to_string(Format format) {
     switch (format) {
         case Format::HUMAN: return "Format::HUMAN";
         case Format::PLAIN: return "Format::PLAIN";
         case Format::JSON : return "Format::JSON";
+        case Format::NDJSON: return "Format::NDJSON";
+        case Format::ARROW: return "Format::ARROW";
         default: return "<unknown>";
     }
 }
@@ -59,15 +70,36 @@ public:
 // PUBLIC MEMBERS
 public:
     Command command    = Command::LIST_TENSORS;
-    String  filename   = "";            ///< The name of the file to read
+    String  filename   = "";            ///< The name of the file to read (empty in a batch)
+    std::vector<String> inputs;         ///< The files and @lists of files of the command line
+    String  files_from = "";            ///< List of more files to read, "-" = the standard input
+    bool    batch      = false;         ///< true = several files are read (see `inputs` and `files_from`)
     String  name       = "";            ///< The name of the tensor to print
     String  prefix     = "";            ///< Only print tensors with this prefix
+    std::vector<String> patterns;       ///< Only print tensors matching any of these globs or /regexes/
+    String  where      = "";            ///< Only print tensors for which this expression holds
     String  when_color = "auto";        ///< When to use color in output
     int     depth      = 0;             ///< The depth of the tree to print
+    int     lookahead  = 4096;          ///< Rows used to align each block of a streamed listing (0 = all)
+    bool    sizes      = false;         ///< true = show the parameters, bytes and dtypes of every subtree
+    bool    fold       = false;         ///< true = show repeated blocks (layers.0 ... layers.79) once
+    String  sort       = "natural";     ///< Order of the tensor names: "natural" or "name"
+    String  signatures = "";            ///< JSON file with more architectures for --identify
     Format  format     = Format::HUMAN; ///< Output format
+    String  serve      = "";            ///< Unix socket where the daemon answers commands
+    int     cache_size = 256;           ///< Megabytes of parsed headers kept by the daemon
+    int     threads    = 0;             ///< Files read, or commands answered by the daemon, at the same time (0 = default)
+    String  connect    = "";            ///< Unix socket of the daemon that runs the command
+    bool    cache_stats = false;        ///< true = ask the daemon for the counters of its cache
+    std::vector<String> forwarded;      ///< The arguments sent to the daemon (all but `--connect`)
+    String  directory  = "";            ///< Directory of the relative paths (empty = the current one), set by the daemon
     bool    help       = false;         ///< true = print usage and exit
     bool    version    = false;         ///< true = print version and exit
     const char * const help_message;
+
+// HELPERS
+public:
+    [[nodiscard]] String resolve(const String& path) const;
 };
 
 /**
@@ -86,11 +118,29 @@ operator<<(std::ostream& os, const CkShowArgs& args) {
     os << "Args:"                                         << std::endl;
     os << "  command: "     << to_string(args.command)    << std::endl;
     os << "  filename: "    << args.filename              << std::endl;
+    os << "  inputs: "      << args.inputs.size()         << std::endl;
+    os << "  files_from: "  << args.files_from            << std::endl;
+    os << "  batch: "       << to_string(args.batch)      << std::endl;
     os << "  name: "        << args.name                  << std::endl;
     os << "  prefix: "      << args.prefix                << std::endl;
+    os << "  patterns:";
+    for( const auto& pattern : args.patterns ) { os << " " << pattern; }
+    os << std::endl;
+    os << "  where: "       << args.where                 << std::endl;
     os << "  when_color: "  << args.when_color            << std::endl;
     os << "  depth: "       << args.depth                 << std::endl;
+    os << "  lookahead: "   << args.lookahead             << std::endl;
+    os << "  sizes: "       << to_string(args.sizes)      << std::endl;
+    os << "  fold: "        << to_string(args.fold)       << std::endl;
+    os << "  sort: "        << args.sort                  << std::endl;
+    os << "  signatures: "  << args.signatures            << std::endl;
     os << "  format: "      << to_string(args.format)     << std::endl;
+    os << "  serve: "       << args.serve                 << std::endl;
+    os << "  cache_size: "  << args.cache_size            << std::endl;
+    os << "  threads: "     << args.threads               << std::endl;
+    os << "  connect: "     << args.connect               << std::endl;
+    os << "  cache_stats: " << to_string(args.cache_stats) << std::endl;
+    os << "  directory: "   << args.directory             << std::endl;
     os << "  help: "        << to_string(args.help)       << std::endl;
     os << "  version: "     << to_string(args.version);
     return os;
@@ -0,0 +1,243 @@
+/*
+| File    : ckshow_batch.cpp
+| Purpose : Runs a ckshow command on many files, printing in argument order.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 20, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <fstream>   // for std::ifstream
+#include <iostream>  // for std::cin
+#include <sstream>   // for std::ostringstream
+#include <thread>    // for std::thread
+#include <vector>    // for std::vector
+#include "colors.h"
+#include "messages.h"
+#include "parallel.h"
+#include "ckshow.h"
+#include "ckshow_batch.h"
+
+/// Jobs per worker that may be read or wait to be printed
+static constexpr size_t JobsPerThread = 4;
+
+/// Buffer of the output of each file (it grows the output in blocks of this size)
+static constexpr size_t FileBufferSize = 64 * 1024;
+
+//============================= CONSTRUCTION ==============================//
+
+/**
+ * Prepares a batch, once the colors of the output are decided.
+ *
+ * @param args  The arguments, with the files in `inputs` and `files_from`.
+ * @param out   Where the outputs of the files go, in order.
+ * @param cache If not null, the headers are taken from this cache.
+ */
+CkShowBatch::CkShowBatch(const CkShowArgs& args, OutputSink& out, HeaderCache* cache)
+: _args{args}
+, _fileArgs{args}
+, _out{out}
+, _cache{cache}
+, _numberOfThreads{ args.threads > 0 ? static_cast<unsigned>(args.threads) : default_thread_count() }
+, _spaced{ args.format == Format::HUMAN || args.format == Format::PLAIN }
+, _headers{ _spaced && args.command != Command::SUMMARY && args.command != Command::IDENTIFY }
+{
+    // each file runs alone, with the colors of the whole output (its own
+    // output is a buffer, which is never a terminal)
+    _fileArgs.inputs.clear();
+    _fileArgs.files_from.clear();
+    _fileArgs.batch      = false;
+    _fileArgs.when_color = Colors::instance().are_colors_enabled() ? "always" : "never";
+}
+
+//================================ RUNNING ================================//
+
+/**
+ * Runs the command on every file of the batch.
+ * @return 0 if every file was shown, 1 if any failed.
+ */
+int
+CkShowBatch::run() {
+    if( _args.format == Format::ARROW ) {
+        Messages::fatal_error("The Arrow output takes a single file.", {
+            "Use `--ndjson` to list the tensors of several files; every record includes its file." });
+    }
+    if( _cache && _args.files_from == "-" ) {
+        Messages::fatal_error("The daemon can't read the list of files from its standard input.", {
+            "Send the files as arguments, or in a list with @LIST." });
+    }
+    // an error in the arguments would be the same for every file
+    CkShow{ _fileArgs, _out, _cache }.check_arguments();
+
+    std::thread reader{ [this]() { _read_inputs(); } };
+    std::vector<std::thread> workers;
+    for( unsigned t = 0 ; t < _numberOfThreads ; ++t ) { workers.emplace_back([this]() { _work(); }); }
+
+    size_t printed = 0, failed = 0;
+    bool   separated = true;
+    for( ;; ) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock lock{_mutex};
+            auto ready = [this]() { return (!_jobs.empty() && _jobs.front()->done) || (_inputEnded && _jobs.empty()); };
+            if( !ready() ) {
+                // what is complete is shown before waiting for the next file
+                lock.unlock();
+                _out.flush();
+                lock.lock();
+                _changed.wait(lock, ready);
+            }
+            if( _jobs.empty() ) { break; }
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+            ++_firstJob;
+            _changed.notify_all();
+        }
+        _print(*job, separated);
+        separated = job->output.ends_with("\n\n");
+        ++printed;
+        if( job->exitCode != 0 ) { ++failed; }
+    }
+    reader.join();
+    for( auto& worker : workers ) { worker.join(); }
+    _out.flush();
+
+    if( failed > 0 ) {
+        Messages::error(std::to_string(failed) + " of " + std::to_string(printed) + " files could not be shown.");
+        return 1;
+    }
+    return 0;
+}
+
+//============================ IMPLEMENTATION =============================//
+
+/**
+ * Adds the files of the command line, of the @LIST files and of
+ * `--files-from`, in that order, then marks the end of the input.
+ */
+void
+CkShowBatch::_read_inputs() {
+    for( const auto& input : _args.inputs ) {
+        if( input.starts_with('@') ) { _read_list(input.substr(1)); }
+        else                         { _add(input); }
+    }
+    if( !_args.files_from.empty() ) { _read_list(_args.files_from); }
+
+    std::lock_guard lock{_mutex};
+    _inputEnded = true;
+    _changed.notify_all();
+}
+
+/**
+ * Adds the files of a list, one path per line, as the lines are read.
+ * @param list The list file, "-" = the standard input.
+ */
+void
+CkShowBatch::_read_list(const String& list) {
+    auto read_lines = [this](std::istream& stream) {
+        String line;
+        while( std::getline(stream, line) ) {
+            if( !line.empty() && line.back() == '\r' ) { line.pop_back(); }
+            if( !line.empty() ) { _add(line); }
+        }
+    };
+    if( list == "-" ) { read_lines(std::cin); return; }
+
+    std::ifstream stream{ _args.resolve(list) };
+    if( !stream ) {
+        // reported in its place among the files, like a file that can't be read
+        String errors;
+        Messages::Capture capture{errors};
+        Messages::error("Unable to read the list of files '" + list + "'.");
+        _add("@" + list, std::move(errors));
+        return;
+    }
+    read_lines(stream);
+}
+
+/**
+ * Adds a file to the batch, waiting while the window of jobs is full.
+ * @param errors If not empty, the job already failed with these messages
+ *               and is only printed.
+ */
+void
+CkShowBatch::_add(String path, String errors) {
+    auto job = std::make_unique<Job>();
+    job->path     = std::move(path);
+    job->exitCode = errors.empty() ? 0 : 1;
+    job->errors   = std::move(errors);
+
+    std::unique_lock lock{_mutex};
+    _changed.wait(lock, [this]() { return _jobs.size() < _numberOfThreads * JobsPerThread; });
+    _jobs.push_back(std::move(job));
+    _changed.notify_all();
+}
+
+/**
+ * Runs the jobs in the order they were added until the input ends.
+ */
+void
+CkShowBatch::_work() {
+    for( ;; ) {
+        Job* job;
+        {
+            std::unique_lock lock{_mutex};
+            _changed.wait(lock, [this]() { return _nextJob < _firstJob + _jobs.size() || _inputEnded; });
+            if( _nextJob == _firstJob + _jobs.size() ) { return; }
+            job = _jobs[_nextJob - _firstJob].get();
+            ++_nextJob;
+        }
+        // (a job stays in `_jobs` until it is done, so the pointer is valid)
+        if( job->exitCode == 0 ) { _process(*job); }
+        std::lock_guard lock{_mutex};
+        job->done = true;
+        _changed.notify_all();
+    }
+}
+
+/**
+ * Runs the command on the file of a job, with its output in `job.output`
+ * and its messages in `job.errors`.
+ */
+void
+CkShowBatch::_process(Job& job) const {
+    CkShowArgs args = _fileArgs;
+    args.filename = job.path;
+    std::ostringstream output;
+    {
+        Messages::Capture capture{job.errors};
+        try {
+            OutputSink out{ output, FileBufferSize };
+            CkShow ckshow{ args, out, _cache };
+            job.exitCode = ckshow.run();
+        }
+        catch( const Messages::FatalError& fatal ) { job.exitCode = fatal.exitCode; }
+        catch( const std::exception& exception ) {
+            Messages::error(exception.what());
+            job.exitCode = 1;
+        }
+    }
+    job.output = output.str();
+}
+
+/**
+ * Prints the output of a job, then its messages.
+ * @param separated true = the output already ends with a blank line
+ *                  (or nothing was printed yet).
+ */
+void
+CkShowBatch::_print(const Job& job, bool separated) {
+    if( _spaced && !separated ) { _out << '\n'; }
+    if( _headers ) {
+        auto& c = Colors::instance();
+        _out << c.highlight() << "==> " << job.path << " <==" << c.reset() << '\n';
+    }
+    _out << job.output;
+    if( !job.errors.empty() ) {
+        // the messages go right after the output of their file
+        _out.flush();
+        Messages::write(job.errors);
+    }
+}
@@ -0,0 +1,89 @@
+/*
+| File    : ckshow_batch.h
+| Purpose : Runs a ckshow command on many files, printing in argument order.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 20, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKSHOW_BATCH_H_
+#define CKSHOW_BATCH_H_
+#include <condition_variable> // for std::condition_variable
+#include <deque>              // for std::deque
+#include <memory>             // for std::unique_ptr
+#include <mutex>              // for std::mutex
+#include "common.h"
+#include "outputsink.h"       // for OutputSink
+#include "ckshow_args.h"      // for CkShowArgs
+class HeaderCache;
+
+
+/**
+ * Runs the command of the arguments on every file of a batch: the files of
+ * the command line, the ones listed in @LIST files, and the ones listed by
+ * `--files-from` (possibly the standard input, read as it arrives).
+ *
+ * A reader thread collects the paths and a pool of workers runs the command
+ * on each file, with its output in a buffer of its own and its messages
+ * captured, so a file that fails ends its own command and not the batch.
+ * The calling thread prints the buffers in the order of the paths as soon
+ * as each one is complete, and flushes the output whenever it waits, so the
+ * first files are printed while the list is still being read. Only a
+ * window of files may wait to be printed; a slow file holds back the
+ * reader, not the memory.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * CkShowBatch batch{ args, OutputSink::standard_output(), nullptr };
+ * return batch.run();
+ * @endcode
+ */
+class CkShowBatch
+{
+// CONSTRUCTION
+public:
+    CkShowBatch(const CkShowArgs& args, OutputSink& out, HeaderCache* cache);
+    CkShowBatch(const CkShowBatch&) = delete;
+    CkShowBatch& operator=(const CkShowBatch&) = delete;
+
+// RUNNING
+public:
+    [[nodiscard]] int run();
+
+// IMPLEMENTATION
+private:
+    struct Job {
+        String path;
+        String output;
+        String errors;         ///< the messages of the command, already formatted
+        int    exitCode = 0;
+        bool   done     = false;
+    };
+    void _read_inputs();
+    void _read_list(const String& list);
+    void _add(String path, String errors = {});
+    void _work();
+    void _process(Job& job) const;
+    void _print(const Job& job, bool separated);
+
+private:
+    const CkShowArgs&                 _args;
+    CkShowArgs                        _fileArgs;        ///< the arguments of each file
+    OutputSink&                       _out;
+    HeaderCache*                      _cache;
+    unsigned                          _numberOfThreads;
+    bool                              _spaced;          ///< true = a blank line between the files
+    bool                              _headers;         ///< true = print '==> FILE <==' before each file
+    std::mutex                        _mutex;
+    std::condition_variable           _changed;
+    std::deque<std::unique_ptr<Job>>  _jobs;            ///< the jobs not printed yet, in order
+    size_t                            _firstJob = 0;    ///< the number of the first job of `_jobs`
+    size_t                            _nextJob  = 0;    ///< the number of the next job for a worker
+    bool                              _inputEnded = false;
+};
+
+#endif // CKSHOW_BATCH_H_
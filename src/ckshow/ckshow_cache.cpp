@@ -0,0 +1,184 @@
+/*
+| File    : ckshow_cache.cpp
+| Purpose : Keeps the parsed headers of the recently used checkpoint files.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 19, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <filesystem>  // for std::filesystem::file_size
+#include "ckshow_cache.h"
+#ifndef _WIN32
+#include <sys/stat.h>  // for ::stat
+#endif
+namespace fs = std::filesystem;
+using tin::ReadError;
+using tin::TensorMap;
+
+
+/**
+ * Returns an estimate of the bytes held by a TensorMap: its tensors with
+ * their names and shapes, and its metadata.
+ */
+static size_t
+_memory_usage(const TensorMap& tensorMap) {
+    size_t bytes = sizeof(TensorMap);
+    for( const auto& tensor : tensorMap.collect_tensors(tin::SortBy::NAME) ) {
+        bytes += 128 + tensor.name().size();
+    }
+    for( const auto& [key, variant] : tensorMap.metadata() ) {
+        bytes += 64 + key.size() + variant.as_string().size();
+    }
+    return bytes;
+}
+
+//============================= CONSTRUCTION ==============================//
+
+/**
+ * Creates an empty cache.
+ * @param capacity The estimated memory of the parsed headers, in bytes,
+ *                 above which the least recently used ones are dropped.
+ */
+HeaderCache::HeaderCache(size_t capacity)
+: _capacity{capacity}
+{
+    _stats.capacity = capacity;
+}
+
+//================================ LOOKUP =================================//
+
+/**
+ * Returns the inventory of a file, sorted in natural order.
+ * @return null if the file can't be read, with the reason in `readError`.
+ */
+std::shared_ptr<const TensorInventory>
+HeaderCache::inventory(const String& path, ReadError& readError) {
+    return _get(path, readError, &Entry::inventory, &Entry::inventoryBytes, [&](size_t& bytes) {
+        auto inventory = std::make_shared<TensorInventory>(path, readError);
+        if( readError != ReadError::None ) { return std::shared_ptr<const TensorInventory>{}; }
+        inventory->sort_naturally();
+        bytes = inventory->memory_usage();
+        return std::shared_ptr<const TensorInventory>{ std::move(inventory) };
+    });
+}
+
+/**
+ * Returns the TensorMap of a file.
+ * @return null if the file can't be read, with the reason in `readError`.
+ */
+std::shared_ptr<const TensorMap>
+HeaderCache::tensor_map(const String& path, ReadError& readError) {
+    return _get(path, readError, &Entry::tensorMap, &Entry::tensorMapBytes, [&](size_t& bytes) {
+        // constructed in place, the TensorMap is never copied nor moved
+        std::shared_ptr<const TensorMap> tensorMap{ new TensorMap(TensorMap::from_file(path, readError)) };
+        if( readError != ReadError::None ) { return std::shared_ptr<const TensorMap>{}; }
+        bytes = _memory_usage(*tensorMap);
+        return tensorMap;
+    });
+}
+
+/**
+ * Returns the counters of the cache.
+ */
+HeaderCache::Stats
+HeaderCache::stats() const {
+    std::lock_guard lock{_mutex};
+    Stats stats   = _stats;
+    stats.entries = _entries.size();
+    return stats;
+}
+
+//============================ IMPLEMENTATION =============================//
+
+/**
+ * Reads the device, inode, size and modification time of a file.
+ * @return `false` if the file doesn't exist or is not a regular file.
+ */
+bool
+HeaderCache::_stat(const String& path, Stamp& stamp) {
+#ifdef _WIN32
+    std::error_code errorCode;
+    if( !fs::is_regular_file(path, errorCode) ) { return false; }
+    stamp.size  = fs::file_size(path, errorCode);
+    stamp.mtime = fs::last_write_time(path, errorCode).time_since_epoch().count();
+    return !errorCode;
+#else
+    struct stat status;
+    if( ::stat(path.c_str(), &status) != 0 || !S_ISREG(status.st_mode) ) { return false; }
+    stamp.device = static_cast<std::uint64_t>(status.st_dev);
+    stamp.inode  = static_cast<std::uint64_t>(status.st_ino);
+    stamp.size   = static_cast<std::uint64_t>(status.st_size);
+    stamp.mtime  = static_cast<std::int64_t>(status.st_mtim.tv_sec) * 1'000'000'000 + status.st_mtim.tv_nsec;
+    return true;
+#endif
+}
+
+/**
+ * Returns a view of a file (`view` of its entry) if the file didn't change
+ * since it was cached, or loads it with `load(bytes)` and caches it.
+ */
+template <typename View, typename Load>
+std::shared_ptr<const View>
+HeaderCache::_get(const String& path, ReadError& readError,
+                  std::shared_ptr<const View> Entry::* view, size_t Entry::* bytes, Load&& load)
+{
+    Stamp stamp;
+    if( !_stat(path, stamp) ) { readError = ReadError::FileNotFound; return nullptr; }
+    {
+        std::lock_guard lock{_mutex};
+        const auto found = _index.find(path);
+        if( found != _index.end() && found->second->stamp == stamp && (*found->second).*view ) {
+            _entries.splice(_entries.begin(), _entries, found->second);
+            ++_stats.hits;
+            return (*found->second).*view;
+        }
+        ++_stats.misses;
+    }
+
+    // the file is read without holding the lock
+    size_t loadedBytes = 0;
+    auto loaded = load(loadedBytes);
+    if( !loaded ) { return nullptr; }
+
+    std::lock_guard lock{_mutex};
+    auto found = _index.find(path);
+    if( found != _index.end() && found->second->stamp != stamp ) {
+        // the views of the older version of the file are dropped
+        _stats.bytes -= found->second->inventoryBytes + found->second->tensorMapBytes;
+        _entries.erase(found->second);
+        _index.erase(found);
+        found = _index.end();
+    }
+    if( found == _index.end() ) {
+        _entries.push_front({ path, stamp, {}, {}, 0, 0 });
+        _index[path] = _entries.begin();
+    }
+    else {
+        _entries.splice(_entries.begin(), _entries, found->second);
+    }
+    Entry& entry = _entries.front();
+    _stats.bytes -= entry.*bytes;
+    _stats.bytes += loadedBytes;
+    entry.*view   = loaded;
+    entry.*bytes  = loadedBytes;
+    _evict();
+    return loaded;
+}
+
+/**
+ * Drops the least recently used entries until the cache is within its
+ * capacity (the most recent entry always stays).
+ */
+void
+HeaderCache::_evict() {
+    while( _stats.bytes > _capacity && _entries.size() > 1 ) {
+        const Entry& last = _entries.back();
+        _stats.bytes -= last.inventoryBytes + last.tensorMapBytes;
+        _index.erase(last.path);
+        _entries.pop_back();
+        ++_stats.evictions;
+    }
+}
@@ -0,0 +1,106 @@
+/*
+| File    : ckshow_cache.h
+| Purpose : Keeps the parsed headers of the recently used checkpoint files.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 19, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKSHOW_CACHE_H_
+#define CKSHOW_CACHE_H_
+#include <cstdint>            // for std::uint64_t, std::int64_t
+#include <list>               // for std::list
+#include <memory>             // for std::shared_ptr
+#include <mutex>              // for std::mutex
+#include <unordered_map>      // for std::unordered_map
+#include <tin/readerror.h>    // for tin::ReadError
+#include <tin/tensormap.h>    // for tin::TensorMap
+#include "common.h"
+#include "ckshow_inventory.h" // for TensorInventory
+
+
+/**
+ * A least-recently-used cache of parsed headers, bounded by memory.
+ *
+ * Each file keeps the views that were asked for: its TensorInventory
+ * (stored in natural order, the default order of the listings, so most
+ * copies don't need sorting) and its TensorMap. Before an entry is reused
+ * the file is stat'ed again; a different device, inode, size or
+ * modification time means the file changed and its header is read again.
+ *
+ * The cache is shared by the threads of the daemon. The lock is only held
+ * to look up and to insert entries, never while a file is read, so two
+ * threads that miss the same file at once may both read it (the last one
+ * stays). When the estimated memory goes over the capacity, the least
+ * recently used entries are dropped; a request that still uses one keeps
+ * it alive through its `shared_ptr`.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * HeaderCache cache{ 256 * 1024 * 1024 };
+ * auto inventory = cache.inventory("model.safetensors", readError);
+ * if( inventory ) { TensorInventory copy = *inventory; copy.sort_by_name(); }
+ * @endcode
+ */
+class HeaderCache
+{
+public:
+    struct Stats {
+        size_t        entries   = 0;
+        size_t        bytes     = 0;   ///< estimated memory of the entries
+        size_t        capacity  = 0;
+        std::uint64_t hits      = 0;
+        std::uint64_t misses    = 0;   ///< files read, including the ones that changed
+        std::uint64_t evictions = 0;
+    };
+
+// CONSTRUCTION
+public:
+    explicit HeaderCache(size_t capacity);
+    HeaderCache(const HeaderCache&) = delete;
+    HeaderCache& operator=(const HeaderCache&) = delete;
+
+// LOOKUP
+public:
+    [[nodiscard]] std::shared_ptr<const TensorInventory> inventory(const String& path, tin::ReadError& readError);
+    [[nodiscard]] std::shared_ptr<const tin::TensorMap>  tensor_map(const String& path, tin::ReadError& readError);
+    [[nodiscard]] Stats stats() const;
+
+// IMPLEMENTATION
+private:
+    struct Stamp {
+        std::uint64_t device = 0;
+        std::uint64_t inode  = 0;
+        std::uint64_t size   = 0;
+        std::int64_t  mtime  = 0;   ///< nanoseconds
+        bool operator==(const Stamp&) const = default;
+    };
+    struct Entry {
+        String                                 path;
+        Stamp                                  stamp;
+        std::shared_ptr<const TensorInventory> inventory;
+        std::shared_ptr<const tin::TensorMap>  tensorMap;
+        size_t                                 inventoryBytes = 0;
+        size_t                                 tensorMapBytes = 0;
+    };
+    using Entries = std::list<Entry>;
+
+    static bool _stat(const String& path, Stamp& stamp);
+    template <typename View, typename Load>
+    std::shared_ptr<const View> _get(const String& path, tin::ReadError& readError,
+                                     std::shared_ptr<const View> Entry::* view, size_t Entry::* bytes, Load&& load);
+    void _evict();
+
+private:
+    mutable std::mutex                                   _mutex;
+    Entries                                              _entries;  ///< most recently used first
+    std::unordered_map<String, Entries::iterator>        _index;
+    size_t                                               _capacity;
+    Stats                                                _stats;
+};
+
+#endif // CKSHOW_CACHE_H_
@@ -0,0 +1,485 @@
+/*
+| File    : ckshow_daemon.cpp
+| Purpose : Answers ckshow commands sent to a Unix domain socket.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 19, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <csignal>       // for std::signal, std::sig_atomic_t
+#include <cstring>       // for std::memcpy
+#include <filesystem>    // for std::filesystem::current_path
+#include <iostream>      // for std::cerr
+#include <sstream>       // for std::ostringstream
+#include <thread>        // for std::thread
+#include "colors.h"
+#include "jsonwriter.h"
+#include "messages.h"
+#include "outputsink.h"
+#include "parallel.h"
+#include "ckshow_args.h"
+#include "ckshow.h"
+#include "ckshow_daemon.h"
+#ifndef _WIN32
+#include <cerrno>        // for errno, EINTR
+#include <fcntl.h>       // for ::fcntl
+#include <poll.h>        // for ::poll
+#include <sys/socket.h>  // for ::socket, ::bind, ::listen, ::accept, ::connect, ::setsockopt
+#include <sys/time.h>    // for timeval
+#include <sys/un.h>      // for sockaddr_un
+#include <unistd.h>      // for ::read, ::write, ::close, ::unlink
+#endif
+namespace fs = std::filesystem;
+
+/// Requests longer than this are not commands, the connection is closed
+static constexpr std::uint32_t MaxRequestSize = 1024 * 1024;
+
+/// Buffer of the output of each request (it grows the answer in blocks of this size)
+static constexpr size_t AnswerBufferSize = 64 * 1024;
+
+/// Seconds a worker waits for the rest of a request that started to arrive
+static constexpr int RequestTimeout = 5;
+
+/// Milliseconds a worker waits for the next request of the connection it
+/// answered, when no other connection is waiting, before giving it back
+static constexpr int LingerTime = 1;
+
+/// Set by SIGINT and SIGTERM, which interrupt the wait for connections.
+static volatile std::sig_atomic_t StopRequested = 0;
+
+static void
+_request_stop(int) {
+    StopRequested = 1;
+}
+
+/**
+ * Appends a 32-bit little-endian number to `frame`.
+ */
+static void
+_put_u32(String& frame, std::uint32_t value) {
+    const char bytes[4] = { static_cast<char>(value), static_cast<char>(value >> 8),
+                            static_cast<char>(value >> 16), static_cast<char>(value >> 24) };
+    frame.append(bytes, 4);
+}
+
+/**
+ * Returns the 32-bit little-endian number that starts at `bytes`.
+ */
+static std::uint32_t
+_get_u32(const char* bytes) {
+    const auto* b = reinterpret_cast<const unsigned char*>(bytes);
+    return std::uint32_t{b[0]} | std::uint32_t{b[1]} << 8 | std::uint32_t{b[2]} << 16 | std::uint32_t{b[3]} << 24;
+}
+
+/**
+ * Starts a frame in `frame`; `_end_frame()` writes its length once the
+ * payload is appended, so the whole frame goes out in one write.
+ */
+static void
+_begin_frame(String& frame) {
+    frame.assign(4, '\0');
+}
+
+static void
+_end_frame(String& frame) {
+    const size_t size = frame.size() - 4;
+    for( int k = 0 ; k < 4 ; ++k ) { frame[k] = static_cast<char>(size >> (8 * k)); }
+}
+
+#ifndef _WIN32
+/**
+ * Writes all of `size` bytes, retrying the writes cut short by signals.
+ */
+static bool
+_write_all(int fileDescriptor, const char* data, size_t size) {
+    while( size > 0 ) {
+        const auto written = ::write(fileDescriptor, data, size);
+        if( written < 0 && errno == EINTR ) { continue; }
+        if( written <= 0 ) { return false; }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * Reads exactly `size` bytes.
+ * @return `false` if the connection was closed or failed before.
+ */
+static bool
+_read_all(int fileDescriptor, char* data, size_t size) {
+    while( size > 0 ) {
+        const auto bytesRead = ::read(fileDescriptor, data, size);
+        if( bytesRead < 0 && errno == EINTR ) { continue; }
+        if( bytesRead <= 0 ) { return false; }
+        data += bytesRead;
+        size -= static_cast<size_t>(bytesRead);
+    }
+    return true;
+}
+
+/**
+ * Reads the payload of the next frame into `payload`.
+ * @return `false` if the connection was closed, failed, or the frame is
+ *         longer than `maxSize`.
+ */
+static bool
+_read_frame(int fileDescriptor, String& payload, std::uint32_t maxSize) {
+    char length[4];
+    if( !_read_all(fileDescriptor, length, 4) ) { return false; }
+    const std::uint32_t size = _get_u32(length);
+    if( size > maxSize ) { return false; }
+    payload.resize(size);
+    return _read_all(fileDescriptor, payload.data(), size);
+}
+
+/**
+ * Fills the address of a Unix domain socket.
+ * @return `false` if the path doesn't fit in the address.
+ */
+static bool
+_socket_address(const String& path, sockaddr_un& address) {
+    address = {};
+    address.sun_family = AF_UNIX;
+    if( path.empty() || path.size() >= sizeof(address.sun_path) ) { return false; }
+    std::memcpy(address.sun_path, path.data(), path.size());
+    return true;
+}
+
+/**
+ * Connects to the Unix domain socket at `path`.
+ * @return The connection, or -1 if nobody is listening there.
+ */
+static int
+_connect(const String& path) {
+    sockaddr_un address;
+    if( !_socket_address(path, address) ) { return -1; }
+    const int connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if( connection < 0 ) { return -1; }
+    if( ::connect(connection, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ) {
+        ::close(connection);
+        return -1;
+    }
+    return connection;
+}
+#endif
+
+//============================= CONSTRUCTION ==============================//
+
+/**
+ * Prepares a daemon.
+ *
+ * @param socketPath      Where the Unix domain socket is created.
+ * @param cacheCapacity   Estimated memory of the parsed headers kept, in bytes.
+ * @param numberOfThreads Requests answered at the same time (0 = default).
+ */
+CkShowDaemon::CkShowDaemon(const String& socketPath, size_t cacheCapacity, unsigned numberOfThreads)
+: _socketPath{socketPath}
+, _cache{cacheCapacity}
+, _numberOfThreads{ numberOfThreads > 0 ? numberOfThreads : std::max(4u, default_thread_count()) }
+{}
+
+//================================ SERVING ================================//
+
+/**
+ * Listens on the socket and answers the commands until the process is
+ * interrupted, then removes the socket.
+ * @return The exit code of the process.
+ */
+int
+CkShowDaemon::serve() {
+#ifdef _WIN32
+    Messages::fatal_error("The daemon needs Unix domain sockets, which are not available on this system.");
+#else
+    sockaddr_un address;
+    if( !_socket_address(_socketPath, address) ) {
+        Messages::fatal_error("The socket path '" + _socketPath + "' is too long.", {
+            "Unix domain sockets accept paths of up to " + std::to_string(sizeof(address.sun_path) - 1) + " characters." });
+    }
+    // a socket left by a daemon that died is replaced, a live one is not
+    std::error_code errorCode;
+    if( fs::is_socket(_socketPath, errorCode) ) {
+        const int probe = _connect(_socketPath);
+        if( probe >= 0 ) {
+            ::close(probe);
+            Messages::fatal_error("Another daemon is already listening on '" + _socketPath + "'.");
+        }
+        ::unlink(_socketPath.c_str());
+    }
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if( listener < 0 || ::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listener, 128) != 0 ) {
+        Messages::fatal_error("Unable to listen on '" + _socketPath + "'.", {
+            std::strerror(errno) });
+    }
+
+    auto& c = Colors::instance();
+    std::cerr << c.info() << "Listening : " << c.reset() << _socketPath << " (" << _numberOfThreads << " threads, "
+              << to_human_size(_cache.stats().capacity) << " of headers, Ctrl+C to stop)" << std::endl;
+    // the answers are read by programs, and the workers never change the colors
+    Colors::instance().disable_colors();
+    std::signal(SIGINT,  _request_stop);
+    std::signal(SIGTERM, _request_stop);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    // the workers write to this pipe when they give a connection back
+    if( ::pipe(_wakeup) != 0 ) {
+        Messages::fatal_error("Unable to create the pipe of the daemon.", { std::strerror(errno) });
+    }
+    ::fcntl(_wakeup[0], F_SETFL, O_NONBLOCK);
+    ::fcntl(_wakeup[1], F_SETFL, O_NONBLOCK);
+
+    std::vector<std::thread> workers;
+    for( unsigned t = 0 ; t < _numberOfThreads ; ++t ) { workers.emplace_back([this]() { _work(); }); }
+
+    // the idle connections are watched here, and only a connection with a
+    // request waiting is handed to a worker; poll() is interrupted by the
+    // signals, unlike an accept() that restarts
+    std::vector<int>    idle;
+    std::vector<pollfd> watched;
+    while( !StopRequested ) {
+        watched.assign({ {listener, POLLIN, 0}, {_wakeup[0], POLLIN, 0} });
+        for( const int connection : idle ) { watched.push_back({connection, POLLIN, 0}); }
+        if( ::poll(watched.data(), watched.size(), -1) <= 0 ) { continue; }
+
+        std::lock_guard lock{_mutex};
+        std::vector<int> stillIdle;
+        for( size_t i = 2 ; i < watched.size() ; ++i ) {
+            // (a closed or failed connection is also handed over, to be closed)
+            if( watched[i].revents != 0 ) { _pending.push_back(watched[i].fd); _ready.notify_one(); }
+            else                          { stillIdle.push_back(watched[i].fd); }
+        }
+        idle.swap(stillIdle);
+        if( watched[1].revents & POLLIN ) {
+            char bytes[64];
+            while( ::read(_wakeup[0], bytes, sizeof(bytes)) > 0 ) {}
+            idle.insert(idle.end(), _returned.begin(), _returned.end());
+            _returned.clear();
+        }
+        if( watched[0].revents & POLLIN ) {
+            const int connection = ::accept(listener, nullptr, nullptr);
+            if( connection >= 0 ) {
+                // a client that stops in the middle of a request can't keep a worker
+                const timeval timeout{ RequestTimeout, 0 };
+                ::setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+                ::setsockopt(connection, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+                idle.push_back(connection);
+                _open.insert(connection);
+            }
+        }
+    }
+
+    ::close(listener);
+    ::unlink(_socketPath.c_str());
+    {
+        // the workers that wait for the rest of a request stop when the
+        // connections are shut down
+        std::lock_guard lock{_mutex};
+        _stopping = true;
+        for( const int connection : _open ) { ::shutdown(connection, SHUT_RDWR); }
+    }
+    _ready.notify_all();
+    for( auto& worker : workers ) { worker.join(); }
+    for( const int connection : _open ) { ::close(connection); }
+    ::close(_wakeup[0]);
+    ::close(_wakeup[1]);
+    return 0;
+#endif
+}
+
+/**
+ * Sends a command to the daemon and prints its answer, as if the command
+ * had run in this process.
+ *
+ * @param socketPath Where the daemon listens.
+ * @param arguments  The arguments of the command.
+ * @return The exit code of the command.
+ */
+int
+CkShowDaemon::request(const String& socketPath, const std::vector<String>& arguments) {
+#ifdef _WIN32
+    Messages::fatal_error("The daemon needs Unix domain sockets, which are not available on this system.");
+#else
+    std::signal(SIGPIPE, SIG_IGN);
+    const int connection = _connect(socketPath);
+    if( connection < 0 ) {
+        Messages::fatal_error("Unable to connect to a daemon on '" + socketPath + "'.", {
+            "Start it with `ckshow --serve " + socketPath + "`." });
+    }
+    std::error_code errorCode;
+    String frame;
+    _begin_frame(frame);
+    frame += fs::current_path(errorCode).string();
+    frame += '\0';
+    for( const auto& argument : arguments ) { frame += argument; frame += '\0'; }
+    _end_frame(frame);
+
+    String answer;
+    const bool answered = _write_all(connection, frame.data(), frame.size())
+                       && _read_frame(connection, answer, UINT32_MAX) && answer.size() >= 8
+                       && _get_u32(answer.data() + 4) <= answer.size() - 8;
+    ::close(connection);
+    if( !answered ) {
+        Messages::fatal_error("The daemon on '" + socketPath + "' closed the connection without answering.");
+    }
+    const std::uint32_t exitCode   = _get_u32(answer.data());
+    const std::uint32_t outputSize = _get_u32(answer.data() + 4);
+    _write_all(STDOUT_FILENO, answer.data() + 8, outputSize);
+    _write_all(STDERR_FILENO, answer.data() + 8 + outputSize, answer.size() - 8 - outputSize);
+    return static_cast<int>(exitCode);
+#endif
+}
+
+//============================ IMPLEMENTATION =============================//
+
+/**
+ * Answers the requests handed to this worker until the daemon stops; after
+ * each answer the connection goes back to the idle ones watched by `serve()`.
+ */
+void
+CkShowDaemon::_work() {
+#ifndef _WIN32
+    String request, answer;
+    for( ;; ) {
+        int connection;
+        {
+            std::unique_lock lock{_mutex};
+            _ready.wait(lock, [this]() { return _stopping || !_pending.empty(); });
+            if( _stopping ) { return; }
+            connection = _pending.front();
+            _pending.pop_front();
+        }
+        // a client that sends its requests one after another keeps the
+        // worker, as long as nobody else is waiting
+        bool open, next;
+        do {
+            open = _read_frame(connection, request, MaxRequestSize);
+            if( open ) {
+                _answer(request, answer);
+                open = _write_all(connection, answer.data(), answer.size());
+            }
+            pollfd followUp{ connection, POLLIN, 0 };
+            next = open && _is_idle() && ::poll(&followUp, 1, LingerTime) > 0;
+        } while( next );
+
+        std::lock_guard lock{_mutex};
+        if( _stopping ) { continue; } // (`serve()` closes the connection)
+        if( open ) {
+            _returned.push_back(connection);
+            // (a full pipe already wakes `serve()`)
+            const char byte = 0;
+            [[maybe_unused]] const auto written = ::write(_wakeup[1], &byte, 1);
+        }
+        else {
+            // once out of `_open` the connection is not shut down by `serve()`,
+            // so its descriptor can be closed and reused
+            _open.erase(connection);
+            ::close(connection);
+        }
+    }
+#endif
+}
+
+/**
+ * Returns `true` if no connection is waiting for a worker.
+ */
+bool
+CkShowDaemon::_is_idle() {
+    std::lock_guard lock{_mutex};
+    return _pending.empty() && !_stopping;
+}
+
+/**
+ * Runs the command of a request and writes its answer frame in `frame`.
+ *
+ * The command runs as in the command line, but its output goes to a buffer,
+ * its messages are captured, and a fatal error ends the command instead of
+ * the process.
+ */
+void
+CkShowDaemon::_answer(const String& request, String& frame) {
+    ++_requests;
+
+    // the working directory of the client, then the arguments
+    std::vector<String> words;
+    for( size_t start = 0 ; start < request.size() ; ) {
+        size_t end = request.find('\0', start);
+        if( end == String::npos ) { end = request.size(); }
+        words.emplace_back(request, start, end - start);
+        start = end + 1;
+    }
+    const String directory = words.empty() ? String{} : words.front();
+    std::vector<char*> argv;
+    String program = "ckshow";
+    argv.push_back(program.data());
+    for( size_t i = 1 ; i < words.size() ; ++i ) { argv.push_back(words[i].data()); }
+    argv.push_back(nullptr);
+
+    std::ostringstream output;
+    String errors;
+    int    exitCode = 0;
+    {
+        Messages::Capture capture{errors};
+        try {
+            CkShowArgs args{ static_cast<int>(argv.size() - 1), argv.data() };
+            args.directory = directory;
+            OutputSink out{ output, AnswerBufferSize };
+            if( args.cache_stats ) { _print_stats(out, args.format == Format::JSON); }
+            else {
+                CkShow ckshow{ args, out, &_cache };
+                exitCode = ckshow.run();
+            }
+        }
+        catch( const Messages::FatalError& fatal ) { exitCode = fatal.exitCode; }
+        catch( const std::exception& exception ) {
+            // the daemon outlives a command that fails unexpectedly
+            Messages::error(exception.what());
+            exitCode = 1;
+        }
+    }
+
+    const String text = output.str();
+    _begin_frame(frame);
+    if( text.size() + errors.size() > UINT32_MAX - 8 ) {
+        // the command didn't reach the client, whatever its own exit code
+        _put_u32(frame, static_cast<std::uint32_t>(exitCode != 0 ? exitCode : 1));
+        _put_u32(frame, 0);
+        frame += "[ERROR] The output is too large to be sent by the daemon.\n";
+        _end_frame(frame);
+        return;
+    }
+    _put_u32(frame, static_cast<std::uint32_t>(exitCode));
+    _put_u32(frame, static_cast<std::uint32_t>(text.size()));
+    frame += text;
+    frame += errors;
+    _end_frame(frame);
+}
+
+/**
+ * Prints the counters of the cache and the number of requests answered.
+ */
+void
+CkShowDaemon::_print_stats(OutputSink& out, bool json) const {
+    const auto stats = _cache.stats();
+    if( json ) {
+        JsonWriter writer{out};
+        writer.begin_object();
+        writer.member("entries", stats.entries);
+        writer.member("bytes", stats.bytes);
+        writer.member("capacity", stats.capacity);
+        writer.member("hits", stats.hits);
+        writer.member("misses", stats.misses);
+        writer.member("evictions", stats.evictions);
+        writer.member("requests", _requests.load());
+        writer.end_object().end_document();
+        return;
+    }
+    out << "Files     : " << stats.entries << '\n';
+    out << "Memory    : " << to_human_size(stats.bytes) << " of " << to_human_size(stats.capacity) << '\n';
+    out << "Hits      : " << stats.hits << '\n';
+    out << "Misses    : " << stats.misses << '\n';
+    out << "Evictions : " << stats.evictions << '\n';
+    out << "Requests  : " << _requests.load() << '\n';
+}
@@ -0,0 +1,93 @@
+/*
+| File    : ckshow_daemon.h
+| Purpose : Answers ckshow commands sent to a Unix domain socket.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 19, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKSHOW_DAEMON_H_
+#define CKSHOW_DAEMON_H_
+#include <atomic>             // for std::atomic
+#include <condition_variable> // for std::condition_variable
+#include <cstdint>            // for std::uint64_t
+#include <deque>              // for std::deque
+#include <mutex>              // for std::mutex
+#include <set>                // for std::set
+#include <vector>             // for std::vector
+#include "common.h"
+#include "ckshow_cache.h"     // for HeaderCache
+
+
+/**
+ * Keeps the parsed headers of the recent files in memory and answers the
+ * ckshow commands sent to a Unix domain socket, so the callers that run
+ * ckshow hundreds of times a minute don't pay a process and a header parse
+ * per call.
+ *
+ * The protocol is a sequence of frames, each one a 32-bit little-endian
+ * length followed by that many bytes:
+ *  - A request holds NUL-terminated strings: the working directory of the
+ *    client, then the arguments of the command as they would follow
+ *    `ckshow` on the command line (relative paths are opened from that
+ *    directory, and printed as they were given).
+ *  - The answer holds the exit code and the length of the output (32-bit
+ *    little-endian each), the output, and then the messages the command
+ *    would have printed to the standard error.
+ * A connection carries any number of requests, each one answered before
+ * the next is read. Answers never carry color codes.
+ *
+ * The main thread accepts the connections and watches the idle ones; a
+ * connection with a request waiting is handed to a pool of workers, and
+ * goes back to the idle ones once answered (unless its next request arrives
+ * right away and no other connection is waiting). A client that keeps its
+ * connection open pays no setup per request and holds no worker while it
+ * waits.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * CkShowDaemon daemon{ "/run/ckshow.sock", 256 * 1024 * 1024, 8 };
+ * return daemon.serve();
+ * ...
+ * return CkShowDaemon::request("/run/ckshow.sock", { "--summary", "model.safetensors" });
+ * @endcode
+ */
+class CkShowDaemon
+{
+// CONSTRUCTION
+public:
+    CkShowDaemon(const String& socketPath, size_t cacheCapacity, unsigned numberOfThreads);
+    CkShowDaemon(const CkShowDaemon&) = delete;
+    CkShowDaemon& operator=(const CkShowDaemon&) = delete;
+
+// SERVING
+public:
+    [[nodiscard]] int serve();
+    [[nodiscard]] static int request(const String& socketPath, const std::vector<String>& arguments);
+
+// IMPLEMENTATION
+private:
+    void _work();
+    bool _is_idle();
+    void _answer(const String& request, String& frame);
+    void _print_stats(OutputSink& out, bool json) const;
+
+private:
+    String                     _socketPath;
+    HeaderCache                _cache;
+    unsigned                   _numberOfThreads;
+    std::mutex                 _mutex;
+    std::condition_variable    _ready;
+    std::deque<int>            _pending;           ///< connections with a request waiting for a worker
+    std::vector<int>           _returned;          ///< answered connections to be watched again
+    std::set<int>              _open;              ///< every connection not closed yet
+    int                        _wakeup[2] = {-1, -1}; ///< pipe that wakes `serve()` when a connection is returned
+    bool                       _stopping = false;
+    std::atomic<std::uint64_t> _requests{0};
+};
+
+#endif // CKSHOW_DAEMON_H_
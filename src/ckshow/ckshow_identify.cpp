@@ -0,0 +1,321 @@
+/*
+| File    : ckshow_identify.cpp
+| Purpose : Recognizes the architecture of a checkpoint from its header.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 15, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm>  // for std::any_of, std::find_first_of, std::equal
+#include <iterator>   // for std::make_move_iterator
+#include "file.h"     // for File
+#include "json.h"     // for JsonValue
+#include "ckshow_identify.h"
+
+
+/**
+ * Wrappers of the components of single-file checkpoints, removed from the
+ * normalized names (longest first, the first that matches is removed).
+ */
+static const StringView Wrappers[] = {
+    "conditioner.embedders.#.transformer.",
+    "text_encoders.clip_l.transformer.",
+    "text_encoders.clip_g.transformer.",
+    "text_encoders.t5xxl.transformer.",
+    "cond_stage_model.transformer.",
+    "conditioner.embedders.#.",
+    "model.diffusion_model.",
+    "first_stage_model.",
+    "cond_stage_model.",
+};
+
+static std::uint64_t
+_mix(std::uint64_t hash, std::uint64_t value) noexcept {
+    hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    hash ^= hash >> 31;
+    hash *= 0xbf58476d1ce4e5b9;
+    return hash ^ (hash >> 27);
+}
+
+//============================== FINGERPRINT ==============================//
+
+/**
+ * Builds the fingerprint of the tensors selected in `inventory`.
+ * @param inventory The tensors; it must outlive the fingerprint.
+ */
+Fingerprint::Fingerprint(const TensorInventory& inventory)
+: _entries{ inventory.entries() }
+{
+    const auto count = static_cast<std::uint32_t>(_entries.size());
+    _nextTensor.assign(count, None);
+    _firstTensor.reserve(count);
+    std::vector<std::int64_t>  shape;
+    String key;
+    // the tensors are linked backwards, so each list ends up in inventory order
+    for( std::uint32_t i = count ; i-- > 0 ; ) {
+        const auto& entry = _entries[i];
+        normalize(entry.name, key);
+        const std::uint64_t keyHash = hash_key(key);
+        const auto [it, inserted] = _firstTensor.try_emplace(keyHash, i);
+        if( !inserted ) { _nextTensor[i] = it->second; it->second = i; }
+
+        // the sum doesn't depend on the order of the tensors
+        std::uint64_t hash = _mix(keyHash, hash_key(entry.dtype));
+        entry.shape(shape);
+        for( const auto dimension : shape ) { hash = _mix(hash, static_cast<std::uint64_t>(dimension)); }
+        _signature += hash;
+    }
+}
+
+/**
+ * Returns the first tensor whose normalized name has the hash `key`, or
+ * `None` if the checkpoint has no such tensor.
+ */
+std::uint32_t
+Fingerprint::first_tensor(std::uint64_t key) const noexcept {
+    const auto it = _firstTensor.find(key);
+    return it == _firstTensor.end() ? None : it->second;
+}
+
+/**
+ * Returns the hash of a normalized name (64-bit FNV-1a, the same on every
+ * platform, as the signatures are meant to be stored).
+ */
+std::uint64_t
+Fingerprint::hash_key(StringView key) noexcept {
+    std::uint64_t hash = 0xcbf29ce484222325;
+    for( const char ch : key ) { hash = (hash ^ static_cast<unsigned char>(ch)) * 0x100000001b3; }
+    return hash;
+}
+
+/**
+ * Stores in `key` the normalized form of a tensor name: every number that
+ * stands alone between separators ('.' or '_') becomes '#', and the wrapper
+ * of a single-file component, if any, is removed.
+ * e.g. "model.diffusion_model.input_blocks.4.1.proj_in.weight" -> "input_blocks.#.#.proj_in.weight"
+ */
+void
+Fingerprint::normalize(StringView name, String& key) {
+    auto is_separator = [](char ch) { return ch == '.' || ch == '_'; };
+    auto is_digit     = [](char ch) { return ch >= '0' && ch <= '9'; };
+    key.clear();
+    for( size_t i = 0 ; i < name.size() ; ) {
+        if( is_digit(name[i]) && (i == 0 || is_separator(name[i-1])) ) {
+            size_t end = i;
+            while( end < name.size() && is_digit(name[end]) ) { ++end; }
+            if( end == name.size() || is_separator(name[end]) ) { key += '#'; i = end; continue; }
+            key.append(name.substr(i, end - i));
+            i = end;
+            continue;
+        }
+        key += name[i++];
+    }
+    for( const StringView wrapper : Wrappers ) {
+        if( key.starts_with(wrapper) ) { key.erase(0, wrapper.size()); break; }
+    }
+}
+
+//========================== ARCHITECTURE TABLE ===========================//
+
+/**
+ * Adds a signature at the end of the table, so it is tried last.
+ */
+void
+ArchitectureTable::add(Signature signature) {
+    signature.keyHashes.clear();
+    signature.shapeHashes.clear();
+    for( const auto& key  : signature.keys   ) { signature.keyHashes.push_back( Fingerprint::hash_key(key) ); }
+    for( const auto& rule : signature.shapes ) { signature.shapeHashes.push_back( Fingerprint::hash_key(rule.key) ); }
+    _signatures.push_back( std::move(signature) );
+}
+
+/**
+ * Loads the signatures of a JSON file (see the class description) and puts
+ * them before the ones already in the table, keeping their order.
+ * @param path  The JSON file.
+ * @param error Set to a description of the problem if the file can't be used.
+ * @return true if the signatures were loaded.
+ */
+bool
+ArchitectureTable::load(const String& path, String& error) {
+    File file;
+    if( !file.open_read(path) ) { error = "Cannot open the signatures file '" + path + "'"; return false; }
+    String text(file.size(), '\0');
+    if( !file.read_at(text.data(), text.size(), 0) ) { error = "Cannot read the signatures file '" + path + "'"; return false; }
+
+    bool ok;
+    const auto root = JsonValue::parse(text, ok);
+    if( !ok || !root.is_array() ) { error = "The signatures file '" + path + "' is not a JSON array"; return false; }
+    ArchitectureTable loaded;
+    for( const auto& item : root.items() ) {
+        Signature signature;
+        signature.name = item["name"].as_string();
+        if( signature.name.empty() || !item["keys"].is_array() || item["keys"].items().empty() ) {
+            error = "Every signature in '" + path + "' needs a \"name\" and a non-empty \"keys\" array";
+            return false;
+        }
+        for( const auto& key : item["keys"].items() ) { signature.keys.push_back( key.as_string() ); }
+        for( const auto& [key, dims] : item["shapes"].members() ) {
+            ShapeRule rule{ key, {} };
+            for( const auto& dim : dims.items() ) {
+                rule.dims.push_back( dim.is_number() ? static_cast<std::int64_t>(dim.as_uint64()) : Any );
+            }
+            signature.shapes.push_back( std::move(rule) );
+        }
+        loaded.add( std::move(signature) );
+    }
+    _signatures.insert(_signatures.begin(), std::make_move_iterator(loaded._signatures.begin()),
+                                            std::make_move_iterator(loaded._signatures.end()));
+    return true;
+}
+
+/**
+ * Returns the signatures that describe the checkpoint: the first one that
+ * holds (its architecture) followed by the components, the signatures that
+ * hold and share no key with the ones before (a signature that shares a key
+ * is a variant of one already reported). Empty if none holds.
+ */
+std::vector<const ArchitectureTable::Signature*>
+ArchitectureTable::identify(const Fingerprint& fingerprint) const {
+    std::vector<const Signature*> found;
+    for( const auto& signature : _signatures ) {
+        const bool variant = std::any_of(found.begin(), found.end(), [&](const Signature* other) {
+            return std::find_first_of(signature.keyHashes.begin(), signature.keyHashes.end(),
+                                      other->keyHashes.begin(), other->keyHashes.end()) != signature.keyHashes.end();
+        });
+        if( !variant && _holds(signature, fingerprint) ) { found.push_back(&signature); }
+    }
+    return found;
+}
+
+/**
+ * Returns true if the checkpoint has every key of `signature` and, for each
+ * shape rule, at least one tensor of the key with that shape.
+ */
+bool
+ArchitectureTable::_holds(const Signature& signature, const Fingerprint& fingerprint) {
+    for( const auto keyHash : signature.keyHashes ) {
+        if( fingerprint.first_tensor(keyHash) == Fingerprint::None ) { return false; }
+    }
+    std::vector<std::int64_t> shape;
+    for( size_t r = 0 ; r < signature.shapes.size() ; ++r ) {
+        const auto& dims = signature.shapes[r].dims;
+        bool matched = false;
+        for( auto i = fingerprint.first_tensor(signature.shapeHashes[r]) ; i != Fingerprint::None && !matched ; i = fingerprint.next_tensor(i) ) {
+            fingerprint.tensor(i).shape(shape);
+            matched = std::equal(shape.begin(), shape.end(), dims.begin(), dims.end(),
+                                 [](std::int64_t size, std::int64_t expected) { return expected == Any || size == expected; });
+        }
+        if( !matched ) { return false; }
+    }
+    return true;
+}
+
+//============================ BUILT-IN TABLE =============================//
+
+/**
+ * Returns the table of the architectures known by ckshow.
+ *
+ * Names are normalized as in `Fingerprint::normalize()`; the shapes that
+ * tell variants apart are mostly the context width of the cross-attention
+ * (768 SD1.x, 1024 SD2.x, 2048 SDXL), the input channels of the first
+ * convolution (9 = inpainting) and the vocabulary of the LLMs.
+ */
+ArchitectureTable
+ArchitectureTable::builtin() {
+    static const StringView UnetToK   = "input_blocks.#.#.transformer_blocks.#.attn2.to_k.weight";
+    static const StringView DiffToK   = "down_blocks.#.attentions.#.transformer_blocks.#.attn2.to_k.weight";
+    static const StringView FluxQkv   = "double_blocks.#.img_attn.qkv.weight";
+    static const StringView FluxLin1  = "single_blocks.#.linear1.weight";
+    static const StringView FluxDQ    = "transformer_blocks.#.attn.add_q_proj.weight";
+    static const StringView FluxDMlp  = "single_transformer_blocks.#.proj_mlp.weight";
+    static const StringView Sd3X      = "joint_blocks.#.x_block.attn.qkv.weight";
+    static const StringView Sd3C      = "joint_blocks.#.context_block.attn.qkv.weight";
+    static const StringView VaeDown   = "encoder.down.#.block.#.conv1.weight";
+    static const StringView VaeDDown  = "encoder.down_blocks.#.resnets.#.conv1.weight";
+    static const StringView VaeConvIn = "decoder.conv_in.weight";
+    static const StringView ClipQ     = "text_model.encoder.layers.#.self_attn.q_proj.weight";
+    static const StringView ClipNorm  = "text_model.final_layer_norm.weight";
+    static const StringView OClipAttn = "model.transformer.resblocks.#.attn.in_proj_weight";
+    static const StringView OClipNorm = "model.ln_final.weight";
+    static const StringView LlmQ      = "model.layers.#.self_attn.q_proj.weight";
+    static const StringView LlmK      = "model.layers.#.self_attn.k_proj.weight";
+    static const StringView LlmGate   = "model.layers.#.mlp.gate_proj.weight";
+    static const StringView LlmEmbed  = "model.embed_tokens.weight";
+    static const StringView GgufQ     = "blk.#.attn_q.weight";
+    static const StringView GgufGate  = "blk.#.ffn_gate.weight";
+    static const StringView GgufEmbed = "token_embd.weight";
+    static const StringView KohyaXlK  = "lora_unet_input_blocks_#_#_transformer_blocks_#_attn2_to_k.lora_down.weight";
+    static const StringView KohyaK    = "lora_unet_down_blocks_#_attentions_#_transformer_blocks_#_attn2_to_k.lora_down.weight";
+
+    using Keys   = std::vector<String>;
+    using Shapes = std::vector<ShapeRule>;
+    auto keys = [](std::initializer_list<StringView> names) { return Keys(names.begin(), names.end()); };
+    auto rule = [](StringView key, std::vector<std::int64_t> dims) { return ShapeRule{ String{key}, std::move(dims) }; };
+
+    ArchitectureTable table;
+    auto add = [&](StringView name, Keys required, Shapes shapes = {}) {
+        table.add({ String{name}, std::move(required), std::move(shapes), {}, {} });
+    };
+    //-- diffusion models
+    add("Flux.1 Fill",             keys({FluxQkv, FluxLin1, "img_in.weight"}), {rule("img_in.weight", {Any, 384})});
+    add("Flux.1-dev",              keys({FluxQkv, FluxLin1, "guidance_in.in_layer.weight"}));
+    add("Flux.1-schnell",          keys({FluxQkv, FluxLin1}));
+    add("Flux.1-dev (diffusers)",  keys({FluxDQ, FluxDMlp, "time_text_embed.guidance_embedder.linear_1.weight"}));
+    add("Flux.1 (diffusers)",      keys({FluxDQ, FluxDMlp}));
+    add("SD3.5 Medium",            keys({Sd3X, Sd3C, "joint_blocks.#.x_block.attn2.qkv.weight"}));
+    add("SD3.5 Large",             keys({Sd3X, Sd3C}), {rule(Sd3X, {Any, 2432})});
+    add("SD3 Medium",              keys({Sd3X, Sd3C}), {rule(Sd3X, {Any, 1536})});
+    add("SD3 (MMDiT)",             keys({Sd3X, Sd3C}));
+    add("SD3 (diffusers)",         keys({FluxDQ, "pos_embed.pos_embed"}));
+    add("SDXL Inpainting",         keys({UnetToK, "label_emb.#.#.weight"}), {rule(UnetToK, {Any, 2048}), rule("input_blocks.#.#.weight", {Any, 9, 3, 3})});
+    add("SDXL",                    keys({UnetToK, "label_emb.#.#.weight"}), {rule(UnetToK, {Any, 2048})});
+    add("SDXL Refiner",            keys({UnetToK, "label_emb.#.#.weight"}), {rule(UnetToK, {Any, 1280})});
+    add("SD1.x Inpainting",        keys({UnetToK, "out.#.weight"}), {rule(UnetToK, {Any, 768}), rule("input_blocks.#.#.weight", {Any, 9, 3, 3})});
+    add("SD1.x",                   keys({UnetToK, "out.#.weight"}), {rule(UnetToK, {Any, 768})});
+    add("SD2.x",                   keys({UnetToK, "out.#.weight"}), {rule(UnetToK, {Any, 1024})});
+    add("SDXL UNet (diffusers)",   keys({DiffToK, "add_embedding.linear_1.weight"}), {rule(DiffToK, {Any, 2048})});
+    add("SD1.x UNet (diffusers)",  keys({DiffToK, "conv_in.weight"}), {rule(DiffToK, {Any, 768})});
+    add("SD2.x UNet (diffusers)",  keys({DiffToK, "conv_in.weight"}), {rule(DiffToK, {Any, 1024})});
+    //-- autoencoders and text encoders
+    add("VAE (16 channels, Flux/SD3)",     keys({VaeDown,  VaeConvIn}), {rule(VaeConvIn, {Any, 16, 3, 3})});
+    add("VAE (4 channels, SD1.x/SD2.x/SDXL)", keys({VaeDown,  VaeConvIn}), {rule(VaeConvIn, {Any, 4, 3, 3})});
+    add("VAE (16 channels, diffusers)",    keys({VaeDDown, VaeConvIn}), {rule(VaeConvIn, {Any, 16, 3, 3})});
+    add("VAE (4 channels, diffusers)",     keys({VaeDDown, VaeConvIn}), {rule(VaeConvIn, {Any, 4, 3, 3})});
+    add("CLIP-L text encoder",             keys({ClipQ, ClipNorm}), {rule(ClipNorm, {768})});
+    add("CLIP-G text encoder",             keys({ClipQ, ClipNorm}), {rule(ClipNorm, {1280})});
+    add("OpenCLIP-H text encoder",         keys({OClipAttn, OClipNorm}), {rule(OClipNorm, {1024})});
+    add("OpenCLIP-bigG text encoder",      keys({OClipAttn, OClipNorm}), {rule(OClipNorm, {1280})});
+    add("T5 encoder",                      keys({"encoder.block.#.layer.#.SelfAttention.q.weight", "shared.weight"}));
+    //-- language models
+    add("Mixtral (MoE)",     keys({LlmQ, "model.layers.#.block_sparse_moe.gate.weight"}));
+    add("Qwen3 MoE",         keys({LlmQ, "model.layers.#.self_attn.q_norm.weight", "model.layers.#.mlp.gate.weight"}));
+    add("Gemma 3",           keys({LlmQ, "model.layers.#.pre_feedforward_layernorm.weight", "model.layers.#.self_attn.q_norm.weight"}));
+    add("Gemma 2",           keys({LlmQ, "model.layers.#.pre_feedforward_layernorm.weight"}));
+    add("Qwen3",             keys({LlmQ, "model.layers.#.self_attn.q_norm.weight", LlmGate}));
+    add("Qwen2",             keys({LlmQ, "model.layers.#.self_attn.q_proj.bias", LlmGate}));
+    add("Phi-3",             keys({"model.layers.#.self_attn.qkv_proj.weight", "model.layers.#.mlp.gate_up_proj.weight"}));
+    add("Llama 3",           keys({LlmQ, LlmGate, LlmEmbed}), {rule(LlmEmbed, {128256, Any})});
+    add("Mistral 7B v0.3",   keys({LlmQ, LlmGate, LlmEmbed}), {rule(LlmEmbed, {32768, 4096}), rule(LlmK, {1024, 4096})});
+    add("Mistral 7B",        keys({LlmQ, LlmGate, LlmEmbed}), {rule(LlmEmbed, {32000, 4096}), rule(LlmK, {1024, 4096})});
+    add("Mistral Nemo",      keys({LlmQ, LlmGate, LlmEmbed}), {rule(LlmEmbed, {131072, 5120})});
+    add("Llama 2",           keys({LlmQ, LlmGate, LlmEmbed}), {rule(LlmEmbed, {32000, Any})});
+    add("Llama-family decoder", keys({LlmQ, LlmGate, LlmEmbed}));
+    add("Qwen2 (GGUF)",      keys({GgufQ, GgufGate, "blk.#.attn_q.bias"}));
+    add("Llama 3 (GGUF)",    keys({GgufQ, GgufGate, GgufEmbed}), {rule(GgufEmbed, {128256, Any})});
+    add("Llama-family decoder (GGUF)", keys({GgufQ, GgufGate, GgufEmbed}));
+    //-- adapters
+    add("Flux LoRA (kohya)",     keys({"lora_unet_double_blocks_#_img_attn_qkv.lora_down.weight"}));
+    add("Flux LoRA (diffusers)", keys({"transformer.transformer_blocks.#.attn.to_q.lora_A.weight",
+                                       "transformer.single_transformer_blocks.#.attn.to_q.lora_A.weight"}));
+    add("SDXL LoRA (kohya)",     keys({KohyaXlK}), {rule(KohyaXlK, {Any, 2048})});
+    add("SDXL LoRA (kohya, text encoders)", keys({"lora_te1_text_model_encoder_layers_#_self_attn_q_proj.lora_down.weight",
+                                                  "lora_te2_text_model_encoder_layers_#_self_attn_q_proj.lora_down.weight"}));
+    add("SD1.x LoRA (kohya)",    keys({KohyaK}), {rule(KohyaK, {Any, 768})});
+    add("SD2.x LoRA (kohya)",    keys({KohyaK}), {rule(KohyaK, {Any, 1024})});
+    add("LLM LoRA (PEFT)",       keys({"base_model.model.model.layers.#.self_attn.q_proj.lora_A.weight"}));
+    return table;
+}
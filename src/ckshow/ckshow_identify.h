@@ -0,0 +1,122 @@
+/*
+| File    : ckshow_identify.h
+| Purpose : Recognizes the architecture of a checkpoint from its header.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 15, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKSHOW_IDENTIFY_H_
+#define CKSHOW_IDENTIFY_H_
+#include <cstdint>            // for std::int64_t, std::uint64_t
+#include <unordered_map>      // for std::unordered_map
+#include <vector>             // for std::vector
+#include "common.h"
+#include "ckshow_inventory.h" // for TensorInventory
+
+
+/**
+ * The structure of a checkpoint reduced to its tensor names, with the layer
+ * indices replaced by '#' ("input_blocks.#.#.proj_in.weight").
+ *
+ * Each normalized name is stored as a 64-bit hash, with the tensors that
+ * have it, so checking whether a name is present costs one lookup. Common
+ * wrappers of single-file checkpoints ("model.diffusion_model.",
+ * "first_stage_model.", ...) are removed, so a UNet is recognized alone or
+ * inside a full checkpoint.
+ *
+ * `signature` condenses every normalized name, shape and dtype into one
+ * number that doesn't depend on the order of the tensors: two files with the
+ * same architecture, size and precision have the same signature.
+ */
+class Fingerprint
+{
+public:
+    static constexpr std::uint32_t None = 0xFFFFFFFF;
+
+// CONSTRUCTION
+public:
+    explicit Fingerprint(const TensorInventory& inventory);
+
+// ATTRIBUTES
+public:
+    [[nodiscard]] std::uint32_t first_tensor(std::uint64_t key) const noexcept;
+    [[nodiscard]] std::uint32_t next_tensor(std::uint32_t index) const noexcept { return _nextTensor[index]; }
+    [[nodiscard]] const TensorInventory::Entry& tensor(std::uint32_t index) const noexcept { return _entries[index]; }
+    [[nodiscard]] std::uint64_t signature() const noexcept { return _signature; }
+    [[nodiscard]] static std::uint64_t hash_key(StringView key) noexcept;
+    static void normalize(StringView name, String& key);
+
+// IMPLEMENTATION
+private:
+    TensorInventory::Entries                         _entries;
+    std::unordered_map<std::uint64_t, std::uint32_t> _firstTensor;  ///< first tensor of each normalized name
+    std::vector<std::uint32_t>                       _nextTensor;   ///< next tensor with the same normalized name
+    std::uint64_t                                    _signature = 0;
+};
+
+
+/**
+ * A table of known architectures, each described by the normalized names
+ * its checkpoints always contain and the shapes some of those tensors have.
+ *
+ * The table is tried in order and the first signature whose rules all hold
+ * names the file, so more specific signatures go before the general ones
+ * ("Flux.1-dev" before "Flux.1"); every other signature that holds is
+ * reported as a component (the VAE or text encoders of a full checkpoint).
+ * Dimensions set to `Any` match any size. More signatures can be loaded
+ * from a JSON file, and are tried before the built-in ones:
+ *
+ * @code{.json}
+ * [ { "name": "My DiT",
+ *     "keys": ["blocks.#.attn.qkv.weight", "final_layer.linear.weight"],
+ *     "shapes": { "final_layer.linear.weight": [null, 1152] } } ]
+ * @endcode
+ *
+ * Example usage:
+ * @code{.cpp}
+ * const Fingerprint fingerprint{ inventory };
+ * for( const auto* signature : ArchitectureTable::builtin().identify(fingerprint) ) {
+ *     std::cout << signature->name << std::endl;
+ * }
+ * @endcode
+ */
+class ArchitectureTable
+{
+public:
+    static constexpr std::int64_t Any = -1;
+    struct ShapeRule {
+        String                    key;
+        std::vector<std::int64_t> dims;  ///< row-major, `Any` = any size
+    };
+    struct Signature {
+        String                     name;
+        std::vector<String>        keys;    ///< normalized names that must be present
+        std::vector<ShapeRule>     shapes;  ///< a tensor of each key must have the shape
+        std::vector<std::uint64_t> keyHashes;
+        std::vector<std::uint64_t> shapeHashes;
+    };
+
+// CONSTRUCTION
+public:
+    ArchitectureTable() = default;
+    [[nodiscard]] static ArchitectureTable builtin();
+
+// SIGNATURES
+public:
+    void add(Signature signature);
+    bool load(const String& path, String& error);
+    [[nodiscard]] std::vector<const Signature*> identify(const Fingerprint& fingerprint) const;
+
+// IMPLEMENTATION
+private:
+    [[nodiscard]] static bool _holds(const Signature& signature, const Fingerprint& fingerprint);
+private:
+    std::vector<Signature> _signatures;
+};
+
+#endif // CKSHOW_IDENTIFY_H_
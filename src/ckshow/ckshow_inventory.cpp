@@ -0,0 +1,393 @@
+/*
+| File    : ckshow_inventory.cpp
+| Purpose : The layout of every tensor of a checkpoint, sorted by name.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 12, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm>  // for std::sort, std::is_sorted, std::lower_bound, std::partition_point, std::stable_partition
+#include <mutex>      // for std::call_once
+#include "parallel.h" // for parallel_for
+#include "ckshow_inventory.h"
+
+
+//============================= CONSTRUCTION ==============================//
+
+/**
+ * Reads the header of a .safetensors or .gguf file.
+ * @param path      The file to read.
+ * @param readError Set to the error found, if any (the inventory is then empty).
+ */
+TensorInventory::TensorInventory(const String& path, ReadError& readError)
+{
+    auto header = std::make_shared<Header>();
+    if( GgufFile::is_gguf_file(path) ) {
+        header->gguf = GgufFile::from_file(path, readError);
+    }
+    else {
+        header->safetensors = SafetensorsFile::from_file(path, readError);
+    }
+    if( readError != ReadError::None ) { return; }
+    _add_entries(*header, _entries);
+    _header = std::move(header);
+    _count  = _entries.size();
+}
+
+/**
+ * Appends an entry for every tensor of the header to `entries`, in file
+ * order and without the padding tensors.
+ */
+void
+TensorInventory::_add_entries(const Header& header, std::vector<Entry>& entries) {
+    const auto& gguf = header.gguf;
+    entries.reserve(entries.size() + gguf.tensors().size());
+    for( const auto& tensor : gguf.tensors() ) {
+        entries.push_back({ tensor.name, GgufFile::type_name(tensor.type), &tensor.shape, true,
+                            gguf.data_offset() + tensor.offset, tensor.size });
+    }
+    const auto& safetensors = header.safetensors;
+    entries.reserve(entries.size() + safetensors.tensors().size());
+    for( const auto& tensor : safetensors.tensors() ) {
+        if( tensor.is_padding() ) { continue; }
+        entries.push_back({ tensor.name, tensor.dtype, &tensor.shape, false,
+                            safetensors.data_offset() + tensor.begin, tensor.size() });
+    }
+}
+
+//=============================== SELECTION ===============================//
+
+/**
+ * Keeps only the tensors whose name starts with `prefix` and matches any of
+ * `patterns` (an empty prefix or an empty pattern set selects everything).
+ *
+ * The names under a prefix are contiguous in the index of the names in byte
+ * order, so the prefix costs two binary searches there and the selection
+ * comes out sorted by name; only the tensors inside that range are run
+ * through the patterns. Entries that were already narrowed are filtered
+ * in their own order.
+ */
+void
+TensorInventory::select(StringView prefix, PatternSet& patterns) {
+    auto name_less = [](const Entry& entry, StringView text) { return entry.name < text; };
+    auto under     = [&](const Entry& entry) { return entry.name.starts_with(prefix); };
+    const auto begin = _entries.begin() + static_cast<std::ptrdiff_t>(_first);
+    const auto end   = begin + static_cast<std::ptrdiff_t>(_count);
+    auto first = begin, last = end;
+
+    if( !prefix.empty() && _byName ) {
+        first = std::lower_bound(begin, end, prefix, name_less);
+        last  = std::partition_point(first, end, under);
+    }
+    else if( !prefix.empty() && _whole && _header ) {
+        // copy the range of the prefix from the index, in name order
+        const auto& byName = _entries_by_name();
+        const auto  from   = std::lower_bound(byName.begin(), byName.end(), prefix, name_less);
+        const auto  to     = std::partition_point(from, byName.end(), under);
+        first    = _entries.begin();
+        last     = std::copy(from, to, first);
+        _byName  = true;
+        _natural = false;
+    }
+    else if( !prefix.empty() ) {
+        last = std::stable_partition(begin, end, under);
+    }
+
+    auto selected = last;
+    if( !patterns.empty() ) {
+        selected = first;
+        for( auto it = first ; it != last ; ++it ) {
+            if( patterns.matches(it->name) ) { *selected++ = *it; }
+        }
+    }
+    _first = static_cast<size_t>(first - _entries.begin());
+    _count = static_cast<size_t>(selected - first);
+    _whole = _whole && _count == _entries.size();
+}
+
+/**
+ * Keeps only the selected entries whose flag in `keep` isn't 0, in the
+ * same order (`keep` has a flag per selected entry).
+ */
+void
+TensorInventory::retain(const std::vector<std::uint8_t>& keep) {
+    const auto begin = _entries.begin() + static_cast<std::ptrdiff_t>(_first);
+    auto selected = begin;
+    for( size_t i = 0 ; i < _count ; ++i ) {
+        if( keep[i] ) { *selected++ = begin[static_cast<std::ptrdiff_t>(i)]; }
+    }
+    _count = static_cast<size_t>(selected - begin);
+    _whole = _whole && _count == _entries.size();
+}
+
+/**
+ * Sorts the selected entries by name, in byte order (a copy of the index
+ * of the names when nothing was narrowed).
+ */
+void
+TensorInventory::sort_by_name() {
+    if( _byName ) { return; }
+    if( _whole && _header ) {
+        const auto& byName = _entries_by_name();
+        std::copy(byName.begin(), byName.end(), _entries.begin());
+        _first   = 0;
+        _byName  = true;
+        _natural = false;
+        return;
+    }
+    const auto begin = _entries.begin() + static_cast<std::ptrdiff_t>(_first);
+    const auto end   = begin + static_cast<std::ptrdiff_t>(_count);
+    // headers are usually written in name order already
+    auto byName = [](const Entry& a, const Entry& b) { return a.name < b.name; };
+    if( !std::is_sorted(begin, end, byName) ) { std::sort(begin, end, byName); _natural = false; }
+    _byName = true;
+}
+
+/**
+ * Returns true if the name component `a` goes before `b` in natural order:
+ * runs of digits compare by their value ("block2" < "block10"), everything
+ * else byte by byte, and names that only differ in leading zeros by bytes.
+ */
+bool
+TensorInventory::natural_less(StringView a, StringView b) noexcept {
+    auto is_digit = [](char ch) { return ch >= '0' && ch <= '9'; };
+    size_t i = 0, j = 0;
+    while( i < a.size() && j < b.size() ) {
+        if( is_digit(a[i]) && is_digit(b[j]) ) {
+            while( i < a.size() && a[i] == '0' ) { ++i; }
+            while( j < b.size() && b[j] == '0' ) { ++j; }
+            size_t endA = i, endB = j;
+            while( endA < a.size() && is_digit(a[endA]) ) { ++endA; }
+            while( endB < b.size() && is_digit(b[endB]) ) { ++endB; }
+            // without leading zeros, the longer number is the larger one
+            if( endA - i != endB - j ) { return endA - i < endB - j; }
+            const int order = a.substr(i, endA - i).compare(b.substr(j, endB - j));
+            if( order != 0 ) { return order < 0; }
+            i = endA;
+            j = endB;
+        }
+        else {
+            if( a[i] != b[j] ) { return static_cast<unsigned char>(a[i]) < static_cast<unsigned char>(b[j]); }
+            ++i;
+            ++j;
+        }
+    }
+    if( i == a.size() && j < b.size() ) { return true;  }
+    if( j == b.size() && i < a.size() ) { return false; }
+    return a < b;
+}
+
+/**
+ * Gives each distinct name component an id, starting from 1.
+ * An open-addressing table: the components are short, so hashing them is
+ * cheap, and the table only holds the ids (the text is in the names).
+ */
+class ComponentIds
+{
+public:
+    std::uint32_t
+    id(StringView component, std::vector<StringView>& components) {
+        if( components.size() * 2 >= _slots.size() ) { _grow(components); }
+        for( size_t slot = _hash(component) & (_slots.size() - 1) ; ; slot = (slot + 1) & (_slots.size() - 1) ) {
+            const std::uint32_t id = _slots[slot];
+            if( id == 0 ) {
+                _slots[slot] = static_cast<std::uint32_t>(components.size());
+                components.push_back(component);
+                return _slots[slot];
+            }
+            if( components[id] == component ) { return id; }
+        }
+    }
+private:
+    static size_t
+    _hash(StringView text) noexcept {
+        std::uint64_t hash = 0xcbf29ce484222325;  // FNV-1a
+        for( const char ch : text ) { hash = (hash ^ static_cast<unsigned char>(ch)) * 0x100000001b3; }
+        return static_cast<size_t>(hash ^ (hash >> 32));
+    }
+    void
+    _grow(const std::vector<StringView>& components) {
+        _slots.assign(std::max<size_t>(1024, _slots.size() * 2), 0);
+        for( std::uint32_t id = 1 ; id < components.size() ; ++id ) {
+            size_t slot = _hash(components[id]) & (_slots.size() - 1);
+            while( _slots[slot] != 0 ) { slot = (slot + 1) & (_slots.size() - 1); }
+            _slots[slot] = id;
+        }
+    }
+    std::vector<std::uint32_t> _slots;  ///< id of the component in each slot, 0 = empty
+};
+
+/**
+ * Sorts the selected entries in natural order, component by component
+ * ("layers.2" before "layers.10").
+ *
+ * The digits are parsed once per distinct component, not per comparison:
+ * every distinct component of the names gets its rank in natural order, so
+ * each name becomes a sequence of integers, which are sorted with an MSD
+ * radix sort (one level per component, a counting sort of the ranks at
+ * each level, insertion sort for the small groups).
+ * @param numberOfThreads Threads used to sort the groups of names (0 = default).
+ */
+void
+TensorInventory::sort_naturally(unsigned numberOfThreads) {
+    static const size_t SmallGroup = 32;
+    static const int    DigitBits  = 11;
+    if( _natural ) { return; }
+    const Entries entries = this->entries();
+    const auto count = static_cast<std::uint32_t>(entries.size());
+    if( count < 2 ) { return; }
+
+    // the components of each name as ids, ended by 0 (consecutive names
+    // usually share most of their components, so the previous ones are
+    // checked before the table of ids)
+    std::vector<std::uint32_t> keys;
+    std::vector<std::uint32_t> starts(count);
+    std::vector<StringView>    components{ StringView{} };
+    ComponentIds            ids;
+    std::vector<StringView>    previous;
+    std::vector<std::uint32_t> previousIds;
+    keys.reserve(size_t{count} * 8);
+    for( std::uint32_t n = 0 ; n < count ; ++n ) {
+        const StringView name = entries[n].name;
+        starts[n] = static_cast<std::uint32_t>(keys.size());
+        size_t depth = 0;
+        for( size_t start = 0 ; start <= name.size() ; ++depth ) {
+            const size_t end = std::min(name.find('.', start), name.size());
+            const StringView component = name.substr(start, end - start);
+            if( depth == previous.size() ) { previous.emplace_back(); previousIds.push_back(0); }
+            if( previousIds[depth] == 0 || previous[depth] != component ) {
+                previous[depth]    = component;
+                previousIds[depth] = ids.id(component, components);
+            }
+            keys.push_back(previousIds[depth]);
+            start = end + 1;
+        }
+        keys.push_back(0);
+    }
+
+    // replace the ids by their rank in natural order (0 stays first)
+    std::vector<std::uint32_t> byRank(components.size() - 1);
+    for( size_t i = 0 ; i < byRank.size() ; ++i ) { byRank[i] = static_cast<std::uint32_t>(i + 1); }
+    std::sort(byRank.begin(), byRank.end(), [&](std::uint32_t a, std::uint32_t b) { return natural_less(components[a], components[b]); });
+    std::vector<std::uint32_t> rank(components.size(), 0);
+    for( size_t i = 0 ; i < byRank.size() ; ++i ) { rank[byRank[i]] = static_cast<std::uint32_t>(i + 1); }
+    for( auto& key : keys ) { key = rank[key]; }
+    const auto maxRank = static_cast<std::uint32_t>(byRank.size());
+
+    // MSD radix sort of the names by their ranks; once the names split in
+    // several groups, the groups are sorted on several threads
+    struct Item { std::uint32_t key; std::uint32_t name; };
+    using Histogram = std::vector<std::uint32_t>;
+    std::vector<Item> items(count), buffer(count);
+    for( std::uint32_t n = 0 ; n < count ; ++n ) { items[n].name = n; }
+
+    auto sequence_less = [&](std::uint32_t a, std::uint32_t b, size_t depth) {
+        const std::uint32_t* x = &keys[starts[a] + depth];
+        const std::uint32_t* y = &keys[starts[b] + depth];
+        while( *x == *y && *x != 0 ) { ++x; ++y; }
+        return *x < *y;
+    };
+    auto sort_group = [&](auto& self, size_t begin, size_t end, size_t depth, Histogram& histogram, bool parallel) -> void {
+        if( end - begin <= SmallGroup ) {
+            for( size_t i = begin + 1 ; i < end ; ++i ) {
+                const Item item = items[i];
+                size_t k = i;
+                for( ; k > begin && sequence_less(item.name, items[k-1].name, depth) ; --k ) { items[k] = items[k-1]; }
+                items[k] = item;
+            }
+            return;
+        }
+        for( size_t i = begin ; i < end ; ++i ) { items[i].key = keys[starts[items[i].name] + depth]; }
+        // LSD passes over the digits of the ranks at this level (usually one)
+        static const std::uint32_t DigitMask = (1u << DigitBits) - 1;
+        for( int shift = 0 ; shift < 32 && (shift == 0 || (maxRank >> shift) != 0) ; shift += DigitBits ) {
+            histogram.assign(size_t{1} << DigitBits, 0);
+            for( size_t i = begin ; i < end ; ++i ) { ++histogram[(items[i].key >> shift) & DigitMask]; }
+            std::uint32_t sum = 0;
+            for( auto& bucket : histogram ) { const auto size = bucket; bucket = sum; sum += size; }
+            for( size_t i = begin ; i < end ; ++i ) {
+                buffer[begin + histogram[(items[i].key >> shift) & DigitMask]++] = items[i];
+            }
+            std::copy(buffer.begin() + static_cast<std::ptrdiff_t>(begin), buffer.begin() + static_cast<std::ptrdiff_t>(end),
+                      items.begin() + static_cast<std::ptrdiff_t>(begin));
+        }
+        // the names that share this component are sorted by the next one
+        std::vector<std::pair<size_t, size_t>> groups;
+        for( size_t i = begin, next = begin ; i < end ; i = next ) {
+            for( next = i + 1 ; next < end && items[next].key == items[i].key ; ++next ) { }
+            if( next - i > 1 && items[i].key != 0 ) { groups.emplace_back(i, next); }
+        }
+        if( parallel && groups.size() > 1 ) {
+            parallel_for(groups.size(), numberOfThreads, [&](size_t g) {
+                Histogram own;
+                self(self, groups[g].first, groups[g].second, depth + 1, own, false);
+            });
+            return;
+        }
+        for( const auto& [first, last] : groups ) { self(self, first, last, depth + 1, histogram, parallel); }
+    };
+    Histogram histogram;
+    sort_group(sort_group, 0, count, 0, histogram, true);
+
+    std::vector<Entry> sorted(count);
+    for( std::uint32_t i = 0 ; i < count ; ++i ) { sorted[i] = entries[items[i].name]; }
+    std::copy(sorted.begin(), sorted.end(), _entries.begin() + static_cast<std::ptrdiff_t>(_first));
+    _byName  = false;
+    _natural = true;
+}
+
+/**
+ * Returns every entry of the file sorted by name, building the index the
+ * first time; the index lives in the shared header, so it is built once for
+ * the inventory and all its copies, even when they run on several threads.
+ */
+const std::vector<TensorInventory::Entry>&
+TensorInventory::_entries_by_name() const {
+    std::call_once(_header->byNameOnce, [&]() {
+        auto& byName = _header->byName;
+        _add_entries(*_header, byName);
+        // headers are usually written in name order already
+        auto less = [](const Entry& a, const Entry& b) { return a.name < b.name; };
+        if( !std::is_sorted(byName.begin(), byName.end(), less) ) { std::sort(byName.begin(), byName.end(), less); }
+    });
+    return _header->byName;
+}
+
+//=============================== ATTRIBUTES ==============================//
+
+/**
+ * Returns an estimate of the bytes held by the inventory and by the header
+ * it points into.
+ */
+size_t
+TensorInventory::memory_usage() const noexcept {
+    // each tensor of the header costs its name, its dimensions and roughly
+    // the size of an entry in bookkeeping
+    size_t bytes = sizeof(*this) + _entries.capacity() * sizeof(Entry);
+    for( const auto& entry : _entries ) {
+        bytes += sizeof(Entry) + entry.name.size() + entry.dims->size() * sizeof(std::uint64_t);
+    }
+    return bytes;
+}
+
+//================================ ENTRY ==================================//
+
+std::uint64_t
+TensorInventory::Entry::elements() const noexcept {
+    std::uint64_t elements = 1;
+    for( const auto dimension : *dims ) { elements *= dimension; }
+    return elements;
+}
+
+/**
+ * Stores the dimensions in row-major order (outermost first) in `shape`,
+ * reversing the ggml order of GGUF tensors so both formats agree.
+ */
+void
+TensorInventory::Entry::shape(std::vector<std::int64_t>& shape) const {
+    if( ggmlOrder ) { shape.assign(dims->rbegin(), dims->rend()); }
+    else            { shape.assign(dims->begin(),  dims->end());  }
+}
@@ -0,0 +1,99 @@
+/*
+| File    : ckshow_inventory.h
+| Purpose : The layout of every tensor of a checkpoint, sorted by name.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 12, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKSHOW_INVENTORY_H_
+#define CKSHOW_INVENTORY_H_
+#include <cstdint>          // for std::uint64_t
+#include <memory>           // for std::shared_ptr
+#include <mutex>            // for std::once_flag
+#include <span>             // for std::span
+#include <vector>           // for std::vector
+#include "common.h"
+#include "gguf.h"           // for GgufFile
+#include "patternset.h"     // for PatternSet
+#include "safetensors.h"    // for SafetensorsFile
+
+
+/**
+ * The name, dtype, shape and position of every tensor of a .safetensors or
+ * .gguf file.
+ *
+ * Unlike tin::TensorMap it exposes the numeric layout (offsets, sizes and
+ * dimensions), which the aggregated and binary listings need. Entries point
+ * into the header that was read, which the copies of an inventory share, so
+ * a copy (e.g. of an inventory kept by the daemon) can be narrowed and
+ * sorted on its own without reading the file again. Padding tensors of
+ * safetensors files are skipped.
+ *
+ * `select()` narrows the entries to the tensors under a name prefix that
+ * match a set of patterns. The prefix is searched in an index of the names
+ * in byte order, built the first time a prefix is given and shared by the
+ * copies, so the entries are never re-sorted to select a prefix.
+ * The entries are in file order until they are sorted, by name with
+ * `sort_by_name()` or in natural order with `sort_naturally()`; both orders
+ * keep the names under any dotted prefix ("model.layers.") together, and
+ * sorting entries that are already in that order costs nothing.
+ */
+class TensorInventory
+{
+public:
+    struct Entry {
+        StringView                        name;
+        StringView                        dtype;     ///< safetensors dtype or ggml type name
+        const std::vector<std::uint64_t>* dims;      ///< dimensions as stored in the file
+        bool                              ggmlOrder; ///< true = `dims` is innermost first (GGUF)
+        std::uint64_t                     offset;    ///< first byte, absolute in the file
+        std::uint64_t                     size;      ///< size in bytes
+
+        [[nodiscard]] std::uint64_t elements() const noexcept;
+        void shape(std::vector<std::int64_t>& shape) const; ///< row-major dimensions
+    };
+    using Entries = std::span<const Entry>;
+
+// CONSTRUCTION
+public:
+    TensorInventory(const String& path, ReadError& readError);
+
+// SELECTION
+public:
+    void select(StringView prefix, PatternSet& patterns);
+    void retain(const std::vector<std::uint8_t>& keep);
+    void sort_by_name();
+    void sort_naturally(unsigned numberOfThreads = 0);
+    [[nodiscard]] static bool natural_less(StringView a, StringView b) noexcept;
+
+// ATTRIBUTES
+public:
+    [[nodiscard]] Entries entries() const noexcept { return { _entries.data() + _first, _count }; }
+    [[nodiscard]] size_t  memory_usage() const noexcept;
+
+// IMPLEMENTATION
+private:
+    struct Header {
+        SafetensorsFile            safetensors;
+        GgufFile                   gguf;
+        mutable std::once_flag     byNameOnce;
+        mutable std::vector<Entry> byName;  ///< every entry sorted by name, built by the first prefix
+    };
+    static void _add_entries(const Header& header, std::vector<Entry>& entries);
+    [[nodiscard]] const std::vector<Entry>& _entries_by_name() const;
+private:
+    std::shared_ptr<const Header> _header;  ///< the parsed file, shared by the copies
+    std::vector<Entry> _entries;
+    size_t             _first   = 0;     ///< selected entries
+    size_t             _count   = 0;
+    bool               _whole   = true;  ///< true = every entry is selected (nothing narrowed yet)
+    bool               _byName  = false; ///< true = the selected entries are sorted by name
+    bool               _natural = false; ///< true = the selected entries are in natural order
+};
+
+#endif // CKSHOW_INVENTORY_H_
@@ -0,0 +1,97 @@
+/*
+| File    : ckshow_nametree.cpp
+| Purpose : The hierarchy of the tensor names, built from the sorted names.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 14, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm>  // for std::min, std::mismatch
+#include "parallel.h" // for parallel_for
+#include "ckshow_nametree.h"
+
+
+/**
+ * Returns the length of the longest prefix of `a` and `b` that ends right
+ * before a dot in both of them ("model.layers" for "model.layers.1.x" and
+ * "model.layers.10.x"), or 0 if they don't share a dotted prefix.
+ */
+static std::uint32_t
+_shared_dotted_prefix(StringView a, StringView b) noexcept {
+    const size_t size = std::min(a.size(), b.size());
+    const auto mismatch = static_cast<size_t>( std::mismatch(a.begin(), a.begin() + size, b.begin()).first - a.begin() );
+    // the character at `mismatch` differs (or ends one of the names),
+    // so the last dot before it is the last one shared by both
+    const size_t dot = a.substr(0, mismatch).rfind('.');
+    return dot == StringView::npos ? 0 : static_cast<std::uint32_t>(dot);
+}
+
+//============================= CONSTRUCTION ==============================//
+
+/**
+ * Builds the tree of the names selected in `inventory`.
+ * @param inventory       The tensors, sorted by name or in natural order (nodes
+ *                        and tensors keep that order); it must outlive the tree.
+ * @param numberOfThreads Threads used to compare the names (0 = default).
+ */
+NameTree::NameTree(const TensorInventory& inventory, unsigned numberOfThreads)
+: _entries{ inventory.entries() }
+{
+    const auto count = static_cast<std::uint32_t>(_entries.size());
+    _nodes.push_back({ 0, 0 });
+    _nextTensor.assign(count, None);
+    if( count == 0 ) { return; }
+
+    // length of the dotted prefix each name shares with the previous one,
+    // the only step that reads the names, split in blocks among the threads
+    static const size_t BlockSize = 64 * 1024;
+    std::vector<std::uint32_t> shared(count, 0);
+    parallel_for((count + BlockSize - 1) / BlockSize, numberOfThreads, [&](size_t block) {
+        const size_t end = std::min<size_t>(count, (block + 1) * BlockSize);
+        for( size_t i = std::max<size_t>(block * BlockSize, 1) ; i < end ; ++i ) {
+            shared[i] = _shared_dotted_prefix(_entries[i-1].name, _entries[i].name);
+        }
+    });
+
+    // children are appended when they are complete, so both lists keep the order of the entries
+    std::vector<std::uint32_t> lastChild { None };
+    std::vector<std::uint32_t> lastTensor{ None };
+    auto append = [&](std::uint32_t parent, bool isNode, std::uint32_t index) {
+        if( isNode ) {
+            if( lastChild[parent] == None ) { _nodes[parent].firstChild = index; }
+            else                            { _nodes[lastChild[parent]].nextSibling = index; }
+            lastChild[parent] = index;
+        } else {
+            if( lastTensor[parent] == None ) { _nodes[parent].firstTensor = index; }
+            else                             { _nextTensor[lastTensor[parent]] = index; }
+            lastTensor[parent] = index;
+        }
+    };
+
+    // each name decides where the previous one goes: in the deepest open
+    // node, unless the two share a longer prefix, which opens a new node;
+    // the nodes deeper than the shared prefix are complete and go to their parents
+    std::vector<std::uint32_t> open{ 0 };
+    for( std::uint32_t i = 1 ; i <= count ; ++i ) {
+        const std::uint32_t length = i < count ? shared[i] : 0;
+        bool          isNode  = false;
+        std::uint32_t pending = i - 1;
+        while( _nodes[open.back()].length > length ) {
+            const std::uint32_t closed = open.back();
+            open.pop_back();
+            append(closed, isNode, pending);
+            isNode  = true;
+            pending = closed;
+        }
+        if( _nodes[open.back()].length < length ) {
+            open.push_back( static_cast<std::uint32_t>(_nodes.size()) );
+            _nodes.push_back({ i, length });
+            lastChild.push_back(None);
+            lastTensor.push_back(None);
+        }
+        append(open.back(), isNode, pending);
+    }
+}
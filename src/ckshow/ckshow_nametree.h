@@ -0,0 +1,79 @@
+/*
+| File    : ckshow_nametree.h
+| Purpose : The hierarchy of the tensor names, built from the sorted names.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 14, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKSHOW_NAMETREE_H_
+#define CKSHOW_NAMETREE_H_
+#include <cstdint>            // for std::uint32_t
+#include <vector>             // for std::vector
+#include "common.h"
+#include "ckshow_inventory.h" // for TensorInventory
+
+
+/**
+ * The tree of the tensor names of an inventory, split at the dots.
+ *
+ * It is a compressed trie: a node is only created where the names below a
+ * dotted prefix branch, so chains of components with a single child are
+ * merged ("model.layers") and no node holds a single tensor. Every node is
+ * a prefix of the names below it; neither nodes nor names own any text,
+ * they refer to the names of the inventory.
+ *
+ * The nodes live in one flat array linked by first-child/next-sibling
+ * indices, and the tensors of each node in a list threaded through one
+ * index per name, so the tree costs a few integers per name whatever its
+ * shape. It is built in one pass over the names, sorted by name or in
+ * natural order (any order that keeps the names under each dotted prefix
+ * together), with a stack of open nodes, from the length of the dotted
+ * prefix each name shares with the previous one; those lengths, which are
+ * the string comparisons, are computed on several threads.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * NameTree tree{ inventory };
+ * for( auto node = tree.root().firstChild ; node != NameTree::None ; node = tree.node(node).nextSibling ) {
+ *     std::cout << tree.name(node) << std::endl;
+ * }
+ * @endcode
+ */
+class NameTree
+{
+public:
+    static constexpr std::uint32_t None = 0xFFFFFFFF;
+    struct Node {
+        std::uint32_t entry;                ///< a tensor below the node, its name starts with the node name
+        std::uint32_t length;               ///< length of the node name (0 = root)
+        std::uint32_t firstChild  = None;   ///< first subnode
+        std::uint32_t nextSibling = None;
+        std::uint32_t firstTensor = None;   ///< first tensor directly in the node (see `next_tensor()`)
+    };
+
+// CONSTRUCTION
+public:
+    explicit NameTree(const TensorInventory& inventory, unsigned numberOfThreads = 0);
+
+// ACCESS
+public:
+    [[nodiscard]] const Node& root() const noexcept { return _nodes.front(); }
+    [[nodiscard]] const Node& node(std::uint32_t index) const noexcept { return _nodes[index]; }
+    [[nodiscard]] StringView  name(const Node& node) const noexcept { return _entries[node.entry].name.substr(0, node.length); }
+    [[nodiscard]] const TensorInventory::Entry& tensor(std::uint32_t index) const noexcept { return _entries[index]; }
+    [[nodiscard]] std::uint32_t next_tensor(std::uint32_t index) const noexcept { return _nextTensor[index]; }
+    [[nodiscard]] size_t number_of_nodes() const noexcept { return _nodes.size(); }
+
+// IMPLEMENTATION
+private:
+    TensorInventory::Entries   _entries;
+    std::vector<Node>          _nodes;
+    std::vector<std::uint32_t> _nextTensor;
+};
+
+#endif // CKSHOW_NAMETREE_H_
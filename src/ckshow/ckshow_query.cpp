@@ -0,0 +1,471 @@
+/*
+| File    : ckshow_query.cpp
+| Purpose : The `--where` expressions over the attributes of the tensors.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 16, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm>  // for std::find_if, std::all_of
+#include <cmath>      // for std::llround, std::floor, std::isfinite
+#include <limits>     // for std::numeric_limits
+#include <string>     // for std::stod, std::stoll
+#include "parallel.h" // for parallel_for
+#include "ckshow_query.h"
+
+
+static bool
+_is_digit(char ch) noexcept { return ch >= '0' && ch <= '9'; }
+
+static bool
+_is_identifier(char ch) noexcept { return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_' || _is_digit(ch); }
+
+static char
+_to_upper(char ch) noexcept { return (ch >= 'a' && ch <= 'z') ? static_cast<char>(ch - 'a' + 'A') : ch; }
+
+/// Returns true if `a` and `b` are equal ignoring the case of ASCII letters.
+static bool
+_equal_ignoring_case(StringView a, StringView b) noexcept {
+    if( a.size() != b.size() ) { return false; }
+    for( size_t i = 0 ; i < a.size() ; ++i ) { if( _to_upper(a[i]) != _to_upper(b[i]) ) { return false; } }
+    return true;
+}
+
+//============================= QUERY PARSER ==============================//
+
+/**
+ * Recursive descent parser that compiles an expression to the bytecode of
+ * a TensorQuery, emitting the instructions as it goes.
+ * (declared as friend of TensorQuery so it can fill the code directly)
+ */
+class QueryParser
+{
+public:
+    QueryParser(TensorQuery& query, StringView expression) : _query{query}, _text{expression} { }
+
+    bool parse(String& error) {
+        const Operand result = parse_or();
+        if( _error.empty() ) { require_condition(result); }
+        skip_spaces();
+        if( _error.empty() && !at_end() ) { _error = "unexpected '" + String{_text.substr(_pos, 1)} + "'"; }
+        if( !_error.empty() ) {
+            error = "Invalid expression '" + String{_text} + "': " + _error + " at position " + std::to_string(_pos);
+            return false;
+        }
+        return true;
+    }
+
+private:
+    using Op = TensorQuery::Op;
+    enum class Kind { INTEGER, NAME, DTYPE, SHAPE, LITERAL };
+    struct Operand {
+        Kind   kind = Kind::INTEGER;  ///< INTEGER operands are already on the stack
+        String text;                  ///< the text of a LITERAL
+    };
+    TensorQuery& _query;
+    StringView   _text;
+    size_t       _pos   = 0;
+    size_t       _depth = 0;  ///< values on the stack at this point of the code
+    String       _error;
+
+    bool at_end() const noexcept { return _pos >= _text.size(); }
+    char peek()   const noexcept { return _text[_pos]; }
+    void skip_spaces() noexcept { while( !at_end() && (peek() == ' ' || peek() == '\t') ) { ++_pos; } }
+
+    /// consumes `symbol` if it is next and isn't the start of a longer operator
+    bool accept(StringView symbol) {
+        skip_spaces();
+        if( !_text.substr(_pos).starts_with(symbol) ) { return false; }
+        const size_t end = _pos + symbol.size();
+        if( (symbol == "!" || symbol == "=" || symbol == "<" || symbol == ">") && end < _text.size() && (_text[end] == '=' || _text[end] == '~') ) { return false; }
+        if( _is_identifier(symbol.back()) && end < _text.size() && _is_identifier(_text[end]) ) { return false; }
+        _pos = end;
+        return true;
+    }
+
+    size_t emit(Op op, std::int64_t operand = 0, TensorQuery::Text text = TensorQuery::Text::NAME) {
+        switch( op ) {
+            case Op::CONSTANT: case Op::RANK: case Op::NUMEL: case Op::BYTES: case Op::OFFSET: case Op::DIM:
+            case Op::TEXT_EQ:  case Op::SHAPE_EQ: case Op::MATCH:
+                ++_depth; break;
+            case Op::NEG: case Op::NOT: case Op::BOOL:
+                break;
+            default: // binary operators, and the jumps that drop the value they test
+                --_depth; break;
+        }
+        _query._maxStack = std::max(_query._maxStack, _depth);
+        _query._code.push_back({ op, text, operand });
+        return _query._code.size() - 1;
+    }
+
+    void require_integer(const Operand& operand) {
+        if( operand.kind == Kind::INTEGER || !_error.empty() ) { return; }
+        _error = operand.kind == Kind::LITERAL
+               ? "a text can only be compared with name, dtype or shape"
+               : "name, dtype and shape can only be compared with ==, != or ~";
+    }
+    void require_condition(const Operand& operand) {
+        if( operand.kind != Kind::INTEGER && _error.empty() ) { _error = "a text is not a condition"; }
+    }
+
+    Operand parse_logical(bool isOr) {
+        Operand left = isOr ? parse_logical(false) : parse_not();
+        while( _error.empty() && (isOr ? (accept("||") || accept("or")) : (accept("&&") || accept("and"))) ) {
+            require_condition(left);
+            const size_t jump = emit(isOr ? Op::JUMP_IF_TRUE : Op::JUMP_IF_FALSE);
+            const Operand right = isOr ? parse_logical(false) : parse_not();
+            require_condition(right);
+            emit(Op::BOOL);
+            _query._code[jump].operand = static_cast<std::int64_t>(_query._code.size());
+            left = {};
+        }
+        return left;
+    }
+    Operand parse_or() { return parse_logical(true); }
+
+    Operand parse_not() {
+        if( accept("!") || accept("not") ) {
+            const Operand operand = parse_not();
+            require_condition(operand);
+            emit(Op::NOT);
+            return {};
+        }
+        return parse_comparison();
+    }
+
+    Operand parse_comparison() {
+        Operand left = parse_sum();
+        if( !_error.empty() ) { return left; }
+        static const std::pair<StringView, Op> Comparisons[] = {
+            {"==", Op::EQ}, {"!=", Op::NE}, {"<=", Op::LE}, {">=", Op::GE}, {"<", Op::LT}, {">", Op::GT}, {"=", Op::EQ}
+        };
+        const bool isMatch = accept("~") || accept("=~"), isNotMatch = !isMatch && accept("!~");
+        Op op = Op::MATCH;
+        if( !isMatch && !isNotMatch ) {
+            const auto* found = std::find_if(std::begin(Comparisons), std::end(Comparisons), [&](const auto& c) { return accept(c.first); });
+            if( found == std::end(Comparisons) ) { return left; }
+            op = found->second;
+        }
+        const Operand right = parse_sum();
+        if( !_error.empty() ) { return {}; }
+        if( left.kind == Kind::INTEGER && right.kind == Kind::INTEGER && op != Op::MATCH ) {
+            emit(op);
+            return {};
+        }
+        compile_text_comparison(left, right, op, isNotMatch);
+        return {};
+    }
+
+    /// `attribute op "literal"` (in either order), as a single instruction
+    void compile_text_comparison(Operand left, Operand right, Op op, bool negate) {
+        if( left.kind == Kind::LITERAL ) { std::swap(left, right); }
+        if( left.kind == Kind::INTEGER || left.kind == Kind::LITERAL || right.kind != Kind::LITERAL ) {
+            _error = right.kind == Kind::INTEGER || left.kind == Kind::INTEGER
+                   ? "a text can't be compared with a number"
+                   : "name, dtype and shape can only be compared with a text in quotes";
+            return;
+        }
+        const auto text = left.kind == Kind::DTYPE ? TensorQuery::Text::DTYPE : TensorQuery::Text::NAME;
+        if( op == Op::MATCH ) {
+            if( left.kind == Kind::SHAPE ) { _error = "shape can only be compared with == or != (e.g. shape == \"[4096,*]\")"; return; }
+            PatternSet pattern;
+            String error;
+            if( !pattern.add(right.text, error) ) { _error = error; return; }
+            _query._patterns.push_back( std::move(pattern) );
+            emit(Op::MATCH, static_cast<std::int64_t>(_query._patterns.size() - 1), text);
+        }
+        else if( op == Op::EQ || op == Op::NE ) {
+            if( left.kind == Kind::SHAPE ) {
+                std::vector<std::int64_t> shape;
+                if( !parse_shape(right.text, shape) ) { _error = "invalid shape \"" + right.text + "\", expected e.g. \"[4096,*]\""; return; }
+                _query._shapes.push_back( std::move(shape) );
+                emit(Op::SHAPE_EQ, static_cast<std::int64_t>(_query._shapes.size() - 1));
+            } else {
+                _query._texts.push_back(right.text);
+                emit(Op::TEXT_EQ, static_cast<std::int64_t>(_query._texts.size() - 1), text);
+            }
+            negate = op == Op::NE;
+        }
+        else { _error = "name, dtype and shape can only be compared with ==, != or ~"; return; }
+        if( negate ) { emit(Op::NOT); }
+    }
+
+    /// "[4096,*]" -> {4096,-1}
+    static bool parse_shape(StringView text, std::vector<std::int64_t>& shape) {
+        if( text.size() < 2 || text.front() != '[' || text.back() != ']' ) { return false; }
+        text = text.substr(1, text.size() - 2);
+        if( text.empty() ) { return true; }
+        for( size_t start = 0 ; ; ) {
+            const size_t end = std::min(text.find(',', start), text.size());
+            StringView item = text.substr(start, end - start);
+            while( !item.empty() && item.front() == ' ' ) { item.remove_prefix(1); }
+            while( !item.empty() && item.back()  == ' ' ) { item.remove_suffix(1); }
+            if( item == "*" ) { shape.push_back(-1); }
+            else {
+                if( item.empty() || !std::all_of(item.begin(), item.end(), _is_digit) ) { return false; }
+                shape.push_back( std::stoll(String{item}) );
+            }
+            start = end + 1;
+            if( end == text.size() ) { break; }
+        }
+        return true;
+    }
+
+    Operand parse_sum() {
+        Operand left = parse_term();
+        while( _error.empty() ) {
+            Op op;
+            if     ( accept("+") ) { op = Op::ADD; }
+            else if( accept("-") ) { op = Op::SUB; }
+            else { break; }
+            require_integer(left);
+            require_integer( parse_term() );
+            emit(op);
+            left = {};
+        }
+        return left;
+    }
+
+    Operand parse_term() {
+        Operand left = parse_unary();
+        while( _error.empty() ) {
+            Op op;
+            if     ( accept("*") ) { op = Op::MUL; }
+            else if( accept("/") ) { op = Op::DIV; }
+            else if( accept("%") ) { op = Op::MOD; }
+            else { break; }
+            require_integer(left);
+            require_integer( parse_unary() );
+            emit(op);
+            left = {};
+        }
+        return left;
+    }
+
+    Operand parse_unary() {
+        if( accept("-") ) {
+            require_integer( parse_unary() );
+            emit(Op::NEG);
+            return {};
+        }
+        return parse_primary();
+    }
+
+    Operand parse_primary() {
+        skip_spaces();
+        if( at_end() ) { _error = "unexpected end of the expression"; return {}; }
+        const char ch = peek();
+        if( accept("(") ) {
+            const Operand operand = parse_or();
+            if( _error.empty() && !accept(")") ) { _error = "expected ')'"; }
+            return operand;
+        }
+        if( _is_digit(ch) )              { parse_number(); return {}; }
+        if( ch == '"' || ch == '\'' )    { return parse_string(); }
+        if( !_is_identifier(ch) )        { _error = "unexpected '" + String(1, ch) + "'"; return {}; }
+
+        const size_t start = _pos;
+        while( !at_end() && _is_identifier(peek()) ) { ++_pos; }
+        const StringView word = _text.substr(start, _pos - start);
+        if( word == "name"   ) { return { Kind::NAME,  {} }; }
+        if( word == "dtype"  ) { return { Kind::DTYPE, {} }; }
+        if( word == "shape"  ) { return { Kind::SHAPE, {} }; }
+        if( word == "rank"   ) { emit(Op::RANK);   return {}; }
+        if( word == "numel"  ) { emit(Op::NUMEL);  return {}; }
+        if( word == "bytes"  ) { emit(Op::BYTES);  return {}; }
+        if( word == "offset" ) { emit(Op::OFFSET); return {}; }
+        if( word == "dims"   ) {
+            const bool bracket  = accept("[");
+            const bool negative = bracket && accept("-");
+            skip_spaces();
+            if( !bracket || at_end() || !_is_digit(peek()) ) { _error = "expected an index, e.g. dims[0] or dims[-1]"; return {}; }
+            // (no tensor has that many dimensions, and the index can't overflow)
+            static const std::int64_t MaxIndex = 64;
+            const size_t indexStart = _pos;
+            std::int64_t index = 0;
+            while( !at_end() && _is_digit(peek()) ) {
+                index = index * 10 + (peek() - '0'); ++_pos;
+                if( index > MaxIndex ) { _pos = indexStart; _error = "invalid index, dims[i] accepts up to 64 dimensions"; return {}; }
+            }
+            if( !accept("]") ) { _error = "expected ']'"; return {}; }
+            emit(Op::DIM, negative ? -index : index);
+            return {};
+        }
+        _pos = start;
+        _error = "unknown attribute '" + String{word} + "' (use name, dtype, shape, rank, numel, bytes, offset or dims[i])";
+        return {};
+    }
+
+    /// integer or decimal number with an optional unit, e.g. "16MB", "1.5 GiB"
+    void parse_number() {
+        static const std::pair<StringView, double> Units[] = {
+            {"KB", 1e3}, {"MB", 1e6}, {"GB", 1e9}, {"TB", 1e12},
+            {"KIB", 1024.0}, {"MIB", 1048576.0}, {"GIB", 1073741824.0}, {"TIB", 1099511627776.0}
+        };
+        const size_t start = _pos;
+        while( !at_end() && (_is_digit(peek()) || peek() == '.') ) { ++_pos; }
+        const String number{ _text.substr(start, _pos - start) };
+        double value = 0;
+        try { value = std::stod(number); } catch( ... ) { _pos = start; _error = "invalid number"; return; }
+        const size_t beforeUnit = _pos;
+        skip_spaces();
+        const size_t unitStart = _pos;
+        while( !at_end() && _is_identifier(peek()) ) { ++_pos; }
+        if( _pos > unitStart ) {
+            String unit;
+            for( const char ch : _text.substr(unitStart, _pos - unitStart) ) { unit += _to_upper(ch); }
+            const auto* found = std::find_if(std::begin(Units), std::end(Units), [&](const auto& u) { return u.first == unit; });
+            if( found == std::end(Units) ) {
+                // not a unit: it belongs to what follows ("1 and ...")
+                if( unit != "AND" && unit != "OR" ) { _pos = unitStart; _error = "unknown unit '" + unit + "' (use KB, MB, GB, TB, KiB, MiB, GiB or TiB)"; return; }
+                _pos = beforeUnit;
+            }
+            else { value *= found->second; }
+        }
+        else { _pos = beforeUnit; }
+        if( number.find('.') != String::npos && value != std::floor(value) && _pos == beforeUnit ) {
+            _pos = start;
+            _error = "the attributes are integers, a decimal number needs a unit";
+            return;
+        }
+        // (2^63 is exact as a double, anything from it up doesn't fit in an int64)
+        static const double MaxValue = 9223372036854775808.0;
+        if( !std::isfinite(value) || value >= MaxValue ) {
+            _pos = start;
+            _error = "number out of range, the attributes are 64-bit integers";
+            return;
+        }
+        emit(Op::CONSTANT, static_cast<std::int64_t>(std::llround(value)));
+    }
+
+    Operand parse_string() {
+        const char quote = peek();
+        String text;
+        for( ++_pos ; !at_end() && peek() != quote ; ++_pos ) {
+            if( peek() == '\\' && _pos + 1 < _text.size() ) { ++_pos; }
+            text += peek();
+        }
+        if( at_end() ) { _error = "unterminated text"; return {}; }
+        ++_pos;
+        return { Kind::LITERAL, std::move(text) };
+    }
+};
+
+//============================== COMPILATION ==============================//
+
+/**
+ * Compiles `expression`, replacing any previous one.
+ * @param expression The condition, e.g. `dtype == "F32" && rank == 2`.
+ * @param error      Set to a description of the problem if it can't be compiled.
+ * @return true if the expression was compiled.
+ */
+bool
+TensorQuery::compile(StringView expression, String& error) {
+    _code.clear();
+    _texts.clear();
+    _shapes.clear();
+    _patterns.clear();
+    _maxStack = 0;
+    QueryParser parser{ *this, expression };
+    if( !parser.parse(error) ) { _code.clear(); return false; }
+    return true;
+}
+
+//=============================== EVALUATION ==============================//
+
+/**
+ * Keeps only the tensors selected in `inventory` for which the expression
+ * holds; the inventory is evaluated in chunks on several threads.
+ * @param inventory       The tensors to filter.
+ * @param numberOfThreads Threads used to evaluate the tensors (0 = default).
+ */
+void
+TensorQuery::select(TensorInventory& inventory, unsigned numberOfThreads) const {
+    static const size_t ChunkSize = 64 * 1024;
+    if( empty() ) { return; }
+    const auto entries = inventory.entries();
+    std::vector<std::uint8_t> keep(entries.size());
+    parallel_for((entries.size() + ChunkSize - 1) / ChunkSize, numberOfThreads, [&](size_t chunk) {
+        // the patterns build their DFA while matching, so each chunk uses a copy
+        std::vector<PatternSet>   patterns = _patterns;
+        std::vector<std::int64_t> stack(_maxStack + 1);
+        const size_t end = std::min(entries.size(), (chunk + 1) * ChunkSize);
+        for( size_t i = chunk * ChunkSize ; i < end ; ++i ) {
+            keep[i] = _evaluate(entries[i], stack.data(), patterns);
+        }
+    });
+    inventory.retain(keep);
+}
+
+/**
+ * Runs the bytecode for one tensor and returns true if the result isn't 0.
+ * The arithmetic wraps around instead of overflowing, and a division by 0
+ * gives 0.
+ */
+bool
+TensorQuery::_evaluate(const TensorInventory::Entry& entry, std::int64_t* stack, std::vector<PatternSet>& patterns) const {
+    static const std::int64_t Min = std::numeric_limits<std::int64_t>::min();
+    auto wrap = [](std::uint64_t value) { return static_cast<std::int64_t>(value); };
+    size_t top = 0;
+    auto binary = [&](auto operation) { --top; stack[top-1] = operation(stack[top-1], stack[top]); };
+    for( size_t pc = 0 ; pc < _code.size() ; ++pc ) {
+        const Instruction& instruction = _code[pc];
+        switch( instruction.op ) {
+            case Op::CONSTANT: stack[top++] = instruction.operand; break;
+            case Op::RANK:     stack[top++] = static_cast<std::int64_t>(entry.dims->size()); break;
+            case Op::NUMEL:    stack[top++] = static_cast<std::int64_t>(entry.elements()); break;
+            case Op::BYTES:    stack[top++] = static_cast<std::int64_t>(entry.size); break;
+            case Op::OFFSET:   stack[top++] = static_cast<std::int64_t>(entry.offset); break;
+            case Op::DIM: {
+                const auto rank  = static_cast<std::int64_t>(entry.dims->size());
+                const auto index = instruction.operand < 0 ? rank + instruction.operand : instruction.operand;
+                const bool valid = index >= 0 && index < rank;
+                stack[top++] = !valid ? 0 : static_cast<std::int64_t>( (*entry.dims)[static_cast<size_t>(entry.ggmlOrder ? rank - 1 - index : index)] );
+                break;
+            }
+            case Op::ADD: binary([&](auto x, auto y) { return wrap(static_cast<std::uint64_t>(x) + static_cast<std::uint64_t>(y)); }); break;
+            case Op::SUB: binary([&](auto x, auto y) { return wrap(static_cast<std::uint64_t>(x) - static_cast<std::uint64_t>(y)); }); break;
+            case Op::MUL: binary([&](auto x, auto y) { return wrap(static_cast<std::uint64_t>(x) * static_cast<std::uint64_t>(y)); }); break;
+            case Op::DIV: binary([](auto x, auto y) { return (y == 0 || (y == -1 && x == Min)) ? 0 : x / y; }); break;
+            case Op::MOD: binary([](auto x, auto y) { return (y == 0 || y == -1) ? 0 : x % y; }); break;
+            case Op::NEG: stack[top-1] = wrap(0 - static_cast<std::uint64_t>(stack[top-1])); break;
+            case Op::EQ:  binary([](auto x, auto y) { return std::int64_t{x == y}; }); break;
+            case Op::NE:  binary([](auto x, auto y) { return std::int64_t{x != y}; }); break;
+            case Op::LT:  binary([](auto x, auto y) { return std::int64_t{x <  y}; }); break;
+            case Op::LE:  binary([](auto x, auto y) { return std::int64_t{x <= y}; }); break;
+            case Op::GT:  binary([](auto x, auto y) { return std::int64_t{x >  y}; }); break;
+            case Op::GE:  binary([](auto x, auto y) { return std::int64_t{x >= y}; }); break;
+            case Op::NOT:  stack[top-1] = stack[top-1] == 0; break;
+            case Op::BOOL: stack[top-1] = stack[top-1] != 0; break;
+            case Op::JUMP_IF_FALSE:
+                if( stack[top-1] == 0 ) { pc = static_cast<size_t>(instruction.operand) - 1; } else { --top; }
+                break;
+            case Op::JUMP_IF_TRUE:
+                if( stack[top-1] != 0 ) { stack[top-1] = 1; pc = static_cast<size_t>(instruction.operand) - 1; } else { --top; }
+                break;
+            case Op::TEXT_EQ: {
+                const auto& text = _texts[static_cast<size_t>(instruction.operand)];
+                stack[top++] = instruction.text == Text::DTYPE ? _equal_ignoring_case(entry.dtype, text) : entry.name == text;
+                break;
+            }
+            case Op::SHAPE_EQ: {
+                const auto& shape = _shapes[static_cast<size_t>(instruction.operand)];
+                const size_t rank = entry.dims->size();
+                bool equal = shape.size() == rank;
+                for( size_t k = 0 ; equal && k < rank ; ++k ) {
+                    const auto size = static_cast<std::int64_t>( (*entry.dims)[entry.ggmlOrder ? rank - 1 - k : k] );
+                    equal = shape[k] < 0 || shape[k] == size;
+                }
+                stack[top++] = equal;
+                break;
+            }
+            case Op::MATCH:
+                stack[top++] = patterns[static_cast<size_t>(instruction.operand)].matches(instruction.text == Text::DTYPE ? entry.dtype : entry.name);
+                break;
+        }
+    }
+    return stack[0] != 0;
+}
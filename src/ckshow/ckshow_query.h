@@ -0,0 +1,94 @@
+/*
+| File    : ckshow_query.h
+| Purpose : The `--where` expressions over the attributes of the tensors.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 16, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKSHOW_QUERY_H_
+#define CKSHOW_QUERY_H_
+#include <cstdint>            // for std::int64_t, std::uint8_t
+#include <vector>             // for std::vector
+#include "common.h"
+#include "patternset.h"       // for PatternSet
+#include "ckshow_inventory.h" // for TensorInventory
+
+
+/**
+ * A condition on the attributes of a tensor, e.g.
+ * `dtype == "f32" && bytes > 16MB && rank == 2 && name ~ "model.layers.*.mlp.*"`.
+ *
+ * Attributes:
+ *   - name, dtype        text; compared with `==`/`!=` (dtype ignoring case)
+ *                        or matched with `~`/`!~` against a glob or a /regex/
+ *   - shape              compared with `==`/`!=` to a text like "[4096,*]"
+ *   - rank, numel, bytes, offset, dims[i]
+ *                        integers (dims[-1] is the last dimension, and a
+ *                        missing dimension is 0)
+ *
+ * Integers support `+ - * / %` and the comparisons `== != < <= > >=`, and
+ * may carry a unit (KB MB GB TB, KiB MiB GiB TiB). Conditions combine with
+ * `&&`/`and`, `||`/`or`, `!`/`not` and parentheses.
+ *
+ * The expression is parsed once and compiled to a flat bytecode for a
+ * small stack machine; the texts, shapes and patterns it compares with are
+ * prepared at compile time, so evaluating a tensor allocates nothing.
+ * `select()` evaluates the tensors of an inventory in chunks on several
+ * threads.
+ *
+ * Example usage:
+ * @code{.cpp}
+ * TensorQuery query;
+ * String error;
+ * if( !query.compile(R"(dtype == "F32" && bytes > 16MB)", error) ) { std::cerr << error; }
+ * query.select(inventory);
+ * @endcode
+ */
+class TensorQuery
+{
+public:
+    enum class Op : std::uint8_t {
+        CONSTANT, RANK, NUMEL, BYTES, OFFSET, DIM,   ///< push a value
+        ADD, SUB, MUL, DIV, MOD, NEG,
+        EQ, NE, LT, LE, GT, GE,
+        NOT, BOOL,      ///< `!x`, and `x != 0`
+        JUMP_IF_FALSE,  ///< jumps keeping the value if it is 0, otherwise drops it
+        JUMP_IF_TRUE,   ///< jumps leaving 1 if the value isn't 0, otherwise drops it
+        TEXT_EQ,        ///< pushes whether a text attribute equals `texts[operand]`
+        SHAPE_EQ,       ///< pushes whether the shape matches `shapes[operand]`
+        MATCH           ///< pushes whether a text attribute matches `patterns[operand]`
+    };
+    enum class Text : std::uint8_t { NAME, DTYPE };
+    struct Instruction {
+        Op           op;
+        Text         text = Text::NAME;  ///< attribute of TEXT_EQ and MATCH
+        std::int64_t operand = 0;
+    };
+
+// COMPILATION
+public:
+    bool compile(StringView expression, String& error);
+    [[nodiscard]] bool empty() const noexcept { return _code.empty(); }
+
+// EVALUATION
+public:
+    void select(TensorInventory& inventory, unsigned numberOfThreads = 0) const;
+
+// IMPLEMENTATION
+private:
+    friend class QueryParser;
+    bool _evaluate(const TensorInventory::Entry& entry, std::int64_t* stack, std::vector<PatternSet>& patterns) const;
+private:
+    std::vector<Instruction>               _code;
+    std::vector<String>                    _texts;     ///< texts compared with TEXT_EQ
+    std::vector<std::vector<std::int64_t>> _shapes;    ///< shapes compared with SHAPE_EQ (-1 = any size)
+    std::vector<PatternSet>                _patterns;  ///< patterns of MATCH, copied by each thread
+    size_t                                 _maxStack = 0;
+};
+
+#endif // CKSHOW_QUERY_H_
@@ -0,0 +1,377 @@
+/*
+| File    : ckskeletonize.cpp
+| Purpose : The `ckskeletonize` command line tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 4, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm>     // for std::min, std::sort
+#include <filesystem>    // for std::filesystem::path
+#include <unordered_set> // for std::unordered_set
+#include <tin/tensormap.h>
+#include "table.h"
+#include "colors.h"
+#include "messages.h"
+#include "file.h"
+#include "gguf.h"
+#include "safetensors.h"
+#include "parallel.h"
+#include "synthetic.h"
+#include "ckskeletonize.h"
+#ifdef _WIN32
+    inline bool is_terminal_output() { return true; }
+#else
+#include <unistd.h>   // for "::isatty()" and STDOUT_FILENO
+#include <sys/stat.h> // for "::stat()"
+    inline bool is_terminal_output() { return ::isatty(STDOUT_FILENO) != 0; }
+#endif
+using namespace tin;
+namespace fs = std::filesystem;
+
+/// Companion files larger than this are not copied (they are not configuration files).
+static constexpr std::uint64_t MaxCompanionSize = 64 * 1024 * 1024;
+
+
+//============================= CONSTRUCTION ==============================//
+
+CkSkeletonize::CkSkeletonize(const CkSkeletonizeArgs& args)
+: _args(args)
+{}
+
+//================================ HELPERS ================================//
+
+void
+CkSkeletonize::print_help() const noexcept {
+    std::cout << _args.help_message  << std::endl;
+}
+
+void
+CkSkeletonize::print_version() const noexcept {
+    std::cout << "ckskeletonize (CheckpointTools ckskeletonize) " << PROJECT_VERSION << std::endl;
+}
+
+/**
+ * Returns true if the file extension is one of the supported checkpoint formats.
+ */
+bool
+CkSkeletonize::is_checkpoint_file(const String& path) {
+    return path.ends_with(".safetensors") || path.ends_with(".gguf");
+}
+
+/**
+ * Returns true if the file is a small file that loaders expect next to the
+ * checkpoint (config.json, model.safetensors.index.json, tokenizer files...).
+ * These files are copied as is when a whole directory is skeletonized.
+ */
+bool
+CkSkeletonize::is_companion_file(const String& path) {
+    return path.ends_with(".json") || path.ends_with(".txt") || path.ends_with(".model");
+}
+
+/**
+ * Checks that a skeleton describes exactly the same tensors and metadata as
+ * the original file when both are loaded through TensorMap.
+ *
+ * @return An empty string on success, otherwise a description of the first difference.
+ */
+String
+CkSkeletonize::verify_skeleton(const String& original, const String& skeleton) {
+    ReadError readError = ReadError::None;
+    auto originalMap = TensorMap::from_file(original, readError);
+    if( readError != ReadError::None ) { return String{ Messages::read_error_description(readError) }; }
+    auto skeletonMap = TensorMap::from_file(skeleton, readError);
+    if( readError != ReadError::None ) { return "skeleton: " + String{ Messages::read_error_description(readError) }; }
+
+    auto originalTensors = originalMap.collect_tensors(SortBy::NAME);
+    auto skeletonTensors = skeletonMap.collect_tensors(SortBy::NAME);
+    if( originalTensors.size() != skeletonTensors.size() ) {
+        return "skeleton has " + std::to_string(skeletonTensors.size()) + " tensors, expected " + std::to_string(originalTensors.size());
+    }
+    for( size_t i=0 ; i<originalTensors.size() ; ++i ) {
+        const auto& a = originalTensors[i];
+        const auto& b = skeletonTensors[i];
+        if( a.name()                != b.name()                ||
+            a.shape().to_string()   != b.shape().to_string()   ||
+            a.dtype().to_string()   != b.dtype().to_string()   )
+        {
+            return "tensor '" + String{ a.name() } + "' differs in the skeleton";
+        }
+    }
+    for( const auto& [key, variant] : originalMap.metadata() ) {
+        if( skeletonMap.metadata().get(key).as_string() != variant.as_string() ) {
+            return "metadata '" + String{ key } + "' differs in the skeleton";
+        }
+    }
+    return {};
+}
+
+/**
+ * Returns the number of bytes actually allocated on disk by a file.
+ *
+ * For a skeleton this is only the header (rounded to the filesystem block
+ * size), no matter how large the logical size of the file is.
+ */
+std::uint64_t
+CkSkeletonize::allocated_size(const String& path) {
+#ifdef _WIN32
+    std::error_code errorCode;
+    auto size = fs::file_size(path, errorCode);
+    return errorCode ? 0 : static_cast<std::uint64_t>(size);
+#else
+    struct stat info;
+    if( ::stat(path.c_str(), &info) != 0 ) { return 0; }
+    return static_cast<std::uint64_t>(info.st_blocks) * 512;
+#endif
+}
+
+//================================= STEPS =================================//
+
+/**
+ * Builds the list of files to process from the inputs provided by the user.
+ *
+ * Directories are scanned recursively and their structure is reproduced in
+ * the output directory. When a single file is provided and the output path
+ * looks like a checkpoint file, it is used as the output filename.
+ */
+std::vector<CkSkeletonize::Job>
+CkSkeletonize::collect_jobs() const {
+    std::vector<Job> jobs;
+    const fs::path outputDir{ _args.output };
+
+    // single file -> explicit output filename
+    if( _args.inputs.size() == 1 && fs::is_regular_file(_args.inputs[0]) &&
+        is_checkpoint_file(_args.output) && !fs::is_directory(_args.output) )
+    {
+        jobs.push_back({ _args.inputs[0], _args.output, true });
+    }
+    else for( const auto& input : _args.inputs ) {
+        if( fs::is_directory(input) ) {
+            std::vector<Job> dirJobs;
+            std::error_code errorCode;
+            for( const auto& entry : fs::recursive_directory_iterator(input, fs::directory_options::skip_permission_denied, errorCode) ) {
+                if( !entry.is_regular_file() ) { continue; }
+                const String path = entry.path().string();
+                const String relative = fs::relative(entry.path(), input).string();
+                if( is_checkpoint_file(path) ) {
+                    dirJobs.push_back({ path, (outputDir / relative).string(), true });
+                }
+                else if( is_companion_file(path) && entry.file_size() <= MaxCompanionSize ) {
+                    dirJobs.push_back({ path, (outputDir / relative).string(), false });
+                }
+            }
+            if( errorCode ) {
+                Messages::fatal_error("Unable to scan the directory.", { "Directory: " + input });
+            }
+            // directory iteration order is unspecified, keep the report stable
+            std::sort(dirJobs.begin(), dirJobs.end(), [](const Job& a, const Job& b) { return a.input < b.input; });
+            jobs.insert(jobs.end(), dirJobs.begin(), dirJobs.end());
+        }
+        else if( fs::is_regular_file(input) ) {
+            jobs.push_back({ input, (outputDir / fs::path(input).filename()).string(), true });
+        }
+        else {
+            Messages::fatal_read_error(ReadError::FileNotFound, input);
+        }
+    }
+
+    // two inputs can't be written to the same output,
+    // and an input must never be replaced by its own skeleton
+    std::unordered_set<String> outputs;
+    for( const auto& job : jobs ) {
+        if( !outputs.insert( fs::weakly_canonical(job.output).string() ).second ) {
+            Messages::fatal_error("More than one input would be written to the same output file.", { "File: " + job.output });
+        }
+        std::error_code errorCode;
+        if( fs::equivalent(job.input, job.output, errorCode) ) {
+            Messages::fatal_error("The output file is the input file itself.", {
+                "File: " + job.input,
+                "Use --output to write the skeletons to a different directory." });
+        }
+    }
+    return jobs;
+}
+
+/**
+ * Processes one file, never aborting the program.
+ *
+ * Any problem is reported in the returned result, so a damaged file in a
+ * directory doesn't prevent the rest of the files from being processed.
+ */
+CkSkeletonize::Result
+CkSkeletonize::process(const Job& job) const {
+    if( !_args.force && fs::exists(job.output) ) {
+        return { "output file already exists (use --force to overwrite it)", 0, 0, 0 };
+    }
+    std::error_code errorCode;
+    auto parent = fs::path(job.output).parent_path();
+    if( !parent.empty() ) { fs::create_directories(parent, errorCode); }
+
+    auto result = job.isCheckpoint ? _skeletonize(job) : _copy(job);
+    if( result.error.empty() ) { result.allocatedSize = allocated_size(job.output); }
+    return result;
+}
+
+/**
+ * Writes the skeleton of a checkpoint file.
+ *
+ * The header (everything before the data section, including the alignment
+ * padding of GGUF files) is copied byte for byte and the file is then
+ * extended to the original size without writing anything else. Extending a
+ * file with ftruncate leaves a hole that reads back as zeros and takes no
+ * space on filesystems with sparse file support. With --fill, the tensors
+ * are then written with synthetic values.
+ */
+CkSkeletonize::Result
+CkSkeletonize::_skeletonize(const Job& job) const {
+    Result result;
+    ReadError readError;
+
+    const SyntheticFill synthetic{ _args.fill, static_cast<std::uint64_t>(_args.seed), _args.mean, _args.std,
+                                   static_cast<unsigned>(std::max(_args.threads, 0)) };
+    SyntheticFill::Tensors tensors;
+    std::uint64_t dataOffset = 0;
+    if( GgufFile::is_gguf_file(job.input) ) {
+        auto gguf = GgufFile::from_file(job.input, readError);
+        dataOffset = gguf.data_offset();
+        tensors    = synthetic.tensors_of(gguf);
+    } else {
+        auto safetensors = SafetensorsFile::from_file(job.input, readError);
+        dataOffset = safetensors.data_offset();
+        tensors    = synthetic.tensors_of(safetensors);
+    }
+    if( readError != ReadError::None ) { result.error = Messages::read_error_description(readError); return result; }
+
+    File input;
+    if( !input.open_read(job.input) ) { result.error = "unable to open the file"; return result; }
+    result.fileSize   = input.size();
+    result.headerSize = std::min(dataOffset, result.fileSize);
+
+    String header(result.headerSize, '\0');
+    if( !input.read_at(header.data(), header.size(), 0) ) { result.error = "unable to read the header"; return result; }
+    if( _args.fill == SyntheticFill::Mode::STATS && !synthetic.measure(input, tensors) ) {
+        result.error = "unable to read the tensor data";
+        return result;
+    }
+    input.close();
+
+    // write to a temporary name so an interrupted run never leaves a truncated skeleton
+    const String partPath = job.output + ".part";
+    File output;
+    if( !output.create(partPath)                                 ||
+        !output.write_at(header.data(), header.size(), 0)        ||
+        !output.resize(result.fileSize)                          ||
+        !synthetic.fill(output, tensors)                         ||
+        !output.sync() )
+    {
+        result.error = "unable to write " + partPath;
+        return result;
+    }
+    output.close();
+    std::error_code errorCode;
+    fs::rename(partPath, job.output, errorCode);
+    if( errorCode ) { result.error = "unable to rename " + partPath; return result; }
+
+    if( _args.verify ) {
+        result.error = verify_skeleton(job.input, job.output);
+    }
+    return result;
+}
+
+/**
+ * Copies a companion file (config, index, tokenizer...) as is.
+ */
+CkSkeletonize::Result
+CkSkeletonize::_copy(const Job& job) const {
+    Result result;
+    std::error_code errorCode;
+    fs::copy_file(job.input, job.output, fs::copy_options::overwrite_existing, errorCode);
+    if( errorCode ) { result.error = "unable to copy the file"; return result; }
+    result.fileSize   = fs::file_size(job.output, errorCode);
+    result.headerSize = result.fileSize;
+    return result;
+}
+
+/**
+ * Prints one line per processed file with its logical and on-disk sizes,
+ * followed by a summary.
+ */
+void
+CkSkeletonize::print_report(const std::vector<Job>& jobs, const std::vector<Result>& results) const {
+    using Align = Table::Align;
+    auto& c = Colors::instance();
+
+    Table table;
+    table.set_alignments({Align::LEFT, Align::RIGHT, Align::RIGHT, Align::LEFT});
+    table.set_styles({ {c.primary(), c.reset()}, {c.data(), c.reset()}, {c.data2(), c.reset()}, {c.info(), c.reset()} });
+
+    std::uint64_t logicalSize = 0, allocatedSize = 0;
+    size_t numberOfErrors = 0;
+    for( size_t i=0 ; i<jobs.size() ; ++i ) {
+        const auto& result = results[i];
+        if( !result.error.empty() ) { ++numberOfErrors; continue; }
+        logicalSize   += result.fileSize;
+        allocatedSize += result.allocatedSize;
+        table.add_row({ jobs[i].output, to_human_size(result.fileSize), to_human_size(result.allocatedSize),
+                        !jobs[i].isCheckpoint ? "copy" : _args.fill == SyntheticFill::Mode::ZEROS ? "skeleton" : "synthetic" });
+    }
+    std::cout << table;
+
+    // errors are reported after the table, in the same order as the inputs
+    for( size_t i=0 ; i<jobs.size() ; ++i ) {
+        if( !results[i].error.empty() ) { Messages::error(jobs[i].input + ": " + results[i].error); }
+    }
+
+    std::cout << std::endl
+              << c.info() << "Files     : " << c.reset() << (jobs.size() - numberOfErrors) << " written";
+    if( numberOfErrors > 0 ) { std::cout << ", " << c.error() << numberOfErrors << " failed" << c.reset(); }
+    std::cout << std::endl
+              << c.info() << "Size      : " << c.reset() << to_human_size(logicalSize)
+              << " (" << to_human_size(allocatedSize) << " on disk)" << std::endl;
+}
+
+//================================ RUNNING ================================//
+
+int
+CkSkeletonize::run() {
+
+    // if the color option is set to "auto", disable colors when outputting to a non-terminal
+    if( _args.when_color == "auto" || _args.when_color == "tty" || _args.when_color == "if-tty" ) {
+        if( !is_terminal_output() ) { Colors::instance().disable_colors(); }
+    }
+    // if the color option is set to "never", disable colors regardless of output type
+    else if ( _args.when_color == "never" || _args.when_color == "no" || _args.when_color == "none") {
+        Colors::instance().disable_colors();
+    }
+
+    // if help was requested, show the help message and exit
+    if( _args.help ) { print_help(); return 0; }
+
+    // if version was requested, show the version and exit
+    if( _args.version ) { print_version(); return 0; }
+
+    // if the user didn't provide any file, show an error message and exit
+    if( _args.inputs.empty() ) {
+        Messages::fatal_error("No file provided. Please specify one or more .safetensors/.gguf files or directories.", {
+            "To get help on how to use this tool, run: ckskeletonize --help"
+        });
+    }
+
+    auto jobs = collect_jobs();
+    if( jobs.empty() ) { Messages::fatal_error("No .safetensors or .gguf file found."); }
+
+    // every file is independent, results are stored by index to keep the report ordered
+    // (when filling, the threads are used inside each file instead)
+    const unsigned fileThreads = _args.fill == SyntheticFill::Mode::ZEROS ? static_cast<unsigned>(std::max(_args.threads, 0)) : 1;
+    std::vector<Result> results(jobs.size());
+    parallel_for(jobs.size(), fileThreads, [&](size_t i) {
+        results[i] = process(jobs[i]);
+    });
+
+    print_report(jobs, results);
+    const bool anyError = std::any_of(results.begin(), results.end(), [](const Result& r) { return !r.error.empty(); });
+    return anyError ? 1 : 0;
+}
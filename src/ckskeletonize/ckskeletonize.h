@@ -0,0 +1,67 @@
+/*
+| File    : ckskeletonize.h
+| Purpose : The `ckskeletonize` command line tool.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 4, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKSKELETONIZE_H_
+#define CKSKELETONIZE_H_
+#include <cstdint>
+#include <vector>
+#include "common.h"
+#include "ckskeletonize_args.h"  // for CkSkeletonizeArgs
+
+
+class CkSkeletonize
+{
+public:
+    /// One file to process.
+    struct Job {
+        String input;
+        String output;
+        bool   isCheckpoint = true; ///< false = small companion file (config, index...) copied as is
+    };
+
+    /// The outcome of processing one file.
+    struct Result {
+        String        error;             ///< empty when the file was processed successfully
+        std::uint64_t fileSize      = 0; ///< logical size of the output file
+        std::uint64_t headerSize    = 0; ///< bytes copied from the original file
+        std::uint64_t allocatedSize = 0; ///< bytes actually allocated on disk by the output file
+    };
+
+// MAIN
+public:
+    CkSkeletonize(const CkSkeletonizeArgs& args);
+    [[nodiscard]] int run();
+
+// STEPS
+public:
+    [[nodiscard]] std::vector<Job> collect_jobs() const;
+    [[nodiscard]] Result           process(const Job& job) const;
+    void print_report(const std::vector<Job>& jobs, const std::vector<Result>& results) const;
+
+// HELPERS
+public:
+    [[nodiscard]] static bool          is_checkpoint_file(const String& path);
+    [[nodiscard]] static bool          is_companion_file(const String& path);
+    [[nodiscard]] static String        verify_skeleton(const String& original, const String& skeleton);
+    [[nodiscard]] static std::uint64_t allocated_size(const String& path);
+    void print_help() const noexcept;
+    void print_version() const noexcept;
+
+// IMPLEMENTATION
+private:
+    [[nodiscard]] Result _skeletonize(const Job& job) const;
+    [[nodiscard]] Result _copy(const Job& job) const;
+private:
+    const CkSkeletonizeArgs _args;
+};
+
+#endif // CKSKELETONIZE_H_
@@ -0,0 +1,121 @@
+/*
+| File    : ckskeletonize_args.cpp
+| Purpose : The arguments of the `ckskeletonize` command line
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 4, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <string>   // for std::string
+#include "common.h"
+#include "ckskeletonize_args.h"
+#include "argument.h"
+#include "messages.h"
+
+
+//================================ HELPERS ================================//
+
+static SyntheticFill::Mode
+_parse_fill_mode(const String& mode) {
+    if( mode == "zeros"  ) { return SyntheticFill::Mode::ZEROS;  }
+    if( mode == "normal" ) { return SyntheticFill::Mode::NORMAL; }
+    if( mode == "stats"  ) { return SyntheticFill::Mode::STATS;  }
+    Messages::fatal_error("Unknown fill mode: '" + mode + "'.", {
+        "Valid modes are 'zeros', 'normal' and 'stats'." });
+}
+
+//============================= CONSTRUCTION ==============================//
+
+/**
+ * Constructs a new CkSkeletonizeArgs object by parsing command line arguments.
+ *
+ * @param argc The number of command line arguments passed to the program.
+ * @param argv An array of C strings representing the command line arguments.
+ */
+CkSkeletonizeArgs::CkSkeletonizeArgs(int argc, char* argv[])
+: help_message{R"(
+Usage: ckskeletonize [OPTIONS] file_or_dir...
+
+  Creates skeleton copies of .safetensors and .gguf checkpoints. A skeleton
+  keeps the exact header and metadata of the original file and has the same
+  size, but its data section is a sparse hole that reads back as zeros, so a
+  70 GB model becomes a file of a few KB on disk that still passes header
+  parsing. Directories are scanned recursively and all files are processed
+  in parallel; the directory structure is reproduced in the output.
+
+  With --fill, the tensors are filled with deterministic pseudo-random
+  values instead, matched to the dtype of each tensor. The same seed always
+  produces the same values, no matter the number of threads. Quantized GGUF
+  tensors are left as zeros.
+
+  OPTIONS:
+    -o, --output <PATH>    Output directory (default: current directory), or the
+                           output file when a single file is skeletonized
+    -t, --threads <N>      Number of files processed at the same time (default: one per core)
+    --no-verify            Don't check that each skeleton round-trips through TensorMap
+
+    --fill <MODE>          How the data section is filled:
+                             zeros  : left as a sparse hole (default)
+                             normal : normal distribution given by --mean and --std
+                             stats  : per-tensor mean and std of the original file
+    --mean <X>             Mean of the values in 'normal' mode (default: 0.0)
+    --std <X>              Standard deviation of the values in 'normal' mode (default: 0.02)
+    --seed <N>             Seed of the pseudo-random values (default: 0)
+    -f, --force            Overwrite existing output files
+
+    --nc, --no-color       Disable color output.
+    -h  , --help           Show this help message and exit.
+    -v  , --version        Show version information and exit.
+
+  Examples:
+    ckskeletonize -o skeletons/ 'model.safetensors'
+    ckskeletonize -o skeletons/ ~/models/
+    ckskeletonize --fill stats -o fixtures/ 'model.safetensors'
+)"}
+{
+    for( int i=1 ; i < argc ; ++i )
+    {
+        auto arg = Argument{i, argc, argv};
+
+        // parse the options
+        if( arg.is_option() ) {
+        //-OUTPUT:
+            if     (arg.is( "-o", "--output"     )) { output  = arg.value(i); }
+            else if(arg.is( "-t", "--threads"    )) { threads = to_integer(arg.value(i)); }
+            else if(arg.is(       "--no-verify"  )) { verify  = false; }
+            else if(arg.is( "-f", "--force"      )) { force   = true;  }
+        //-FILL:
+            else if(arg.is(       "--fill"       )) { fill    = _parse_fill_mode(arg.value(i)); }
+            else if(arg.is(       "--mean"       )) { mean    = to_double(arg.value(i)); }
+            else if(arg.is(       "--std"        )) { std     = to_double(arg.value(i), -1.0); }
+            else if(arg.is(       "--seed"       )) { seed    = to_integer(arg.value(i)); }
+        //-EXTRA:
+            else if(arg.is( "-h", "--help"       )) { help = true; }
+            else if(arg.is( "-v", "--version"    )) { version = true; }
+            else if(arg.is( "--color"            )) { when_color = arg.value(i);  }
+            else if(arg.is( "--nc", "--no-color" )) { when_color = "never"; }
+            else {
+                // if an unknown argument is encountered, display a fatal error message
+                Messages::fatal_error( "Unknown argument: " + arg.name(), {
+                    "Try `ckskeletonize --help` for more information." });
+            }
+            // check if the user provided a value that was not consumed by the option
+            if( arg.has_value() && !arg.was_value_consumed() ) {
+                Messages::fatal_error( "The argument '"+ arg.name() +"' no expects a value and '"+ arg.value(i) +"' was provided.", {
+                    "Try `ckskeletonize --help` for more information." });
+            }
+        }
+        // handle positional arguments, arguments without a preceding hyphen
+        // (every positional argument is an input file or directory)
+        else {
+            inputs.push_back( arg.name() );
+        }
+    }
+
+    if( std < 0.0 ) {
+        Messages::fatal_error("The standard deviation must be a non-negative number.");
+    }
+}
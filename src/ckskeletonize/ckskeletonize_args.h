@@ -0,0 +1,73 @@
+/*
+| File    : ckskeletonize_args.h
+| Purpose : The arguments of the `ckskeletonize` command line
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 4, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef CKSKELETONIZE_ARGS_H_
+#define CKSKELETONIZE_ARGS_H_
+#include <iostream>
+#include <vector>
+#include "common.h"
+#include "synthetic.h"  // for SyntheticFill::Mode
+
+
+struct CkSkeletonizeArgs
+{
+// CONSTRUCTION/DESTRUCTION
+public:
+    CkSkeletonizeArgs(int argc, char* argv[]);
+    CkSkeletonizeArgs() = default;
+    CkSkeletonizeArgs(const CkSkeletonizeArgs&) = default;
+    CkSkeletonizeArgs(CkSkeletonizeArgs&&) noexcept = default;
+    ~CkSkeletonizeArgs() = default;
+
+// PUBLIC MEMBERS
+public:
+    std::vector<String> inputs;               ///< Checkpoint files or directories to skeletonize
+    String  output     = ".";                 ///< Output directory (or output file for a single input file)
+    int     threads    = 0;                   ///< Number of threads (0 = one per core)
+    SyntheticFill::Mode fill = SyntheticFill::Mode::ZEROS; ///< How the data section is filled
+    double  mean       = 0.0;                 ///< Mean of the values in NORMAL fill mode
+    double  std        = 0.02;                ///< Standard deviation of the values in NORMAL fill mode
+    int     seed       = 0;                   ///< Seed of the synthetic values
+    String  when_color = "auto";              ///< When to use color in output
+    bool    verify     = true;                ///< true = check that the skeleton round-trips through TensorMap
+    bool    force      = false;               ///< true = overwrite existing output files
+    bool    help       = false;               ///< true = print usage and exit
+    bool    version    = false;               ///< true = print version and exit
+    const char * const help_message = nullptr;
+};
+
+/**
+ * Overloads the insertion operator (<<) for printing CkSkeletonizeArgs objects to an output stream.
+ *
+ * @param os   The output stream where the Args data will be printed.
+ * @param args The Args object being printed to the stream.
+ * @return A reference `os` for chaining.
+ */
+inline std::ostream&
+operator<<(std::ostream& os, const CkSkeletonizeArgs& args) {
+    os << "Args:"                                         << std::endl;
+    os << "  inputs: "      << args.inputs.size()         << std::endl;
+    os << "  output: "      << args.output                << std::endl;
+    os << "  threads: "     << args.threads               << std::endl;
+    os << "  fill: "        << static_cast<int>(args.fill) << std::endl;
+    os << "  mean: "        << args.mean                  << std::endl;
+    os << "  std: "         << args.std                   << std::endl;
+    os << "  seed: "        << args.seed                  << std::endl;
+    os << "  when_color: "  << args.when_color            << std::endl;
+    os << "  verify: "      << to_string(args.verify)     << std::endl;
+    os << "  force: "       << to_string(args.force)      << std::endl;
+    os << "  help: "        << to_string(args.help)       << std::endl;
+    os << "  version: "     << to_string(args.version);
+    return os;
+}
+
+#endif // CKSKELETONIZE_ARGS_H_
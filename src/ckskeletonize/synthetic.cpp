@@ -0,0 +1,382 @@
+/*
+| File    : synthetic.cpp
+| Purpose : Fills the tensors of a skeleton with deterministic pseudo-random values.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 5, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#include <algorithm> // for std::min, std::max
+#include <atomic>    // for std::atomic
+#include <bit>       // for std::bit_cast
+#include <cmath>     // for std::sqrt, std::nearbyint
+#include <cstring>   // for std::memcpy
+#include <limits>    // for std::numeric_limits
+#include "minifloat.h"
+#include "parallel.h"
+#include "philox.h"
+#include "synthetic.h"
+
+/// Tensors are generated and written in chunks of this size.
+static constexpr std::uint64_t ChunkSize = 32 * 1024 * 1024;
+
+static constexpr float TwoPi = 6.28318530717958647692f;
+
+
+//================================ HELPERS ================================//
+
+/**
+ * Returns the identifier of the random stream of a tensor (32-bit FNV-1a of its name).
+ */
+static std::uint32_t
+_stream_of(StringView name) noexcept {
+    std::uint32_t hash = 2166136261u;
+    for( unsigned char ch : name ) { hash = (hash ^ ch) * 16777619u; }
+    return hash;
+}
+
+/**
+ * Natural logarithm of x in (0, 1], accurate to about 1e-6.
+ * Written without branches or library calls so the batch loops vectorize.
+ */
+static inline float
+_fast_log(float x) noexcept {
+    // x = m * 2^e with m in [sqrt(1/2), sqrt(2)), log(m) = 2*atanh(s), s = (m-1)/(m+1)
+    const std::uint32_t bits     = std::bit_cast<std::uint32_t>(x);
+    const std::uint32_t offset   = bits - 0x3F3504F3u; // 0x3F3504F3 = sqrt(1/2)
+    const float         exponent = static_cast<float>(static_cast<std::int32_t>(offset) >> 23);
+    const float         m  = std::bit_cast<float>((offset & 0x007FFFFFu) + 0x3F3504F3u);
+    const float         s  = (m - 1.0f) / (m + 1.0f);
+    const float         s2 = s * s;
+    const float atanh = s * (1.0f + s2 * (1.0f/3.0f + s2 * (1.0f/5.0f + s2 * (1.0f/7.0f + s2 * (1.0f/9.0f)))));
+    return exponent * 0.693147180559945f + 2.0f * atanh;
+}
+
+/**
+ * Square root of x >= 0 (reciprocal square root estimate refined with Newton's method).
+ * std::sqrt can't be vectorized by most compilers because it may set errno.
+ */
+static inline float
+_fast_sqrt(float x) noexcept {
+    float r = std::bit_cast<float>(0x5F3759DFu - (std::bit_cast<std::uint32_t>(x) >> 1));
+    r = r * (1.5f - 0.5f * x * r * r);
+    r = r * (1.5f - 0.5f * x * r * r);
+    r = r * (1.5f - 0.5f * x * r * r);
+    return x * r;
+}
+
+/**
+ * Sine and cosine of 2*pi*u for u in [0, 1], accurate to about 1e-6.
+ * Written without branches or library calls so the batch loops vectorize.
+ */
+static inline void
+_fast_sincos_2pi(float u, float& sine, float& cosine) noexcept {
+    // reduce to a in [-pi, pi] and use the Taylor series up to the 18th power
+    // (u >= 0, so the integer conversion is a floor that vectorizes without SSE4.1)
+    const float a  = TwoPi * (u - static_cast<float>(static_cast<std::int32_t>(u + 0.5f)));
+    const float a2 = a * a;
+    sine   = a * (1.0f - a2/6.0f * (1.0f - a2/20.0f * (1.0f - a2/42.0f * (1.0f - a2/72.0f * (1.0f - a2/110.0f *
+                 (1.0f - a2/156.0f * (1.0f - a2/210.0f * (1.0f - a2/272.0f))))))));
+    cosine = 1.0f - a2/2.0f * (1.0f - a2/12.0f * (1.0f - a2/30.0f * (1.0f - a2/56.0f * (1.0f - a2/90.0f *
+                 (1.0f - a2/132.0f * (1.0f - a2/182.0f * (1.0f - a2/240.0f * (1.0f - a2/306.0f))))))));
+}
+
+/// Number of elements produced by one Philox batch (four per block).
+static constexpr std::uint64_t BatchElements = 4 * Philox4x32::BatchSize;
+
+/**
+ * Generates the normally distributed values of elements [4*block, 4*block + BatchElements)
+ * of a tensor (Box-Muller transform over a batch of Philox blocks).
+ */
+static void
+_normal_batch(const Philox4x32& philox, std::uint32_t stream, std::uint64_t block, float normals[BatchElements]) noexcept {
+    Philox4x32::Batch batch;
+    philox.generate_batch(block, stream, 0, batch);
+    for( int pair=0 ; pair<2 ; ++pair ) {
+        for( int i=0 ; i<Philox4x32::BatchSize ; ++i ) {
+            float sine, cosine;
+            const float radius = _fast_sqrt(-2.0f * _fast_log(Philox4x32::to_uniform(batch[2*pair][i])));
+            _fast_sincos_2pi(Philox4x32::to_uniform(batch[2*pair + 1][i]), sine, cosine);
+            normals[4*i + 2*pair]     = radius * cosine;
+            normals[4*i + 2*pair + 1] = radius * sine;
+        }
+    }
+}
+
+/**
+ * Generates elements [first, first+count) of a tensor from normally
+ * distributed values, converting each one with `encode(float)`.
+ */
+template <typename Element, typename Encode>
+static void
+_generate_normal(const Philox4x32& philox, std::uint32_t stream, std::uint64_t first, std::uint64_t count,
+                 char* buffer, float mean, float std, Encode encode)
+{
+    const std::uint64_t end = first + count;
+    float normals[BatchElements];
+    for( std::uint64_t block = first / 4 ; block * 4 < end ; block += Philox4x32::BatchSize ) {
+        _normal_batch(philox, stream, block, normals);
+        const std::uint64_t base = block * 4;
+        const std::uint64_t from = std::max(base, first);
+        const std::uint64_t to   = std::min(base + BatchElements, end);
+        for( std::uint64_t index = from ; index < to ; ++index ) {
+            const Element element = encode(mean + std * normals[index - base]);
+            std::memcpy(buffer + (index - first) * sizeof(Element), &element, sizeof(Element));
+        }
+    }
+}
+
+/**
+ * Generates elements [first, first+count) of a tensor with uniformly random bits.
+ * Elements of up to 32 bits take one Philox word each; a 64-bit element
+ * takes two words of its own (words 2*index and 2*index+1).
+ */
+template <typename Element>
+static void
+_generate_bits(const Philox4x32& philox, std::uint32_t stream, std::uint64_t first, std::uint64_t count, char* buffer)
+{
+    constexpr std::uint64_t Words = sizeof(Element) > 4 ? 2 : 1;
+    const std::uint64_t end = first + count;
+    Philox4x32::Batch batch;
+    for( std::uint64_t block = first * Words / 4 ; block * 4 < end * Words ; block += Philox4x32::BatchSize ) {
+        philox.generate_batch(block, stream, 1, batch);
+        const std::uint64_t base = block * 4 / Words;
+        const std::uint64_t from = std::max(base, first);
+        const std::uint64_t to   = std::min(base + BatchElements / Words, end);
+        for( std::uint64_t index = from ; index < to ; ++index ) {
+            const std::uint64_t word = (index - base) * Words;
+            const std::uint64_t i = word / 4, lane = word % 4;
+            std::uint64_t bits;
+            if constexpr( Words == 2 ) { bits = (static_cast<std::uint64_t>(batch[lane][i]) << 32) | batch[lane + 1][i]; }
+            else                       { bits = batch[(lane + 1) % 4][i]; }
+            const Element element = static_cast<Element>(bits);
+            std::memcpy(buffer + (index - first) * sizeof(Element), &element, sizeof(Element));
+        }
+    }
+}
+
+/**
+ * Rounds a value to the nearest integer representable by `Integer`.
+ */
+template <typename Integer>
+static Integer
+_to_integer(float value) noexcept {
+    constexpr float min = static_cast<float>(std::numeric_limits<Integer>::min());
+    constexpr float max = static_cast<float>(std::numeric_limits<Integer>::max());
+    const float rounded = std::nearbyint(value);
+    if( !(rounded > min) ) { return std::numeric_limits<Integer>::min(); }
+    if( !(rounded < max) ) { return std::numeric_limits<Integer>::max(); }
+    return static_cast<Integer>(rounded);
+}
+
+/**
+ * Accumulates sum and sum of squares of `count` elements decoded with `decode(Element)`.
+ */
+template <typename Element, typename Decode>
+static void
+_accumulate(const char* buffer, std::uint64_t count, double& sum, double& sumOfSquares, std::uint64_t& finite, Decode decode)
+{
+    for( std::uint64_t i=0 ; i<count ; ++i ) {
+        Element element;
+        std::memcpy(&element, buffer + i * sizeof(Element), sizeof(Element));
+        const double value = decode(element);
+        if( !std::isfinite(value) ) { continue; }
+        sum += value; sumOfSquares += value * value; ++finite;
+    }
+}
+
+//============================= CONSTRUCTION ==============================//
+
+SyntheticFill::SyntheticFill(Mode mode, std::uint64_t seed, double mean, double std, unsigned numberOfThreads)
+: _mode(mode), _seed(seed), _mean(mean), _std(std), _numberOfThreads(numberOfThreads)
+{}
+
+//=============================== HELPERS =================================//
+
+/**
+ * Returns true if tensors of the given safetensors dtype can be generated.
+ */
+bool
+SyntheticFill::is_supported(StringView dtype) noexcept {
+    return safetensors_dtype_size(dtype) != 0;
+}
+
+//============================== OPERATIONS ===============================//
+
+/**
+ * Returns the tensors of a .safetensors file that can be filled.
+ * Alignment padding tensors are excluded.
+ */
+SyntheticFill::Tensors
+SyntheticFill::tensors_of(const SafetensorsFile& safetensors) const {
+    Tensors tensors;
+    for( const auto& tensor : safetensors.tensors() ) {
+        if( tensor.is_padding() || !is_supported(tensor.dtype) ) { continue; }
+        tensors.push_back({ tensor.name, tensor.dtype, safetensors.data_offset() + tensor.begin,
+                            tensor.size() / safetensors_dtype_size(tensor.dtype), _mean, _std });
+    }
+    return tensors;
+}
+
+/**
+ * Returns the tensors of a .gguf file that can be filled.
+ * Quantized tensors are excluded, their blocks can't be generated from a distribution.
+ */
+SyntheticFill::Tensors
+SyntheticFill::tensors_of(const GgufFile& gguf) const {
+    Tensors tensors;
+    for( const auto& tensor : gguf.tensors() ) {
+        StringView dtype;
+        switch( tensor.type ) {
+            case 0:  dtype = "F32";  break;
+            case 1:  dtype = "F16";  break;
+            case 24: dtype = "I8";   break;
+            case 25: dtype = "I16";  break;
+            case 26: dtype = "I32";  break;
+            case 27: dtype = "I64";  break;
+            case 28: dtype = "F64";  break;
+            case 30: dtype = "BF16"; break;
+            default: continue;
+        }
+        tensors.push_back({ tensor.name, String{dtype}, gguf.data_offset() + tensor.offset,
+                            tensor.size / safetensors_dtype_size(dtype), _mean, _std });
+    }
+    return tensors;
+}
+
+/**
+ * Splits the tensors in chunks of at most `ChunkSize` bytes that can be
+ * processed independently. The values don't depend on where the chunks
+ * start, every element is derived from its own index.
+ */
+std::vector<SyntheticFill::Chunk>
+SyntheticFill::_split(const Tensors& tensors) const {
+    std::vector<Chunk> chunks;
+    for( size_t t=0 ; t<tensors.size() ; ++t ) {
+        const std::uint64_t elementsPerChunk = ChunkSize / safetensors_dtype_size(tensors[t].dtype);
+        for( std::uint64_t first=0 ; first<tensors[t].numberOfElements ; first+=elementsPerChunk ) {
+            chunks.push_back({ t, first, std::min(elementsPerChunk, tensors[t].numberOfElements - first) });
+        }
+    }
+    return chunks;
+}
+
+/**
+ * Measures the mean and standard deviation of every tensor in the original file.
+ *
+ * @param original The original checkpoint file.
+ * @param tensors  The tensors to measure, updated with the statistics found.
+ * @return false if the file couldn't be read.
+ */
+bool
+SyntheticFill::measure(const File& original, Tensors& tensors) const {
+    struct Partial { double sum = 0.0; double sumOfSquares = 0.0; std::uint64_t count = 0; };
+
+    const auto chunks = _split(tensors);
+    std::vector<Partial> partials(chunks.size());
+    std::atomic<bool> ok{true};
+    parallel_for(chunks.size(), _numberOfThreads, [&](size_t c) {
+        thread_local std::vector<char> buffer(ChunkSize);
+        const auto& chunk  = chunks[c];
+        const auto& tensor = tensors[chunk.tensor];
+        const auto  elementSize = safetensors_dtype_size(tensor.dtype);
+        if( !original.read_at(buffer.data(), chunk.count * elementSize, tensor.offset + chunk.first * elementSize) ) {
+            ok = false;
+            return;
+        }
+        auto& p = partials[c];
+        const auto& d = tensor.dtype;
+        const char* data = buffer.data();
+        if     ( d == "F32"     ) { _accumulate<float        >(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](float v)         { return v; }); }
+        else if( d == "F64"     ) { _accumulate<double       >(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](double v)        { return v; }); }
+        else if( d == "F16"     ) { _accumulate<std::uint16_t>(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](std::uint16_t v) { return f16_to_float(v);  }); }
+        else if( d == "BF16"    ) { _accumulate<std::uint16_t>(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](std::uint16_t v) { return bf16_to_float(v); }); }
+        else if( d == "F8_E4M3" ) { _accumulate<std::uint8_t >(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](std::uint8_t v)  { return f8_e4m3_to_float(v); }); }
+        else if( d == "F8_E5M2" ) { _accumulate<std::uint8_t >(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](std::uint8_t v)  { return f8_e5m2_to_float(v); }); }
+        else if( d == "I64"     ) { _accumulate<std::int64_t >(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](std::int64_t v)  { return static_cast<double>(v); }); }
+        else if( d == "I32"     ) { _accumulate<std::int32_t >(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](std::int32_t v)  { return static_cast<double>(v); }); }
+        else if( d == "I16"     ) { _accumulate<std::int16_t >(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](std::int16_t v)  { return static_cast<double>(v); }); }
+        else if( d == "I8"      ) { _accumulate<std::int8_t  >(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](std::int8_t v)   { return static_cast<double>(v); }); }
+        else if( d == "U64"     ) { _accumulate<std::uint64_t>(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](std::uint64_t v) { return static_cast<double>(v); }); }
+        else if( d == "U32"     ) { _accumulate<std::uint32_t>(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](std::uint32_t v) { return static_cast<double>(v); }); }
+        else if( d == "U16"     ) { _accumulate<std::uint16_t>(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](std::uint16_t v) { return static_cast<double>(v); }); }
+        else if( d == "U8"      ) { _accumulate<std::uint8_t >(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](std::uint8_t v)  { return static_cast<double>(v); }); }
+        else if( d == "BOOL"    ) { _accumulate<std::uint8_t >(data, chunk.count, p.sum, p.sumOfSquares, p.count, [](std::uint8_t v)  { return v ? 1.0 : 0.0; }); }
+    });
+    if( !ok ) { return false; }
+
+    // combine the partial sums in chunk order so the result doesn't depend on the threads
+    std::vector<Partial> totals(tensors.size());
+    for( size_t c=0 ; c<chunks.size() ; ++c ) {
+        auto& total = totals[chunks[c].tensor];
+        total.sum += partials[c].sum; total.sumOfSquares += partials[c].sumOfSquares; total.count += partials[c].count;
+    }
+    for( size_t t=0 ; t<tensors.size() ; ++t ) {
+        if( totals[t].count == 0 ) { tensors[t].mean = 0.0; tensors[t].std = 0.0; continue; }
+        const double n = static_cast<double>(totals[t].count);
+        tensors[t].mean = totals[t].sum / n;
+        tensors[t].std  = std::sqrt(std::max(0.0, totals[t].sumOfSquares / n - tensors[t].mean * tensors[t].mean));
+    }
+    return true;
+}
+
+/**
+ * Generates elements [first, first+count) of a tensor into `buffer`.
+ */
+void
+SyntheticFill::_generate(const Tensor& tensor, std::uint64_t first, std::uint64_t count, char* buffer) const {
+    const Philox4x32    philox{ _seed };
+    const std::uint32_t stream = _stream_of(tensor.name);
+    const float mean = static_cast<float>(tensor.mean);
+    const float std  = static_cast<float>(tensor.std);
+    const bool  real = _mode == Mode::STATS; // integers use real statistics or random bits
+    const auto& d    = tensor.dtype;
+
+    if     ( d == "F32"     ) { _generate_normal<float        >(philox, stream, first, count, buffer, mean, std, [](float v) { return v; }); }
+    else if( d == "F64"     ) { _generate_normal<double       >(philox, stream, first, count, buffer, mean, std, [](float v) { return static_cast<double>(v); }); }
+    else if( d == "F16"     ) { _generate_normal<std::uint16_t>(philox, stream, first, count, buffer, mean, std, float_to_f16);     }
+    else if( d == "BF16"    ) { _generate_normal<std::uint16_t>(philox, stream, first, count, buffer, mean, std, float_to_bf16);    }
+    else if( d == "F8_E4M3" ) { _generate_normal<std::uint8_t >(philox, stream, first, count, buffer, mean, std, float_to_f8_e4m3); }
+    else if( d == "F8_E5M2" ) { _generate_normal<std::uint8_t >(philox, stream, first, count, buffer, mean, std, float_to_f8_e5m2); }
+    else if( d == "BOOL"    ) {
+        if( real ) { _generate_normal<std::uint8_t>(philox, stream, first, count, buffer, mean, std, [](float v) { return static_cast<std::uint8_t>(v >= 0.5f); }); }
+        else       { _generate_normal<std::uint8_t>(philox, stream, first, count, buffer, 0.0f, 1.0f, [](float v) { return static_cast<std::uint8_t>(v >= 0.0f); }); }
+    }
+    else if( d == "I64" ) { if( real ) { _generate_normal<std::int64_t >(philox, stream, first, count, buffer, mean, std, _to_integer<std::int64_t >); } else { _generate_bits<std::int64_t >(philox, stream, first, count, buffer); } }
+    else if( d == "I32" ) { if( real ) { _generate_normal<std::int32_t >(philox, stream, first, count, buffer, mean, std, _to_integer<std::int32_t >); } else { _generate_bits<std::int32_t >(philox, stream, first, count, buffer); } }
+    else if( d == "I16" ) { if( real ) { _generate_normal<std::int16_t >(philox, stream, first, count, buffer, mean, std, _to_integer<std::int16_t >); } else { _generate_bits<std::int16_t >(philox, stream, first, count, buffer); } }
+    else if( d == "I8"  ) { if( real ) { _generate_normal<std::int8_t  >(philox, stream, first, count, buffer, mean, std, _to_integer<std::int8_t  >); } else { _generate_bits<std::int8_t  >(philox, stream, first, count, buffer); } }
+    else if( d == "U64" ) { if( real ) { _generate_normal<std::uint64_t>(philox, stream, first, count, buffer, mean, std, _to_integer<std::uint64_t>); } else { _generate_bits<std::uint64_t>(philox, stream, first, count, buffer); } }
+    else if( d == "U32" ) { if( real ) { _generate_normal<std::uint32_t>(philox, stream, first, count, buffer, mean, std, _to_integer<std::uint32_t>); } else { _generate_bits<std::uint32_t>(philox, stream, first, count, buffer); } }
+    else if( d == "U16" ) { if( real ) { _generate_normal<std::uint16_t>(philox, stream, first, count, buffer, mean, std, _to_integer<std::uint16_t>); } else { _generate_bits<std::uint16_t>(philox, stream, first, count, buffer); } }
+    else if( d == "U8"  ) { if( real ) { _generate_normal<std::uint8_t >(philox, stream, first, count, buffer, mean, std, _to_integer<std::uint8_t >); } else { _generate_bits<std::uint8_t >(philox, stream, first, count, buffer); } }
+}
+
+/**
+ * Writes synthetic values for every tensor, in parallel chunks.
+ *
+ * @param output  The skeleton file, already extended to its final size.
+ * @param tensors The tensors to fill (from `tensors_of()`, and `measure()` in STATS mode).
+ * @return false if the file couldn't be written.
+ */
+bool
+SyntheticFill::fill(const File& output, const Tensors& tensors) const {
+    if( _mode == Mode::ZEROS ) { return true; }
+
+    const auto chunks = _split(tensors);
+    std::atomic<bool> ok{true};
+    parallel_for(chunks.size(), _numberOfThreads, [&](size_t c) {
+        thread_local std::vector<char> buffer(ChunkSize);
+        const auto& chunk  = chunks[c];
+        const auto& tensor = tensors[chunk.tensor];
+        const auto  elementSize = safetensors_dtype_size(tensor.dtype);
+        _generate(tensor, chunk.first, chunk.count, buffer.data());
+        if( !output.write_at(buffer.data(), chunk.count * elementSize, tensor.offset + chunk.first * elementSize) ) {
+            ok = false;
+        }
+    });
+    return ok;
+}
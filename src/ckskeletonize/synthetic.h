@@ -0,0 +1,85 @@
+/*
+| File    : synthetic.h
+| Purpose : Fills the tensors of a skeleton with deterministic pseudo-random values.
+| Author  : Martin Rizzo | <martinrizzo@gmail.com>
+| Date    : Dec 5, 2025
+| Repo    : https://github.com/martin-rizzo/CheckpointTools
+| License : MIT
+|- - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -
+|                              CheckpointTools
+|      CLI tools for inspecting and manipulating model checkpoint files
+\_ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _ _*/
+#pragma once
+#ifndef SYNTHETIC_H_
+#define SYNTHETIC_H_
+#include <cstdint>
+#include <vector>
+#include "common.h"
+#include "file.h"
+#include "gguf.h"
+#include "safetensors.h"
+
+
+/**
+ * Fills the tensors of a skeleton file with synthetic data.
+ *
+ * Floating point tensors receive normally distributed values, either with a
+ * fixed mean and standard deviation or with the ones measured on the real
+ * tensor. Integer tensors receive uniformly random bits, or rounded normal
+ * values when the real statistics are used.
+ *
+ * The value of every element depends only on the seed, the tensor name and
+ * the element index (a Philox counter), so the output is identical no matter
+ * how the work is split between threads, and a tensor gets the same values
+ * after the checkpoint is resharded. Quantized GGUF tensors are not filled.
+ */
+class SyntheticFill
+{
+public:
+    enum class Mode {
+        ZEROS,   ///< no fill, the data section stays as a sparse hole
+        NORMAL,  ///< fixed normal distribution for all tensors
+        STATS    ///< per-tensor mean and standard deviation of the original file
+    };
+
+    /// A tensor that can be filled, with its location in the file.
+    struct Tensor {
+        String        name;
+        String        dtype;                ///< safetensors dtype name ("F16", "BF16", "F32", ...)
+        std::uint64_t offset           = 0; ///< absolute offset of the first byte in the file
+        std::uint64_t numberOfElements = 0;
+        double        mean             = 0.0;
+        double        std              = 0.0;
+    };
+    using Tensors = std::vector<Tensor>;
+
+// CONSTRUCTION
+public:
+    SyntheticFill(Mode mode, std::uint64_t seed, double mean, double std, unsigned numberOfThreads);
+
+// OPERATIONS
+public:
+    [[nodiscard]] Tensors tensors_of(const SafetensorsFile& safetensors) const;
+    [[nodiscard]] Tensors tensors_of(const GgufFile& gguf) const;
+    [[nodiscard]] bool    measure(const File& original, Tensors& tensors) const;
+    [[nodiscard]] bool    fill(const File& output, const Tensors& tensors) const;
+
+// HELPERS
+public:
+    [[nodiscard]] static bool is_supported(StringView dtype) noexcept;
+
+// IMPLEMENTATION
+private:
+    struct Chunk { size_t tensor; std::uint64_t first; std::uint64_t count; };
+    [[nodiscard]] std::vector<Chunk> _split(const Tensors& tensors) const;
+    void _generate(const Tensor& tensor, std::uint64_t first, std::uint64_t count, char* buffer) const;
+private:
+    Mode          _mode;
+    std::uint64_t _seed;
+    double        _mean;
+    double        _std;
+    unsigned      _numberOfThreads;
+};
+
+
+#endif // SYNTHETIC_H_